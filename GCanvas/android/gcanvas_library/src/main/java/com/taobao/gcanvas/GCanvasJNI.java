@@ -234,6 +234,24 @@ public class GCanvasJNI {
 
     public static native int getNativeFps(String contextId);
 
+    /**
+     * Decodes an encoded PNG off the GL thread. The texture is uploaded by a
+     * later render of the canvas, until then images drawn from it are skipped.
+     */
+    public static native void addPngTextureAsync(String contextId, byte[] png, int textureId);
+
+    /**
+     * Per frame statistics of a canvas, off by default. Takes effect with the
+     * next frame the GL thread renders.
+     */
+    public static native void setFrameStatsEnabled(String contextId, boolean enabled);
+
+    /**
+     * @param maxFrames the newest frames to return, 0 for all that are kept
+     * @return {"frames":[...]} with one object per frame, oldest first
+     */
+    public static native String getFrameStatsJson(String contextId, int maxFrames);
+
     public static void registerWXCallNativeFunc(Context context) {
         /**
          * We have a different javascript-call-native solution on Weex, which we call it "directly" call-native.
@@ -256,6 +274,12 @@ public class GCanvasJNI {
 
     public static native void render(String contextID, String renderCommands);
 
+    /**
+     * Runs several sync commands of one type in a single round trip to the GL thread.
+     * @return the results in the order of args, empty for a command that timed out
+     */
+    public static native String[] callNativeBatch(String contextID, int type, String[] args);
+
 
     public static native void release(); // Deletes native canvas
 
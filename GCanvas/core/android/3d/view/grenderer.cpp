@@ -5,6 +5,7 @@
 #include <GCanvasManager.h>
 #include <android/bitmap.h>
 #include <support/Util.h>
+#include <gcanvas/GGLStateCache.h>
 #include "grenderer.h"
 
 
@@ -114,6 +115,7 @@ bool GRenderer::initialize() {
         destroy();
         return false;
     }
+    GGLStateCache::Current()->Invalidate();
 
     if (!eglQuerySurface(display, surface, EGL_WIDTH, &width) ||
         !eglQuerySurface(display, surface, EGL_HEIGHT, &height)) {
@@ -126,7 +128,7 @@ bool GRenderer::initialize() {
     m_egl_surface = surface;
     m_egl_context = context;
 
-    glViewport(0, 0, width, height);
+    GGLStateCache::Current()->Viewport(0, 0, width, height);
 
     m_width = width;
     m_height = height;
@@ -240,7 +242,11 @@ void GRenderer::renderLoop() {
                 if (!initResult) {
                     break;
                 }
-                if (mProxy) mProxy->setContextLost(false);
+                if (mProxy) {
+                    mProxy->setContextLost(false);
+                    // the context is created without sharing, it is its own group
+                    mProxy->GetGCanvasContext()->SetShareGroup(m_egl_context);
+                }
             }
 
             mProxy->OnSurfaceChanged(0, 0, m_width, m_height);
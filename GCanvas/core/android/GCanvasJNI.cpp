@@ -21,6 +21,8 @@
 #include "support/Log.h"
 
 #include "GSystemFontInformation.h"
+#include "gcanvas/GTexture.h"
+#include "png/PngLoader.h"
 
 
 #ifdef GCANVAS_WEEX
@@ -28,6 +30,7 @@
 #include <3d/gmanager.h>
 #include "GCanvasManager.h"
 #include "GCanvasLinkNative.h"
+#include "gcanvas/GProgramBinaryCache.h"
 #include "elf_sym_reader.h"
 
 #endif
@@ -65,6 +68,26 @@ char *jstringToString(JNIEnv *env, jstring jstr) {
     return strReturn;
 }
 
+// TextureMgr wants pixels released by delete [], lodepng hands out malloc'ed ones
+static unsigned char *DecodePngImage(const unsigned char *buffer, unsigned int size,
+                                     unsigned int *w, unsigned int *h) {
+    unsigned char *decoded = nullptr;
+    if (PngLoader::Instance().DecodePng(buffer, size, &decoded, w, h) != 0 ||
+        decoded == nullptr) {
+        free(decoded);
+        return nullptr;
+    }
+    size_t length = (size_t) (*w) * (*h) * 4;
+    unsigned char *pixels = new unsigned char[length];
+    memcpy(pixels, decoded, length);
+    free(decoded);
+    return pixels;
+}
+
+static void RegisterImageDecoder() {
+    TextureMgr::SetDecodeImageCallback(DecodePngImage);
+}
+
 
 #ifdef GCANVAS_WEEX
 
@@ -143,6 +166,7 @@ extern int g_js_version;
 JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_newCanvas(
         JNIEnv *je, jclass jc, jstring contextId, jint jsVersion, jstring clearColor) {
     LOG_E("Canvas JNI::newCanvas. jsVer=%d", jsVersion);
+    RegisterImageDecoder();
     GCanvasManager *theManager = GCanvasManager::GetManager();
     char *cid = jstringToString(je, contextId);
     string canvasId = cid;
@@ -419,6 +443,7 @@ JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_setDevicePixelRatio(
 }
 
 JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_init(JNIEnv *je, jclass jc) {
+    RegisterImageDecoder();
 #ifdef ENABLE_GPROF
     monstartup("libgcanvas.so");
 #endif
@@ -472,17 +497,13 @@ JNIEXPORT jstring JNICALL Java_com_taobao_gcanvas_GCanvasJNI_getImageData(
 #endif
 
 
-extern bool g_use_pre_compile;
-extern std::string g_shader_cache_path;
-
 JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_setPreCompilePath(
         JNIEnv *je, jclass jc, jstring path) {
     const char *pathPreCompile = je->GetStringUTFChars(path, 0);
 
     LOG_D("Canvas JNI::setPreCompilePath = %s", pathPreCompile);
 
-    g_use_pre_compile = true;
-    g_shader_cache_path = pathPreCompile;
+    GProgramBinaryCache::GetInstance()->SetDirectory(pathPreCompile);
 
     je->ReleaseStringUTFChars(path, pathPreCompile);
 }
@@ -555,6 +576,82 @@ JNIEXPORT jstring JNICALL Java_com_taobao_gcanvas_GCanvasJNI_exeSyncCmd
     return nullptr;
 }
 
+JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_addPngTextureAsync
+        (JNIEnv *je, jclass jc, jstring ContextID, jbyteArray png, jint textureId) {
+    if (png == nullptr) {
+        return;
+    }
+    char *cid = jstringToString(je, ContextID);
+    string contextID = cid;
+    free(cid);
+
+    GCanvasManager *theManager = GCanvasManager::GetManager();
+    GCanvasWeex *theCanvas = (GCanvasWeex *) theManager->GetCanvas(contextID);
+    if (theCanvas) {
+        jsize size = je->GetArrayLength(png);
+        jbyte *bytes = je->GetByteArrayElements(png, nullptr);
+        // the loader copies the buffer
+        theCanvas->AddPngTextureAsync((const unsigned char *) bytes, (unsigned int) size,
+                                      textureId);
+        je->ReleaseByteArrayElements(png, bytes, JNI_ABORT);
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_setFrameStatsEnabled
+        (JNIEnv *je, jclass jc, jstring ContextID, jboolean enabled) {
+    char *cid = jstringToString(je, ContextID);
+    string contextID = cid;
+    free(cid);
+
+    GCanvasManager *theManager = GCanvasManager::GetManager();
+    GCanvasWeex *theCanvas = (GCanvasWeex *) theManager->GetCanvas(contextID);
+    if (theCanvas) {
+        theCanvas->SetFrameStatsEnabled(enabled == JNI_TRUE);
+    }
+}
+
+JNIEXPORT jstring JNICALL Java_com_taobao_gcanvas_GCanvasJNI_getFrameStatsJson
+        (JNIEnv *je, jclass jc, jstring ContextID, jint maxFrames) {
+    char *cid = jstringToString(je, ContextID);
+    string contextID = cid;
+    free(cid);
+
+    GCanvasManager *theManager = GCanvasManager::GetManager();
+    GCanvasWeex *theCanvas = (GCanvasWeex *) theManager->GetCanvas(contextID);
+    if (theCanvas) {
+        std::string json = theCanvas->GetFrameStatsJson(maxFrames > 0 ? (size_t) maxFrames : 0);
+        return je->NewStringUTF(json.c_str());
+    }
+    return je->NewStringUTF("{\"frames\":[]}");
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_taobao_gcanvas_GCanvasJNI_callNativeBatch
+        (JNIEnv *je, jclass jc, jstring ContextID, jint type, jobjectArray args) {
+    int length = je->GetArrayLength(args);
+    std::vector<std::string> batch;
+    batch.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        jstring s = (jstring) je->GetObjectArrayElement(args, i);
+        const char *cmd = je->GetStringUTFChars(s, 0);
+        batch.push_back(cmd);
+        je->ReleaseStringUTFChars(s, cmd);
+        je->DeleteLocalRef(s);
+    }
+
+    char *cid = jstringToString(je, ContextID);
+    std::vector<std::string> results = GCanvasLinkNative::CallNativeBatch(cid, type, batch);
+    free(cid);
+
+    jclass stringClass = je->FindClass("java/lang/String");
+    jobjectArray resultArray = je->NewObjectArray(length, stringClass, nullptr);
+    for (int i = 0; i < length; ++i) {
+        jstring s = je->NewStringUTF(results[i].c_str());
+        je->SetObjectArrayElement(resultArray, i, s);
+        je->DeleteLocalRef(s);
+    }
+    return resultArray;
+}
+
 //extern int g_encode_type;
 //extern int g_clear_color_time;
 
@@ -172,6 +172,18 @@ JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_setConfig(JNIEnv *je,
 JNIEXPORT jstring JNICALL Java_com_taobao_gcanvas_GCanvasJNI_exeSyncCmd
         (JNIEnv *je, jclass jc, jstring ContextID, jint type, jstring args);
 
+JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_addPngTextureAsync
+        (JNIEnv *je, jclass jc, jstring ContextID, jbyteArray png, jint textureId);
+
+JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_setFrameStatsEnabled
+        (JNIEnv *je, jclass jc, jstring ContextID, jboolean enabled);
+
+JNIEXPORT jstring JNICALL Java_com_taobao_gcanvas_GCanvasJNI_getFrameStatsJson
+        (JNIEnv *je, jclass jc, jstring ContextID, jint maxFrames);
+
+JNIEXPORT jobjectArray JNICALL Java_com_taobao_gcanvas_GCanvasJNI_callNativeBatch
+        (JNIEnv *je, jclass jc, jstring ContextID, jint type, jobjectArray args);
+
 JNIEXPORT void JNICALL Java_com_taobao_gcanvas_GCanvasJNI_bindTexture(
         JNIEnv *je, jclass jc, jstring contextId, jobject bitmap, jint id,
         jint target, jint level, jint internalformat, jint format, jint type);
@@ -27,6 +27,31 @@ GCanvasLinkNative::CallNative(const char *ContextId, int type, const char *args)
         return nullptr;
     }
 
+    if (type & GCANVAS_BATCH_FLAG) {
+        vector<string> batch;
+        const char *begin = args;
+        for (const char *p = args;; ++p) {
+            if (*p == GCANVAS_BATCH_SEPARATOR || *p == '\0') {
+                batch.push_back(string(begin, p - begin));
+                if (*p == '\0') {
+                    break;
+                }
+                begin = p + 1;
+            }
+        }
+        vector<string> results = CallNativeBatch(ContextId, type & ~GCANVAS_BATCH_FLAG, batch);
+        string joined;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (i != 0) {
+                joined += GCANVAS_BATCH_SEPARATOR;
+            }
+            joined += results[i];
+        }
+        char *resultChar = new char[joined.length() + 1];
+        strcpy(resultChar, joined.c_str());
+        return resultChar;
+    }
+
     GCanvasManager *theManager = GCanvasManager::GetManager();
     string sContextId = ContextId;
     GCanvasWeex *theCanvas = static_cast<GCanvasWeex *>(theManager->GetCanvas(sContextId));
@@ -40,3 +65,21 @@ GCanvasLinkNative::CallNative(const char *ContextId, int type, const char *args)
     }
     return nullptr;
 }
+
+__attribute__ ((visibility ("default"))) vector<string>
+GCanvasLinkNative::CallNativeBatch(const char *ContextId, int type, const vector<string> &args) {
+    if (ContextId == nullptr || args.empty()) {
+        LOG_D("parameter error.\n");
+        return vector<string>(args.size());
+    }
+
+    GCanvasManager *theManager = GCanvasManager::GetManager();
+    string sContextId = ContextId;
+    GCanvasWeex *theCanvas = static_cast<GCanvasWeex *>(theManager->GetCanvas(sContextId));
+    if (theCanvas == nullptr) {
+        LOG_E("callnative batch CAN NOT FIND Canvas, id = %s, count=%d", sContextId.c_str(),
+              (int) args.size());
+        return vector<string>(args.size());
+    }
+    return theCanvas->CallNativeBatch(type, args);
+}
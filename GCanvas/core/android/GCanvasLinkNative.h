@@ -11,11 +11,21 @@
 #define GCANVAS_GCANVASLINKNATIVE_H
 
 //#include "GCanvas.hpp"
+#include <string>
+#include <vector>
+
+// set on the type when args holds several sync commands split by
+// GCANVAS_BATCH_SEPARATOR, they run in one round trip and the results come
+// back split the same way
+#define GCANVAS_BATCH_FLAG 0x10000000
+#define GCANVAS_BATCH_SEPARATOR '\x1e'
 
 namespace gcanvas {
     class GCanvasLinkNative {
     public:
         static const char* CallNative(const char* ContextId,int type,const char* args);
+        static std::vector<std::string> CallNativeBatch(const char* ContextId, int type,
+                                                        const std::vector<std::string> &args);
     };
 }
 
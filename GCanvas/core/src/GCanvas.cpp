@@ -82,8 +82,31 @@ void GCanvas::OnSurfaceChanged(int x, int y, int width, int height) {
 }
 
 
+void GCanvas::BeginFrame() {
+    mCanvasContext->GetFrameProfiler().BeginFrame();
+}
+
 void GCanvas::drawFrame() {
+    // closed before returning so the thread's active profiler is not left
+    // pointing at this canvas
+    GFrameProfiler &profiler = mCanvasContext->GetFrameProfiler();
+    if (!profiler.IsInFrame()) {
+        profiler.BeginFrame();
+    }
     mCanvasContext->SendVertexBufferToGPU();
+    profiler.EndFrame();
+}
+
+void GCanvas::SetFrameStatsEnabled(bool enabled) {
+    mCanvasContext->GetFrameProfiler().SetEnabled(enabled);
+}
+
+size_t GCanvas::GetFrameStats(std::vector<GFrameStats> &frames, size_t maxFrames) {
+    return mCanvasContext->GetFrameProfiler().GetFrames(frames, maxFrames);
+}
+
+std::string GCanvas::GetFrameStatsJson(size_t maxFrames) {
+    return mCanvasContext->GetFrameProfiler().ToJson(maxFrames);
 }
 
 }
@@ -24,13 +24,21 @@ public:
     virtual void CreateContext();
     virtual void Clear();
     
-    API_EXPORT void OnSurfaceChanged(int x, int y, int width, int height);
+    API_EXPORT virtual void OnSurfaceChanged(int x, int y, int width, int height);
     
     GCanvasContext* GetGCanvasContext() { return mCanvasContext; }
     float GetDevicePixelRatio() { return mCanvasContext->GetDevicePixelRatio();}
 
     API_EXPORT void drawFrame();
 
+    // per frame statistics, see GFrameProfiler; off by default, any thread
+    API_EXPORT void SetFrameStatsEnabled(bool enabled);
+    // opens a frame for hosts drawing through GCanvasContext directly,
+    // drawFrame() closes it; without it drawFrame() counts only its flush
+    API_EXPORT void BeginFrame();
+    API_EXPORT size_t GetFrameStats(std::vector<GFrameStats> &frames, size_t maxFrames = 0);
+    API_EXPORT std::string GetFrameStatsJson(size_t maxFrames = 0);
+
 
 public:
     std::string mContextId;
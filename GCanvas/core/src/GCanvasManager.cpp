@@ -58,6 +58,7 @@ GCanvasManager::~GCanvasManager()
 
 GCanvas* GCanvasManager::NewCanvas(const std::string canvasId, bool onScreen, bool useFbo, GCanvasHooks *hooks)
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     GCanvas *c = GetCanvas(canvasId);
     if (!c)
     {
@@ -73,6 +74,7 @@ GCanvas* GCanvasManager::NewCanvas(const std::string canvasId, bool onScreen, bo
 #ifdef GCANVAS_WEEX
 GCanvasWeex* GCanvasManager::NewCanvasWeex(const std::string canvasId, bool onScreen, bool useFbo)
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     GCanvas *c = GetCanvas(canvasId);
     if (!c)
     {
@@ -87,12 +89,15 @@ GCanvasWeex* GCanvasManager::NewCanvasWeex(const std::string canvasId, bool onSc
 
 void GCanvasManager::RemoveCanvas(const std::string canvasId)
 {
-    std::map< std::string, GCanvas * >::iterator it = mCanvases.find(canvasId);
-    if (it != mCanvases.end())
     {
-        delete it->second;
-        it->second = 0;
-        mCanvases.erase(it);
+        std::lock_guard<std::recursive_mutex> lock(mMutex);
+        std::map< std::string, GCanvas * >::iterator it = mCanvases.find(canvasId);
+        if (it != mCanvases.end())
+        {
+            delete it->second;
+            it->second = 0;
+            mCanvases.erase(it);
+        }
     }
     
 #ifdef IOS
@@ -107,6 +112,7 @@ void GCanvasManager::RemoveCanvas(const std::string canvasId)
 }
 GCanvas *GCanvasManager::GetCanvas(const std::string canvasId)
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     std::map< std::string, GCanvas * >::iterator it = mCanvases.find(canvasId);
     if (it != mCanvases.end())
     {
@@ -117,6 +123,7 @@ GCanvas *GCanvasManager::GetCanvas(const std::string canvasId)
 
 void GCanvasManager::Clear()
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     std::map< std::string, GCanvas * >::iterator it = mCanvases.begin();
     for (; it != mCanvases.end(); ++it)
     {
@@ -147,11 +154,13 @@ void GCanvasManager::Clear()
 
 void GCanvasManager::AddCanvas(GCanvas *p)
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     mCanvases[p->mContextId] = p;
 }
 
 int GCanvasManager::CanvasCount()
 {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     return (int)mCanvases.size();
 }
 
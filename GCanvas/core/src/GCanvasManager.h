@@ -16,10 +16,13 @@
 #endif
 
 #include <map>
+#include <mutex>
 #include <queue>
 
 namespace gcanvas
 {
+// The canvas map may be used from several threads, each rendering its own
+// canvases with its own GL context.
 class GCanvasManager
 {
 public:
@@ -45,6 +48,7 @@ public:
     static void Release();
 
 protected:
+    std::recursive_mutex mMutex;
     std::map< std::string, GCanvas * > mCanvases;
 #ifdef ANDROID
     std::map<std::string,std::queue<struct GCanvasCmd *> *> mCmdQueue;
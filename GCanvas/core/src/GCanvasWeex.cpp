@@ -9,13 +9,20 @@
 #ifdef GCANVAS_WEEX
 
 #include "gcanvas/GShaderManager.h"
+#include "gcanvas/GGLStateCache.h"
 #include "GCanvasManager.h"
 #include "GCanvasWeex.hpp"
 #include "GCanvas2dContext.h"
+#include "gcanvas/GFrameProfiler.h"
 #include "support/Encode.h"
+#include "support/GLUtil.h"
+#include "support/TraceRing.h"
 #include "support/Util.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
 
 #ifdef ANDROID
 #include "platform/Android/GCanvas2DContextAndroid.h"
@@ -32,13 +39,41 @@ GCanvasWeex::GCanvasWeex(std::string contextId, const GCanvasConfig &config) :
     mFps = 0.0f;
     mContextLost = false;
     mResult = "";
-#ifdef ANDROID
-    sem_init(&mSyncSem, 0, 0);
-#endif
+
+    // GCANVAS_RECORD_DIR=/path captures every canvas into <contextId>.gcap
+    const char *recordDir = getenv("GCANVAS_RECORD_DIR");
+    if (recordDir != nullptr && recordDir[0] != '\0') {
+        mRecorder.Open(std::string(recordDir) + "/" + mContextId + ".gcap");
+    }
 }
 
 GCanvasWeex::~GCanvasWeex() {
+    mRecorder.Close();
+}
 
+bool GCanvasWeex::StartRecording(const std::string &path) {
+    if (!mRecorder.Open(path)) {
+        return false;
+    }
+    // the state set before, so the capture replays on its own
+    if (mCanvasContext != nullptr) {
+        if (mCanvasContext->GetWidth() > 0 && mCanvasContext->GetHeight() > 0) {
+            int32_t surface[4] = {mCanvasContext->mX, mCanvasContext->mY,
+                                  mCanvasContext->GetWidth(), mCanvasContext->GetHeight()};
+            mRecorder.Record(CAPTURE_SURFACE, surface, 4, nullptr, 0);
+        }
+        int32_t type = mCanvasContext->mContextType;
+        mRecorder.Record(CAPTURE_CONTEXT_TYPE, &type, 1, nullptr, 0);
+        float ratio = mCanvasContext->GetDevicePixelRatio();
+        mRecorder.Record(CAPTURE_DEVICE_PIXEL_RATIO, &ratio, sizeof(ratio));
+        GColorRGBA color = mCanvasContext->GetClearColor();
+        mRecorder.Record(CAPTURE_CLEAR_COLOR, color.components, sizeof(color.components));
+    }
+    return true;
+}
+
+void GCanvasWeex::StopRecording() {
+    mRecorder.Close();
 }
 
 void GCanvasWeex::CreateContext() {
@@ -55,9 +90,17 @@ void GCanvasWeex::Clear() {
     // No need to clean up GL memory with glDeleteBuffers or glDeleteTextures.
     // It all gets blown away automatically when the context is lost.
     mContextLost = true;
+    mTextureLoader.CancelAll();
     mTextureMgr.Clear();
+    mWebglState.Invalidate();
 #ifdef ANDROID
-    clearCmdQueue();
+    // called off the GL thread, the queue's consumer empties it
+    mDiscardCmdQueue.store(true);
+    signalUpGLthread();
+    {
+        std::lock_guard<std::mutex> lock(mSyncCacheMutex);
+        mSyncResultCache.clear();
+    }
 #endif
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     LOG_D("GCanvasWeex::DoContextLost end.");
@@ -65,10 +108,16 @@ void GCanvasWeex::Clear() {
 
 
 void GCanvasWeex::SetClearColor(const GColorRGBA &c) {
+    if (mRecorder.IsRecording()) {
+        mRecorder.Record(CAPTURE_CLEAR_COLOR, c.components, sizeof(c.components));
+    }
     mCanvasContext->SetClearColor(c);
 }
 
 void GCanvasWeex::SetDevicePixelRatio(const float ratio) {
+    if (mRecorder.IsRecording()) {
+        mRecorder.Record(CAPTURE_DEVICE_PIXEL_RATIO, &ratio, sizeof(ratio));
+    }
     mCanvasContext->SetDevicePixelRatio(ratio);
 }
 
@@ -77,7 +126,32 @@ int GCanvasWeex::GetContextType() {
 }
 
 void GCanvasWeex::SetContextType(int contextType) {
+    if (mRecorder.IsRecording()) {
+        int32_t type = contextType;
+        mRecorder.Record(CAPTURE_CONTEXT_TYPE, &type, 1, nullptr, 0);
+    }
+    if (0 == mCanvasContext->mContextType && 0 != contextType) {
+        mUnbindVertexArrays = true;
+    }
     mCanvasContext->mContextType = contextType;
+    mWebglState.Invalidate();
+}
+
+void GCanvasWeex::PrepareWebGL() {
+    if (mUnbindVertexArrays.exchange(false)) {
+        mCanvasContext->UnbindVertexArrays();
+    }
+}
+
+void GCanvasWeex::OnSurfaceChanged(int x, int y, int width, int height) {
+    if (mRecorder.IsRecording()) {
+        int32_t surface[4] = {x, y, width, height};
+        mRecorder.Record(CAPTURE_SURFACE, surface, 4, nullptr, 0);
+    }
+    GFrameAttachScope profile(mCanvasContext->GetFrameProfiler());
+    GCanvas::OnSurfaceChanged(x, y, width, height);
+    // a new surface sets up viewport, framebuffer and program for 2d
+    mWebglState.Invalidate();
 }
 
 GTexture *GCanvasWeex::GetFboTexture() {
@@ -96,6 +170,11 @@ void GCanvasWeex::AddTexture(int textureGroupId, int glID, int width, int height
     LOG_D("AddTexture, Group ID = %d, GL ID = %d, width = %d, height = %d, context lost = %d",
           textureGroupId, glID, width, height, mContextLost);
     if (mContextLost) return;
+    if (mRecorder.IsRecording()) {
+        // pixels of a host texture are not ours to read, replay stands in a blank one
+        int32_t args[3] = {textureGroupId, width, height};
+        mRecorder.Record(CAPTURE_EXTERNAL_TEXTURE, args, 3, nullptr, 0);
+    }
     mTextureMgr.Append(textureGroupId, glID, width, height);
 }
 
@@ -114,11 +193,48 @@ void GCanvasWeex::AddOfflineTexture(int textureGroupId, int glID){
 bool GCanvasWeex::AddPngTexture(const unsigned char *buffer, unsigned int size, int textureGroupId,
                                 unsigned int *pWidth, unsigned int *pHeight) {
     if (mContextLost) return false;
+    if (mRecorder.IsRecording()) {
+        int32_t args[2] = {textureGroupId, 0};
+        mRecorder.Record(CAPTURE_PNG_TEXTURE, args, 2, buffer, size);
+    }
+    GFrameAttachScope profile(mCanvasContext->GetFrameProfiler());
     return mTextureMgr.AppendPng(buffer, size, textureGroupId, pWidth, pHeight);
 }
 
+bool GCanvasWeex::AddCompressedTexture(const unsigned char *buffer, unsigned int size,
+                                       int textureGroupId, bool alphaSplit,
+                                       unsigned int *pWidth, unsigned int *pHeight) {
+    if (mContextLost) return false;
+    if (mRecorder.IsRecording()) {
+        int32_t args[2] = {textureGroupId, alphaSplit ? 1 : 0};
+        mRecorder.Record(CAPTURE_COMPRESSED_TEXTURE, args, 2, buffer, size);
+    }
+    GFrameAttachScope profile(mCanvasContext->GetFrameProfiler());
+    return mTextureMgr.AppendCompressed(textureGroupId, buffer, size, alphaSplit,
+                                        pWidth, pHeight);
+}
+
+void GCanvasWeex::AddPngTextureAsync(const unsigned char *buffer, unsigned int size,
+                                     int textureGroupId) {
+    if (mContextLost) return;
+    if (mRecorder.IsRecording()) {
+        int32_t args[2] = {textureGroupId, 1};
+        mRecorder.Record(CAPTURE_PNG_TEXTURE, args, 2, buffer, size);
+    }
+    mTextureLoader.Load(textureGroupId, buffer, size);
+}
+
+void GCanvasWeex::SetTextureReadyCallback(const GTextureLoader::ReadyCallback &callback) {
+    mTextureLoader.SetReadyCallback(callback);
+}
+
 void GCanvasWeex::RemoveTexture(int textureId) {
     if (mContextLost) return;
+    if (mRecorder.IsRecording()) {
+        int32_t id = textureId;
+        mRecorder.Record(CAPTURE_REMOVE_TEXTURE, &id, 1, nullptr, 0);
+    }
+    mTextureLoader.Cancel(textureId);
     mTextureMgr.Remove(textureId);
 }
 
@@ -136,15 +252,16 @@ void GCanvasWeex::drawFBO(std::string fboName, GCompositeOperation compositeOp,
 
 
     mCanvasContext->Save();
-    glViewport(mCanvasContext->mX, mCanvasContext->mY, mCanvasContext->mWidth,
-               mCanvasContext->mHeight);
+    GGLStateCache::Current()->Viewport(mCanvasContext->mX, mCanvasContext->mY,
+                                       mCanvasContext->mWidth, mCanvasContext->mHeight);
 
     GFrameBufferObject &fbo = mCanvasContext->mFboMap[fboName];
 
     mCanvasContext->UseDefaultRenderPipeline();
 
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_DEPTH_TEST);
+    GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Disable(GL_DEPTH_TEST);
+    mCanvasContext->SetClipScissorEnabled(false);
 
     mCanvasContext->DoSetGlobalCompositeOperation(compositeOp, compositeOp);
 
@@ -159,11 +276,12 @@ void GCanvasWeex::drawFBO(std::string fboName, GCompositeOperation compositeOp,
     mCanvasContext->mVertexBufferIndex = 0;
 
     if (mCanvasContext->HasClipRegion()) {
-        glEnable(GL_STENCIL_TEST);
-        glEnable(GL_DEPTH_TEST);
+        GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
+        GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
     }
+    mCanvasContext->SetClipScissorEnabled(true);
 
-    glViewport(0, 0, mCanvasContext->mWidth, mCanvasContext->mHeight);
+    GGLStateCache::Current()->Viewport(0, 0, mCanvasContext->mWidth, mCanvasContext->mHeight);
 
     mCanvasContext->Restore();
 }
@@ -207,17 +325,66 @@ void GCanvasWeex::calculateFPS() {
     }
 }
 
+void GCanvasWeex::RenderWebGLBinary(const void *data, int length) {
+    if (mContextLost || length <= 0) {
+        return;
+    }
+    if (0 == mCanvasContext->mContextType) {
+        LOG_W("GCanvasWeex::RenderWebGLBinary: not a WebGL context");
+        return;
+    }
+    if (mRecorder.IsRecording()) {
+        mRecorder.Record(CAPTURE_WEBGL_BINARY, data, (size_t) length);
+    }
+    GFrameScope frame(mCanvasContext->GetFrameProfiler());
+    if (mTextureLoader.Upload(mTextureMgr) > 0) {
+        mWebglState.ForgetTextures();
+    }
+    calculateFPS();
+    {
+        GFRAME_PHASE(FRAME_PHASE_PARSE);
+        mWebglBinaryReader.SetDevicePixelRatio(GetDevicePixelRatio());
+#ifdef IOS
+        // framebuffer 0 is the GLKView's, same as the text bindFramebuffer
+        GWebGLBindToGLKViewFunc bindToView = mCanvasContext->GetGWebGLBindToGLKViewFunc();
+        if (bindToView) {
+            std::string contextId = mContextId;
+            mWebglBinaryReader.SetDefaultFramebufferBinder([bindToView, contextId]() {
+                bindToView(contextId);
+            });
+        }
+#endif
+        PrepareWebGL();
+        mWebglBinaryReader.Execute(data, (size_t) length);
+    }
+    // WebGL drives GL directly, the binary stream bypasses the mirror
+    GGLStateCache::Current()->Invalidate();
+    mWebglState.Invalidate();
+}
+
 //for string cmd
 void GCanvasWeex::Render(const char *renderCommands, int length) {
     if (mContextLost) {
         return;
     }
+    if (mRecorder.IsRecording() && length > 0) {
+        mRecorder.Record(CAPTURE_RENDER, renderCommands, (size_t) length);
+    }
+    GFrameScope frame(mCanvasContext->GetFrameProfiler());
     LOG_D("GCanvasWeex::Render: mContextType: %d", GetContextType());
+    // finish a slice of the background image loads before drawing
+    if (mTextureLoader.Upload(mTextureMgr) > 0) {
+        mWebglState.ForgetTextures();
+    }
     if (0 != mCanvasContext->mContextType) {
         if (length > 0) {
             calculateFPS();
-            LOG_E("GCanvasWeex::Render:[WebGL] renderCommands:%s", renderCommands);
+            GTRACE(gcanvas::TRACE_RENDER_WEBGL, length, 0);
+            LOG_D("GCanvasWeex::Render:[WebGL] renderCommands:%s", renderCommands);
+            GFRAME_PHASE(FRAME_PHASE_PARSE);
             executeWebGLCommands(renderCommands, length);
+            // WebGL drives GL directly
+            GGLStateCache::Current()->Invalidate();
         }
     } else {
         if (nullptr == mCanvasContext->mCurrentState ||
@@ -228,7 +395,9 @@ void GCanvasWeex::Render(const char *renderCommands, int length) {
         mCanvasContext->BindFBO();
         if (length > 0) {
             calculateFPS();
-            LOG_E("GCanvasWeex::Render:[2D] renderCommands:%s", renderCommands);
+            GTRACE(gcanvas::TRACE_RENDER_2D, length, 0);
+            LOG_D("GCanvasWeex::Render:[2D] renderCommands:%s", renderCommands);
+            GFRAME_PHASE(FRAME_PHASE_PARSE);
             execute2dCommands(renderCommands, length);
         }
         mCanvasContext->UnbindFBO();
@@ -259,45 +428,70 @@ void GCanvasWeex::DrawImage(int textureId, float sx, float sy, float sw, float s
             mOfflineTextures.erase(iter);
         }
 #endif
-        mCanvasContext->DoDrawImage(group.mVecTexture[0]->GetWidth(),
-                                   group.mVecTexture[0]->GetHeight(),
-                                   group.mVecTexture[0]->GetGlID(), sx, sy, sw, sh, dx, dy, dw,
-                                   dh);
+        if (group.mAlphaSplit) {
+            mCanvasContext->DrawAlphaSplitImage(group.mVecTexture[0]->GetWidth(),
+                                                group.mVecTexture[0]->GetHeight(),
+                                                group.mVecTexture[0]->GetGlID(),
+                                                sx, sy, sw, sh, dx, dy, dw, dh);
+            return;
+        }
+        // pick a smaller level when minifying, source coords scale with it
+        const GTransform &t = mCanvasContext->mCurrentState->mTransform;
+        float scale = std::min(std::fabs(dw / sw), std::fabs(dh / sh)) *
+                      std::sqrt(t.a * t.a + t.b * t.b);
+        const Texture *texture = mTextureMgr.GetLevelForScale(textureId, scale);
+        float rx = texture->GetWidth() / static_cast<float>(group.mVecTexture[0]->GetWidth());
+        float ry = texture->GetHeight() / static_cast<float>(group.mVecTexture[0]->GetHeight());
+        mCanvasContext->DoDrawImage(texture->GetWidth(), texture->GetHeight(),
+                                   texture->GetGlID(), sx * rx, sy * ry, sw * rx, sh * ry,
+                                   dx, dy, dw, dh);
     } else {
-        int start_col = sx / group.mTileWidth;
-        int stop_col =
-                (sx + sw - 1) / group.mTileWidth; // length is start with 1,so need
-        // to minus 1 before check
-        int start_row = sy / group.mTileHeight;
-        int stop_row = (sy + sh - 1) / group.mTileHeight;
+        // clip the source rect to the image, keeping dest in proportion
+        float scale_w = dw / sw;
+        float scale_h = dh / sh;
+        float src_x1 = std::max(sx, 0.0f);
+        float src_y1 = std::max(sy, 0.0f);
+        float src_x2 = std::min(sx + sw, static_cast<float>(group.mSrcWidth));
+        float src_y2 = std::min(sy + sh, static_cast<float>(group.mSrcHeight));
+        if (src_x2 <= src_x1 || src_y2 <= src_y1) {
+            return;
+        }
 
-        int block_count = (group.mSrcWidth - 1) / group.mTileWidth +
-                          1; // spilt block per row
+        int start_col = static_cast<int>(src_x1) / group.mTileWidth;
+        int stop_col = static_cast<int>(std::ceil(src_x2) - 1) / group.mTileWidth;
+        int start_row = static_cast<int>(src_y1) / group.mTileHeight;
+        int stop_row = static_cast<int>(std::ceil(src_y2) - 1) / group.mTileHeight;
 
         LOG_D("[GCanvasWeex::drawImage] row:[%d~%d], col:[%d~%d]", start_row,
               stop_row, start_col, stop_col);
 
-        float scale_h = dh / sh;
-        float scale_w = dw / sw;
         for (int r = start_row; r <= stop_row; ++r) {
-            int y1 = std::max(r * group.mTileHeight, static_cast<int>(sy));
-            int y2 = std::min((r + 1) * group.mTileHeight, static_cast<int>(sy + sh));
-            float new_h = (y2 - y1) * scale_h;
+            float tile_y = static_cast<float>(r * group.mTileHeight);
+            float y1 = std::max(tile_y, src_y1);
+            float y2 = std::min(tile_y + group.mTileHeight, src_y2);
+            if (y2 <= y1) continue;
 
             for (int c = start_col; c <= stop_col; ++c) {
-                int index = r * block_count + c;
-                int x1 = std::max(c * group.mTileWidth, static_cast<int>(sx));
-                int x2 = std::min((c + 1) * group.mTileWidth, static_cast<int>(sx + sw));
-                LOG_D("[GCanvasWeex::drawImage] rc:(%d, %d), x:(%d, %d), y:(%d, %d)",
+                int index = group.TileIndex(c, r);
+                if (index < 0) continue;
+
+                float tile_x = static_cast<float>(c * group.mTileWidth);
+                float x1 = std::max(tile_x, src_x1);
+                float x2 = std::min(tile_x + group.mTileWidth, src_x2);
+                if (x2 <= x1) continue;
+
+                LOG_D("[GCanvasWeex::drawImage] rc:(%d, %d), x:(%f, %f), y:(%f, %f)",
                       r, c, x1, x2, y1, y2);
 
-                mCanvasContext->DoDrawImage(group.mVecTexture[index]->GetWidth(),
-                                           group.mVecTexture[index]->GetHeight(),
-                                           group.mVecTexture[index]->GetGlID(),
-                                           x1 % group.mTileWidth, y1 % group.mTileHeight,
-                                           x2 - x1, y2 - y1, dx + (x1 - sx) * scale_w,
-                                           dy + (y1 - sy) * scale_h, (x2 - x1) * scale_w,
-                                           new_h);
+                // source coords are local to the tile so UVs come out of the tile size
+                const Texture *tile = group.mVecTexture[index];
+                mCanvasContext->DoDrawImage(tile->GetWidth(), tile->GetHeight(),
+                                           tile->GetGlID(),
+                                           x1 - tile_x, y1 - tile_y,
+                                           x2 - x1, y2 - y1,
+                                           dx + (x1 - sx) * scale_w,
+                                           dy + (y1 - sy) * scale_h,
+                                           (x2 - x1) * scale_w, (y2 - y1) * scale_h);
             }
         }
     }
@@ -308,36 +502,30 @@ void GCanvasWeex::UsePatternRenderPipeline(int textureListId, int textureWidth,
                                            const std::string &pattern, bool isStroke) {
     mCanvasContext->SendVertexBufferToGPU();
 
-#ifdef IOS
-    mCanvasContext->mCurrentState->mShader = GShaderManager::getSingleton()->programForKey("PATTERN");
-#endif
-
-#ifdef ANDROID
-    mCanvasContext->mCurrentState->mShader = ((GCanvas2DContextAndroid *) mCanvasContext)->GetShaderManager()->programForKey(
-            "PATTERN");
-#endif
+    mCanvasContext->mCurrentState->mShader =
+            mCanvasContext->GetShaderManager()->programForKey("PATTERN");
 
     if (nullptr == mCanvasContext->mCurrentState->mShader) {
         return;
     }
     mCanvasContext->mCurrentState->mShader->Bind();
+    mCanvasContext->UpdateVertexAttribs();
 
-    GFillStyle *style = isStroke ? mCanvasContext->mCurrentState->mStrokeStyle
-                                 : mCanvasContext->mCurrentState->mFillStyle;
-    if (style != nullptr) {
-        delete style;
-        style = nullptr;
+    if (isStroke) {
+        mCanvasContext->mCurrentState->mStrokeStyle.Reset();
+    } else {
+        mCanvasContext->mCurrentState->mFillStyle.Reset();
     }
 
     if (textureListId >= 0 && pattern != "") {
-        style = new FillStylePattern(textureListId, pattern);
+        GFillStyle *style = new FillStylePattern(textureListId, pattern);
         if (isStroke) {
             mCanvasContext->mCurrentState->mStrokeStyle = style;
         } else {
             mCanvasContext->mCurrentState->mFillStyle = style;
         }
         mCanvasContext->mCurrentState->mShader->SetRepeatMode(
-                ((FillStylePattern *) style)->GetPattern());
+                ((FillStylePattern *) style)->GetRepeatMode());
 
         mCanvasContext->mCurrentState->mFillColor = StrValueToColorRGBA("white");
         mCanvasContext->mCurrentState->mTextureId = textureListId;
@@ -350,25 +538,17 @@ void GCanvasWeex::UsePatternRenderPipeline(int textureListId,
                                            const std::string &pattern, bool isStroke) {
     mCanvasContext->SendVertexBufferToGPU();
 
-#ifdef IOS
-    mCanvasContext->mCurrentState->mShader = GShaderManager::getSingleton()->programForKey("PATTERN");
-#endif
-
-#ifdef ANDROID
-    mCanvasContext->mCurrentState->mShader = ((GCanvas2DContextAndroid *) mCanvasContext)->GetShaderManager()->programForKey(
-            "PATTERN");
-#endif
+    mCanvasContext->mCurrentState->mShader =
+            mCanvasContext->GetShaderManager()->programForKey("PATTERN");
 
     mCanvasContext->mCurrentState->mShader->Bind();
-    if (mCanvasContext->mCurrentState->mFillStyle != nullptr) {
-        delete mCanvasContext->mCurrentState->mFillStyle;
-        mCanvasContext->mCurrentState->mFillStyle = nullptr;
-    }
+    mCanvasContext->UpdateVertexAttribs();
+    mCanvasContext->mCurrentState->mFillStyle.Reset();
     if (textureListId >= 0 && pattern != "") {
         mCanvasContext->mCurrentState->mFillStyle =
                 new FillStylePattern(textureListId, pattern);
         mCanvasContext->mCurrentState->mShader->SetRepeatMode(
-                ((FillStylePattern *) (mCanvasContext->mCurrentState->mFillStyle))->GetPattern());
+                ((FillStylePattern *) (mCanvasContext->mCurrentState->mFillStyle.Get()))->GetRepeatMode());
         const Texture *texture = getTextureWithOneImage(
                 mCanvasContext->mCurrentState->mFillStyle->GetTextureListID());
         if (texture) {
@@ -415,6 +595,51 @@ void GCanvasWeex::parseSetTransForTextform(
 }
 
 
+// staging size for PutImageData, decoded pixels go to GL one band at a time
+#define IMAGE_DATA_BAND_BYTES (64 * 1024)
+
+struct ImageDataUploader {
+    int width;
+    int height;
+    int rowBytes;
+    int row;
+    int filled;
+    std::string band;
+};
+
+static void FlushImageDataRows(ImageDataUploader *uploader) {
+    int rows = std::min(uploader->filled / uploader->rowBytes,
+                        uploader->height - uploader->row);
+    if (rows > 0) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, uploader->row, uploader->width, rows,
+                        GL_RGBA, GL_UNSIGNED_BYTE, uploader->band.c_str());
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                     TexImageSize(uploader->width, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                                  UnpackAlignment()));
+        uploader->row += rows;
+    }
+    uploader->filled = 0;
+}
+
+// the band holds whole rows, so it is uploaded every time it fills up
+static bool UploadImageDataRows(const char *data, int len, void *userData) {
+    ImageDataUploader *uploader = (ImageDataUploader *) userData;
+    int bandSize = (int) uploader->band.size();
+
+    while (len > 0 && uploader->row < uploader->height) {
+        int n = std::min(len, bandSize - uploader->filled);
+        memcpy(&uploader->band[uploader->filled], data, n);
+        uploader->filled += n;
+        data += n;
+        len -= n;
+
+        if (uploader->filled == bandSize) {
+            FlushImageDataRows(uploader);
+        }
+    }
+    return uploader->row < uploader->height;
+}
+
 void
 GCanvasWeex::PutImageData(
         const char *imageData,
@@ -430,26 +655,36 @@ GCanvasWeex::PutImageData(
 
           dx, dy, sw, sh, dw, dh);
 
-    std::string &pixels_data = mTempStr;
-    if ((unsigned int) dataLength > pixels_data.length())
-        pixels_data.resize(dataLength);
-
-    GLubyte *pixels = (GLubyte *) (pixels_data.c_str());
-
-    gcanvas::Base64DecodeBuf(reinterpret_cast<char *>(pixels), imageData, dataLength);
-
     GLuint glID;
     glGenTextures(1, &glID);
-    glBindTexture(GL_TEXTURE_2D, glID);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, sw, sh, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, pixels);
+                 GL_UNSIGNED_BYTE, nullptr);
+
+    // decode straight into the texture a band of rows at a time
+    ImageDataUploader uploader;
+    uploader.width = (int) sw;
+    uploader.height = (int) sh;
+    uploader.rowBytes = 4 * uploader.width;
+    uploader.row = 0;
+    uploader.filled = 0;
+    int bandRows = uploader.rowBytes > 0 ? IMAGE_DATA_BAND_BYTES / uploader.rowBytes : 0;
+    uploader.band.resize((size_t) std::max(1, bandRows) * uploader.rowBytes);
+
+    if (uploader.rowBytes > 0 && uploader.height > 0) {
+        if (gcanvas::Base64DecodeStream(imageData, dataLength, UploadImageDataRows,
+                                        &uploader) < 0) {
+            LOG_W("[PutImageData] malformed image data, length=%d", dataLength);
+        }
+        FlushImageDataRows(&uploader);
+    }
 
     mCanvasContext->DoDrawImage(sw, sh, glID, 0, 0, sw, sh, dx, dy, dw, dh);
-    if (!mContextLost) glDeleteTextures(1, (const GLuint *) (&glID));
+    if (!mContextLost) GGLStateCache::Current()->DeleteTextures(1, (const GLuint *) (&glID));
 }
 
 void
@@ -504,12 +739,23 @@ GCanvasWeex::GetImageData(int
 
     glFinish();
     glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-    gcanvas::FlipPixel(pixels, w, h);
 
     if (base64Encode) {
+        // encode rows bottom-up, which flips to canvas orientation for free
         pixelsData.resize(gcanvas::Base64EncodeLen(buf_size));
-        gcanvas::Base64EncodeBuf((char *) (pixelsData.c_str()), ptr_data->c_str(),
-                                 buf_size);
+        char *dest = (char *) pixelsData.c_str();
+        int rowBytes = 4 * w;
+        int written = 0;
+        gcanvas::Base64Encoder encoder;
+        gcanvas::Base64EncodeBegin(encoder);
+        for (int row = h - 1; row >= 0; --row) {
+            written += gcanvas::Base64EncodeUpdate(encoder, dest + written,
+                                                   (const char *) pixels + row * rowBytes,
+                                                   rowBytes);
+        }
+        gcanvas::Base64EncodeFinish(encoder, dest + written);
+    } else {
+        gcanvas::FlipPixel(pixels, w, h);
     }
     LOG_D("GCanvas.cpp::getImageData end...[%d]=%s", buf_size,
           pixelsData.c_str());
@@ -817,7 +1063,7 @@ void GCanvasWeex::execute2dCommands(const char *renderCommands, int length) {
     if (mContextLost) return;
 
 
-    if (LOG_LEVEL_DEBUG == GetLogLevel()) {
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG)) {
         char log_tmp[128];
         snprintf(log_tmp, sizeof(log_tmp), "%s", renderCommands);
         LOG_D("[executeRenderCommands][%d]%s", strlen(renderCommands), log_tmp);
@@ -1160,9 +1406,6 @@ void GCanvasWeex::execute2dCommands(const char *renderCommands, int length) {
                 p++;
                 const int stop_count = atoi(str);
 
-                if (mCanvasContext->mCurrentState->mFillStyle != nullptr) {
-                    delete mCanvasContext->mCurrentState->mFillStyle;
-                }
                 mCanvasContext->mCurrentState->mFillStyle =
                         new FillStyleRadialGradient(start, end);
 
@@ -1201,9 +1444,6 @@ void GCanvasWeex::execute2dCommands(const char *renderCommands, int length) {
                 p++;
                 const int stop_count = atoi(str);
 
-                if (mCanvasContext->mCurrentState->mFillStyle != nullptr) {
-                    delete mCanvasContext->mCurrentState->mFillStyle;
-                }
                 mCanvasContext->mCurrentState->mFillStyle =
                         new FillStyleLinearGradient(start, end);
 
@@ -1375,9 +1615,6 @@ void GCanvasWeex::execute2dCommands(const char *renderCommands, int length) {
                 if (textLen > 0) {
                     strncpy(tmpFont, pStart, textLen);
                     tmpFont[textLen] = 0;
-                    if (mCanvasContext->mCurrentState->mFont != nullptr) {
-                        delete mCanvasContext->mCurrentState->mFont;
-                    }
                     mCanvasContext->mCurrentState->mFont = new GFontStyle(tmpFont);
                 }
                 if (*p == ';') ++p;
@@ -1423,9 +1660,6 @@ void GCanvasWeex::execute2dCommands(const char *renderCommands, int length) {
         mCanvasContext->Save();
         mCanvasContext->SetFillStyle(StrValueToColorRGBA("black"));
 #ifdef ANDROID
-        if (mCanvasContext->mCurrentState->mFont != nullptr) {
-            delete mCanvasContext->mCurrentState->mFont;
-        }
         mCanvasContext->mCurrentState->mFont = new GFontStyle("20px");
 #endif
         char fpsString[20];
@@ -1465,7 +1699,7 @@ int GCanvasWeex::getCmdType(int type) {
 }
 
 int GCanvasWeex::getSyncAttrib(int type) {
-    return (type >> 29) && 0x1;
+    return (type >> 29) & 0x1;
 }
 
 int GCanvasWeex::getOpType(int type) {
@@ -1479,16 +1713,13 @@ void GCanvasWeex::signalUpGLthread() {
 
 std::string GCanvasWeex::canvasProc(int op, int sync, std::string args) {
 
-    LOG_E("canvasProc start.");
-
     if (args.c_str() == nullptr || args.length() == 0 ||
         !strcmp(args.c_str(), "")) {
         return "";
     }
 
-    LOG_E("canvasProc,length = %d,args = %s\n", args.length(), args.c_str());
+    LOG_D("canvasProc,length = %d,args = %s\n", args.length(), args.c_str());
     this->Render(args.c_str(), (int) args.length());
-    LOG_E("canvasProc finished.");
 
     return "";
 }
@@ -1498,6 +1729,11 @@ std::string GCanvasWeex::webglProc(int op, int sync, std::string args) {
         !strcmp(args.c_str(), "")) {
         return nullptr;
     }
+    if (mRecorder.IsRecording()) {
+        mRecorder.Record(CAPTURE_WEBGL, args.c_str(), args.length());
+    }
+    GFrameScope frame(mCanvasContext->GetFrameProfiler());
+    GFRAME_PHASE(FRAME_PHASE_PARSE);
     const char *commands = args.c_str();
     executeWebGLCommands(commands, (int) args.length());
     return "";
@@ -1530,43 +1766,160 @@ const char *GCanvasWeex::CallNative(int type, const std::string &args) {
         return "";
     }
 
-    mResult = "";
+    if (getSyncAttrib(type) != SYNC) {
+        struct GCanvasCmd *p = new struct GCanvasCmd();
+        p->type = type;
+        p->args = args;
+        PushCmd(p);
+        return nullptr;
+    }
 
-    int sync = getSyncAttrib(type);
+    LOG_D("call native sync call, start wait. cmd is %s", args.c_str());
+    std::future<std::string> future = CallNativeFuture(type, args);
+    if (future.wait_for(std::chrono::milliseconds(GCANVAS_TIMEOUT)) !=
+        std::future_status::ready) {
+        LOG_W("call native sync timeout, cmd is %s", args.c_str());
+        return "";
+    }
+    std::string result = future.get();
+    LOG_D("call native sync result: %s", result.c_str());
+    if (result.length() > 0) {
+        char *resultChar = new char[result.length() + 1];
+        strcpy(resultChar, result.c_str());
+        return resultChar;
+    } else {
+        LOG_D("return empty string");
+        return "";
+    }
+}
+
+void GCanvasWeex::PushCmd(struct GCanvasCmd *p) {
+    mCmdQueue.Push(p);
+    GTRACE(gcanvas::TRACE_CMD_QUEUED, p->type, p->args.length());
+
+    // one wakeup per burst, the GL thread drains everything queued by then
+    if (!mDrainScheduled.exchange(true)) {
+        signalUpGLthread();
+    }
+}
+
+std::future<std::string> GCanvasWeex::CallNativeFuture(int type, const std::string &args) {
+    std::shared_ptr<std::promise<std::string> > promise =
+            std::make_shared<std::promise<std::string> >();
+    std::future<std::string> future = promise->get_future();
+
+    if (mContextLost || mExit) {
+        promise->set_value("");
+        return future;
+    }
+
+    bool cacheable = IsCacheableSyncCmd(type, args);
+    if (cacheable) {
+        std::lock_guard<std::mutex> lock(mSyncCacheMutex);
+        auto iter = mSyncResultCache.find(args);
+        if (iter != mSyncResultCache.end()) {
+            promise->set_value(iter->second);
+            return future;
+        }
+    }
 
     struct GCanvasCmd *p = new struct GCanvasCmd();
     p->type = type;
     p->args = args;
+    p->result = promise;
+    p->cacheable = cacheable;
+    PushCmd(p);
+    return future;
+}
+
+std::vector<std::string> GCanvasWeex::CallNativeBatch(int type,
+                                                      const std::vector<std::string> &args) {
+    std::vector<std::future<std::string> > futures;
+    futures.reserve(args.size());
+    for (size_t i = 0; i < args.size(); ++i) {
+        futures.push_back(CallNativeFuture(type, args[i]));
+    }
 
-    mCmdQueue.push(p);
+    // one deadline for the whole batch, the commands run back to back
+    std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(GCANVAS_TIMEOUT);
+    std::vector<std::string> results(args.size());
+    for (size_t i = 0; i < futures.size(); ++i) {
+        if (futures[i].wait_until(deadline) != std::future_status::ready) {
+            LOG_W("call native batch timeout, %d of %d answered", (int) i, (int) futures.size());
+            break;
+        }
+        results[i] = futures[i].get();
+    }
+    return results;
+}
 
-    signalUpGLthread();
+// WebGL text protocol indices, see g_webglFuncMap
+#define WEBGL_GET_PARAMETER_INDEX 65
+#define WEBGL_GET_SHADER_PRECISION_FORMAT_INDEX 71
+#define WEBGL_GET_SUPPORTED_EXTENSIONS_INDEX 73
 
+bool GCanvasWeex::IsCacheableSyncCmd(int type, const std::string &args) {
+    if (getCmdType(type) != WEBGL || getSyncAttrib(type) != SYNC) {
+        return false;
+    }
+    // a single command, "index,arguments;"
+    size_t semicolon = args.find(';');
+    if (semicolon != std::string::npos && semicolon + 1 != args.length()) {
+        return false;
+    }
 
-    if (sync == SYNC) {
-        LOG_D("call native sync call, start wait. cmd is %s", args.c_str());
-        gcanvas::waitUtilTimeout(&mSyncSem, GCANVAS_TIMEOUT);
-        LOG_D("call native sync result: %s", mResult.c_str());
-        if (mResult.length() > 0) {
-            char *resultChar = new char[mResult.length() + 1];
-            strcpy(resultChar, mResult.c_str());
-            return resultChar;
-        } else {
-            LOG_D("return empty string");
-            return "";
-        }
+    const char *p = args.c_str();
+    int index = atoi(p);
+    if (index == WEBGL_GET_SHADER_PRECISION_FORMAT_INDEX ||
+        index == WEBGL_GET_SUPPORTED_EXTENSIONS_INDEX) {
+        return true;
+    }
+    if (index != WEBGL_GET_PARAMETER_INDEX) {
+        return false;
     }
 
-    return nullptr;
+    const char *comma = strchr(p, ',');
+    if (comma == nullptr) {
+        return false;
+    }
+    // implementation limits and strings, not state
+    switch (atoi(comma + 1)) {
+        case GL_ALIASED_LINE_WIDTH_RANGE:
+        case GL_ALIASED_POINT_SIZE_RANGE:
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_CUBE_MAP_TEXTURE_SIZE:
+        case GL_MAX_FRAGMENT_UNIFORM_VECTORS:
+        case GL_MAX_RENDERBUFFER_SIZE:
+        case GL_MAX_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_TEXTURE_SIZE:
+        case GL_MAX_VARYING_VECTORS:
+        case GL_MAX_VERTEX_ATTRIBS:
+        case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_VERTEX_UNIFORM_VECTORS:
+        case GL_MAX_VIEWPORT_DIMS:
+        case GL_SUBPIXEL_BITS:
+        case GL_RENDERER:
+        case GL_SHADING_LANGUAGE_VERSION:
+        case GL_VENDOR:
+        case GL_VERSION:
+            return true;
+        default:
+            return false;
+    }
 }
 
+// GL thread only, the one consumer of mCmdQueue
 void GCanvasWeex::clearCmdQueue() {
+    mDiscardCmdQueue.store(false);
 
     GCanvasManager *theManager = GCanvasManager::GetManager();
     theManager->clearQueueByContextId(mContextId);
-    while (!mCmdQueue.empty()) {
-        struct GCanvasCmd *p = reinterpret_cast<struct GCanvasCmd *> (mCmdQueue.front());
-        mCmdQueue.pop();
+    struct GCanvasCmd *p = nullptr;
+    while (mCmdQueue.Pop(p)) {
+        if (p->result) {
+            p->result->set_value("");
+        }
         delete p;
     }
 
@@ -1578,58 +1931,129 @@ void GCanvasWeex::clearCmdQueue() {
 
 }
 
-void GCanvasWeex::QueueProc(std::queue<struct GCanvasCmd *> *queue) {
-    if (queue == nullptr) {
-        return;
+// Consecutive async commands of the same type run as one batch, a render
+// command string is a sequence of ';' terminated commands.
+static void CoalesceCmd(struct GCanvasCmd *into, const struct GCanvasCmd *p) {
+    if (!into->args.empty() && into->args[into->args.length() - 1] != ';') {
+        into->args += ';';
     }
-    if (!queue->empty()) {
-        struct GCanvasCmd *p = reinterpret_cast<struct GCanvasCmd *>(queue->front());
-        int type = p->type;
-        int cmd = getCmdType(type);
-        int op = getOpType(type);
-        int sync = getSyncAttrib(type);
+    into->args += p->args;
+}
 
-        std::string args = p->args;
+void GCanvasWeex::ProcessCmd(struct GCanvasCmd *p) {
+    int type = p->type;
+    int cmd = getCmdType(type);
+    int op = getOpType(type);
+    int sync = getSyncAttrib(type);
 
-        LOG_E("start to process queue cmd.");
+    GTRACE(gcanvas::TRACE_CMD_EXEC, type, p->args.length());
+    if (p->result) {
+        mResult.clear();
+    }
 
-        switch (cmd) {
-            case CANVAS: {
-                canvasProc(op, sync, args);
-                break;
-            }
-            case WEBGL: {
-                webglProc(op, sync, args);
-                break;
-            }
-            case VULKAN: {
-                vulkanProc(op, sync, args);
-                break;
-            }
-            case METAL: {
-                metalProc(op, sync, args);
-                break;
-            }
-            default: {
-                break;
-            }
+    switch (cmd) {
+        case CANVAS: {
+            canvasProc(op, sync, p->args);
+            break;
+        }
+        case WEBGL: {
+            webglProc(op, sync, p->args);
+            break;
+        }
+        case VULKAN: {
+            vulkanProc(op, sync, p->args);
+            break;
+        }
+        case METAL: {
+            metalProc(op, sync, p->args);
+            break;
+        }
+        default: {
+            break;
         }
+    }
+
+    if (op == 1) {
+        setRefreshFlag(true);
+    }
 
-        if (op == 1) {
-            setRefreshFlag(true);
+    if (p->result) {
+        // answered right away, the caller may be waiting on it
+        GTRACE(gcanvas::TRACE_SYNC_RESULT, mResult.length(), 0);
+        if (p->cacheable && !mResult.empty()) {
+            std::lock_guard<std::mutex> lock(mSyncCacheMutex);
+            mSyncResultCache[p->args] = mResult;
         }
+        p->result->set_value(mResult);
+    }
+
+    delete p;
+}
+
+void GCanvasWeex::QueueProc(std::queue<struct GCanvasCmd *> *queue) {
+    if (queue == nullptr) {
+        return;
+    }
+    struct GCanvasCmd *pending = nullptr;
+    int executed = 0, coalesced = 0;
+    while (!queue->empty()) {
+        struct GCanvasCmd *p = queue->front();
         queue->pop();
+        if (pending != nullptr && pending->type == p->type &&
+            getSyncAttrib(p->type) != SYNC && !p->result && !pending->result) {
+            CoalesceCmd(pending, p);
+            delete p;
+            ++coalesced;
+            continue;
+        }
+        if (pending != nullptr) {
+            ProcessCmd(pending);
+            ++executed;
+        }
+        pending = p;
+    }
+    if (pending != nullptr) {
+        ProcessCmd(pending);
+        ++executed;
+    }
+    GTRACE(gcanvas::TRACE_CMD_DRAIN, executed, coalesced);
+}
 
-        delete p;
+void GCanvasWeex::DrainCmdQueue() {
+    // cleared first: whatever is pushed from now on signals again, whatever
+    // was pushed before is drained below
+    mDrainScheduled.store(false);
+    if (mDiscardCmdQueue.load()) {
+        clearCmdQueue();
+        return;
+    }
 
-        if (sync == SYNC) {
-            setSyncFlag();
+    struct GCanvasCmd *pending = nullptr;
+    struct GCanvasCmd *p = nullptr;
+    int executed = 0, coalesced = 0;
+    while (mCmdQueue.Pop(p)) {
+        if (pending != nullptr && pending->type == p->type &&
+            getSyncAttrib(p->type) != SYNC && !p->result && !pending->result) {
+            CoalesceCmd(pending, p);
+            delete p;
+            ++coalesced;
+            continue;
+        }
+        if (pending != nullptr) {
+            ProcessCmd(pending);
+            ++executed;
         }
+        pending = p;
     }
+    if (pending != nullptr) {
+        ProcessCmd(pending);
+        ++executed;
+    }
+    GTRACE(gcanvas::TRACE_CMD_DRAIN, executed, coalesced);
 }
 
 void GCanvasWeex::LinkNativeGLProc() {
-    if (mContextLost) {
+    if (mContextLost || mDiscardCmdQueue.load()) {
         LOG_E("in LinkNativeGLProc mContextLost");
         clearCmdQueue();
         return;
@@ -1639,21 +2063,15 @@ void GCanvasWeex::LinkNativeGLProc() {
     std::queue<struct GCanvasCmd *> *queue = theManager->getQueueByContextId(
             mContextId);
     if (queue != nullptr) {
-        LOG_E("in LinkNativeProc QueueProc queue");
         QueueProc(queue);
     }
-    //    LOG_D("in LinkNativeProc QueueProc mCmdQueue");
-    QueueProc(&mCmdQueue);
+    DrainCmdQueue();
 
     if (queue != nullptr) {
         delete queue;
     }
 }
 
-void GCanvasWeex::setSyncFlag() {
-    mSync = true;
-}
-
 void GCanvasWeex::setThreadExit() {
     mExit = true;
 }
@@ -1663,10 +2081,10 @@ void GCanvasWeex::setContextLost(bool lost) {
 }
 
 void GCanvasWeex::finishProc() {
-    if (mSync == SYNC) {
-        LOG_D("LinkNativeGLProc,sync proc result=%s\n", mResult.c_str());
-        sem_post(&mSyncSem);
-        mSync = false;
+    // sync results are posted as their commands run, what is left in the
+    // queue of an exiting context would only time out
+    if (mExit) {
+        clearCmdQueue();
     }
 }
 
@@ -1675,6 +2093,24 @@ void GCanvasWeex::setRefreshFlag(bool refresh) {
 }
 
 
+void GCanvasWeex::RecordBitmap(const struct BitmapCmd &cmd, bool subImage) {
+    int32_t args[CAPTURE_BITMAP_HEADER_COUNT];
+    args[CAPTURE_BITMAP_SUB_IMAGE] = subImage ? 1 : 0;
+    args[CAPTURE_BITMAP_ID] = cmd.id;
+    args[CAPTURE_BITMAP_TARGET] = cmd.target;
+    args[CAPTURE_BITMAP_LEVEL] = cmd.level;
+    args[CAPTURE_BITMAP_INTERNAL_FORMAT] = cmd.interformat;
+    args[CAPTURE_BITMAP_FORMAT] = cmd.format;
+    args[CAPTURE_BITMAP_TYPE] = cmd.type;
+    args[CAPTURE_BITMAP_WIDTH] = cmd.width;
+    args[CAPTURE_BITMAP_HEIGHT] = cmd.height;
+    args[CAPTURE_BITMAP_XOFFSET] = cmd.xoffset;
+    args[CAPTURE_BITMAP_YOFFSET] = cmd.yoffset;
+    // Android bitmaps are tightly packed, whatever GL_UNPACK_ALIGNMENT says
+    size_t size = TexImageSize(cmd.width, cmd.height, cmd.format, cmd.type, 1);
+    mRecorder.Record(CAPTURE_BITMAP, args, CAPTURE_BITMAP_HEADER_COUNT, cmd.Bitmap, size);
+}
+
 void GCanvasWeex::addBitmapQueue(struct BitmapCmd *p) {
     mBitmapQueue.push(p);
 }
@@ -1684,11 +2120,15 @@ void GCanvasWeex::bindTexture(struct BitmapCmd cmd) {
     //        struct BitmapCmd *p = reinterpret_cast<struct BitmapCmd * >(mBitmapQueue.front());
     GLuint glID;
     LOG_D("DO BIND TEXTURE. context type = %d", GetContextType());
+    if (mRecorder.IsRecording()) {
+        RecordBitmap(cmd, false);
+    }
+    GFrameAttachScope profile(mCanvasContext->GetFrameProfiler());
 
     //step 1:bindtexture
     if (GetContextType() == 0) {
         glGenTextures(1, &glID);
-        glBindTexture(GL_TEXTURE_2D, glID);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
                         GL_LINEAR_MIPMAP_NEAREST);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
@@ -1702,6 +2142,11 @@ void GCanvasWeex::bindTexture(struct BitmapCmd cmd) {
     glTexImage2D(cmd.target, cmd.level, cmd.interformat, cmd.width,
                  cmd.height, 0, cmd.format,
                  cmd.type, cmd.Bitmap);
+    if (cmd.Bitmap != nullptr) {
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                     TexImageSize(cmd.width, cmd.height, cmd.format, cmd.type,
+                                  UnpackAlignment()));
+    }
 
     //step 2:save textureid
     if (GetContextType() == 0) {
@@ -1724,20 +2169,31 @@ void GCanvasWeex::bindTexture(GTexture *texture) {
 
 void GCanvasWeex::texSubImage2D(struct BitmapCmd cmd) {
     LOG_D("start to texSubImage2D in grenderer.");
+    if (mRecorder.IsRecording()) {
+        RecordBitmap(cmd, true);
+    }
+    GFrameAttachScope profile(mCanvasContext->GetFrameProfiler());
     glTexSubImage2D(cmd.target, cmd.level, cmd.xoffset, cmd.yoffset,
                     cmd.width, cmd.height,
                     cmd.format,
                     cmd.type, cmd.Bitmap);
+    GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                 TexImageSize(cmd.width, cmd.height, cmd.format, cmd.type,
+                              UnpackAlignment()));
 }
 
 
 bool GCanvasWeex::continueProcess() {
 
+    if (mDiscardCmdQueue.load()) {
+        return true;
+    }
     if (mContextLost) {
         return false;
     }
 
-    return !mBitmapQueue.empty() || !mCmdQueue.empty();
+    // a pending sync result also needs a pass to post it
+    return !mBitmapQueue.empty() || !mCmdQueue.Empty();
 
 }
 
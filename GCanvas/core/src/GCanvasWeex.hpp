@@ -13,15 +13,25 @@
 
 #include "GCanvas.hpp"
 #include "GCanvas2dContext.h"
+#include "gcanvas/GCommandRecorder.h"
+#include "gcanvas/GTextureLoader.h"
+#include "gcanvas/GWebglBinaryStream.h"
+#include "gcanvas/GWebglStateMirror.h"
 #include "support/DynArray.h"
 #include "support/Log.h"
 #include "export.h"
 
 #ifdef ANDROID
 
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 #include <jni.h>
-#include <semaphore.h>
+#include "support/SPSCQueue.h"
 #define GCANVAS_TIMEOUT 800
 
 #endif
@@ -66,6 +76,9 @@ struct GCanvasCmd
     std::string contextId;
     int type;
     std::string args;
+    // sync commands only, fulfilled with the result once the command ran
+    std::shared_ptr< std::promise< std::string > > result;
+    bool cacheable = false;
 };
 
 struct BitmapCmd
@@ -127,6 +140,7 @@ public:
     virtual void CreateContext();
 
     virtual void Clear();
+    void OnSurfaceChanged(int x, int y, int width, int height) override;
     
     
     //call context API
@@ -141,8 +155,23 @@ public:
     //Weex 2D
      bool AddPngTexture(const unsigned char *buffer, unsigned int size, int textureGroupId,
                        unsigned int *pWidth, unsigned int *pHeight);
+     // KTX/PKM ETC1/ETC2 upload, alphaSplit for ETC1 color-over-alpha images
+     bool AddCompressedTexture(const unsigned char *buffer, unsigned int size,
+                               int textureGroupId, bool alphaSplit,
+                               unsigned int *pWidth, unsigned int *pHeight);
+     // decode off the GL thread, the texture is usable once the ready
+     // callback fires; it runs on the GL thread from Render
+     void AddPngTextureAsync(const unsigned char *buffer, unsigned int size,
+                             int textureGroupId);
+     void SetTextureReadyCallback(const GTextureLoader::ReadyCallback &callback);
      void AddTexture(int textureGroupId, int glID, int width, int height);
 
+     // capture of everything fed to this canvas from now on, see
+     // GCommandRecorder.h; textures loaded before are not in it
+     bool StartRecording(const std::string &path);
+     void StopRecording();
+     bool IsRecording() const { return mRecorder.IsRecording(); }
+
 #ifdef IOS
      void AddOfflineTexture(int textureGroupId, int glID);
 #endif
@@ -165,6 +194,8 @@ public:
 
      void RemoveTexture(int id);
      void Render(const char *renderCommands, int length);
+     // binary WebGL stream, see GWebglBinaryStream.h; data must be 4 byte aligned
+     void RenderWebGLBinary(const void *data, int length);
      void SetOrtho(int width, int height);
      void SetTyOffsetFlag(bool flag);
      void UsePatternRenderPipeline(int textureListId, int width, int height,
@@ -174,11 +205,21 @@ public:
     
     //Weex WebGL
      void setSyncResult(std::string result);
+#if defined(ANDROID) || defined(__linux__)
+     void initWebglExt();
+#endif
 #ifdef ANDROID
      std::string exeSyncCmd(int cmd, const char *&args);
      std::string exe2dSyncCmd(int cmd, const char *&args);
-     void initWebglExt();
      const char *CallNative(int type, const std::string &args);
+     // Queues a sync command and returns without waiting, so several can be
+     // in flight in one GL round trip. Contexts that are lost or exiting
+     // resolve to an empty string.
+     std::future< std::string > CallNativeFuture(int type, const std::string &args);
+     // runs sync commands in one round trip, results in the order of args
+     std::vector< std::string > CallNativeBatch(int type, const std::vector< std::string > &args);
+     bool IsCacheableSyncCmd(int type, const std::string &args);
+     void PushCmd(struct GCanvasCmd *p);
      int getCmdType(int type);
      int getSyncAttrib(int type);
      int getOpType(int type);
@@ -190,8 +231,9 @@ public:
      void LinkNativeGLProc();
      void clearCmdQueue();
      void QueueProc(std::queue<struct GCanvasCmd *> *queue);
+     void DrainCmdQueue();
+     void ProcessCmd(struct GCanvasCmd *p);
      virtual void setRefreshFlag(bool refresh);
-     void setSyncFlag();
      void setThreadExit();
      void finishProc();
      bool continueProcess();
@@ -199,6 +241,7 @@ public:
      void bindTexture(struct BitmapCmd cmd);
      void bindTexture(GTexture *texture);
      void texSubImage2D(struct BitmapCmd cmd);
+     void RecordBitmap(const struct BitmapCmd &cmd, bool subImage);
      void setContextLost(bool lost);
 #endif
     
@@ -215,6 +258,7 @@ protected:
      void calculateFPS();
      void execute2dCommands(const char *renderCommands, int length);
      int executeWebGLCommands(const char *&cmd, int length);
+     void PrepareWebGL();
      bool isCmd(const char *in, const char *match) { return in[0] == match[0]; }
      const char *parseSetTransform(const char *renderCommands,
                                   int parseMode, // what to read: IDENTITY, FULL_XFORM, etc.
@@ -282,15 +326,29 @@ public:
     bool mContextLost;
     DynArray<GTransform> mActionStack;
     TextureMgr mTextureMgr;
+    GTextureLoader mTextureLoader;
+    GWebglBinaryReader mWebglBinaryReader;
+    // GL state set through the WebGL handlers, see GWebglStateMirror.h
+    GWebglStateMirror mWebglState;
+    // set by SetContextType when 2d gives up the context, applied on the GL thread
+    std::atomic<bool> mUnbindVertexArrays{false};
+    GCommandRecorder mRecorder;
     std::string mResult = "";
 
 #ifdef ANDROID
     DynArray<Callback *> mCallbacks;
-    sem_t mSyncSem;
-    bool mSync = false;
     bool mExit = false;
-    std::queue<struct GCanvasCmd *> mCmdQueue;
+    // CallNative (JS thread) -> LinkNativeGLProc (GL thread)
+    SPSCQueue<struct GCanvasCmd *> mCmdQueue;
+    // a wakeup is on its way, so the rest of a burst does not signal again
+    std::atomic<bool> mDrainScheduled{false};
+    // set by Clear() off the GL thread, the GL thread then drops the queue
+    std::atomic<bool> mDiscardCmdQueue{false};
     std::queue<struct BitmapCmd *> mBitmapQueue;
+    // results that can not change while the GL context lives, answered on
+    // the calling thread once known, see IsCacheableSyncCmd
+    std::mutex mSyncCacheMutex;
+    std::unordered_map< std::string, std::string > mSyncResultCache;
 #endif
 
     
@@ -9,12 +9,16 @@
 
 
 #include "GCanvas2dContext.h"
+#include "GGLStateCache.h"
 #include "GShaderManager.h"
 #include "../GCanvas.hpp"
 #include "../support/GLUtil.h"
 
 #include <assert.h>
 #include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <utility>
 
 #define SIZE_EPSILON 1.f
 
@@ -86,7 +90,7 @@ void GCanvasContext::FillText(const unsigned short *text, unsigned int text_leng
     Save();
     DoTranslate(x, y);
     DoScale(1 / mDevicePixelRatio * scaleWidth, 1 / mDevicePixelRatio);
-    mFontManager->DrawText(text, text_length, 0, 0, isStroke, mCurrentState->mFont);
+    mFontManager->DrawText(text, text_length, 0, 0, isStroke, mCurrentState->mFont.Get());
     Restore();
 
     mCurrentState->mShader->SetOverideTextureColor(0);
@@ -184,6 +188,7 @@ void GCanvasContext::SetCanvasDimension(const int w, const int h, bool resetStat
     // reset status and clear screen
     if (resetStatus) {
         mVertexBufferIndex = 0;
+        mSpriteBatch.Clear();
         ResetStateStack();
         DoSetGlobalCompositeOperation(COMPOSITE_OP_SOURCE_OVER, COMPOSITE_OP_SOURCE_OVER);
         UseDefaultRenderPipeline();
@@ -278,9 +283,14 @@ GTexture *GCanvasContext::GetFboTexture() {
 GCanvasContext::~GCanvasContext() {
     if (mFontTexture != nullptr) {
         GLuint textureId = mFontTexture->GetTextureID();
-        glDeleteTextures(1, &textureId);
+        GGLStateCache::Current()->DeleteTextures(1, &textureId);
     }
 
+    mVertexArrays.Release();
+    mFrameProfiler.Release();
+    GShaderManager::releaseForShareGroup(mShaderManager);
+    mShaderManager = nullptr;
+
     delete mFontManager;
 }
 
@@ -294,12 +304,13 @@ bool GCanvasContext::InitializeGLEnvironment() {
         InitFBO();
     }
 
-    glEnable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_ALWAYS);
-    glActiveTexture(GL_TEXTURE0);
+    mVertexArrays.Invalidate();
+    GGLStateCache::Current()->Enable(GL_BLEND);
+    GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
+    GGLStateCache::Current()->DepthFunc(GL_ALWAYS);
+    GGLStateCache::Current()->ActiveTexture(GL_TEXTURE0);
 
-    glViewport(0, 0, mWidth, mHeight);
+    GGLStateCache::Current()->Viewport(0, 0, mWidth, mHeight);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
@@ -319,48 +330,27 @@ bool GCanvasContext::InitializeGLEnvironment() {
 
 
 bool GCanvasContext::InitializeGLShader() {
-    UsePatternRenderPipeline();
-    if (nullptr == mCurrentState->mShader) {
-        return false;
-    }
-    BindVertexBuffer();
-
-    UseLinearGradientPipeline();
-    if (nullptr == mCurrentState->mShader) {
-        return false;
-    }
-    BindVertexBuffer();
-
-    UseRadialGradientPipeline();
-    if (nullptr == mCurrentState->mShader) {
-        return false;
-    }
-    BindVertexBuffer();
-
-    UseTextureRenderPipeline();
-    if (nullptr == mCurrentState->mShader) {
-        return false;
-    }
-    BindVertexBuffer();
-
-    UseShadowRenderPipeline();
-    if (nullptr == mCurrentState->mShader) {
-        return false;
-    }
-    BindVertexBuffer();
-
+    // the other programs compile on first use, see GShaderManager
     UseDefaultRenderPipeline();
     if (nullptr == mCurrentState->mShader) {
         return false;
     }
     BindVertexBuffer();
 
+    // the programs of the first fills and images compile off the GL thread,
+    // without EGL they stay lazy
+    std::vector<std::string> names = {"TEXTURE", "PATTERN", "SHADOW"};
+    names.push_back(mGradientLookupEnabled ? "LINEAR_LUT" : "LINEAR");
+    names.push_back(mGradientLookupEnabled ? "RADIAL_LUT" : "RADIAL");
+    GetShaderManager()->precompileAsync(names);
+
     return true;
 }
 
 void GCanvasContext::ClearGeometryDataBuffers() {
     mPath.Reset();
     mVertexBufferIndex = 0;
+    mSpriteBatch.Clear();
 }
 
 
@@ -378,14 +368,16 @@ void GCanvasContext::ResetStateStack() {
 
     if (hasOldState) {
         oldTransfrom = mCurrentState->mTransform;
-        if (mCurrentState->mClipPath != nullptr) {
-            ResetClip();
+        if (!mClipStack.empty()) {
+            mClipStack.clear();
+            ApplyClipState();
         }
     }
 
+    mClipStack.reserve(GCANVAS_STATE_STACK_SIZE);
     mStateStack.clear();
-    GCanvasState state;
-    mStateStack.push_back(state);
+    mStateStack.reserve(GCANVAS_STATE_STACK_SIZE);
+    mStateStack.push_back(GCanvasState());
     mCurrentState = &mStateStack.back();
     mCurrentState->mTransform = mProjectTransform;
     mCurrentState->mUserTransform = GTransformIdentity;
@@ -400,42 +392,39 @@ void GCanvasContext::ResetStateStack() {
     }
 
     SetClipFlag(false);
-    if (mCurrentState->mClipPath != nullptr) {
-        mCurrentState->mClipPath->DrawPolygons2DToContext(this,
-                                                             mCurrentState->mClipPath->mFillRule,
-                                                             FILL_TARGET_DEPTH);
-        SetClipFlag(true);
-    }
 }
 
 void GCanvasContext::BindVertexBuffer() {
-    BindPositionVertexBuffer();
-
-    if (mCurrentState->mShader->GetTexcoordSlot() >= 0) {
-        glEnableVertexAttribArray((GLuint) mCurrentState->mShader->GetTexcoordSlot());
-        glVertexAttribPointer((GLuint) mCurrentState->mShader->GetTexcoordSlot(), 2,
-                              GL_FLOAT, GL_FALSE, sizeof(GVertex),
-                              ((float *) CanvasVertexBuffer) + 2);
-    }
-    if (mCurrentState->mShader->GetColorSlot() >= 0) {
-        glEnableVertexAttribArray((GLuint) mCurrentState->mShader->GetColorSlot());
-        glVertexAttribPointer((GLuint) mCurrentState->mShader->GetColorSlot(), 4,
-                              GL_FLOAT, GL_FALSE, sizeof(GVertex),
-                              ((float *) CanvasVertexBuffer) + 4);
-    }
+    GShader *shader = mCurrentState->mShader;
+    const GVertexAttrib attribs[3] = {
+            {shader->GetPositionSlot(), 2, sizeof(GVertex), CanvasVertexBuffer, 0},
+            {shader->GetTexcoordSlot(), 2, sizeof(GVertex), ((float *) CanvasVertexBuffer) + 2, 0},
+            {shader->GetColorSlot(), 4, sizeof(GVertex), ((float *) CanvasVertexBuffer) + 4, 0}
+    };
+    mVertexArrays.Bind(shader, attribs, 3);
 }
 
-GLuint GCanvasContext::PositionSlot() {
-    return (GLuint) mCurrentState->mShader->GetPositionSlot();
+/**
+ * Programs are compiled lazily and may place their attributes differently,
+ * every program has its own layout over the vertex buffer. Binding it is a
+ * single VAO bind once the layout was specified, see GVertexArrayCache.
+ */
+void GCanvasContext::UpdateVertexAttribs() {
+    if (mCurrentState->mShader == nullptr) {
+        return;
+    }
+    BindVertexBuffer();
 }
 
-void GCanvasContext::BindPositionVertexBuffer() {
-    if (mCurrentState->mShader->GetPositionSlot() >= 0) {
-        glEnableVertexAttribArray((GLuint) mCurrentState->mShader->GetPositionSlot());
-        glVertexAttribPointer((GLuint) mCurrentState->mShader->GetPositionSlot(), 2,
-                              GL_FLOAT, GL_FALSE, sizeof(GVertex),
-                              CanvasVertexBuffer);
-    }
+/**
+ * Subpaths are drawn straight from their point lists, position only. They
+ * get a layout of their own so the program's layout stays as it was.
+ */
+void GCanvasContext::BindPointArray(const GPoint *points) {
+    const GVertexAttrib attribs[1] = {
+            {mCurrentState->mShader->GetPositionSlot(), 2, sizeof(GPoint), points, 0}
+    };
+    mVertexArrays.Bind(&mPath, attribs, 1);
 }
 
 void GCanvasContext::SetTexture(int textureId) {
@@ -450,18 +439,24 @@ void GCanvasContext::SetTexture(int textureId) {
 //| g h i |      | 0 0 1 0 |
 //               | g h 0 i |
 void GCanvasContext::SendVertexBufferToGPU(const GLenum geometry_type) {
+    if (!mSpriteBatch.Empty()) {
+        FlushSpriteBatch(geometry_type);
+    }
     if (mVertexBufferIndex == 0) {
         return;
     }
     mCurrentState->mShader->SetTransform(mCurrentState->mTransform);
     mCurrentState->mShader->SetHasTexture(mCurrentState->mTextureId != InvalidateTextureId);
     if (mCurrentState->mTextureId != InvalidateTextureId) {
-        glBindTexture(GL_TEXTURE_2D, mCurrentState->mTextureId);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mCurrentState->mTextureId);
     }
 
     //draw call
     mDrawCallCount++;
     glDrawArrays(geometry_type, 0, mVertexBufferIndex);
+    GFRAME_COUNT(FRAME_COUNTER_FLUSHES, 1);
+    GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+    GFRAME_COUNT(FRAME_COUNTER_VERTICES, mVertexBufferIndex);
 
     mVertexBufferIndex = 0;
 }
@@ -661,6 +656,79 @@ void GCanvasContext::PushReverseRectangle(float x, float y, float w, float h,
     mVertexBufferIndex += 6;
 }
 
+void GCanvasContext::PushSprite(float x, float y, float w, float h,
+                                float tx, float ty, float tw, float th,
+                                GColorRGBA color, bool flipY) {
+    // vertices pushed earlier have to reach the screen first
+    if (mVertexBufferIndex > 0 || mSpriteBatch.Full()) {
+        SendVertexBufferToGPU();
+    }
+
+    if (flipY) {
+        ty = 1 - ty;
+        th *= -1;
+    }
+
+    mSpriteBatch.Push(GTransformMake(w, 0, 0, h, x, y), tx, ty, tw, th, color);
+}
+
+/**
+ * Sprites are queued while the TEXTURE program is current, any change of
+ * program, texture, transform or blending goes through
+ * SendVertexBufferToGPU() and draws them first.
+ */
+bool GCanvasContext::UseSpriteBatch() {
+    if (!mSpriteBatchEnabled || mCurrentState->mShader != mTextureShader) {
+        return false;
+    }
+    if (mSpriteShader == nullptr) {
+        if (!mSpriteBatch.IsSupported()) {
+            return false;
+        }
+        mSpriteShader = (SpriteShader *) FindShader("SPRITE");
+        if (mSpriteShader == nullptr || !mSpriteShader->IsComplete()) {
+            LOG_W("UseSpriteBatch: sprite program unavailable, drawing images as vertices");
+            mSpriteShader = nullptr;
+            mSpriteBatchEnabled = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * The sprites were queued before anything now in the vertex buffer. A few
+ * of them only go into an empty buffer and are drawn with it, more take
+ * one instanced draw call with the sprite program.
+ */
+void GCanvasContext::FlushSpriteBatch(GLenum geometry_type) {
+    if (mSpriteBatch.Count() < GSpriteBatch::MIN_INSTANCED_SPRITES &&
+        mVertexBufferIndex == 0 && geometry_type == GL_TRIANGLES) {
+        mVertexBufferIndex = mSpriteBatch.WriteVertices(CanvasVertexBuffer);
+        mSpriteBatch.Clear();
+        return;
+    }
+
+    GShader *shader = mCurrentState->mShader;
+    mSpriteShader->Bind();
+    mSpriteShader->SetTransform(mCurrentState->mTransform);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mCurrentState->mTextureId);
+
+    mDrawCallCount++;
+    mSpriteBatch.Draw(mSpriteShader, mVertexArrays);
+    GFRAME_COUNT(FRAME_COUNTER_FLUSHES, 1);
+
+    shader->Bind();
+    BindVertexBuffer();
+}
+
+void GCanvasContext::SetSpriteBatchEnabled(bool enable) {
+    if (!enable && !mSpriteBatch.Empty()) {
+        SendVertexBufferToGPU();
+    }
+    mSpriteBatchEnabled = enable;
+}
+
 void GCanvasContext::PushPoints(const std::vector<GPoint> &points,
                                 GColorRGBA color) {
     GPoint uv = PointMake(0, 0);
@@ -740,8 +808,26 @@ void GCanvasContext::ApplyTransform(GTransform t) {
 }
 #endif
 
+void GCanvasContext::SetShareGroup(const void *shareGroup) {
+    if (mShaderManager != nullptr) {
+        LOG_W("SetShareGroup: shader manager already in use");
+        return;
+    }
+    mShareGroup = shareGroup;
+    mHasShareGroup = true;
+}
+
+GShaderManager *GCanvasContext::GetShaderManager() {
+    if (mShaderManager == nullptr) {
+        // without a host provided group the programs go to the singleton
+        mShaderManager = GShaderManager::acquireForShareGroup(
+                mHasShareGroup ? mShareGroup : nullptr);
+    }
+    return mShaderManager;
+}
+
 GShader *GCanvasContext::FindShader(const char *name) {
-    GShader *shader = GShaderManager::getSingleton()->programForKey(name);
+    GShader *shader = GetShaderManager()->programForKey(name);
     if (shader) {
         std::vector<GCanvasLog> log = shader->GetErrorVector();
         LogExceptionVector(mHooks, mContextId, log);
@@ -750,6 +836,12 @@ GShader *GCanvasContext::FindShader(const char *name) {
     return shader;
 }
 
+void GCanvasContext::WarmUpShaders(const std::vector<std::string> &names) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        FindShader(names[i].c_str());
+    }
+}
+
 
 void GCanvasContext::SetTransformOfShader(const GTransform &trans) {
     // emit the buffered geometry data
@@ -783,6 +875,7 @@ void GCanvasContext::SetTransformOfShader(const GTransform &trans) {
         }
 
         glUniformMatrix4fv(shader->GetTransformSlot(), 1, GL_FALSE, &(m[0]));
+        shader->InvalidateTransform();
     }
 }
 
@@ -803,7 +896,7 @@ GCanvasContext::DoSetGlobalCompositeOperation(GCompositeOperation op, GComposite
 
     GBlendOperationFuncs funcs = GCompositeOperationFuncs(op);
 
-    glBlendFunc(funcs.source, funcs.destination);
+    GGLStateCache::Current()->BlendFunc(funcs.source, funcs.destination);
 
     mCurrentState->mGlobalCompositeOp = op;
 }
@@ -813,7 +906,7 @@ GCanvasContext::DoSetGlobalCompositeOperation(GCompositeOperation op, GComposite
 
 
 void GCanvasContext::DrawFBOToFBO(GFrameBufferObject &src, GFrameBufferObject &dest) {
-    glViewport(0, 0, dest.ExpectedWidth(), dest.ExpectedHeight());
+    GGLStateCache::Current()->Viewport(0, 0, dest.ExpectedWidth(), dest.ExpectedHeight());
 
     DoSetGlobalCompositeOperation(COMPOSITE_OP_REPLACE, COMPOSITE_OP_REPLACE);
 
@@ -822,13 +915,15 @@ void GCanvasContext::DrawFBOToFBO(GFrameBufferObject &src, GFrameBufferObject &d
                               static_cast<float >(src.ExpectedHeight()) / src.Height(),
                               GColorWhite);
     mCurrentState->mShader->SetTransform(GTransformIdentity);
-    glBindTexture(GL_TEXTURE_2D, src.mFboTexture.GetTextureID());
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, src.mFboTexture.GetTextureID());
     glDrawArrays(GL_TRIANGLES, 0, mVertexBufferIndex);
+    GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+    GFRAME_COUNT(FRAME_COUNTER_VERTICES, mVertexBufferIndex);
     mVertexBufferIndex = 0;
 }
 
 void GCanvasContext::PrepareDrawElemetToFBO(GFrameBufferObject &fbo) {
-    glViewport(0, 0, fbo.ExpectedWidth(), fbo.ExpectedHeight());
+    GGLStateCache::Current()->Viewport(0, 0, fbo.ExpectedWidth(), fbo.ExpectedHeight());
     GTransform &t = mCurrentState->mTransform;
     t = CalculateProjectTransform(fbo.ExpectedWidth(), fbo.ExpectedHeight());
 }
@@ -848,6 +943,7 @@ void GCanvasContext::Blur(const GRectf &rect, float blur,
                           bool isOnScreen, float scale) {
     const float Step = 5;
     blur /= 2.5f;
+    SetClipScissorEnabled(false);
 
     GFrameBufferObjectPtr originFbo;
     float blurStep;
@@ -890,7 +986,8 @@ void GCanvasContext::Blur(const GRectf &rect, float blur,
     if (isOnScreen) {
         // draw screen
         DoSetGlobalCompositeOperation(COMPOSITE_OP_SOURCE_OVER, COMPOSITE_OP_SOURCE_OVER);
-        glViewport(0, 0, mWidth, mHeight);
+        GGLStateCache::Current()->Viewport(0, 0, mWidth, mHeight);
+        SetClipScissorEnabled(true);
         mCurrentState->mShader->SetDelta(0, 1.0f / shadowFbo->Height());
         DrawFBOToScreen(*shadowFbo, rect.leftTop.x + mCurrentState->mShadowOffsetX,
                         rect.leftTop.y + mCurrentState->mShadowOffsetY,
@@ -1009,7 +1106,7 @@ void GCanvasContext::FillBlur() {
 }
 
 void GCanvasContext::ApplyFillStylePipeline(bool isStroke) {
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
+    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle.Get() : mCurrentState->mFillStyle.Get();
     if (style == nullptr || style->IsDefault()) {
         UseDefaultRenderPipeline();
     } else {
@@ -1024,31 +1121,218 @@ void GCanvasContext::ApplyFillStylePipeline(bool isStroke) {
 }
 
 void GCanvasContext::ClipRegion() {
-    BeforeClip();
+    ClipRegionNew(FILL_RULE_NONZERO);
+}
+
+/**
+ * Clips are pushed incrementally: a nested clip is only tested against the
+ * layer below, so Restore() never has to rasterize a clip path again.
+ * Depth layer n is stored as ClipDepthValue(n) and drawn with a depth range
+ * collapsed to that value, so GL_EQUAL selects exactly the current layer.
+ */
+void GCanvasContext::ClipRegionNew(GFillRule rule) {
+    SendVertexBufferToGPU();
+    mPath.Close();
+    PushClipLayer(mPath, rule);
+}
 
-    if (mCurrentState->mClipPath) {
-        delete mCurrentState->mClipPath;
-        mCurrentState->mClipPath = nullptr;
+void GCanvasContext::PushClipLayer(GPath &path, GFillRule rule) {
+    GClipLayer layer;
+    layer.transform = mCurrentState->mTransform;
+    layer.depthLevel = ClipDepthLevel();
+    layer.hasScissor = false;
+    layer.rule = rule;
+    layer.depthLost = false;
+    if (mClipStack.size() > (size_t) mCurrentState->mClipBase) {
+        layer.hasScissor = mClipStack.back().hasScissor;
+        memcpy(layer.scissor, mClipStack.back().scissor, sizeof(layer.scissor));
     }
 
-    mPath.Close();
-    mCurrentState->mClipPath = new GPath(mPath);
-    mCurrentState->mClipPath->ClipRegion(this);
-    SetClipFlag(true);
+    GRectf rect;
+    if (path.GetAxisAlignedRect(rect) && ClipRectToScissor(rect, layer)) {
+        layer.bounds = rect;
+        ApplyClipScissor(&layer);
+    } else {
+        if (layer.depthLevel >= GCANVAS_CLIP_DEPTH_LEVELS) {
+            LOG_W("clip ignored, more than %d nested clip paths", GCANVAS_CLIP_DEPTH_LEVELS);
+            return;
+        }
+        path.GetRect(layer.bounds);
+        if (layer.depthLevel == 0) {
+            // first depth layer, drop whatever earlier clips left behind;
+            // layers suspended by resetClip() are rasterized again on restore()
+            GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
+            GGLStateCache::Current()->DepthMask(GL_TRUE);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            GGLStateCache::Current()->DepthMask(GL_FALSE);
+            for (size_t i = 0; i < mClipStack.size(); ++i) {
+                if (mClipStack[i].depthLevel > 0) {
+                    mClipStack[i].depthLost = true;
+                }
+            }
+        }
+        path.DrawPolygons2DToContext(this, rule, FILL_TARGET_DEPTH);
+        layer.depthLevel++;
+        layer.path = std::make_shared<GPath>(path);
+        SetClipFlag(true);
+    }
 
-    AfterClip();
+    mClipStack.push_back(layer);
+    mCurrentState->mClipDepth = (int) mClipStack.size();
 }
 
-void GCanvasContext::ClipRegionNew(GFillRule rule) {
-    if (mCurrentState->mClipPath) {
-        delete mCurrentState->mClipPath;
-        mCurrentState->mClipPath = nullptr;
+// clears the depth buffer and clips again with the layers from base up,
+// each under the transform it was made with
+void GCanvasContext::RebuildClipLayers(size_t base) {
+    std::vector<GClipLayer> layers(mClipStack.begin() + base, mClipStack.end());
+    mClipStack.resize(base);
+    ApplyClipState();
+
+    GTransform transform = mCurrentState->mTransform;
+    int clipDepth = mCurrentState->mClipDepth;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        GClipLayer &layer = layers[i];
+        if (!layer.path) {
+            layer.depthLevel = ClipDepthLevel();
+            layer.depthLost = false;
+            mClipStack.push_back(layer);
+            continue;
+        }
+        mCurrentState->mTransform = layer.transform;
+        mCurrentState->mShader->SetTransform(layer.transform);
+        PushClipLayer(*layer.path, layer.rule);
     }
+    mCurrentState->mTransform = transform;
+    mCurrentState->mShader->SetTransform(transform);
+    mCurrentState->mClipDepth = clipDepth;
+}
 
-    mPath.Close();
-    mCurrentState->mClipPath = new GPath(mPath);
-    mCurrentState->mClipPath->mFillRule = rule;
-    mCurrentState->mClipPath->DrawPolygons2DToContext(this, rule, FILL_TARGET_DEPTH);
+bool GCanvasContext::ClipRectToScissor(const GRectf &rect, GClipLayer &layer) {
+    const GTransform &t = layer.transform;
+    if (!((t.b == 0 && t.c == 0) || (t.a == 0 && t.d == 0))) {
+        return false;
+    }
+
+    GLint viewport[4];
+    GGLStateCache::Current()->GetViewport(viewport);
+
+    GPoint p1 = GPointApplyGTransform(rect.leftTop.x, rect.leftTop.y, t);
+    GPoint p2 = GPointApplyGTransform(rect.bottomRight.x, rect.bottomRight.y, t);
+    float x1 = (std::min(p1.x, p2.x) + 1) * 0.5f * viewport[2] + viewport[0];
+    float x2 = (std::max(p1.x, p2.x) + 1) * 0.5f * viewport[2] + viewport[0];
+    float y1 = (std::min(p1.y, p2.y) + 1) * 0.5f * viewport[3] + viewport[1];
+    float y2 = (std::max(p1.y, p2.y) + 1) * 0.5f * viewport[3] + viewport[1];
+
+    // keep the pixels whose centers are inside, as rasterizing would
+    GLint left = (GLint) floorf(x1 + 0.5f);
+    GLint right = (GLint) floorf(x2 + 0.5f);
+    GLint bottom = (GLint) floorf(y1 + 0.5f);
+    GLint top = (GLint) floorf(y2 + 0.5f);
+
+    if (layer.hasScissor) {
+        left = std::max(left, layer.scissor[0]);
+        bottom = std::max(bottom, layer.scissor[1]);
+        right = std::min(right, layer.scissor[0] + layer.scissor[2]);
+        top = std::min(top, layer.scissor[1] + layer.scissor[3]);
+    }
+
+    layer.hasScissor = true;
+    layer.scissor[0] = left;
+    layer.scissor[1] = bottom;
+    layer.scissor[2] = std::max(right - left, 0);
+    layer.scissor[3] = std::max(top - bottom, 0);
+    return true;
+}
+
+void GCanvasContext::PopClipLayers(size_t depth) {
+    SendVertexBufferToGPU();
+
+    while (mClipStack.size() > depth) {
+        GClipLayer layer = mClipStack.back();
+        mClipStack.pop_back();
+
+        int level = ClipDepthLevel();
+        if (layer.depthLevel > level && level > 0) {
+            ApplyClipScissor(&layer);
+            RestoreClipDepth(layer, level);
+        }
+    }
+
+    // back in effect after a resetClip(), maybe under a depth buffer that a
+    // later clip cleared
+    size_t base = (size_t) mCurrentState->mClipBase;
+    for (size_t i = base; i < mClipStack.size(); ++i) {
+        if (mClipStack[i].depthLost) {
+            RebuildClipLayers(base);
+            break;
+        }
+    }
+
+    ApplyClipState();
+}
+
+// hand the pixels of a popped depth layer back to the layer below it
+void GCanvasContext::RestoreClipDepth(const GClipLayer &layer, int level) {
+    float depth = ClipDepthValue(level);
+
+    GGLStateCache::Current()->Disable(GL_BLEND);
+    GGLStateCache::Current()->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    GGLStateCache::Current()->DepthRange(depth, depth);
+    // deeper layers hold smaller values
+    GGLStateCache::Current()->DepthFunc(GL_GREATER);
+    GGLStateCache::Current()->DepthMask(GL_TRUE);
+
+    GTransform transform = mCurrentState->mTransform;
+    int textureId = mCurrentState->mTextureId;
+    mCurrentState->mTransform = layer.transform;
+    mCurrentState->mTextureId = InvalidateTextureId;
+
+    PushRectangle(layer.bounds.leftTop.x, layer.bounds.leftTop.y,
+                  layer.bounds.Width(), layer.bounds.Height(), 0, 0, 0, 0, GColorWhite);
+    SendVertexBufferToGPU();
+
+    mCurrentState->mTransform = transform;
+    mCurrentState->mTextureId = textureId;
+
+    GGLStateCache::Current()->DepthMask(GL_FALSE);
+    GGLStateCache::Current()->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    GGLStateCache::Current()->Enable(GL_BLEND);
+}
+
+void GCanvasContext::ApplyClipScissor(const GClipLayer *layer) {
+    if (layer != nullptr && layer->hasScissor) {
+        GGLStateCache::Current()->Enable(GL_SCISSOR_TEST);
+        GGLStateCache::Current()->Scissor(layer->scissor[0], layer->scissor[1], layer->scissor[2], layer->scissor[3]);
+    } else {
+        GGLStateCache::Current()->Disable(GL_SCISSOR_TEST);
+    }
+}
+
+void GCanvasContext::ApplyClipState() {
+    bool clipped = mClipStack.size() > (size_t) mCurrentState->mClipBase;
+    ApplyClipScissor(clipped ? &mClipStack.back() : nullptr);
+
+    int level = ClipDepthLevel();
+    if (level > 0) {
+        float depth = ClipDepthValue(level);
+        GGLStateCache::Current()->DepthRange(depth, depth);
+        GGLStateCache::Current()->DepthFunc(GL_EQUAL);
+    } else {
+        GGLStateCache::Current()->DepthRange(0, 1);
+        GGLStateCache::Current()->DepthFunc(GL_ALWAYS);
+    }
+    GGLStateCache::Current()->DepthMask(GL_FALSE);
+    SetClipFlag(level > 0);
+}
+
+void GCanvasContext::SetClipScissorEnabled(bool enabled) {
+    if (mClipStack.size() > (size_t) mCurrentState->mClipBase && mClipStack.back().hasScissor) {
+        if (enabled) {
+            GGLStateCache::Current()->Enable(GL_SCISSOR_TEST);
+        } else {
+            GGLStateCache::Current()->Disable(GL_SCISSOR_TEST);
+        }
+    }
 }
 
 
@@ -1084,11 +1368,13 @@ void GCanvasContext::RestoreRenderPipeline() {
         UsePatternRenderPipeline(mSaveIsStroke);
     } else if (name == "TEXTURE") {
         UseTextureRenderPipeline();
+    } else if (name == "TEXTURE_ALPHA_SPLIT") {
+        UseTextureAlphaSplitRenderPipeline();
     } else if (name == "SHADOW") {
         UseShadowRenderPipeline();
-    } else if (name == "LINEAR") {
+    } else if (name == "LINEAR" || name == "LINEAR_LUT") {
         UseLinearGradientPipeline(mSaveIsStroke);
-    } else if (name == "RADIAL") {
+    } else if (name == "RADIAL" || name == "RADIAL_LUT") {
         UseRadialGradientPipeline(mSaveIsStroke);
     } else {
         UseDefaultRenderPipeline();
@@ -1102,17 +1388,20 @@ void GCanvasContext::UseDefaultRenderPipeline() {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
     SetTexture(InvalidateTextureId);
 }
 
 void GCanvasContext::UseTextureRenderPipeline() {
     GShader *newShader = FindShader("TEXTURE");
+    mTextureShader = newShader;
 
     if (newShader != nullptr && mCurrentState->mShader != newShader) {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
 
         TextureShader *textureShader = (TextureShader*)(mCurrentState->mShader);
         if( textureShader != nullptr )
@@ -1122,6 +1411,17 @@ void GCanvasContext::UseTextureRenderPipeline() {
     }
 }
 
+void GCanvasContext::UseTextureAlphaSplitRenderPipeline() {
+    GShader *newShader = FindShader("TEXTURE_ALPHA_SPLIT");
+
+    if (newShader != nullptr && mCurrentState->mShader != newShader) {
+        SendVertexBufferToGPU();
+        mCurrentState->mShader = newShader;
+        mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
+    }
+}
+
 inline double Gaussian(double x, double sigma) {
     return 1 / exp(x * x / 2 / (sigma * sigma)) / sigma / sqrt(2 * M_PI);
 }
@@ -1140,6 +1440,7 @@ void GCanvasContext::UseShadowRenderPipeline() {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
 }
 
@@ -1150,6 +1451,7 @@ void GCanvasContext::UseShadowRenderPipeline(double radius) {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
 
     //Shadow with radius
@@ -1165,18 +1467,19 @@ void GCanvasContext::UsePatternRenderPipeline(bool isStroke) {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
 
     //Pattern
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
+    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle.Get() : mCurrentState->mFillStyle.Get();
     if (style != nullptr && style->IsPattern()) {
         FillStylePattern *pattern = (FillStylePattern *) (style);
-        mCurrentState->mShader->SetRepeatMode(pattern->GetPattern());
+        mCurrentState->mShader->SetRepeatMode(pattern->GetRepeatMode());
         mCurrentState->mTextureId = pattern->GetTextureListID();
         mCurrentState->mShader->SetTextureSize(pattern->GetTextureWidth(),
                                                pattern->GetTextureHeight());
         if (mCurrentState->mTextureId != InvalidateTextureId) {
-            glBindTexture(GL_TEXTURE_2D, mCurrentState->mTextureId);
+            GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mCurrentState->mTextureId);
         }
         //Pattern Alpha
         PatternShader *patternShader = (PatternShader *) (mCurrentState->mShader);
@@ -1186,52 +1489,106 @@ void GCanvasContext::UsePatternRenderPipeline(bool isStroke) {
     }
 }
 
+/**
+ * The *_LUT programs read the colors from a 256x1 texture baked from the
+ * stop list, the plain ones evaluate the stops per pixel from uniforms.
+ */
+GShader *GCanvasContext::FindGradientShader(const char *name, const char *lookupName,
+                                            GFillStyle *style) {
+    GShader *shader = nullptr;
+    if (mGradientLookupEnabled && style != nullptr) {
+        shader = FindShader(lookupName);
+    }
+    return shader != nullptr ? shader : FindShader(name);
+}
+
+void GCanvasContext::BindGradientLookup(const GGradientStops &stops) {
+    GLuint texture = mGradientCache.Find(stops);
+    if (texture == 0 || texture != mGradientTexture) {
+        // geometry batched so far was meant for the previous stop list
+        SendVertexBufferToGPU();
+    }
+
+    GGLStateCache *cache = GGLStateCache::Current();
+    cache->ActiveTexture(GL_TEXTURE0 + GradientShader::LOOKUP_TEXTURE_UNIT);
+    if (texture == 0) {
+        texture = mGradientCache.Upload(stops);
+    } else {
+        cache->BindTexture(GL_TEXTURE_2D, texture);
+    }
+    cache->ActiveTexture(GL_TEXTURE0);
+    mGradientTexture = texture;
+}
+
+template<class Gradient>
+static void ApplyGradientStops(GCanvasContext *context, GShader *shader, Gradient *grad,
+                               GGradientStops &stops) {
+    const int count = std::min(grad->GetColorStopCount(), GGRADIENT_MAX_STOPS);
+    stops.count = count;
+    for (int i = 0; i < count; ++i) {
+        const typename Gradient::ColorStop *stop = grad->GetColorStop(i);
+        stops.pos[i] = stop->pos;
+        stops.color[i] = BlendColor(context, stop->color);
+    }
+
+    if (!shader->HasLookupTexture()) {
+        shader->SetColorStopCount(count);
+        for (int i = 0; i < count; ++i) {
+            shader->SetColorStop(stops.color[i].components, stops.pos[i], i);
+        }
+    }
+}
+
 void GCanvasContext::UseLinearGradientPipeline(bool isStroke) {
-    GShader *newShader = FindShader("LINEAR");
+    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle.Get() : mCurrentState->mFillStyle.Get();
+    if (style != nullptr && !style->IsLinearGradient()) {
+        style = nullptr;
+    }
+    GShader *newShader = FindGradientShader("LINEAR", "LINEAR_LUT", style);
 
     if (newShader != nullptr && mCurrentState->mShader != newShader) {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
 
     //Linear Gradinet
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
-    if (style != nullptr && style->IsLinearGradient()) {
+    if (style != nullptr) {
         FillStyleLinearGradient *grad = (FillStyleLinearGradient *) (style);
         mCurrentState->mShader->SetRange(grad->GetStartPos(), grad->GetEndPos());
-        mCurrentState->mShader->SetColorStopCount(grad->GetColorStopCount());
 
-        const int count = grad->GetColorStopCount();
-        for (int i = 0; i < count; ++i) {
-            const FillStyleLinearGradient::ColorStop *stop = grad->GetColorStop(i);
-            GColorRGBA c = BlendColor(this, stop->color);
-            mCurrentState->mShader->SetColorStop(c.components, stop->pos, i);
+        GGradientStops stops;
+        ApplyGradientStops(this, mCurrentState->mShader, grad, stops);
+        if (mCurrentState->mShader->HasLookupTexture()) {
+            BindGradientLookup(stops);
         }
     }
 }
 
 void GCanvasContext::UseRadialGradientPipeline(bool isStroke) {
-    GShader *newShader = FindShader("RADIAL");
+    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle.Get() : mCurrentState->mFillStyle.Get();
+    if (style != nullptr && !style->IsRadialGradient()) {
+        style = nullptr;
+    }
+    GShader *newShader = FindGradientShader("RADIAL", "RADIAL_LUT", style);
 
     if (newShader != nullptr && mCurrentState->mShader != newShader) {
         SendVertexBufferToGPU();
         mCurrentState->mShader = newShader;
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
 
     //Radial Gradinet
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
-    if (style != nullptr && style->IsRadialGradient()) {
+    if (style != nullptr) {
         FillStyleRadialGradient *grad = (FillStyleRadialGradient *) (style);
         mCurrentState->mShader->SetRange(grad->GetStartPos(), grad->GetEndPos());
-        mCurrentState->mShader->SetColorStopCount(grad->GetColorStopCount());
 
-        const int count = grad->GetColorStopCount();
-        for (int i = 0; i < count; ++i) {
-            const FillStyleRadialGradient::ColorStop *stop = grad->GetColorStop(i);
-            GColorRGBA c = BlendColor(this, stop->color);
-            mCurrentState->mShader->SetColorStop(c.components, stop->pos, i);
+        GGradientStops stops;
+        ApplyGradientStops(this, mCurrentState->mShader, grad, stops);
+        if (mCurrentState->mShader->HasLookupTexture()) {
+            BindGradientLookup(stops);
         }
     }
 }
@@ -1307,7 +1664,6 @@ void GCanvasContext::SetFont(const char *font) {
         if (strcmp(mCurrentState->mFont->GetOriginFontName().c_str(), font) == 0) {
             return;
         }
-        delete mCurrentState->mFont;
     }
     mCurrentState->mFont = new GFontStyle(font, mDevicePixelRatio);
 }
@@ -1340,10 +1696,7 @@ void GCanvasContext::SetFillStyle(const char *str) {
 }
 
 void GCanvasContext::SetFillStyle(GColorRGBA c) {
-    if (mCurrentState->mFillStyle != nullptr) {
-        delete mCurrentState->mFillStyle;
-        mCurrentState->mFillStyle = nullptr;
-    }
+    mCurrentState->mFillStyle.Reset();
     
     mCurrentState->mFillColor = c;
     UseDefaultRenderPipeline();
@@ -1358,10 +1711,7 @@ void GCanvasContext::SetStrokeStyle(const char *str) {
 }
 
 void GCanvasContext::SetStrokeStyle(const GColorRGBA &c) {
-    if (mCurrentState->mStrokeStyle != nullptr) {
-        delete mCurrentState->mStrokeStyle;
-        mCurrentState->mStrokeStyle = nullptr;
-    }
+    mCurrentState->mStrokeStyle.Reset();
     
     mCurrentState->mStrokeColor = c;
     UseDefaultRenderPipeline();
@@ -1375,13 +1725,7 @@ void GCanvasContext::SetFillStylePattern(int textureId, int width, int height, c
     //change fill style, need send vertex buffer
     SendVertexBufferToGPU();
         
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
-    if (style != nullptr) {
-        delete style;
-        style = nullptr;
-    }
-
-    style = new FillStylePattern(textureId, width, height, repeatMode);
+    GFillStyle *style = new FillStylePattern(textureId, width, height, repeatMode);
     if (isStroke) {
         mCurrentState->mStrokeStyle = style;
     } else {
@@ -1395,20 +1739,13 @@ void GCanvasContext::SetFillStyleLinearGradient(float startArr[], float endArr[]
     //change fill style, need send vertex buffer
     SendVertexBufferToGPU();
 
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
-
-    if (style != nullptr) {
-        delete style;
-        style = nullptr;
-    }
-
     GPoint start, end;
     start.x = startArr[0];
     start.y = startArr[1];
     end.x = endArr[0];
     end.y = endArr[1];
 
-    style = new FillStyleLinearGradient(start, end);
+    GFillStyle *style = new FillStyleLinearGradient(start, end);
     if (isStroke) {
         mCurrentState->mStrokeStyle = style;
     } else {
@@ -1428,13 +1765,7 @@ void GCanvasContext::SetFillStyleRadialGradient(float startArr[], float endArr[]
     //change fill style, need send vertex buffer
     SendVertexBufferToGPU();
 
-    GFillStyle *style = isStroke ? mCurrentState->mStrokeStyle : mCurrentState->mFillStyle;
-
-    if (style != nullptr) {
-        delete style;
-        style = nullptr;
-    }
-    style = new FillStyleRadialGradient(startArr, endArr);
+    GFillStyle *style = new FillStyleRadialGradient(startArr, endArr);
     if (isStroke) {
         mCurrentState->mStrokeStyle = style;
     } else {
@@ -1475,7 +1806,23 @@ void GCanvasContext::SetLineJoin(const char *p) {
 
 
 std::vector<float> &GCanvasContext::GetLineDash() {
-    return mCurrentState->mLineDash;
+    if (mCurrentState->mLineDash == nullptr) {
+        mCurrentState->mLineDash = new std::vector<float>();
+    }
+    return *mCurrentState->mLineDash.Mutable();
+}
+
+const std::vector<float> &GCanvasContext::LineDash() const {
+    static const std::vector<float> sNoDash;
+    return mCurrentState->mLineDash ? *mCurrentState->mLineDash : sNoDash;
+}
+
+void GCanvasContext::SetLineDash(std::vector<float> lineDash) {
+    if (lineDash.empty()) {
+        mCurrentState->mLineDash.Reset();
+    } else {
+        mCurrentState->mLineDash = new std::vector<float>(std::move(lineDash));
+    }
 }
 
 
@@ -1486,8 +1833,10 @@ void GCanvasContext::ClearScreen() {
     LOG_D("ClearScreen: r:%f, g:%f, b:%f, a:%f", mClearColor.rgba.r, mClearColor.rgba.g, mClearColor.rgba.b,
           mClearColor.rgba.a);
     glClearColor(mClearColor.rgba.r, mClearColor.rgba.g, mClearColor.rgba.b, mClearColor.rgba.a);
-    glStencilMask(0xff);
+    GGLStateCache::Current()->StencilMask(0xff);
+    SetClipScissorEnabled(false);
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    SetClipScissorEnabled(true);
 }
 
 /**
@@ -1499,8 +1848,10 @@ void GCanvasContext::Resize(int width, int height)
     mWidth = width;
     mHeight = height;
 
-    glViewport(0, 0, width, height);
+    GGLStateCache::Current()->Viewport(0, 0, width, height);
+    SetClipScissorEnabled(false);
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    SetClipScissorEnabled(true);
 
     if (mContextType == 0) {
         mVertexBufferIndex = 0;
@@ -1596,10 +1947,6 @@ bool GCanvasContext::Restore() {
         return false;
     }
     
-    if (mCurrentState->mClipPath) {
-        ResetClip();
-    }
-    
     GShader *oldShader = mCurrentState->mShader;
     
     mStateStack.pop_back();
@@ -1608,20 +1955,15 @@ bool GCanvasContext::Restore() {
     auto op = mCurrentState->mGlobalCompositeOp;
     GBlendOperationFuncs funcs = GCompositeOperationFuncs(op);
     
-    glBlendFuncSeparate(funcs.source, funcs.destination,
+    GGLStateCache::Current()->BlendFuncSeparate(funcs.source, funcs.destination,
                         funcs.source, funcs.destination);
     
     if (mCurrentState->mShader != oldShader) {
         mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
     }
     
-    SetClipFlag(false);
-    if (mCurrentState->mClipPath) {
-        mCurrentState->mClipPath->DrawPolygons2DToContext(this,
-                                                             mCurrentState->mClipPath->mFillRule,
-                                                             FILL_TARGET_DEPTH);
-        SetClipFlag(true);
-    }
+    PopClipLayers((size_t) mCurrentState->mClipDepth);
     
     return true;
 }
@@ -1734,19 +2076,12 @@ void GCanvasContext::Clip(GFillRule rule) {
     ClipRegionNew(rule);
 }
 
+// every clip stops applying until the matching restore(), which finds the
+// layers of the enclosing states still on the stack and applies them again
 void GCanvasContext::ResetClip() {
-    if (mCurrentState->mClipPath) {
-        delete mCurrentState->mClipPath;
-        mCurrentState->mClipPath = nullptr;
-        
-        glDepthMask(GL_FALSE);
-        glDepthFunc(GL_ALWAYS);
-        
-        glClear(GL_STENCIL_BUFFER_BIT);
-        glDisable(GL_STENCIL_TEST);
-        
-        SetClipFlag(false);
-    }
+    SendVertexBufferToGPU();
+    mCurrentState->mClipBase = (int) mClipStack.size();
+    ApplyClipState();
 }
 
 void GCanvasContext::Stroke() {
@@ -1778,7 +2113,7 @@ float GCanvasContext::MeasureTextWidth(const char *text, int strLength) {
     if (mCurrentState->mFont == nullptr) {
         mCurrentState->mFont = new GFontStyle(nullptr, mDevicePixelRatio);
     }
-    int width = mFontManager->MeasureText(text, strLength, mCurrentState->mFont);
+    int width = mFontManager->MeasureText(text, strLength, mCurrentState->mFont.Get());
     return width / mDevicePixelRatio;
 }
 
@@ -1807,9 +2142,29 @@ void GCanvasContext::DoDrawImage(float w, float h, int TextureId, float sx,
     
     GColorRGBA color = BlendWhiteColor(this);
     SetTexture(TextureId);
+    if (UseSpriteBatch()) {
+        PushSprite(dx, dy, dw, dh, sx / w, sy / h, sw / w, sh / h, color, flipY);
+        return;
+    }
     PushRectangle(dx, dy, dw, dh, sx / w, sy / h, sw / w, sh / h, color, flipY);
 }
 
+void GCanvasContext::DrawAlphaSplitImage(float w, float h, int TextureId, float sx,
+                                         float sy, float sw, float sh, float dx,
+                                         float dy, float dw, float dh) {
+    GShader *prevShader = mCurrentState->mShader;
+    UseTextureAlphaSplitRenderPipeline();
+    DoDrawImage(w, h, TextureId, sx, sy, sw, sh, dx, dy, dw, dh);
+
+    // the split layout only applies to this texture, go back to the caller's pipeline
+    if (prevShader != nullptr && prevShader != mCurrentState->mShader) {
+        SendVertexBufferToGPU();
+        mCurrentState->mShader = prevShader;
+        mCurrentState->mShader->Bind();
+        UpdateVertexAttribs();
+    }
+}
+
 
 void GCanvasContext::GetImageData(int x, int y, int width, int height, uint8_t *pixels) {
     SendVertexBufferToGPU();
@@ -1856,7 +2211,7 @@ void GCanvasContext::PutImageData(const unsigned char *rgbaData, int tw,
 
     SendVertexBufferToGPU();
     SetTexture(InvalidateTextureId);
-    glDeleteTextures(1, &glID);
+    GGLStateCache::Current()->DeleteTextures(1, &glID);
 }
 
 
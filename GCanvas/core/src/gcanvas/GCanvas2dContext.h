@@ -13,14 +13,19 @@
 #include "GCanvasState.h"
 #include "GFrameBufferObject.h"
 #include "GTexture.h"
+#include "GGradientCache.h"
+#include "GSpriteBatch.h"
+#include "GVertexArrayCache.h"
 #include "GConvert.h"
 #include "GTreemap.h"
 #include "GFontManager.h"
+#include "GFrameProfiler.h"
 #include "../support/Log.h"
 
 #include <iostream>
 #include <limits.h>
 #include <functional>
+#include <memory>
 
 extern GColorRGBA BlendColor(GCanvasContext *context, GColorRGBA color);
 extern GColorRGBA BlendWhiteColor(GCanvasContext *context);
@@ -37,16 +42,35 @@ typedef void (*GWebGLBindToGLKViewFunc)(std::string contextId);
 #endif
 
 class GCanvas;
+class GShaderManager;
 
 struct GCanvasConfig {
     bool flip;              //deafult is false,
     bool useFbo;            //default is true
 };
 
+/**
+ * Entry of the clip stack. A rectangle under an axis-aligned transform
+ * only narrows the scissor box; any other clip takes the next depth layer.
+ * Depth layers keep their path, so they can be rasterized again once a
+ * clip made after resetClip() cleared the depth buffer under them.
+ */
+struct GClipLayer {
+    GTransform transform;   // transform the clip was rasterized with
+    GRectf bounds;          // clip path bounds before transform
+    int depthLevel;         // depth layer in effect, 0 for none
+    bool hasScissor;
+    GLint scissor[4];       // scissor box in effect, window coordinates
+    std::shared_ptr<GPath> path;   // depth layers only
+    GFillRule rule;
+    bool depthLost;         // the depth buffer no longer holds this layer
+};
+
 class GCanvasContext {
 public:
     static const int GCANVAS_STATE_STACK_SIZE = 16;
     static const int GCANVAS_VERTEX_BUFFER_SIZE = 2048;
+    static const int GCANVAS_CLIP_DEPTH_LEVELS = 255;
 
     GCanvasContext(short w, short h, const GCanvasConfig &config, GCanvasHooks *hooks = nullptr);
     virtual ~GCanvasContext();
@@ -57,10 +81,11 @@ public:
     void ResetStateStack();
     
     void BindVertexBuffer();
+    void UpdateVertexAttribs();
     void ClearGeometryDataBuffers();
     API_EXPORT void SendVertexBufferToGPU(const GLenum geometry_type = GL_TRIANGLES);
-    void BindPositionVertexBuffer();
-    GLuint PositionSlot();
+    // position only layout over a point list, BindVertexBuffer() goes back
+    void BindPointArray(const GPoint *points);
     
     void UpdateProjectTransform();
     GTransform CalculateProjectTransform(int width, int height);
@@ -72,6 +97,7 @@ public:
 
     API_EXPORT void UseDefaultRenderPipeline();
     void UseTextureRenderPipeline();
+    void UseTextureAlphaSplitRenderPipeline();
     void UseShadowRenderPipeline();
     void UseShadowRenderPipeline(double radius);
     void UsePatternRenderPipeline(bool isStroke = false);
@@ -79,6 +105,27 @@ public:
     void UseRadialGradientPipeline(bool isStroke = false);
     void ApplyFillStylePipeline(bool isStroke = false);
 
+    // Gradients are drawn from a baked lookup texture by default, disable to
+    // fall back to the shaders that evaluate the color stops per pixel
+    API_EXPORT void SetGradientLookupEnabled(bool enable) { mGradientLookupEnabled = enable; }
+    API_EXPORT bool IsGradientLookupEnabled() const { return mGradientLookupEnabled; }
+
+    // Images drawn in a row with the same texture and state are batched into
+    // one instanced draw call where instanced arrays are available, disable
+    // to always push six vertices per image
+    API_EXPORT void SetSpriteBatchEnabled(bool enable);
+    API_EXPORT bool IsSpriteBatchEnabled() const { return mSpriteBatchEnabled; }
+
+    // Contexts created with a shared EGL context should pass the same key,
+    // e.g. the root EGLContext, to share one program cache. Without a key a
+    // context uses the process wide GShaderManager singleton.
+    API_EXPORT void SetShareGroup(const void *shareGroup);
+    API_EXPORT GShaderManager *GetShaderManager();
+
+    // Programs compile on first use, compile these now instead, e.g. the
+    // pipelines the first frame is known to need
+    API_EXPORT void WarmUpShaders(const std::vector<std::string> &names);
+
     void SetTexture(int textureId);
 
     
@@ -98,6 +145,9 @@ public:
     void PushPoints(const std::vector<GPoint> &points, GColorRGBA color);
     void PushVertexs(const std::vector<GVertex> &vertexs);
     void PushTriangleFanPoints(const std::vector<GPoint> &points, GColorRGBA color);
+    // same arguments as PushRectangle, queued in the sprite batch
+    void PushSprite(float x, float y, float w, float h, float tx, float ty,
+                    float tw, float th, GColorRGBA color, bool flipY = false);
 
     //----------------Getter & Setter------------------------
     API_EXPORT bool IsUseFbo();
@@ -132,6 +182,14 @@ public:
     
     bool HasClipRegion() const { return mHasClipRegion; }
     void SetClipFlag(const bool flag) { mHasClipRegion = flag; }
+
+    // of the clips in effect, layers under the current resetClip() do not count
+    int ClipDepthLevel() const {
+        return mClipStack.size() > (size_t) mCurrentState->mClipBase ? mClipStack.back().depthLevel : 0;
+    }
+    float ClipDepthValue(int level) const { return 1.0f - level / 256.0f; }
+    // offscreen passes must not be cut by the on-screen clip rect
+    void SetClipScissorEnabled(bool enabled);
     
     void SetContextLost(bool v) { mContextLost = v; }
     
@@ -215,8 +273,8 @@ public:
 
 
     API_EXPORT std::vector<float> &GetLineDash();
-    API_EXPORT std::vector<float> LineDash() const { return mCurrentState->mLineDash; }
-    API_EXPORT void SetLineDash(std::vector<float> lineDash) { mCurrentState->mLineDash = lineDash; }
+    API_EXPORT const std::vector<float> &LineDash() const;
+    API_EXPORT void SetLineDash(std::vector<float> lineDash);
     
     API_EXPORT float LineDashOffset() const { return mCurrentState->mLineDashOffset; }
     API_EXPORT void SetLineDashOffset(float offset) { mCurrentState->mLineDashOffset = offset; }
@@ -282,6 +340,11 @@ public:
                                 float dx, float dy, float dw, float dh,
                                 bool flipY = false);
     
+    // draw a texture in the ETC1 alpha split layout, w and h are the visible size
+    API_EXPORT void DrawAlphaSplitImage(float w, float h, int TextureId,
+                                        float sx, float sy, float sw, float sh,
+                                        float dx, float dy, float dw, float dh);
+
     API_EXPORT void PutImageData(const unsigned char *rgbaData,
                                  int tw, int th, int x, int y,
                                  int sx, int sy, int sw, int sh,
@@ -299,10 +362,18 @@ public:
 
     void ClipRegion();
     void ClipRegionNew(GFillRule rule = FILL_RULE_NONZERO);
+    void PushClipLayer(GPath &path, GFillRule rule);
+    void RebuildClipLayers(size_t base);
 
     void BeforeClip();
     void AfterClip();
 
+    void PopClipLayers(size_t depth);
+    bool ClipRectToScissor(const GRectf &rect, GClipLayer &layer);
+    void RestoreClipDepth(const GClipLayer &layer, int level);
+    void ApplyClipScissor(const GClipLayer *layer);
+    void ApplyClipState();
+
     API_EXPORT void FillText(const unsigned short *text, unsigned int text_length,
                              float x, float y, bool isStroke, float scaleWidth = 1.0);
 
@@ -314,6 +385,10 @@ public:
     //Dump
     long DrawCallCount();
     void ClearDrawCallCount();
+    const GVertexArrayCache &GetVertexArrayCache() const { return mVertexArrays; }
+    // before another context type draws, the 2d VAO would catch its pointers
+    void UnbindVertexArrays() { mVertexArrays.Unbind(); }
+    GFrameProfiler &GetFrameProfiler() { return mFrameProfiler; }
 
     //----------------Weex API------------------------
 #ifdef GCANVAS_WEEX
@@ -339,6 +414,12 @@ protected:
     DrawTextWithLength(const char *text, int strLength, float x, float y, bool isStroke = false, float maxWidth = SHRT_MAX);
 
     virtual GShader *FindShader(const char *name);
+
+    GShader *FindGradientShader(const char *name, const char *lookupName, GFillStyle *style);
+    void BindGradientLookup(const GGradientStops &stops);
+
+    bool UseSpriteBatch();
+    void FlushSpriteBatch(GLenum geometry_type);
     
     void FillRectBlur(float x, float y, float w, float h);
     void StrokeRectBlur(float x, float y, float w, float h);
@@ -398,17 +479,34 @@ public:
 protected:
     GPath mPath;
     std::vector<GCanvasState> mStateStack;
+    std::vector<GClipLayer> mClipStack;
     bool mHasClipRegion;
 
     GShader *mSaveShader;
     bool mSaveIsStroke;
 
     GVertex CanvasVertexBuffer[GCanvasContext::GCANVAS_VERTEX_BUFFER_SIZE];
+    GVertexArrayCache mVertexArrays;
     
     bool mIsGLInited = false;
     GFrameBufferObjectPool mFrameBufferPool;
     GTexture *mFontTexture = nullptr;
 
+    GShaderManager *mShaderManager = nullptr;
+    const void *mShareGroup = nullptr;
+    bool mHasShareGroup = false;
+
+    GGradientCache mGradientCache;
+    GLuint mGradientTexture = 0;
+    bool mGradientLookupEnabled = true;
+
+    GSpriteBatch mSpriteBatch;
+    GShader *mTextureShader = nullptr;   // sprites are only queued under it
+    SpriteShader *mSpriteShader = nullptr;
+    bool mSpriteBatchEnabled = true;
+
+    GFrameProfiler mFrameProfiler;
+
     bool mHiQuality;
 
 #ifdef GCANVAS_WEEX
@@ -21,15 +21,15 @@ GCanvasState::GCanvasState()
     mMiterLimit = 10;
     mLineDashOffset = 0;
     
-    mFont = nullptr; // delay-load: "10px sans-serif"
+    // mFont delay-load: "10px sans-serif"
     
     mTextAlign = TEXT_ALIGN_START;
     mTextBaseline = TEXT_BASELINE_ALPHABETIC;
     mTransform = GTransformIdentity;
-    mClipPath = nullptr;
+    mUserTransform = GTransformIdentity;
+    mClipDepth = 0;
+    mClipBase = 0;
     mShader = nullptr;
-    mFillStyle = nullptr;
-    mStrokeStyle = nullptr;
     
     mShadowColor = gcanvas::StrValueToColorRGBA("transparent");
     mShadowBlur = 0;
@@ -39,134 +39,3 @@ GCanvasState::GCanvasState()
     mscaleFontX = 1.0f;
     mscaleFontY = 1.0f;
 }
-
-GCanvasState::GCanvasState(const GCanvasState &state)
-{
-    mGlobalCompositeOp = state.mGlobalCompositeOp;
-    mFillColor.rgba = state.mFillColor.rgba;
-    mStrokeColor.rgba = state.mStrokeColor.rgba;
-    mGlobalAlpha = state.mGlobalAlpha;
-    mLineWidth = state.mLineWidth;
-    mLineCap = state.mLineCap;
-    mLineJoin = state.mLineJoin;
-    mMiterLimit = state.mMiterLimit;
-    mShader = state.mShader;
-    
-    mFillStyle = nullptr;
-    if (state.mFillStyle != nullptr)
-    {
-        mFillStyle = state.mFillStyle->Clone();
-    }
-    mStrokeStyle = nullptr;
-    if ( state.mStrokeStyle != nullptr )
-    {
-        mStrokeStyle = state.mStrokeStyle->Clone();
-    }
-    
-    if (state.mFont != nullptr)
-    {
-        mFont = new gcanvas::GFontStyle(*state.mFont);
-    }
-    else
-    {
-        mFont = nullptr;
-    }
-    
-    mTextAlign = state.mTextAlign;
-    mTextBaseline = state.mTextBaseline;
-    mTransform = state.mTransform;
-    
-    if (state.mClipPath != nullptr)
-    {
-        mClipPath = new GPath(*(state.mClipPath));
-    }
-    else
-    {
-        mClipPath = nullptr;
-    }
-    mTextureId = state.mTextureId;
-    
-    mShadowColor = state.mShadowColor;
-    mShadowBlur = state.mShadowBlur;
-    mShadowOffsetX = state.mShadowOffsetX;
-    mShadowOffsetY = state.mShadowOffsetY;
-
-    mscaleFontX = state.mscaleFontX;
-    mscaleFontY = state.mscaleFontY;
-}
-
-GCanvasState &GCanvasState::operator=(const GCanvasState &state)
-{
-    mGlobalCompositeOp = state.mGlobalCompositeOp;
-    mFillColor.rgba = state.mFillColor.rgba;
-    mStrokeColor.rgba = state.mStrokeColor.rgba;
-    mGlobalAlpha = state.mGlobalAlpha;
-    mLineWidth = state.mLineWidth;
-    mLineCap = state.mLineCap;
-    mLineJoin = state.mLineJoin;
-    mMiterLimit = state.mMiterLimit;
-    mShader = state.mShader;
-    
-    mFillStyle = nullptr;
-    if (state.mFillStyle != nullptr)
-    {
-        mFillStyle = state.mFillStyle->Clone();
-    }
-    mStrokeStyle = nullptr;
-    if (state.mStrokeStyle != nullptr)
-    {
-        mStrokeStyle = state.mStrokeStyle->Clone();
-    }
-    if (mFont != nullptr)
-    {
-        delete mFont;
-        mFont = nullptr;
-    }
-    
-    if (state.mFont != nullptr)
-    {
-        mFont = new gcanvas::GFontStyle(*state.mFont);
-    }
-    
-    
-    mTextAlign = state.mTextAlign;
-    mTextBaseline = state.mTextBaseline;
-    mTransform = state.mTransform;
-    
-    if (mClipPath != nullptr)
-    {
-        delete mClipPath;
-        mClipPath = nullptr;
-    }
-    
-    if (state.mClipPath != nullptr)
-    {
-        mClipPath = new GPath(*(state.mClipPath));
-    }
-    mShadowColor = state.mShadowColor;
-    mShadowBlur = state.mShadowBlur;
-    mShadowOffsetX = state.mShadowOffsetX;
-    mShadowOffsetY = state.mShadowOffsetY;
-
-    mscaleFontX = state.mscaleFontX;
-    mscaleFontY = state.mscaleFontY;
-    
-    return *this;
-}
-
-GCanvasState::~GCanvasState()
-{
-    if (mClipPath != nullptr)
-    {
-        delete mClipPath;
-    }
-    if (mFont != nullptr)
-    {
-        delete mFont;
-        mFont = nullptr;
-    }
-    if (mFillStyle != nullptr)
-    {
-        delete mFillStyle;
-    }
-}
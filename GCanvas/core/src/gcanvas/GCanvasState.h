@@ -16,34 +16,149 @@
 #include "GFillStyle.h"
 #include "GFontStyle.h"
 #include "GTextDefine.h"
-#include "GFontStyle.h"
 
 #include <stdio.h>
+#include <cstddef>
+#include <vector>
 
 const int InvalidateTextureId = -1;
 
+template <class T>
+inline T *GStateClone(T &obj)
+{
+    return new T(obj);
+}
+
+inline GFillStyle *GStateClone(GFillStyle &obj)
+{
+    return obj.Clone();
+}
+
+/**
+ * Reference counted handle for the heavy parts of GCanvasState.
+ *
+ * Save() copies the handle instead of the object, so a deep copy only
+ * happens when a shared object is modified through Mutable(). Setters
+ * replace the object by assigning a new one, which leaves saved states
+ * untouched. The count is not atomic: a state stack belongs to one
+ * context and one thread.
+ */
+template <class T>
+class GStateRef
+{
+public:
+    GStateRef() : mBlock(nullptr)
+    {
+    }
+
+    GStateRef(T *obj) : mBlock(obj != nullptr ? new Block(obj) : nullptr)
+    {
+    }
+
+    GStateRef(const GStateRef &other) : mBlock(other.mBlock)
+    {
+        if (mBlock != nullptr)
+        {
+            ++mBlock->refCount;
+        }
+    }
+
+    ~GStateRef()
+    {
+        Release();
+    }
+
+    GStateRef &operator=(const GStateRef &other)
+    {
+        if (other.mBlock != nullptr)
+        {
+            ++other.mBlock->refCount;
+        }
+        Release();
+        mBlock = other.mBlock;
+        return *this;
+    }
+
+    GStateRef &operator=(T *obj)
+    {
+        Release();
+        mBlock = (obj != nullptr) ? new Block(obj) : nullptr;
+        return *this;
+    }
+
+    T *Get() const { return mBlock != nullptr ? mBlock->obj : nullptr; }
+    T *operator->() const { return mBlock->obj; }
+    T &operator*() const { return *mBlock->obj; }
+
+    explicit operator bool() const { return mBlock != nullptr; }
+    bool operator==(std::nullptr_t) const { return mBlock == nullptr; }
+    bool operator!=(std::nullptr_t) const { return mBlock != nullptr; }
+
+    bool IsShared() const { return mBlock != nullptr && mBlock->refCount > 1; }
+
+    // detach from other states before writing in place
+    T *Mutable()
+    {
+        if (IsShared())
+        {
+            T *copy = GStateClone(*mBlock->obj);
+            --mBlock->refCount;
+            mBlock = (copy != nullptr) ? new Block(copy) : nullptr;
+        }
+        return Get();
+    }
+
+    void Reset()
+    {
+        Release();
+    }
+
+private:
+    struct Block
+    {
+        explicit Block(T *o) : obj(o), refCount(1) {}
+        T *obj;
+        int refCount;
+    };
+
+    void Release()
+    {
+        if (mBlock != nullptr && --mBlock->refCount == 0)
+        {
+            delete mBlock->obj;
+            delete mBlock;
+        }
+        mBlock = nullptr;
+    }
+
+    Block *mBlock;
+};
+
+/**
+ * Plain values are copied on Save(); styles, font and line dash are
+ * shared with the saved state until one of them is replaced.
+ */
 class GCanvasState
 {
 public:
     GCanvasState();
-    GCanvasState(const GCanvasState &state);
-    GCanvasState &operator=(const GCanvasState &state);
-    ~GCanvasState();
     
     //transfrom
     GTransform mTransform;
     GTransform mUserTransform;
     
-    //ClipPath
-    GPath *mClipPath;
+    //clip layers in effect, see GCanvasContext::mClipStack
+    int mClipDepth;
+    //layers below are suspended by resetClip() until the matching restore()
+    int mClipBase;
 
 
     //fill style,stroke style,shadow
     GColorRGBA mFillColor;
-    GFillStyle *mFillStyle;
+    GStateRef<GFillStyle> mFillStyle;
 
     GColorRGBA mStrokeColor;
-    GFillStyle *mStrokeStyle;
+    GStateRef<GFillStyle> mStrokeStyle;
 
     GColorRGBA mShadowColor;
     int mShadowBlur;
@@ -56,11 +171,11 @@ public:
     float mLineWidth;
     float mMiterLimit;
     
-    std::vector<float> mLineDash;
+    GStateRef<std::vector<float> > mLineDash;
     float mLineDashOffset;
     
     //font style
-    gcanvas::GFontStyle *mFont;
+    GStateRef<gcanvas::GFontStyle> mFont;
     GTextAlign mTextAlign;
     GTextBaseline mTextBaseline;
 
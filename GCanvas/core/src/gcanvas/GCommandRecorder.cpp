@@ -0,0 +1,172 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GCommandRecorder.h"
+#include "../support/Log.h"
+
+// a record larger than this is taken for a corrupt length
+static const uint32_t MAX_RECORD_BYTES = 256 * 1024 * 1024;
+
+GCommandRecorder::GCommandRecorder()
+        : mFile(nullptr), mRecording(false), mRecordCount(0)
+{
+}
+
+GCommandRecorder::~GCommandRecorder()
+{
+    Close();
+}
+
+bool GCommandRecorder::Open(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    mFile = fopen(path.c_str(), "wb");
+    if (mFile == nullptr)
+    {
+        LOG_W("GCommandRecorder: can not write %s", path.c_str());
+        mRecording.store(false, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t fileHeader[2] = {MAGIC, VERSION};
+    fwrite(fileHeader, sizeof(fileHeader), 1, mFile);
+    mRecordCount = 0;
+    mRecording.store(true, std::memory_order_relaxed);
+    LOG_I("GCommandRecorder: recording to %s", path.c_str());
+    return true;
+}
+
+void GCommandRecorder::Close()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRecording.store(false, std::memory_order_relaxed);
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+void GCommandRecorder::Record(int type, const int32_t *header, int headerCount,
+                              const void *data, size_t length)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFile == nullptr)
+    {
+        return;
+    }
+    if (data == nullptr)
+    {
+        length = 0;
+    }
+
+    uint32_t recordHeader[3] = {(uint32_t)type, (uint32_t)headerCount, (uint32_t)length};
+    bool ok = fwrite(recordHeader, sizeof(recordHeader), 1, mFile) == 1;
+    if (ok && headerCount > 0)
+    {
+        ok = fwrite(header, sizeof(int32_t), headerCount, mFile) == (size_t)headerCount;
+    }
+    if (ok && length > 0)
+    {
+        ok = fwrite(data, 1, length, mFile) == length;
+    }
+    if (!ok)
+    {
+        // a disk full capture stays readable up to the last whole record
+        LOG_W("GCommandRecorder: write failed, recording stopped");
+        fclose(mFile);
+        mFile = nullptr;
+        mRecording.store(false, std::memory_order_relaxed);
+        return;
+    }
+    ++mRecordCount;
+}
+
+
+GCaptureReader::GCaptureReader() : mFile(nullptr)
+{
+}
+
+GCaptureReader::~GCaptureReader()
+{
+    Close();
+}
+
+bool GCaptureReader::Open(const std::string &path)
+{
+    Close();
+    mFile = fopen(path.c_str(), "rb");
+    if (mFile == nullptr)
+    {
+        LOG_W("GCaptureReader: can not read %s", path.c_str());
+        return false;
+    }
+
+    uint32_t fileHeader[2] = {0, 0};
+    if (fread(fileHeader, sizeof(fileHeader), 1, mFile) != 1 ||
+        fileHeader[0] != GCommandRecorder::MAGIC ||
+        fileHeader[1] != GCommandRecorder::VERSION)
+    {
+        LOG_W("GCaptureReader: %s is not a capture of version %u", path.c_str(),
+              GCommandRecorder::VERSION);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void GCaptureReader::Close()
+{
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+bool GCaptureReader::Next(GCaptureRecord &record)
+{
+    if (mFile == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t recordHeader[3];
+    if (fread(recordHeader, sizeof(recordHeader), 1, mFile) != 1)
+    {
+        return false;
+    }
+    uint32_t headerCount = recordHeader[1];
+    uint32_t length = recordHeader[2];
+    if (headerCount > MAX_RECORD_BYTES / sizeof(int32_t) || length > MAX_RECORD_BYTES)
+    {
+        LOG_W("GCaptureReader: corrupt record of type %u", recordHeader[0]);
+        return false;
+    }
+
+    record.type = (int)recordHeader[0];
+    record.header.resize(headerCount);
+    record.data.resize(length);
+    if (headerCount > 0 &&
+        fread(&record.header[0], sizeof(int32_t), headerCount, mFile) != headerCount)
+    {
+        return false;
+    }
+    if (length > 0 && fread(&record.data[0], 1, length, mFile) != length)
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GCOMMANDRECORDER_H
+#define GCANVAS_GCOMMANDRECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Capture file of everything a canvas was fed: command streams, texture
+ * payloads and surface changes, in call order, so a real frame can be
+ * replayed without the host.
+ *
+ * Layout, all fields in the byte order of the recording device:
+ *   uint32 magic 'GCAP', uint32 version
+ *   records: uint32 type, uint32 header count, uint32 data length,
+ *            int32 header[count], data[length]
+ *
+ * Headers carry the integer arguments of a call, data its strings, floats
+ * or pixels; see GCaptureRecordType for each record.
+ */
+enum GCaptureRecordType
+{
+    CAPTURE_SURFACE = 1,          // header x, y, width, height
+    CAPTURE_CONTEXT_TYPE,         // header type
+    CAPTURE_DEVICE_PIXEL_RATIO,   // data float
+    CAPTURE_CLEAR_COLOR,          // data float r, g, b, a
+    CAPTURE_RENDER,               // data commands of Render()
+    CAPTURE_WEBGL,                // data commands sent to the WebGL proc
+    CAPTURE_WEBGL_BINARY,         // data binary WebGL stream
+    CAPTURE_PNG_TEXTURE,          // header group id, async; data png
+    CAPTURE_COMPRESSED_TEXTURE,   // header group id, alpha split; data ktx/pkm
+    CAPTURE_EXTERNAL_TEXTURE,     // header group id, width, height; no pixels
+    CAPTURE_REMOVE_TEXTURE,       // header group id
+    CAPTURE_BITMAP,               // header see GCaptureBitmapHeader; data pixels
+};
+
+// header fields of CAPTURE_BITMAP, the arguments of a BitmapCmd
+enum GCaptureBitmapHeader
+{
+    CAPTURE_BITMAP_SUB_IMAGE,     // 0 texImage2D of a new texture, 1 texSubImage2D
+    CAPTURE_BITMAP_ID,
+    CAPTURE_BITMAP_TARGET,
+    CAPTURE_BITMAP_LEVEL,
+    CAPTURE_BITMAP_INTERNAL_FORMAT,
+    CAPTURE_BITMAP_FORMAT,
+    CAPTURE_BITMAP_TYPE,
+    CAPTURE_BITMAP_WIDTH,
+    CAPTURE_BITMAP_HEIGHT,
+    CAPTURE_BITMAP_XOFFSET,
+    CAPTURE_BITMAP_YOFFSET,
+    CAPTURE_BITMAP_HEADER_COUNT
+};
+
+struct GCaptureRecord
+{
+    int type;
+    std::vector<int32_t> header;
+    std::vector<char> data;
+};
+
+/**
+ * Appends records to a capture file. Record() may be called from any
+ * thread and does nothing while no file is open, so callers only pay for
+ * the IsRecording() check.
+ */
+class GCommandRecorder
+{
+public:
+    static const uint32_t MAGIC = 0x50414347;   // "GCAP"
+    static const uint32_t VERSION = 1;
+
+    GCommandRecorder();
+
+    ~GCommandRecorder();
+
+    // truncates path, an open file is closed first
+    bool Open(const std::string &path);
+
+    void Close();
+
+    bool IsRecording() const { return mRecording.load(std::memory_order_relaxed); }
+
+    void Record(int type, const int32_t *header, int headerCount,
+                const void *data, size_t length);
+
+    void Record(int type, const void *data, size_t length)
+    {
+        Record(type, nullptr, 0, data, length);
+    }
+
+    unsigned long RecordCount() const { return mRecordCount; }
+
+private:
+    std::mutex mMutex;
+    FILE *mFile;
+    std::atomic<bool> mRecording;
+    unsigned long mRecordCount;
+};
+
+/**
+ * Reads a capture file back record by record.
+ */
+class GCaptureReader
+{
+public:
+    GCaptureReader();
+
+    ~GCaptureReader();
+
+    // false if the file is missing or not a capture of a known version
+    bool Open(const std::string &path);
+
+    void Close();
+
+    // false at the end of the file or on a truncated record
+    bool Next(GCaptureRecord &record);
+
+private:
+    FILE *mFile;
+};
+
+#endif /* GCANVAS_GCOMMANDRECORDER_H */
@@ -16,8 +16,9 @@
 
 namespace gcanvas {
     GColorRGBA StrValueToColorRGBA(const char *value) {
-        static std::map<std::string, GColorRGBA> colorMap;
-        if (colorMap.empty()) {
+        // built once, thread safe, canvases parse colors on several threads
+        static const std::map<std::string, GColorRGBA> colorMap = [] {
+            std::map<std::string, GColorRGBA> colorMap;
             colorMap.insert(std::pair<std::string, GColorRGBA>(
                     "black", {{0.0f / 255, 0.0f / 255, 0.0f / 255, 1.0f}}));
             colorMap.insert(std::pair<std::string, GColorRGBA>(
@@ -372,7 +373,8 @@ namespace gcanvas {
                     "transparent", {{0, 0, 0, 0.0f}}));
             colorMap.insert(std::pair<std::string, GColorRGBA>(
                     "transparent_white", {{1.f, 1.f, 1.f, 0.f}}));
-        }
+            return colorMap;
+        }();
 
         GColorRGBA c = {{0.0f, 0.0f, 0.0f, 1.0f}};
         if (value == nullptr) {
@@ -12,6 +12,26 @@
 
 #include "GConvert.h"
 
+#include <string.h>
+
+enum GRepeatMode
+{
+    REPEAT_MODE_NO_REPEAT,
+    REPEAT_MODE_REPEAT,
+    REPEAT_MODE_REPEAT_X,
+    REPEAT_MODE_REPEAT_Y
+};
+
+// parsed once when the pattern is created, unknown values fall back to no-repeat
+static inline GRepeatMode GRepeatModeFromString(const char *pattern)
+{
+    if (pattern == nullptr) return REPEAT_MODE_NO_REPEAT;
+    if (strcmp(pattern, "repeat") == 0) return REPEAT_MODE_REPEAT;
+    if (strcmp(pattern, "repeat-x") == 0) return REPEAT_MODE_REPEAT_X;
+    if (strcmp(pattern, "repeat-y") == 0) return REPEAT_MODE_REPEAT_Y;
+    return REPEAT_MODE_NO_REPEAT;
+}
+
 class GFillStyle
 {
 public:
@@ -44,19 +64,23 @@ class FillStylePattern : public GFillStyle
 {
 public:
     FillStylePattern(int texture_list_id, const std::string &pattern)
-        : GFillStyle(STYLE_PATTERN), mPattern(pattern), mTextureListId(texture_list_id)
+        : GFillStyle(STYLE_PATTERN), mPattern(pattern),
+          mRepeatMode(GRepeatModeFromString(pattern.c_str())), mTextureListId(texture_list_id),
+          mTextureWidth(0), mTextureHeight(0)
     {
     }
     
     FillStylePattern(int texture_list_id, short textureWidth, short textHeight, const std::string &pattern)
     : GFillStyle(STYLE_PATTERN),mTextureWidth(textureWidth), mTextureHeight(textHeight),
-    mPattern(pattern), mTextureListId(texture_list_id)
+    mPattern(pattern), mRepeatMode(GRepeatModeFromString(pattern.c_str())),
+    mTextureListId(texture_list_id)
     {
     }
 
     virtual ~FillStylePattern() { mPattern.clear(); }
 
     const std::string &GetPattern() const { return mPattern; }
+    GRepeatMode GetRepeatMode() const { return mRepeatMode; }
     int GetTextureListID() { return mTextureListId; }
     short GetTextureWidth() { return mTextureWidth; }
     short GetTextureHeight() { return mTextureHeight; }
@@ -66,11 +90,13 @@ public:
     {
         FillStylePattern *ptr =
             new FillStylePattern(mTextureListId, mPattern);
+        *ptr = *this;
         return ptr;
     }
 
 private:
     std::string mPattern;
+    GRepeatMode mRepeatMode;
     int mTextureListId;
     short mTextureWidth;
     short mTextureHeight;
@@ -7,6 +7,8 @@
  * the LICENSE file in the root directory of this source tree.
  */
 #include "GFrameBufferObject.h"
+#include "GGLStateCache.h"
+#include "GFrameProfiler.h"
 #include "../support/Log.h"
 #include <functional>
 #include "GConvert.h"
@@ -29,7 +31,7 @@ GFrameBufferObject::~GFrameBufferObject() {
  */
 void GFrameBufferObject::DeleteFBO() {
     if (mFboFrame) {
-        glDeleteFramebuffers(1, &mFboFrame);
+        GGLStateCache::Current()->DeleteFramebuffers(1, &mFboFrame);
         mFboFrame = 0;
     }
 
@@ -39,7 +41,7 @@ void GFrameBufferObject::DeleteFBO() {
     }
 
     GLuint textureId = mFboTexture.GetTextureID();
-    glDeleteTextures(1, &textureId);
+    GGLStateCache::Current()->DeleteTextures(1, &textureId);
     mFboTexture.Unbind();
 }
 
@@ -58,13 +60,14 @@ bool GFrameBufferObject::InitFBO(int width, int height, GColorRGBA color, bool e
 
 
     glGenFramebuffers(1, &mFboFrame);
+    GFRAME_COUNT(FRAME_COUNTER_FBO_ALLOCATIONS, 1);
     if (mFboFrame <= 0 && errVec) {
         GCanvasLog log;
         fillLogInfo(log, "gen_framebuffer_fail", "<function:%s, glGetError:%x>", __FUNCTION__, glGetError());
         errVec->push_back(log);
     }
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &mSaveFboFrame);
-    glBindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
+    mSaveFboFrame = (GLint) GGLStateCache::Current()->BoundFramebuffer();
+    GGLStateCache::Current()->BindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
 
     mFboTexture.SetWidth(width);
     mFboTexture.SetHeight(height);
@@ -148,8 +151,8 @@ void GFrameBufferObject::BindFBO() {
         return;
     }
 
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &mSaveFboFrame);
-    glBindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
+    mSaveFboFrame = (GLint) GGLStateCache::Current()->BoundFramebuffer();
+    GGLStateCache::Current()->BindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
 
     if (!mFboTexture.IsValidate()) {
         mFboTexture.CreateTexture(nullptr);
@@ -174,7 +177,7 @@ void GFrameBufferObject::UnbindFBO() {
         return;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, mSaveFboFrame);
+    GGLStateCache::Current()->BindFramebuffer(GL_FRAMEBUFFER, mSaveFboFrame);
 }
 
 int GFrameBufferObject::DetachTexture() {
@@ -0,0 +1,405 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GFrameProfiler.h"
+#include "../support/Log.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_EXT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE_EXT
+#define GL_QUERY_RESULT_AVAILABLE_EXT 0x8867
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+typedef void (*GGenQueriesFunc)(GLsizei n, GLuint *ids);
+typedef void (*GDeleteQueriesFunc)(GLsizei n, const GLuint *ids);
+typedef void (*GBeginQueryFunc)(GLenum target, GLuint id);
+typedef void (*GEndQueryFunc)(GLenum target);
+typedef void (*GGetQueryObjectuivFunc)(GLuint id, GLenum pname, GLuint *params);
+typedef void (*GGetQueryObjectui64vFunc)(GLuint id, GLenum pname, uint64_t *params);
+
+// GL_EXT_disjoint_timer_query entry points, the same for every context
+static GGenQueriesFunc sGenQueries = nullptr;
+static GDeleteQueriesFunc sDeleteQueries = nullptr;
+static GBeginQueryFunc sBeginQuery = nullptr;
+static GEndQueryFunc sEndQuery = nullptr;
+static GGetQueryObjectuivFunc sGetQueryObjectuiv = nullptr;
+static GGetQueryObjectui64vFunc sGetQueryObjectui64v = nullptr;
+
+thread_local GFrameProfiler *GFrameProfiler::sActive = nullptr;
+
+static uint64_t NowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+GFrameProfiler::GFrameProfiler()
+        : mRequestedEnabled(false), mEnabled(false), mInFrame(false), mPreviousActive(nullptr), mFrameNumber(0),
+          mFrameStartNs(0), mPhase(-1), mPhaseStartNs(0), mRing(DEFAULT_CAPACITY),
+          mRingNext(0), mRingCount(0), mTimerSupport(-1), mRunningQuery(-1)
+{
+    ResetCounters();
+    memset(mQueries, 0, sizeof(mQueries));
+}
+
+GFrameProfiler::~GFrameProfiler()
+{
+    if (sActive == this)
+    {
+        sActive = mInFrame ? mPreviousActive : nullptr;
+    }
+}
+
+void GFrameProfiler::SetCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    mRing.assign(capacity > 0 ? capacity : 1, GFrameStats());
+    mRingNext = 0;
+    mRingCount = 0;
+}
+
+size_t GFrameProfiler::Capacity() const
+{
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    return mRing.size();
+}
+
+void GFrameProfiler::ResetCounters()
+{
+    memset(mPhaseNs, 0, sizeof(mPhaseNs));
+    memset(mCounters, 0, sizeof(mCounters));
+}
+
+void GFrameProfiler::BeginFrame()
+{
+    if (mInFrame)
+    {
+        EndFrame();
+    }
+    mEnabled = mRequestedEnabled.load();
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    mInFrame = true;
+    mPreviousActive = sActive;
+    sActive = this;
+    ++mFrameNumber;
+    mFrameStartNs = NowNs();
+
+    CollectTimerQueries();
+    BeginTimerQuery();
+}
+
+void GFrameProfiler::EndFrame()
+{
+    if (!mInFrame)
+    {
+        return;
+    }
+    uint64_t now = NowNs();
+    if (mPhase >= 0)
+    {
+        // a phase left open is charged up to here
+        mPhaseNs[mPhase] += now - mPhaseStartNs;
+        mPhaseStartNs = now;
+    }
+    EndTimerQuery();
+
+    GFrameStats stats;
+    stats.frame = mFrameNumber;
+    stats.cpuMs = (now - mFrameStartNs) / 1000000.0;
+    stats.parseMs = mPhaseNs[FRAME_PHASE_PARSE] / 1000000.0;
+    stats.tessellationMs = mPhaseNs[FRAME_PHASE_TESSELLATE] / 1000000.0;
+    stats.glyphRasterMs = mPhaseNs[FRAME_PHASE_GLYPH_RASTER] / 1000000.0;
+    stats.textureUploadBytes = mCounters[FRAME_COUNTER_TEXTURE_UPLOAD_BYTES];
+    stats.flushCount = (uint32_t)mCounters[FRAME_COUNTER_FLUSHES];
+    stats.drawCalls = (uint32_t)mCounters[FRAME_COUNTER_DRAW_CALLS];
+    stats.fboAllocations = (uint32_t)mCounters[FRAME_COUNTER_FBO_ALLOCATIONS];
+    stats.vertexCount = mCounters[FRAME_COUNTER_VERTICES];
+    stats.gpuMs = -1;
+    {
+        std::lock_guard<std::mutex> lock(mRingMutex);
+        mRing[mRingNext] = stats;
+        mRingNext = (mRingNext + 1) % mRing.size();
+        if (mRingCount < mRing.size())
+        {
+            ++mRingCount;
+        }
+    }
+    ResetCounters();
+
+    mInFrame = false;
+    if (sActive == this)
+    {
+        sActive = mPreviousActive;
+    }
+    mPreviousActive = nullptr;
+}
+
+int GFrameProfiler::EnterPhase(int phase)
+{
+    int previous = mPhase;
+    uint64_t now = NowNs();
+    if (previous >= 0)
+    {
+        mPhaseNs[previous] += now - mPhaseStartNs;
+    }
+    mPhase = phase;
+    mPhaseStartNs = now;
+    return previous;
+}
+
+void GFrameProfiler::LeavePhase(int previous)
+{
+    uint64_t now = NowNs();
+    if (mPhase >= 0)
+    {
+        mPhaseNs[mPhase] += now - mPhaseStartNs;
+    }
+    mPhase = previous;
+    mPhaseStartNs = now;
+}
+
+size_t GFrameProfiler::GetFrames(std::vector<GFrameStats> &frames, size_t maxFrames) const
+{
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    size_t count = mRingCount;
+    if (maxFrames > 0 && maxFrames < count)
+    {
+        count = maxFrames;
+    }
+    frames.resize(count);
+    size_t start = (mRingNext + mRing.size() - count) % mRing.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        frames[i] = mRing[(start + i) % mRing.size()];
+    }
+    return count;
+}
+
+std::string GFrameProfiler::ToJson(size_t maxFrames) const
+{
+    std::vector<GFrameStats> frames;
+    GetFrames(frames, maxFrames);
+
+    std::string json = "{\"frames\":[";
+    char buffer[512];
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        const GFrameStats &f = frames[i];
+        char gpu[32];
+        if (f.gpuMs >= 0)
+        {
+            snprintf(gpu, sizeof(gpu), "%.3f", f.gpuMs);
+        }
+        else
+        {
+            snprintf(gpu, sizeof(gpu), "null");
+        }
+        snprintf(buffer, sizeof(buffer),
+                 "%s{\"frame\":%llu,\"cpuMs\":%.3f,\"parseMs\":%.3f,\"tessellationMs\":%.3f,"
+                 "\"glyphRasterMs\":%.3f,\"textureUploadBytes\":%llu,\"flushCount\":%u,"
+                 "\"drawCalls\":%u,\"fboAllocations\":%u,\"vertexCount\":%llu,\"gpuMs\":%s}",
+                 i > 0 ? "," : "", (unsigned long long)f.frame, f.cpuMs, f.parseMs,
+                 f.tessellationMs, f.glyphRasterMs, (unsigned long long)f.textureUploadBytes,
+                 f.flushCount, f.drawCalls, f.fboAllocations,
+                 (unsigned long long)f.vertexCount, gpu);
+        json += buffer;
+    }
+    json += "]}";
+    return json;
+}
+
+bool GFrameProfiler::IsTimerQuerySupported()
+{
+    if (mTimerSupport >= 0)
+    {
+        return mTimerSupport == 1;
+    }
+
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (extensions == nullptr)
+    {
+        // no current context, try again next time
+        return false;
+    }
+    mTimerSupport = 0;
+
+#if defined(ANDROID) || defined(__linux__)
+    if (strstr(extensions, "GL_EXT_disjoint_timer_query") != nullptr && sGetQueryObjectui64v == nullptr)
+    {
+        sGenQueries = (GGenQueriesFunc)eglGetProcAddress("glGenQueriesEXT");
+        sDeleteQueries = (GDeleteQueriesFunc)eglGetProcAddress("glDeleteQueriesEXT");
+        sBeginQuery = (GBeginQueryFunc)eglGetProcAddress("glBeginQueryEXT");
+        sEndQuery = (GEndQueryFunc)eglGetProcAddress("glEndQueryEXT");
+        sGetQueryObjectuiv = (GGetQueryObjectuivFunc)eglGetProcAddress("glGetQueryObjectuivEXT");
+        sGetQueryObjectui64v = (GGetQueryObjectui64vFunc)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    }
+#endif
+    // iOS has no timer queries, GPU time stays unknown there
+
+    if (strstr(extensions, "GL_EXT_disjoint_timer_query") == nullptr ||
+        sGenQueries == nullptr || sDeleteQueries == nullptr || sBeginQuery == nullptr ||
+        sEndQuery == nullptr || sGetQueryObjectuiv == nullptr || sGetQueryObjectui64v == nullptr)
+    {
+        LOG_I("GFrameProfiler: timer queries not supported, no GPU time");
+        return false;
+    }
+
+    GLuint names[MAX_PENDING_QUERIES];
+    sGenQueries(MAX_PENDING_QUERIES, names);
+    for (int i = 0; i < MAX_PENDING_QUERIES; ++i)
+    {
+        mQueries[i].name = names[i];
+        mQueries[i].pending = false;
+    }
+    // the disjoint flag is cleared by reading it
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    mTimerSupport = 1;
+    return true;
+}
+
+void GFrameProfiler::BeginTimerQuery()
+{
+    mRunningQuery = -1;
+    if (!IsTimerQuerySupported())
+    {
+        return;
+    }
+    for (int i = 0; i < MAX_PENDING_QUERIES; ++i)
+    {
+        if (!mQueries[i].pending)
+        {
+            sBeginQuery(GL_TIME_ELAPSED_EXT, mQueries[i].name);
+            mRunningQuery = i;
+            return;
+        }
+    }
+    // all in flight, this frame goes without GPU time
+}
+
+void GFrameProfiler::EndTimerQuery()
+{
+    if (mRunningQuery < 0)
+    {
+        return;
+    }
+    sEndQuery(GL_TIME_ELAPSED_EXT);
+    mQueries[mRunningQuery].frame = mFrameNumber;
+    mQueries[mRunningQuery].pending = true;
+    mRunningQuery = -1;
+}
+
+void GFrameProfiler::CollectTimerQueries()
+{
+    if (mTimerSupport != 1)
+    {
+        return;
+    }
+
+    bool any = false;
+    for (int i = 0; i < MAX_PENDING_QUERIES; ++i)
+    {
+        any = any || mQueries[i].pending;
+    }
+    if (!any)
+    {
+        return;
+    }
+
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    for (int i = 0; i < MAX_PENDING_QUERIES; ++i)
+    {
+        PendingQuery &query = mQueries[i];
+        if (!query.pending)
+        {
+            continue;
+        }
+        GLuint available = 0;
+        sGetQueryObjectuiv(query.name, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available && !disjoint)
+        {
+            continue;
+        }
+        query.pending = false;
+        if (disjoint)
+        {
+            // the GPU clock jumped, the result means nothing
+            continue;
+        }
+
+        uint64_t elapsedNs = 0;
+        sGetQueryObjectui64v(query.name, GL_QUERY_RESULT_EXT, &elapsedNs);
+
+        std::lock_guard<std::mutex> lock(mRingMutex);
+        for (size_t k = 0; k < mRingCount; ++k)
+        {
+            size_t index = (mRingNext + mRing.size() - 1 - k) % mRing.size();
+            if (mRing[index].frame == query.frame)
+            {
+                mRing[index].gpuMs = elapsedNs / 1000000.0;
+                break;
+            }
+        }
+    }
+}
+
+void GFrameProfiler::Release()
+{
+    if (mInFrame)
+    {
+        EndFrame();
+    }
+    if (mTimerSupport == 1)
+    {
+        GLuint names[MAX_PENDING_QUERIES];
+        for (int i = 0; i < MAX_PENDING_QUERIES; ++i)
+        {
+            names[i] = mQueries[i].name;
+            mQueries[i].pending = false;
+        }
+        sDeleteQueries(MAX_PENDING_QUERIES, names);
+    }
+    // a new context gets new queries
+    mTimerSupport = -1;
+}
+
+
+GFrameAttachScope::GFrameAttachScope(GFrameProfiler &profiler)
+        : mPrevious(GFrameProfiler::sActive), mAttached(false)
+{
+    if (profiler.IsEnabled() && mPrevious != &profiler)
+    {
+        GFrameProfiler::sActive = &profiler;
+        mAttached = true;
+    }
+}
+
+GFrameAttachScope::~GFrameAttachScope()
+{
+    if (mAttached)
+    {
+        GFrameProfiler::sActive = mPrevious;
+    }
+}
@@ -0,0 +1,234 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GFRAMEPROFILER_H
+#define GCANVAS_GFRAMEPROFILER_H
+
+#include "GGL.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// phases are timed exclusively, a nested phase pauses the outer one
+enum GFramePhase
+{
+    FRAME_PHASE_PARSE,          // command parsing and dispatch
+    FRAME_PHASE_TESSELLATE,     // curve flattening, stroke and fill geometry
+    FRAME_PHASE_GLYPH_RASTER,   // glyphs rendered into the glyph cache
+    FRAME_PHASE_COUNT
+};
+
+enum GFrameCounter
+{
+    FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+    FRAME_COUNTER_FLUSHES,        // vertex buffer submissions of the 2d pipeline
+    FRAME_COUNTER_DRAW_CALLS,     // glDraw* of 2d and WebGL
+    FRAME_COUNTER_FBO_ALLOCATIONS,
+    FRAME_COUNTER_VERTICES,
+    FRAME_COUNTER_COUNT
+};
+
+struct GFrameStats
+{
+    uint64_t frame;            // sequence number, from 1
+    double cpuMs;              // BeginFrame to EndFrame
+    double parseMs;
+    double tessellationMs;
+    double glyphRasterMs;
+    uint64_t textureUploadBytes;
+    uint32_t flushCount;
+    uint32_t drawCalls;
+    uint32_t fboAllocations;
+    uint64_t vertexCount;
+    double gpuMs;              // < 0 while pending or without timer queries
+};
+
+/**
+ * Per canvas frame statistics, the last Capacity() frames kept in a ring.
+ *
+ * Frames are bracketed on the GL thread with BeginFrame/EndFrame. While a
+ * profiler is active on a thread, code anywhere below it reports through
+ * GFRAME_PHASE and GFRAME_COUNT without knowing the canvas; work done
+ * between frames under a GFrameAttachScope is charged to the next frame.
+ * GPU time comes from GL_EXT_disjoint_timer_query and is filled in a few
+ * frames late, when the query result is available.
+ *
+ * Off until SetEnabled(true). SetEnabled(), GetFrames() and ToJson() may be
+ * called from any thread, a new setting takes effect at the next BeginFrame.
+ */
+class GFrameProfiler
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 120;
+
+    GFrameProfiler();
+
+    ~GFrameProfiler();
+
+    // the profiler reporting on this thread, nullptr if none
+    static GFrameProfiler *Active() { return sActive; }
+
+    void SetEnabled(bool enabled) { mRequestedEnabled.store(enabled); }
+
+    // the setting of the current or last frame, GL thread only
+    bool IsEnabled() const { return mEnabled; }
+
+    bool IsInFrame() const { return mInFrame; }
+
+    // drops the frames kept so far
+    void SetCapacity(size_t capacity);
+
+    size_t Capacity() const;
+
+    // needs the canvas' context current, ends an open frame first
+    void BeginFrame();
+
+    void EndFrame();
+
+    // returns the phase to hand back to LeavePhase
+    int EnterPhase(int phase);
+
+    void LeavePhase(int previous);
+
+    void Count(GFrameCounter counter, uint64_t value) { mCounters[counter] += value; }
+
+    // oldest first, at most maxFrames of the newest when > 0
+    size_t GetFrames(std::vector<GFrameStats> &frames, size_t maxFrames = 0) const;
+
+    // {"frames":[{...},...]} with the fields of GFrameStats, gpuMs null if unknown
+    std::string ToJson(size_t maxFrames = 0) const;
+
+    // deletes the queries, needs the context current
+    void Release();
+
+private:
+    friend class GFrameAttachScope;
+
+    static const int MAX_PENDING_QUERIES = 4;
+
+    struct PendingQuery
+    {
+        GLuint name;
+        uint64_t frame;
+        bool pending;
+    };
+
+    bool IsTimerQuerySupported();
+
+    void BeginTimerQuery();
+
+    void EndTimerQuery();
+
+    void CollectTimerQueries();
+
+    void ResetCounters();
+
+    static thread_local GFrameProfiler *sActive;
+
+    std::atomic<bool> mRequestedEnabled;
+    bool mEnabled;
+    bool mInFrame;
+    GFrameProfiler *mPreviousActive;
+    uint64_t mFrameNumber;
+    uint64_t mFrameStartNs;
+
+    int mPhase;   // -1 outside a phase
+    uint64_t mPhaseStartNs;
+    uint64_t mPhaseNs[FRAME_PHASE_COUNT];
+    uint64_t mCounters[FRAME_COUNTER_COUNT];
+
+    mutable std::mutex mRingMutex;
+    std::vector<GFrameStats> mRing;
+    size_t mRingNext;
+    size_t mRingCount;
+
+    int mTimerSupport;   // -1 unknown, 0 no, 1 yes
+    PendingQuery mQueries[MAX_PENDING_QUERIES];
+    int mRunningQuery;   // index into mQueries, -1 if none
+};
+
+// one frame of profiler, e.g. one Render call; inside a frame the host
+// opened it only adds to that frame
+class GFrameScope
+{
+public:
+    explicit GFrameScope(GFrameProfiler &profiler)
+            : mProfiler(profiler), mOwner(!profiler.IsInFrame())
+    {
+        if (mOwner)
+        {
+            mProfiler.BeginFrame();
+        }
+    }
+
+    ~GFrameScope()
+    {
+        if (mOwner)
+        {
+            mProfiler.EndFrame();
+        }
+    }
+
+private:
+    GFrameProfiler &mProfiler;
+    bool mOwner;
+};
+
+// reports of work outside a frame go to profiler, counted with the next frame
+class GFrameAttachScope
+{
+public:
+    explicit GFrameAttachScope(GFrameProfiler &profiler);
+
+    ~GFrameAttachScope();
+
+private:
+    GFrameProfiler *mPrevious;
+    bool mAttached;
+};
+
+class GFramePhaseScope
+{
+public:
+    explicit GFramePhaseScope(GFramePhase phase) : mProfiler(GFrameProfiler::Active())
+    {
+        if (mProfiler != nullptr)
+        {
+            mPrevious = mProfiler->EnterPhase(phase);
+        }
+    }
+
+    ~GFramePhaseScope()
+    {
+        if (mProfiler != nullptr)
+        {
+            mProfiler->LeavePhase(mPrevious);
+        }
+    }
+
+private:
+    GFrameProfiler *mProfiler;
+    int mPrevious = -1;
+};
+
+#define GFRAME_PHASE_CONCAT(a, b) a##b
+#define GFRAME_PHASE_NAME(line) GFRAME_PHASE_CONCAT(gFramePhaseScope, line)
+#define GFRAME_PHASE(phase) GFramePhaseScope GFRAME_PHASE_NAME(__LINE__)(phase)
+
+#define GFRAME_COUNT(counter, value)                                        \
+    do {                                                                    \
+        GFrameProfiler *gFrameProfiler = GFrameProfiler::Active();          \
+        if (gFrameProfiler != nullptr)                                      \
+            gFrameProfiler->Count((counter), (uint64_t)(value));            \
+    } while (0)
+
+#endif /* GCANVAS_GFRAMEPROFILER_H */
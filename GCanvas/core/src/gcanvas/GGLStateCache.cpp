@@ -0,0 +1,596 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GGLStateCache.h"
+#include "../support/Log.h"
+
+GGLStateCache::GGLStateCache()
+        : mKnown(0), mTextureKnown(0), mIssuedCount(0), mSkippedCount(0), mMismatchCount(0)
+{
+#ifdef GCANVAS_GL_STATE_VERIFY
+    mVerify = true;
+#else
+    mVerify = false;
+#endif
+}
+
+GGLStateCache *GGLStateCache::Current()
+{
+    static thread_local GGLStateCache cache;
+    return &cache;
+}
+
+void GGLStateCache::Invalidate()
+{
+    mKnown = 0;
+    mTextureKnown = 0;
+}
+
+void GGLStateCache::ResetCounters()
+{
+    mIssuedCount = 0;
+    mSkippedCount = 0;
+    mMismatchCount = 0;
+}
+
+bool GGLStateCache::Verify()
+{
+    bool ok = true;
+    for (int bit = 1; bit & KNOWN_ALL; bit <<= 1)
+    {
+        if ((mKnown & bit) && !Check(bit))
+        {
+            ok = false;
+        }
+    }
+    if ((mKnown & KNOWN_ACTIVE_TEXTURE) && ActiveUnit() >= 0 && ActiveUnit() < MAX_TEXTURE_UNITS &&
+        (mTextureKnown & (1u << ActiveUnit())) && !Check(KNOWN_TEXTURE))
+    {
+        ok = false;
+    }
+    return ok;
+}
+
+bool GGLStateCache::Skip(int bit)
+{
+    if (mVerify && !Check(bit))
+    {
+        return false;
+    }
+    ++mSkippedCount;
+    return true;
+}
+
+void GGLStateCache::Issued(int bit)
+{
+    mKnown |= bit;
+    ++mIssuedCount;
+}
+
+int GGLStateCache::ActiveUnit() const
+{
+    return (int)(mActiveTexture - GL_TEXTURE0);
+}
+
+bool GGLStateCache::Check(int bit)
+{
+    GLint v[4] = {0, 0, 0, 0};
+    GLboolean b[4] = {GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE};
+    GLfloat f[2] = {0, 0};
+    bool same = true;
+    const char *name = "";
+
+    switch (bit)
+    {
+        case KNOWN_PROGRAM:
+            name = "program";
+            glGetIntegerv(GL_CURRENT_PROGRAM, v);
+            same = (GLuint)v[0] == mProgram;
+            break;
+        case KNOWN_ACTIVE_TEXTURE:
+            name = "active texture";
+            glGetIntegerv(GL_ACTIVE_TEXTURE, v);
+            same = (GLenum)v[0] == mActiveTexture;
+            break;
+        case KNOWN_TEXTURE:
+            name = "texture binding";
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, v);
+            same = (GLuint)v[0] == mTextures[ActiveUnit()];
+            break;
+        case KNOWN_FRAMEBUFFER:
+            name = "framebuffer";
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, v);
+            same = (GLuint)v[0] == mFramebuffer;
+            break;
+        case KNOWN_BLEND_FUNC:
+            name = "blend func";
+            glGetIntegerv(GL_BLEND_SRC_RGB, &v[0]);
+            glGetIntegerv(GL_BLEND_DST_RGB, &v[1]);
+            glGetIntegerv(GL_BLEND_SRC_ALPHA, &v[2]);
+            glGetIntegerv(GL_BLEND_DST_ALPHA, &v[3]);
+            for (int i = 0; i < 4; ++i) same = same && (GLenum)v[i] == mBlendFunc[i];
+            break;
+        case KNOWN_DEPTH_FUNC:
+            name = "depth func";
+            glGetIntegerv(GL_DEPTH_FUNC, v);
+            same = (GLenum)v[0] == mDepthFunc;
+            break;
+        case KNOWN_DEPTH_MASK:
+            name = "depth mask";
+            glGetBooleanv(GL_DEPTH_WRITEMASK, b);
+            same = b[0] == mDepthMask;
+            break;
+        case KNOWN_DEPTH_RANGE:
+            name = "depth range";
+            glGetFloatv(GL_DEPTH_RANGE, f);
+            same = f[0] == mDepthRange[0] && f[1] == mDepthRange[1];
+            break;
+        case KNOWN_STENCIL_FUNC:
+            name = "stencil func";
+            glGetIntegerv(GL_STENCIL_FUNC, &v[0]);
+            glGetIntegerv(GL_STENCIL_REF, &v[1]);
+            glGetIntegerv(GL_STENCIL_VALUE_MASK, &v[2]);
+            same = (GLenum)v[0] == mStencilFunc && v[1] == mStencilRef &&
+                   (GLuint)v[2] == mStencilValueMask;
+            break;
+        case KNOWN_STENCIL_OP_FRONT:
+            name = "stencil op";
+            glGetIntegerv(GL_STENCIL_FAIL, &v[0]);
+            glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &v[1]);
+            glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &v[2]);
+            for (int i = 0; i < 3; ++i) same = same && (GLenum)v[i] == mStencilOpFront[i];
+            break;
+        case KNOWN_STENCIL_OP_BACK:
+            name = "stencil back op";
+            glGetIntegerv(GL_STENCIL_BACK_FAIL, &v[0]);
+            glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_FAIL, &v[1]);
+            glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_PASS, &v[2]);
+            for (int i = 0; i < 3; ++i) same = same && (GLenum)v[i] == mStencilOpBack[i];
+            break;
+        case KNOWN_STENCIL_MASK:
+            name = "stencil mask";
+            glGetIntegerv(GL_STENCIL_WRITEMASK, v);
+            same = (GLuint)v[0] == mStencilMask;
+            break;
+        case KNOWN_COLOR_MASK:
+            name = "color mask";
+            glGetBooleanv(GL_COLOR_WRITEMASK, b);
+            for (int i = 0; i < 4; ++i) same = same && b[i] == mColorMask[i];
+            break;
+        case KNOWN_SCISSOR:
+            name = "scissor box";
+            glGetIntegerv(GL_SCISSOR_BOX, v);
+            for (int i = 0; i < 4; ++i) same = same && v[i] == mScissor[i];
+            break;
+        case KNOWN_VIEWPORT:
+            name = "viewport";
+            glGetIntegerv(GL_VIEWPORT, v);
+            for (int i = 0; i < 4; ++i) same = same && v[i] == mViewport[i];
+            break;
+        case KNOWN_BLEND:
+            name = "GL_BLEND";
+            same = (glIsEnabled(GL_BLEND) == GL_TRUE) == mBlend;
+            break;
+        case KNOWN_DEPTH_TEST:
+            name = "GL_DEPTH_TEST";
+            same = (glIsEnabled(GL_DEPTH_TEST) == GL_TRUE) == mDepthTest;
+            break;
+        case KNOWN_STENCIL_TEST:
+            name = "GL_STENCIL_TEST";
+            same = (glIsEnabled(GL_STENCIL_TEST) == GL_TRUE) == mStencilTest;
+            break;
+        case KNOWN_SCISSOR_TEST:
+            name = "GL_SCISSOR_TEST";
+            same = (glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE) == mScissorTest;
+            break;
+        default:
+            break;
+    }
+
+    if (!same)
+    {
+        ++mMismatchCount;
+        LOG_W("GGLStateCache: cached %s differs from GL, something bypassed the cache", name);
+        if (bit == KNOWN_TEXTURE)
+        {
+            mTextureKnown &= ~(1u << ActiveUnit());
+        }
+        else
+        {
+            mKnown &= ~bit;
+        }
+    }
+    return same;
+}
+
+void GGLStateCache::UseProgram(GLuint program)
+{
+    if ((mKnown & KNOWN_PROGRAM) && mProgram == program && Skip(KNOWN_PROGRAM))
+    {
+        return;
+    }
+    glUseProgram(program);
+    mProgram = program;
+    Issued(KNOWN_PROGRAM);
+}
+
+GLuint GGLStateCache::BoundProgram()
+{
+    if (!(mKnown & KNOWN_PROGRAM))
+    {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        mProgram = (GLuint)program;
+        mKnown |= KNOWN_PROGRAM;
+    }
+    return mProgram;
+}
+
+void GGLStateCache::ActiveTexture(GLenum unit)
+{
+    if ((mKnown & KNOWN_ACTIVE_TEXTURE) && mActiveTexture == unit && Skip(KNOWN_ACTIVE_TEXTURE))
+    {
+        return;
+    }
+    glActiveTexture(unit);
+    mActiveTexture = unit;
+    Issued(KNOWN_ACTIVE_TEXTURE);
+}
+
+void GGLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+    if (target != GL_TEXTURE_2D)
+    {
+        glBindTexture(target, texture);
+        ++mIssuedCount;
+        return;
+    }
+
+    if (!(mKnown & KNOWN_ACTIVE_TEXTURE))
+    {
+        GLint unit = GL_TEXTURE0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+        mActiveTexture = (GLenum)unit;
+        mKnown |= KNOWN_ACTIVE_TEXTURE;
+    }
+
+    int index = ActiveUnit();
+    if (index < 0 || index >= MAX_TEXTURE_UNITS)
+    {
+        glBindTexture(target, texture);
+        ++mIssuedCount;
+        return;
+    }
+
+    unsigned int unitBit = 1u << index;
+    if ((mTextureKnown & unitBit) && mTextures[index] == texture)
+    {
+        if (!mVerify || Check(KNOWN_TEXTURE))
+        {
+            ++mSkippedCount;
+            return;
+        }
+    }
+    glBindTexture(target, texture);
+    mTextures[index] = texture;
+    mTextureKnown |= unitBit;
+    ++mIssuedCount;
+}
+
+GLuint GGLStateCache::BoundTexture()
+{
+    if ((mKnown & KNOWN_ACTIVE_TEXTURE))
+    {
+        int index = ActiveUnit();
+        if (index >= 0 && index < MAX_TEXTURE_UNITS && (mTextureKnown & (1u << index)))
+        {
+            return mTextures[index];
+        }
+    }
+    GLint texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    return (GLuint)texture;
+}
+
+void GGLStateCache::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    if ((mKnown & KNOWN_FRAMEBUFFER) && mFramebuffer == framebuffer && Skip(KNOWN_FRAMEBUFFER))
+    {
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    mFramebuffer = framebuffer;
+    Issued(KNOWN_FRAMEBUFFER);
+}
+
+GLuint GGLStateCache::BoundFramebuffer()
+{
+    if (!(mKnown & KNOWN_FRAMEBUFFER))
+    {
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        mFramebuffer = (GLuint)framebuffer;
+        mKnown |= KNOWN_FRAMEBUFFER;
+    }
+    return mFramebuffer;
+}
+
+void GGLStateCache::DeleteTextures(GLsizei n, const GLuint *textures)
+{
+    glDeleteTextures(n, textures);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        for (int unit = 0; unit < MAX_TEXTURE_UNITS; ++unit)
+        {
+            if ((mTextureKnown & (1u << unit)) && mTextures[unit] == textures[i])
+            {
+                mTextures[unit] = 0;
+            }
+        }
+    }
+}
+
+void GGLStateCache::DeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+    glDeleteFramebuffers(n, framebuffers);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if ((mKnown & KNOWN_FRAMEBUFFER) && mFramebuffer == framebuffers[i])
+        {
+            mFramebuffer = 0;
+        }
+    }
+}
+
+void GGLStateCache::DeleteProgram(GLuint program)
+{
+    glDeleteProgram(program);
+    if ((mKnown & KNOWN_PROGRAM) && mProgram == program)
+    {
+        // stays current until another program is used, forget it so the
+        // name is rebound once GL hands it out again
+        mKnown &= ~KNOWN_PROGRAM;
+    }
+}
+
+int GGLStateCache::CapabilityBit(GLenum cap) const
+{
+    switch (cap)
+    {
+        case GL_BLEND:
+            return KNOWN_BLEND;
+        case GL_DEPTH_TEST:
+            return KNOWN_DEPTH_TEST;
+        case GL_STENCIL_TEST:
+            return KNOWN_STENCIL_TEST;
+        case GL_SCISSOR_TEST:
+            return KNOWN_SCISSOR_TEST;
+        default:
+            return 0;
+    }
+}
+
+void GGLStateCache::SetCapability(GLenum cap, bool enabled)
+{
+    int bit = CapabilityBit(cap);
+    bool *value = nullptr;
+    switch (bit)
+    {
+        case KNOWN_BLEND:
+            value = &mBlend;
+            break;
+        case KNOWN_DEPTH_TEST:
+            value = &mDepthTest;
+            break;
+        case KNOWN_STENCIL_TEST:
+            value = &mStencilTest;
+            break;
+        case KNOWN_SCISSOR_TEST:
+            value = &mScissorTest;
+            break;
+        default:
+            break;
+    }
+
+    if (value != nullptr && (mKnown & bit) && *value == enabled && Skip(bit))
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(cap);
+    }
+    else
+    {
+        glDisable(cap);
+    }
+
+    if (value != nullptr)
+    {
+        *value = enabled;
+        Issued(bit);
+    }
+    else
+    {
+        ++mIssuedCount;
+    }
+}
+
+void GGLStateCache::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha,
+                                      GLenum dstAlpha)
+{
+    if ((mKnown & KNOWN_BLEND_FUNC) && mBlendFunc[0] == srcRGB && mBlendFunc[1] == dstRGB &&
+        mBlendFunc[2] == srcAlpha && mBlendFunc[3] == dstAlpha && Skip(KNOWN_BLEND_FUNC))
+    {
+        return;
+    }
+    glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    mBlendFunc[0] = srcRGB;
+    mBlendFunc[1] = dstRGB;
+    mBlendFunc[2] = srcAlpha;
+    mBlendFunc[3] = dstAlpha;
+    Issued(KNOWN_BLEND_FUNC);
+}
+
+void GGLStateCache::DepthFunc(GLenum func)
+{
+    if ((mKnown & KNOWN_DEPTH_FUNC) && mDepthFunc == func && Skip(KNOWN_DEPTH_FUNC))
+    {
+        return;
+    }
+    glDepthFunc(func);
+    mDepthFunc = func;
+    Issued(KNOWN_DEPTH_FUNC);
+}
+
+void GGLStateCache::DepthMask(GLboolean flag)
+{
+    if ((mKnown & KNOWN_DEPTH_MASK) && mDepthMask == flag && Skip(KNOWN_DEPTH_MASK))
+    {
+        return;
+    }
+    glDepthMask(flag);
+    mDepthMask = flag;
+    Issued(KNOWN_DEPTH_MASK);
+}
+
+void GGLStateCache::DepthRange(GLfloat zNear, GLfloat zFar)
+{
+    if ((mKnown & KNOWN_DEPTH_RANGE) && mDepthRange[0] == zNear && mDepthRange[1] == zFar &&
+        Skip(KNOWN_DEPTH_RANGE))
+    {
+        return;
+    }
+    glDepthRangef(zNear, zFar);
+    mDepthRange[0] = zNear;
+    mDepthRange[1] = zFar;
+    Issued(KNOWN_DEPTH_RANGE);
+}
+
+void GGLStateCache::StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    if ((mKnown & KNOWN_STENCIL_FUNC) && mStencilFunc == func && mStencilRef == ref &&
+        mStencilValueMask == mask && Skip(KNOWN_STENCIL_FUNC))
+    {
+        return;
+    }
+    glStencilFunc(func, ref, mask);
+    mStencilFunc = func;
+    mStencilRef = ref;
+    mStencilValueMask = mask;
+    Issued(KNOWN_STENCIL_FUNC);
+}
+
+void GGLStateCache::StencilOp(GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+    const int both = KNOWN_STENCIL_OP_FRONT | KNOWN_STENCIL_OP_BACK;
+    if ((mKnown & both) == both &&
+        mStencilOpFront[0] == sfail && mStencilOpFront[1] == dpfail && mStencilOpFront[2] == dppass &&
+        mStencilOpBack[0] == sfail && mStencilOpBack[1] == dpfail && mStencilOpBack[2] == dppass &&
+        Skip(KNOWN_STENCIL_OP_FRONT) && (!mVerify || Check(KNOWN_STENCIL_OP_BACK)))
+    {
+        return;
+    }
+    glStencilOp(sfail, dpfail, dppass);
+    mStencilOpFront[0] = mStencilOpBack[0] = sfail;
+    mStencilOpFront[1] = mStencilOpBack[1] = dpfail;
+    mStencilOpFront[2] = mStencilOpBack[2] = dppass;
+    Issued(both);
+}
+
+void GGLStateCache::StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+    if (face == GL_FRONT_AND_BACK)
+    {
+        StencilOp(sfail, dpfail, dppass);
+        return;
+    }
+
+    int bit = (face == GL_FRONT) ? KNOWN_STENCIL_OP_FRONT : KNOWN_STENCIL_OP_BACK;
+    GLenum *op = (face == GL_FRONT) ? mStencilOpFront : mStencilOpBack;
+    if ((mKnown & bit) && op[0] == sfail && op[1] == dpfail && op[2] == dppass && Skip(bit))
+    {
+        return;
+    }
+    glStencilOpSeparate(face, sfail, dpfail, dppass);
+    op[0] = sfail;
+    op[1] = dpfail;
+    op[2] = dppass;
+    Issued(bit);
+}
+
+void GGLStateCache::StencilMask(GLuint mask)
+{
+    if ((mKnown & KNOWN_STENCIL_MASK) && mStencilMask == mask && Skip(KNOWN_STENCIL_MASK))
+    {
+        return;
+    }
+    glStencilMask(mask);
+    mStencilMask = mask;
+    Issued(KNOWN_STENCIL_MASK);
+}
+
+void GGLStateCache::ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+{
+    if ((mKnown & KNOWN_COLOR_MASK) && mColorMask[0] == r && mColorMask[1] == g &&
+        mColorMask[2] == b && mColorMask[3] == a && Skip(KNOWN_COLOR_MASK))
+    {
+        return;
+    }
+    glColorMask(r, g, b, a);
+    mColorMask[0] = r;
+    mColorMask[1] = g;
+    mColorMask[2] = b;
+    mColorMask[3] = a;
+    Issued(KNOWN_COLOR_MASK);
+}
+
+void GGLStateCache::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if ((mKnown & KNOWN_SCISSOR) && mScissor[0] == x && mScissor[1] == y &&
+        mScissor[2] == width && mScissor[3] == height && Skip(KNOWN_SCISSOR))
+    {
+        return;
+    }
+    glScissor(x, y, width, height);
+    mScissor[0] = x;
+    mScissor[1] = y;
+    mScissor[2] = width;
+    mScissor[3] = height;
+    Issued(KNOWN_SCISSOR);
+}
+
+void GGLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if ((mKnown & KNOWN_VIEWPORT) && mViewport[0] == x && mViewport[1] == y &&
+        mViewport[2] == width && mViewport[3] == height && Skip(KNOWN_VIEWPORT))
+    {
+        return;
+    }
+    glViewport(x, y, width, height);
+    mViewport[0] = x;
+    mViewport[1] = y;
+    mViewport[2] = width;
+    mViewport[3] = height;
+    Issued(KNOWN_VIEWPORT);
+}
+
+void GGLStateCache::GetViewport(GLint viewport[4])
+{
+    if (!(mKnown & KNOWN_VIEWPORT))
+    {
+        glGetIntegerv(GL_VIEWPORT, mViewport);
+        mKnown |= KNOWN_VIEWPORT;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        viewport[i] = mViewport[i];
+    }
+}
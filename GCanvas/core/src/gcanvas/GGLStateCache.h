@@ -0,0 +1,178 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GGLSTATECACHE_H
+#define GCANVAS_GGLSTATECACHE_H
+
+#include "GGL.h"
+
+/**
+ * Shadow copy of the GL state the 2d pipeline toggles per draw. Setters
+ * only reach GL when the value differs from the last one issued, and the
+ * texture/framebuffer getters answer without a glGet round trip.
+ *
+ * GL state is per context and a context is current on one thread, so
+ * there is one cache per thread. Code that makes another context current
+ * on the thread, or that drives GL directly (WebGL), must call
+ * Invalidate() afterwards.
+ *
+ * With verify enabled (GCANVAS_GL_STATE_VERIFY, or SetVerifyEnabled) every
+ * skipped call is checked against glGet first; a mismatch is logged,
+ * counted and the call is issued.
+ */
+class GGLStateCache
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 8;
+
+    GGLStateCache();
+
+    static GGLStateCache *Current();
+
+    void Invalidate();
+
+    void SetVerifyEnabled(bool enabled) { mVerify = enabled; }
+
+    bool IsVerifyEnabled() const { return mVerify; }
+
+    // check every known entry against GL, false if any differed
+    bool Verify();
+
+    void UseProgram(GLuint program);
+
+    GLuint BoundProgram();
+
+    void ActiveTexture(GLenum unit);
+
+    void BindTexture(GLenum target, GLuint texture);
+
+    GLuint BoundTexture();
+
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+    GLuint BoundFramebuffer();
+
+    // deleting a bound object rebinds 0 and frees the name for reuse
+    void DeleteTextures(GLsizei n, const GLuint *textures);
+
+    void DeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+
+    void DeleteProgram(GLuint program);
+
+    void Enable(GLenum cap) { SetCapability(cap, true); }
+
+    void Disable(GLenum cap) { SetCapability(cap, false); }
+
+    void BlendFunc(GLenum src, GLenum dst) { BlendFuncSeparate(src, dst, src, dst); }
+
+    void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+
+    void DepthFunc(GLenum func);
+
+    void DepthMask(GLboolean flag);
+
+    void DepthRange(GLfloat zNear, GLfloat zFar);
+
+    void StencilFunc(GLenum func, GLint ref, GLuint mask);
+
+    void StencilOp(GLenum sfail, GLenum dpfail, GLenum dppass);
+
+    void StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+
+    void StencilMask(GLuint mask);
+
+    void ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+
+    void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // x, y, width, height; asks GL only while unknown
+    void GetViewport(GLint viewport[4]);
+
+    // uniform uploads are cached by the shaders, they only report here
+    void CountUniform(bool issued) { issued ? ++mIssuedCount : ++mSkippedCount; }
+
+    unsigned long IssuedCount() const { return mIssuedCount; }
+
+    unsigned long SkippedCount() const { return mSkippedCount; }
+
+    unsigned long MismatchCount() const { return mMismatchCount; }
+
+    void ResetCounters();
+
+private:
+    enum
+    {
+        KNOWN_PROGRAM = 1 << 0,
+        KNOWN_ACTIVE_TEXTURE = 1 << 1,
+        KNOWN_FRAMEBUFFER = 1 << 2,
+        KNOWN_BLEND_FUNC = 1 << 3,
+        KNOWN_DEPTH_FUNC = 1 << 4,
+        KNOWN_DEPTH_MASK = 1 << 5,
+        KNOWN_DEPTH_RANGE = 1 << 6,
+        KNOWN_STENCIL_FUNC = 1 << 7,
+        KNOWN_STENCIL_OP_FRONT = 1 << 8,
+        KNOWN_STENCIL_OP_BACK = 1 << 9,
+        KNOWN_STENCIL_MASK = 1 << 10,
+        KNOWN_COLOR_MASK = 1 << 11,
+        KNOWN_SCISSOR = 1 << 12,
+        KNOWN_BLEND = 1 << 13,
+        KNOWN_DEPTH_TEST = 1 << 14,
+        KNOWN_STENCIL_TEST = 1 << 15,
+        KNOWN_SCISSOR_TEST = 1 << 16,
+        KNOWN_TEXTURE = 1 << 17,    // texture of the active unit, see mTextureKnown
+        KNOWN_VIEWPORT = 1 << 18,
+        KNOWN_ALL = (1 << 19) - 1
+    };
+
+    void SetCapability(GLenum cap, bool enabled);
+
+    int CapabilityBit(GLenum cap) const;
+
+    // true when the cached value may be trusted for a skip
+    bool Skip(int bit);
+
+    bool Check(int bit);
+
+    void Issued(int bit);
+
+    int ActiveUnit() const;
+
+    unsigned int mKnown;
+    unsigned int mTextureKnown;
+    bool mVerify;
+
+    GLuint mProgram;
+    GLenum mActiveTexture;
+    GLuint mTextures[MAX_TEXTURE_UNITS];
+    GLuint mFramebuffer;
+    GLenum mBlendFunc[4];
+    GLenum mDepthFunc;
+    GLboolean mDepthMask;
+    GLfloat mDepthRange[2];
+    GLenum mStencilFunc;
+    GLint mStencilRef;
+    GLuint mStencilValueMask;
+    GLenum mStencilOpFront[3];
+    GLenum mStencilOpBack[3];
+    GLuint mStencilMask;
+    GLboolean mColorMask[4];
+    GLint mScissor[4];
+    GLint mViewport[4];
+    bool mBlend;
+    bool mDepthTest;
+    bool mStencilTest;
+    bool mScissorTest;
+
+    unsigned long mIssuedCount;
+    unsigned long mSkippedCount;
+    unsigned long mMismatchCount;
+};
+
+#endif /* GCANVAS_GGLSTATECACHE_H */
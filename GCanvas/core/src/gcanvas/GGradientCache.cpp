@@ -0,0 +1,171 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GGradientCache.h"
+#include "GFrameProfiler.h"
+#include "GGLStateCache.h"
+#include "../support/Log.h"
+
+#include <string.h>
+
+GGradientCache::GGradientCache() : mUseCounter(0)
+{
+}
+
+GGradientCache::~GGradientCache()
+{
+    Clear();
+}
+
+uint32_t GGradientCache::Hash(const GGradientStops &stops)
+{
+    // FNV-1a over the used part of the stop list
+    uint32_t hash = 2166136261u;
+    int count = stops.count < GGRADIENT_MAX_STOPS ? stops.count : GGRADIENT_MAX_STOPS;
+    const unsigned char *p = (const unsigned char *)&count;
+    for (size_t i = 0; i < sizeof(count); ++i)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    p = (const unsigned char *)stops.pos;
+    for (size_t i = 0; i < count * sizeof(float); ++i)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    p = (const unsigned char *)stops.color;
+    for (size_t i = 0; i < count * sizeof(GColorRGBA); ++i)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool GGradientCache::SameStops(const GGradientStops &a, const GGradientStops &b)
+{
+    return a.count == b.count &&
+           memcmp(a.pos, b.pos, a.count * sizeof(float)) == 0 &&
+           memcmp(a.color, b.color, a.count * sizeof(GColorRGBA)) == 0;
+}
+
+GLuint GGradientCache::Find(const GGradientStops &stops)
+{
+    uint32_t hash = Hash(stops);
+    for (size_t i = 0; i < mEntries.size(); ++i)
+    {
+        Entry &entry = mEntries[i];
+        if (entry.hash == hash && SameStops(entry.stops, stops))
+        {
+            entry.lastUse = ++mUseCounter;
+            return entry.texture;
+        }
+    }
+    return 0;
+}
+
+static unsigned char ColorComponentToByte(float value)
+{
+    if (value <= 0) return 0;
+    if (value >= 1) return 255;
+    return (unsigned char)(value * 255 + 0.5f);
+}
+
+void GGradientCache::Bake(const GGradientStops &stops, unsigned char *pixels)
+{
+    int count = stops.count < GGRADIENT_MAX_STOPS ? stops.count : GGRADIENT_MAX_STOPS;
+    for (int i = 0; i < LOOKUP_WIDTH; ++i)
+    {
+        float t = (float)i / (LOOKUP_WIDTH - 1);
+        GColorRGBA c = {{0, 0, 0, 0}};
+        if (count > 0)
+        {
+            if (t <= stops.pos[0])
+            {
+                c = stops.color[0];
+            }
+            else if (t >= stops.pos[count - 1])
+            {
+                c = stops.color[count - 1];
+            }
+            else
+            {
+                int k = 0;
+                while (k < count - 2 && t > stops.pos[k + 1])
+                {
+                    ++k;
+                }
+                float w = stops.pos[k + 1] - stops.pos[k];
+                float f = w > 0 ? (t - stops.pos[k]) / w : 1;
+                for (int j = 0; j < 4; ++j)
+                {
+                    c.components[j] = stops.color[k].components[j] * (1 - f) +
+                                      stops.color[k + 1].components[j] * f;
+                }
+            }
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            pixels[i * 4 + j] = ColorComponentToByte(c.components[j]);
+        }
+    }
+}
+
+GLuint GGradientCache::Upload(const GGradientStops &stops)
+{
+    unsigned char pixels[LOOKUP_WIDTH * 4];
+    Bake(stops, pixels);
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    if (texture == 0)
+    {
+        LOG_W("GGradientCache::Upload glGenTextures failed");
+        return 0;
+    }
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, LOOKUP_WIDTH, 1, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, pixels);
+    GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, LOOKUP_WIDTH * 4);
+
+    Entry entry;
+    entry.hash = Hash(stops);
+    entry.stops = stops;
+    entry.texture = texture;
+    entry.lastUse = ++mUseCounter;
+
+    if ((int)mEntries.size() < MAX_ENTRIES)
+    {
+        mEntries.push_back(entry);
+        return texture;
+    }
+
+    size_t oldest = 0;
+    for (size_t i = 1; i < mEntries.size(); ++i)
+    {
+        if (mEntries[i].lastUse < mEntries[oldest].lastUse)
+        {
+            oldest = i;
+        }
+    }
+    GGLStateCache::Current()->DeleteTextures(1, &mEntries[oldest].texture);
+    mEntries[oldest] = entry;
+    return texture;
+}
+
+void GGradientCache::Clear()
+{
+    for (size_t i = 0; i < mEntries.size(); ++i)
+    {
+        GGLStateCache::Current()->DeleteTextures(1, &mEntries[i].texture);
+    }
+    mEntries.clear();
+}
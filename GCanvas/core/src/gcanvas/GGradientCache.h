@@ -0,0 +1,76 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GGRADIENTCACHE_H
+#define GCANVAS_GGRADIENTCACHE_H
+
+#include "GGL.h"
+#include "GPoint.h"
+
+#include <stdint.h>
+#include <vector>
+
+#define GGRADIENT_MAX_STOPS 5
+
+// stop list of one gradient, colors already blended with the global alpha
+struct GGradientStops
+{
+    int count;
+    float pos[GGRADIENT_MAX_STOPS];
+    GColorRGBA color[GGRADIENT_MAX_STOPS];
+};
+
+/**
+ * Gradient stop lists baked into 256x1 RGBA lookup textures, so the
+ * gradient shaders do one texture fetch per pixel instead of walking the
+ * stops. Entries are keyed by a hash of the stop list and the least
+ * recently used one is replaced once the cache is full.
+ *
+ * Textures belong to the GL context the cache is used with.
+ */
+class GGradientCache
+{
+public:
+    static const int LOOKUP_WIDTH = 256;
+    static const int MAX_ENTRIES = 32;
+
+    GGradientCache();
+
+    ~GGradientCache();
+
+    // texture for the stops, 0 when not cached yet
+    GLuint Find(const GGradientStops &stops);
+
+    // bake and upload, the new texture is left bound to the active unit
+    GLuint Upload(const GGradientStops &stops);
+
+    void Clear();
+
+    int Size() const { return (int)mEntries.size(); }
+
+    // fill LOOKUP_WIDTH RGBA pixels, t = i / (LOOKUP_WIDTH - 1)
+    static void Bake(const GGradientStops &stops, unsigned char *pixels);
+
+    static uint32_t Hash(const GGradientStops &stops);
+
+private:
+    struct Entry
+    {
+        uint32_t hash;
+        GGradientStops stops;
+        GLuint texture;
+        unsigned long lastUse;
+    };
+
+    static bool SameStops(const GGradientStops &a, const GGradientStops &b);
+
+    std::vector<Entry> mEntries;
+    unsigned long mUseCounter;
+};
+
+#endif /* GCANVAS_GGRADIENTCACHE_H */
@@ -7,7 +7,9 @@
  * the LICENSE file in the root directory of this source tree.
  */
 #include "GPath.h"
+#include "GGLStateCache.h"
 #include "GCanvas2dContext.h"
+#include "GFrameProfiler.h"
 
 #define  G_PATH_RECURSION_LIMIT 8
 #define  G_PATH_DISTANCE_EPSILON 1.0f
@@ -131,6 +133,7 @@ void GPath::Close() {
 
 void GPath::QuadraticCurveTo(float cpx, float cpy, float x, float y,
                              float scale) {
+    GFRAME_PHASE(FRAME_PHASE_TESSELLATE);
     mDistanceTolerance = G_PATH_DISTANCE_EPSILON / scale;
     mDistanceTolerance *= mDistanceTolerance;
 
@@ -178,6 +181,7 @@ void GPath::recursiveQuadratic(float x1, float y1, float x2, float y2,
 
 void GPath::BezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y,
                           float x, float y, float scale) {
+    GFRAME_PHASE(FRAME_PHASE_TESSELLATE);
     mDistanceTolerance = G_PATH_DISTANCE_EPSILON / scale;
     mDistanceTolerance *= mDistanceTolerance;
 
@@ -259,6 +263,7 @@ void GPath::recursiveBezier(float x1, float y1, float x2, float y2, float x3,
 
 
 void GPath::ArcTo(float x1, float y1, float x2, float y2, float radius) {
+    GFRAME_PHASE(FRAME_PHASE_TESSELLATE);
     // Lifted from http://code.google.com/p/fxcanvas/
     GPoint cp = mCurrentPosition;
 
@@ -294,6 +299,7 @@ void GPath::ArcTo(float x1, float y1, float x2, float y2, float radius) {
 
 void GPath::Arc(float cx, float cy, float radius, float startAngle,
                 float endAngle, bool antiClockwise) {
+    GFRAME_PHASE(FRAME_PHASE_TESSELLATE);
     float spanAngle = endAngle - startAngle;
     if (antiClockwise) {
         spanAngle = -spanAngle;
@@ -367,22 +373,22 @@ void GPath::Arc(float cx, float cy, float radius, float startAngle,
 
 void GPath::ClipRegion(GCanvasContext *context)
 {
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    GGLStateCache::Current()->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 
-    glEnable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
     // clip use high mask bit
     GLuint mask = 0x80;
     GLuint ref = 0x80;
-    glStencilMask(mask);
+    GGLStateCache::Current()->StencilMask(mask);
 
     // use stencil func
     if (context->HasClipRegion()) {
-        glStencilFunc(GL_EQUAL, ref, mask);
-        glStencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
+        GGLStateCache::Current()->StencilFunc(GL_EQUAL, ref, mask);
+        GGLStateCache::Current()->StencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
     } else {
         glClear(GL_STENCIL_BUFFER_BIT);
-        glStencilFunc(GL_ALWAYS, ref, mask);
-        glStencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
+        GGLStateCache::Current()->StencilFunc(GL_ALWAYS, ref, mask);
+        GGLStateCache::Current()->StencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
     }
 
     for (std::vector<tSubPath>::const_iterator pathIter =
@@ -393,13 +399,14 @@ void GPath::ClipRegion(GCanvasContext *context)
             continue;
         }
 
-        glVertexAttribPointer(context->PositionSlot(), 2, GL_FLOAT, GL_FALSE,
-                              sizeof(GPoint), &(path.front()));
+        context->BindPointArray(&(path.front()));
         context->mDrawCallCount++;
         glDrawArrays(GL_TRIANGLE_FAN, 0, (GLsizei) path.size());
+        GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+        GFRAME_COUNT(FRAME_COUNTER_VERTICES, path.size());
     }
-    context->BindPositionVertexBuffer();
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    context->BindVertexBuffer();
+    GGLStateCache::Current()->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
     // reset stencil
     SetStencilForClip();
@@ -423,30 +430,20 @@ void GPath::PushTriangleFanPoints(GCanvasContext *context, tSubPath* subPath, GC
 
 void GPath::DrawPolygons2DToContext(GCanvasContext *context, GFillRule rule, GFillTarget target )
 {
-    
-    GLint bindFBO = 0;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bindFBO);
-    
-    
     context->SendVertexBufferToGPU();
     
     GColorRGBA color = BlendColor(context, context->mCurrentState->mFillColor);
     
     // Disable drawing to the color buffer, enable the stencil buffer
-    if (context->mCurrentState->mShader->GetTexcoordSlot() > 0) {
-        glDisableVertexAttribArray((GLuint)context->mCurrentState->mShader->GetTexcoordSlot());
-    }
-    glDisableVertexAttribArray((GLuint)context->mCurrentState->mShader->GetColorSlot());
-    
-    glDisable(GL_BLEND);
-    glEnable(GL_STENCIL_TEST);
-    glStencilMask(0xff);
+    GGLStateCache::Current()->Disable(GL_BLEND);
+    GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->StencilMask(0xff);
     
-    glStencilFunc(GL_ALWAYS, 0, 0xff);
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    GGLStateCache::Current()->StencilFunc(GL_ALWAYS, 0, 0xff);
+    GGLStateCache::Current()->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     
     // Clear the needed area in the stencil buffer
-    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    GGLStateCache::Current()->StencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
     GColorRGBA white = {1,1,1,1};
     
     GPoint minPos = mMinPosition;
@@ -458,12 +455,12 @@ void GPath::DrawPolygons2DToContext(GCanvasContext *context, GFillRule rule, GFi
     
     if( rule == FILL_RULE_NONZERO )
     {
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
-        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+        GGLStateCache::Current()->StencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+        GGLStateCache::Current()->StencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
     }
     else if( rule == FILL_RULE_EVENODD )
     {
-        glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+        GGLStateCache::Current()->StencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
     }
     
     for (std::vector<tSubPath>::iterator iter = mPathStack.begin(); iter != mPathStack.end(); ++iter)
@@ -472,41 +469,43 @@ void GPath::DrawPolygons2DToContext(GCanvasContext *context, GFillRule rule, GFi
         
         if( path.points.size() == 0 ) continue;
         
-        glVertexAttribPointer((GLuint) context->mCurrentState->mShader->GetPositionSlot(), 2,
-                              GL_FLOAT, GL_FALSE, 0,
-                              &(path.points.front()));
+        context->BindPointArray(&(path.points.front()));
         context->mDrawCallCount++;
         glDrawArrays(GL_TRIANGLE_FAN, 0, (int)path.points.size());
+        GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+        GFRAME_COUNT(FRAME_COUNTER_VERTICES, path.points.size());
     }
     
     context->BindVertexBuffer();
     
     //enable color or depth buffer, push a rect with the correct size and color
     if( target == FILL_TARGET_DEPTH ) {
-        glDepthFunc(GL_ALWAYS);
-        glDepthMask(GL_TRUE);
-        glClear(GL_DEPTH_BUFFER_BIT);
+        // write the next clip layer, see GCanvasContext::ClipRegionNew
+        float depth = context->ClipDepthValue(context->ClipDepthLevel() + 1);
+        GGLStateCache::Current()->DepthRange(depth, depth);
+        GGLStateCache::Current()->DepthFunc(GL_ALWAYS);
+        GGLStateCache::Current()->DepthMask(GL_TRUE);
     }
     else if( target == FILL_TARGET_COLOR ) {
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glEnable(GL_BLEND);
+        GGLStateCache::Current()->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        GGLStateCache::Current()->Enable(GL_BLEND);
     }
     
-    glStencilFunc(GL_NOTEQUAL, 0x00, 0xff);
-    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    GGLStateCache::Current()->StencilFunc(GL_NOTEQUAL, 0x00, 0xff);
+    GGLStateCache::Current()->StencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
     
     context->PushRectangle(minPos.x, minPos.y, maxPos.x-minPos.x, maxPos.y-minPos.y, 0, 0, 0, 0, color);
     context->SendVertexBufferToGPU();
     
-    glDisable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
     
     if( target == FILL_TARGET_DEPTH )
     {
-        glDepthMask(GL_FALSE);
-        glDepthFunc(GL_EQUAL);
+        GGLStateCache::Current()->DepthMask(GL_FALSE);
+        GGLStateCache::Current()->DepthFunc(GL_EQUAL);
         
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glEnable(GL_BLEND);
+        GGLStateCache::Current()->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        GGLStateCache::Current()->Enable(GL_BLEND);
     }
 }
 
@@ -728,6 +727,7 @@ std::vector<tSubPath>* GPath::DrawLineDash(GCanvasContext *context)
 
 void GPath::CreateLinesFromPoints(GCanvasContext *context, GColorRGBA color, std::vector<GVertex> *vertexVec)
 {
+    GFRAME_PHASE(FRAME_PHASE_TESSELLATE);
     float lineWidth = context->LineWidth() * 0.5;
     float minValidValue = 0.01;
 
@@ -901,12 +901,12 @@ void GPath::StencilRectForStroke(GCanvasContext *context, std::vector<GVertex> &
     GColorRGBA color = BlendStrokeColor(context);
     
     //set environment
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-    glEnable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
     
     // clear stencil buffer
-    glStencilFunc(GL_ALWAYS, 0, 0xff);
-    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    GGLStateCache::Current()->StencilFunc(GL_ALWAYS, 0, 0xff);
+    GGLStateCache::Current()->StencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
     GColorRGBA white = {1,1,1,1};
     
     float extend = context->MiterLimit() * context->LineWidth();
@@ -929,23 +929,23 @@ void GPath::StencilRectForStroke(GCanvasContext *context, std::vector<GVertex> &
     context->SendVertexBufferToGPU();
     
     // first draw stencil
-    glStencilFunc(GL_ALWAYS, 0x1, 0xFF);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    GGLStateCache::Current()->StencilFunc(GL_ALWAYS, 0x1, 0xFF);
+    GGLStateCache::Current()->StencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
     
     // push vertexs
     context->PushVertexs(vertexVec);
     context->SendVertexBufferToGPU();
     
     // second draw color buffer with stencil buffer
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glStencilFunc(GL_NOTEQUAL, 0x00, 0xff);
-    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    GGLStateCache::Current()->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    GGLStateCache::Current()->StencilFunc(GL_NOTEQUAL, 0x00, 0xff);
+    GGLStateCache::Current()->StencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
     
     context->PushRectangle(rect.x, rect.y, rect.width, rect.height, 0, 0, 0, 0, color);
     context->SendVertexBufferToGPU();
     
     // reset
-    glDisable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
 }
 
 float GPath::calcPointAngle(const GPoint &director, const GPoint &center) {
@@ -1044,6 +1044,43 @@ void GPath::GetRect(GRectf& rect)
     rect.bottomRight = mMaxPosition;
 }
 
+bool GPath::GetAxisAlignedRect(GRectf& rect)
+{
+    const tSubPath *rectPath = nullptr;
+    for (std::vector<tSubPath>::const_iterator iter = mPathStack.begin();
+         iter != mPathStack.end(); ++iter)
+    {
+        if (iter->points.empty()) continue;
+        if (rectPath != nullptr) return false;
+        rectPath = &(*iter);
+    }
+    if (rectPath == nullptr) return false;
+
+    const std::vector<GPoint> &pts = rectPath->points;
+    size_t count = pts.size();
+    if (count == 5 && pts[4].x == pts[0].x && pts[4].y == pts[0].y)
+    {
+        count = 4;
+    }
+    if (count != 4) return false;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        const GPoint &p = pts[i];
+        const GPoint &q = pts[(i + 1) % 4];
+        if ((p.x != mMinPosition.x && p.x != mMaxPosition.x) ||
+            (p.y != mMinPosition.y && p.y != mMaxPosition.y))
+        {
+            return false;
+        }
+        // every edge moves along exactly one axis
+        if ((p.x == q.x) == (p.y == q.y)) return false;
+    }
+
+    GetRect(rect);
+    return true;
+}
+
 
 
 void GPath::RestoreStencilForClip(GCanvasContext *context)
@@ -1057,9 +1094,9 @@ void GPath::RestoreStencilForClip(GCanvasContext *context)
     else
     {
         // disable
-        glStencilMask(0xFF);
+        GGLStateCache::Current()->StencilMask(0xFF);
         glClear(GL_STENCIL_BUFFER_BIT);
-        glDisable(GL_STENCIL_TEST);
+        GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
     }
 }
 
@@ -1067,9 +1104,9 @@ void GPath::RestoreStencilForClip(GCanvasContext *context)
 void GPath::SetStencilForClip()
 {
     GLuint mask = 0x80;
-    glStencilMask(mask);
-    glStencilFunc(GL_EQUAL, mask, mask);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GGLStateCache::Current()->StencilMask(mask);
+    GGLStateCache::Current()->StencilFunc(GL_EQUAL, mask, mask);
+    GGLStateCache::Current()->StencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 }
 
 inline double calc_distance(double x1, double y1, double x2, double y2)
@@ -62,6 +62,9 @@ public:
 
     void GetRect(GRectf& rect);
 
+    // true when the path is a single rectangle with axis-aligned edges
+    bool GetAxisAlignedRect(GRectf& rect);
+
     static void SubdivideCubicTo(GPath *path, GPoint points[4], int level = 4);
 
     static void ChopCubicAt(GPoint src[4], GPoint dst[7], float t);
@@ -0,0 +1,266 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GProgramBinaryCache.h"
+#include "GGLStateCache.h"
+#include "../support/Log.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_PROGRAM_BINARY_LENGTH_OES 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#define GL_NUM_PROGRAM_BINARY_FORMATS_OES 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+// file layout: magic, binary format, binary length, binary
+static const uint32_t PROGRAM_BINARY_MAGIC = 0x31425047; // "GPB1"
+
+GProgramBinaryCache *GProgramBinaryCache::GetInstance()
+{
+    static GProgramBinaryCache *sInstance = new GProgramBinaryCache();
+    return sInstance;
+}
+
+GProgramBinaryCache::GProgramBinaryCache()
+        : mSupport(-1), mGetProgramBinary(nullptr), mProgramBinary(nullptr),
+          mProgramParameteri(nullptr), mHitCount(0), mMissCount(0)
+{
+    const char *directory = getenv("GCANVAS_PROGRAM_CACHE_DIR");
+    if (directory != nullptr)
+    {
+        mDirectory = directory;
+    }
+}
+
+void GProgramBinaryCache::SetDirectory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDirectory = directory;
+    if (!mDirectory.empty() && mDirectory[mDirectory.size() - 1] == '/')
+    {
+        mDirectory.erase(mDirectory.size() - 1);
+    }
+}
+
+std::string GProgramBinaryCache::GetDirectory()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDirectory;
+}
+
+bool GProgramBinaryCache::IsSupported()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return CheckSupport();
+}
+
+bool GProgramBinaryCache::CheckSupport()
+{
+    if (mSupport >= 0)
+    {
+        return mSupport == 1;
+    }
+    mSupport = 0;
+
+#if defined(ANDROID) || defined(__linux__)
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    const char *version = (const char *)glGetString(GL_VERSION);
+    if (extensions == nullptr || version == nullptr)
+    {
+        // no current context, try again next time
+        mSupport = -1;
+        return false;
+    }
+
+    if (strstr(extensions, "GL_OES_get_program_binary") != nullptr)
+    {
+        mGetProgramBinary = (GGetProgramBinaryFunc)eglGetProcAddress("glGetProgramBinaryOES");
+        mProgramBinary = (GProgramBinaryFunc)eglGetProcAddress("glProgramBinaryOES");
+    }
+    bool es3 = strncmp(version, "OpenGL ES 3", 11) == 0;
+    if (es3)
+    {
+        mProgramParameteri = (GProgramParameteriFunc)eglGetProcAddress("glProgramParameteri");
+    }
+    if ((mGetProgramBinary == nullptr || mProgramBinary == nullptr) && es3)
+    {
+        mGetProgramBinary = (GGetProgramBinaryFunc)eglGetProcAddress("glGetProgramBinary");
+        mProgramBinary = (GProgramBinaryFunc)eglGetProcAddress("glProgramBinary");
+    }
+    if (mGetProgramBinary == nullptr || mProgramBinary == nullptr)
+    {
+        LOG_I("GProgramBinaryCache: program binaries not supported");
+        return false;
+    }
+
+    // some drivers expose the entry points without a single usable format
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formatCount);
+    if (formatCount <= 0)
+    {
+        LOG_I("GProgramBinaryCache: no program binary formats");
+        return false;
+    }
+    mSupport = 1;
+#endif
+    return mSupport == 1;
+}
+
+static void HashBytes(uint64_t &hash, const char *str)
+{
+    if (str == nullptr)
+    {
+        return;
+    }
+    for (const unsigned char *p = (const unsigned char *)str; *p; ++p)
+    {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    // separator so that "ab"+"c" and "a"+"bc" differ
+    hash = (hash ^ 0xff) * 1099511628211ULL;
+}
+
+std::string GProgramBinaryCache::FilePath(const std::string &name, const char *vertexSrc,
+                                          const char *fragmentSrc)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    HashBytes(hash, (const char *)glGetString(GL_VENDOR));
+    HashBytes(hash, (const char *)glGetString(GL_RENDERER));
+    HashBytes(hash, (const char *)glGetString(GL_VERSION));
+    HashBytes(hash, vertexSrc);
+    HashBytes(hash, fragmentSrc);
+
+    char suffix[24];
+    snprintf(suffix, sizeof(suffix), "-%016llx.bin", (unsigned long long)hash);
+    return mDirectory + "/" + name + suffix;
+}
+
+GLuint GProgramBinaryCache::LoadProgram(const std::string &name, const char *vertexSrc,
+                                        const char *fragmentSrc)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mDirectory.empty() || !CheckSupport())
+    {
+        return 0;
+    }
+
+    std::string path = FilePath(name, vertexSrc, fragmentSrc);
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        ++mMissCount;
+        return 0;
+    }
+
+    uint32_t header[3] = {0, 0, 0};
+    std::vector<unsigned char> binary;
+    bool valid = fread(header, sizeof(header), 1, file) == 1 &&
+                 header[0] == PROGRAM_BINARY_MAGIC && header[2] > 0;
+    if (valid)
+    {
+        binary.resize(header[2]);
+        valid = fread(&binary[0], 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    GLuint program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        mProgramBinary(program, header[1], &binary[0], (GLint)binary.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            GGLStateCache::Current()->DeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0)
+    {
+        LOG_W("GProgramBinaryCache: drop unusable binary %s", path.c_str());
+        remove(path.c_str());
+        ++mMissCount;
+        return 0;
+    }
+
+    ++mHitCount;
+    return program;
+}
+
+void GProgramBinaryCache::PrepareLink(GLuint program)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (program == 0 || mDirectory.empty() || !CheckSupport() ||
+        mProgramParameteri == nullptr)
+    {
+        return;
+    }
+    mProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool GProgramBinaryCache::SaveProgram(GLuint program, const std::string &name,
+                                      const char *vertexSrc, const char *fragmentSrc)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (program == 0 || mDirectory.empty() || !CheckSupport())
+    {
+        return false;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    mGetProgramBinary(program, length, &written, &format, &binary[0]);
+    if (written <= 0)
+    {
+        LOG_W("GProgramBinaryCache: glGetProgramBinary failed for %s", name.c_str());
+        return false;
+    }
+
+    mkdir(mDirectory.c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+
+    // write aside and rename, so a concurrent reader never sees half a file
+    std::string path = FilePath(name, vertexSrc, fragmentSrc);
+    std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOG_W("GProgramBinaryCache: can not write %s", tmpPath.c_str());
+        return false;
+    }
+    uint32_t header[3] = {PROGRAM_BINARY_MAGIC, (uint32_t)format, (uint32_t)written};
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+              fwrite(&binary[0], 1, written, file) == (size_t)written;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
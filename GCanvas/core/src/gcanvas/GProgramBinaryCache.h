@@ -0,0 +1,84 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GPROGRAMBINARYCACHE_H
+#define GCANVAS_GPROGRAMBINARYCACHE_H
+
+#include "GGL.h"
+
+#include <mutex>
+#include <string>
+
+// same signatures for the OES entry points and the ES 3 core ones
+typedef void (*GGetProgramBinaryFunc)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                      GLenum *binaryFormat, void *binary);
+typedef void (*GProgramBinaryFunc)(GLuint program, GLenum binaryFormat,
+                                   const void *binary, GLint length);
+typedef void (*GProgramParameteriFunc)(GLuint program, GLenum pname, GLint value);
+
+/**
+ * Linked programs saved to disk with GL_OES_get_program_binary, or the
+ * core glGetProgramBinary of ES 3, and restored instead of compiling the
+ * GLSL on the next start.
+ *
+ * A file is named after the program and a hash of the GL vendor, renderer
+ * and version strings plus both sources, so a driver update or a shader
+ * change simply misses. Binaries the driver refuses are deleted and the
+ * caller compiles from source as if nothing was cached.
+ *
+ * The cache is off until a directory is set, either with SetDirectory() or
+ * through the GCANVAS_PROGRAM_CACHE_DIR environment variable.
+ */
+class GProgramBinaryCache
+{
+public:
+    static GProgramBinaryCache *GetInstance();
+
+    void SetDirectory(const std::string &directory);
+
+    std::string GetDirectory();
+
+    // program linked from a cached binary, 0 when there is none
+    GLuint LoadProgram(const std::string &name, const char *vertexSrc,
+                       const char *fragmentSrc);
+
+    // before glLinkProgram of a program that goes to SaveProgram, ES 3
+    // drivers may not keep the binary of a program linked without the hint
+    void PrepareLink(GLuint program);
+
+    // store the binary of a program linked from the given sources
+    bool SaveProgram(GLuint program, const std::string &name,
+                     const char *vertexSrc, const char *fragmentSrc);
+
+    // needs a current context the first time
+    bool IsSupported();
+
+    unsigned int HitCount() const { return mHitCount; }
+
+    unsigned int MissCount() const { return mMissCount; }
+
+private:
+    GProgramBinaryCache();
+
+    bool CheckSupport();
+
+    std::string FilePath(const std::string &name, const char *vertexSrc,
+                         const char *fragmentSrc);
+
+    std::mutex mMutex;
+    std::string mDirectory;
+    int mSupport;   // -1 unknown, 0 no, 1 yes
+    GGetProgramBinaryFunc mGetProgramBinary;
+    GProgramBinaryFunc mProgramBinary;
+    GProgramParameteriFunc mProgramParameteri;   // ES 3 only
+
+    unsigned int mHitCount;
+    unsigned int mMissCount;
+};
+
+#endif /* GCANVAS_GPROGRAMBINARYCACHE_H */
@@ -8,61 +8,23 @@
  */
 
 #include "GShader.h"
+#include "GGLStateCache.h"
+#include "GProgramBinaryCache.h"
 
-#ifdef ANDROID
-
-#include "GPreCompiledShaders.h"
-
-#define CHECK_GL_ERROR_DEBUG()                                                 \
-    do                                                                         \
-    {                                                                          \
-        GLenum __error = glGetError();                                         \
-        if (__error)                                                           \
-        {                                                                      \
-            LOG_E("OpenGL error 0x%04X in %s %s %d\n", __error, __FILE__,      \
-                  __FUNCTION__, __LINE__);                                     \
-        }                                                                      \
-    } while (false)
-
-
-bool GShader::initWithPreCompiledProgramByteArray(
-        const char *shaderName, const GLchar *vShaderByteArray,
-        const GLchar *fShaderByteArray)
-{
-    mHandle = glCreateProgram();
-    bool haveProgram = GPreCompiledShaders::getInstance()->LoadProgram(mHandle, shaderName);
-
-    CHECK_GL_ERROR_DEBUG();
-
-    return haveProgram;
-}
-
-extern bool g_use_pre_compile;
-
-#endif
-
-
+#include <stdio.h>
 #include <string.h>
 
 GShader::GShader(const char *name, const char *vertexShaderSrc,
                  const char *fragmentShaderSrc)
         : mHandle(0), mName(name)
 {
-#ifdef ANDROID
-    std::string shaderName = SHADER_NAME_PREFIX + mName;
-
-    if (g_use_pre_compile)
+    GProgramBinaryCache *binaryCache = GProgramBinaryCache::GetInstance();
+    mHandle = binaryCache->LoadProgram(mName, vertexShaderSrc, fragmentShaderSrc);
+    if (mHandle != 0)
     {
-        if (GPreCompiledShaders::getInstance()
-                    ->GetSupportPreCompiledShaders() &&
-            initWithPreCompiledProgramByteArray(
-                    shaderName.c_str(), vertexShaderSrc, fragmentShaderSrc))
-        {
-            return;
-        }
+        return;
     }
-#endif
-    
+
     GLuint vertexShader = compileShader(vertexShaderSrc, GL_VERTEX_SHADER);
     if (vertexShader == 0)
     {
@@ -84,6 +46,7 @@ GShader::GShader(const char *name, const char *vertexShaderSrc,
     mHandle = glCreateProgram();
     glAttachShader(mHandle, vertexShader);
     glAttachShader(mHandle, fragmentShader);
+    binaryCache->PrepareLink(mHandle);
     glLinkProgram(mHandle);
 
     glDeleteShader(vertexShader);
@@ -100,28 +63,19 @@ GShader::GShader(const char *name, const char *vertexShaderSrc,
         fillLogInfo(log, "program_link_fail", "name:%s, error:%x", name, message);
         mErrVec.push_back(log);
         
-        glDeleteProgram(mHandle);
+        GGLStateCache::Current()->DeleteProgram(mHandle);
         mHandle = 0;
         return;
     }
-#ifdef ANDROID
-    else
-    {
-        if (g_use_pre_compile &&
-            GPreCompiledShaders::getInstance()
-                    ->GetSupportPreCompiledShaders())
-        {
-            GPreCompiledShaders::getInstance()->AddProgram(mHandle, mName);
-        }
-    }
-#endif
+
+    binaryCache->SaveProgram(mHandle, mName, vertexShaderSrc, fragmentShaderSrc);
 }
 
 GShader::~GShader()
 {
     if (mHandle != 0)
     {
-        glDeleteProgram(mHandle);
+        GGLStateCache::Current()->DeleteProgram(mHandle);
         mHandle = 0;
     }
 }
@@ -158,12 +112,17 @@ GLuint GShader::compileShader(const char *shader, GLenum shaderType)
 
 void GShader::Bind()
 {
-    glUseProgram(mHandle);
+    GGLStateCache::Current()->UseProgram(mHandle);
     RestoreShaderState();
 }
 
 void GShader::SetTransform(const GTransform &trans)
 {
+    GLfloat value[6] = {trans.a, trans.b, trans.c, trans.d, trans.tx, trans.ty};
+    if (!mTransformValue.Update(value))
+    {
+        return;
+    }
 
     GLfloat m[16] = {0.0f};
     m[0] = trans.a;
@@ -203,14 +162,11 @@ void DefaultShader::calculateAttributesLocations()
     mOverrideTextureColorSlot =
             glGetUniformLocation(mHandle, "b_overrideTextureColor");
 
-    glUseProgram(mHandle);
-
-    glUniform1i(mHasTextureSlot, 0);
+    GGLStateCache::Current()->UseProgram(mHandle);
 
-    glUniform1i(mOverrideTextureColorSlot, 0);
+    SetHasTexture(false);
 
-    mHasTextureFlag = false;
-    mOverrideTextureColorFlag = false;
+    SetOverideTextureColor(0);
 }
 
 TextureShader::TextureShader(const char *name, const char *vertexShaderSrc,
@@ -231,6 +187,21 @@ void TextureShader::calculateAttributesLocations()
     mPremultipliedAlphaSlot = glGetUniformLocation(mHandle, "b_premultipliedAlpha");
 }
 
+SpriteShader::SpriteShader(const char *name, const char *vertexShaderSrc,
+                           const char *fragmentShaderSrc)
+        : TextureShader(name, vertexShaderSrc, fragmentShaderSrc)
+{
+    calculateAttributesLocations();
+}
+
+void SpriteShader::calculateAttributesLocations()
+{
+    TextureShader::calculateAttributesLocations();
+    mTransformXSlot = glGetAttribLocation(mHandle, "a_transformX");
+    mTransformYSlot = glGetAttribLocation(mHandle, "a_transformY");
+    mTexRectSlot = glGetAttribLocation(mHandle, "a_texRect");
+}
+
 ShadowShader::ShadowShader(const char *name, const char *vertexShaderSrc,
                              const char *fragmentShaderSrc)
         : GShader(name, vertexShaderSrc, fragmentShaderSrc)
@@ -271,8 +242,8 @@ void PatternShader::calculateAttributesLocations()
     mTextureSizeSlot = glGetUniformLocation(mHandle, "textureSize");
     mPatternAlphaSlot = glGetUniformLocation(mHandle, "u_patternAlpha");
 
-    glUseProgram(mHandle);
-    SetRepeatMode("no-repeat");
+    GGLStateCache::Current()->UseProgram(mHandle);
+    SetRepeatMode(REPEAT_MODE_NO_REPEAT);
 }
 
 
@@ -292,25 +263,25 @@ void GradientShader::calculateAttributesLocations()
     mTransfromSlot = glGetUniformLocation(mHandle, "u_modelView");
     mTextureSamplerSlot = glGetUniformLocation(mHandle, "u_texture");
     mHasTextureSlot = glGetUniformLocation(mHandle, "b_hasTexture");
+    mGradientSamplerSlot = glGetUniformLocation(mHandle, "u_gradient");
 
     mStopCountSlot = glGetUniformLocation(mHandle, "u_stopCount");
 
-    mStop0ColorSlot = glGetUniformLocation(mHandle, "u_stopColor0");
-    mStop1ColorSlot = glGetUniformLocation(mHandle, "u_stopColor1");
-    mStop2ColorSlot = glGetUniformLocation(mHandle, "u_stopColor2");
-    mStop3ColorSlot = glGetUniformLocation(mHandle, "u_stopColor3");
-    mStop4ColorSlot = glGetUniformLocation(mHandle, "u_stopColor4");
-
-    mStop0Slot = glGetUniformLocation(mHandle, "u_stop0");
-    mStop1Slot = glGetUniformLocation(mHandle, "u_stop1");
-    mStop2Slot = glGetUniformLocation(mHandle, "u_stop2");
-    mStop3Slot = glGetUniformLocation(mHandle, "u_stop3");
-    mStop4Slot = glGetUniformLocation(mHandle, "u_stop4");
-
-    glUseProgram(mHandle);
-    glUniform1i(mHasTextureSlot, 0);
+    char name[16];
+    for (int i = 0; i < MAX_STOP_NUM; ++i)
+    {
+        snprintf(name, sizeof(name), "u_stopColor%d", i);
+        mStopColorSlot[i] = glGetUniformLocation(mHandle, name);
+        snprintf(name, sizeof(name), "u_stop%d", i);
+        mStopSlot[i] = glGetUniformLocation(mHandle, name);
+    }
 
-    mHasTextureFlag = false;
+    GGLStateCache::Current()->UseProgram(mHandle);
+    SetHasTexture(false);
+    if (mGradientSamplerSlot >= 0)
+    {
+        glUniform1i(mGradientSamplerSlot, LOOKUP_TEXTURE_UNIT);
+    }
 }
 
 
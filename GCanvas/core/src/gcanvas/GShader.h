@@ -12,10 +12,83 @@
 #include "GGL.h"
 #include "GPoint.h"
 #include "GTransform.h"
+#include "GFillStyle.h"
+#include "GGLStateCache.h"
 #include "../support/Log.h"
 
+#include <string.h>
 #include <vector>
 
+/**
+ * Last value uploaded to one uniform. Uniforms are program state, so a
+ * shader only has to upload when the value changes; Update() stores the
+ * new value and returns whether the upload is needed. The program that was
+ * bound at upload time is remembered too, so a setter called while some
+ * other program is current never leaves a stale value behind.
+ */
+template<class T, int N>
+class GUniformShadow
+{
+public:
+    GUniformShadow() : mProgram(0), mCount(0), mValid(false) {}
+
+    bool Update(const T *value, int count = N)
+    {
+        GGLStateCache *cache = GGLStateCache::Current();
+        GLuint program = cache->BoundProgram();
+        if (count > N)
+        {
+            mValid = false;
+            cache->CountUniform(true);
+            return true;
+        }
+        if (mValid && mProgram == program && mCount == count &&
+            memcmp(mValue, value, count * sizeof(T)) == 0)
+        {
+            cache->CountUniform(false);
+            return false;
+        }
+        memcpy(mValue, value, count * sizeof(T));
+        mProgram = program;
+        mCount = count;
+        mValid = true;
+        cache->CountUniform(true);
+        return true;
+    }
+
+    bool Update(T v0)
+    {
+        T value[1] = {v0};
+        return Update(value, 1);
+    }
+
+    bool Update(T v0, T v1)
+    {
+        T value[2] = {v0, v1};
+        return Update(value, 2);
+    }
+
+    bool Update(T v0, T v1, T v2)
+    {
+        T value[3] = {v0, v1, v2};
+        return Update(value, 3);
+    }
+
+    bool Update(T v0, T v1, T v2, T v3)
+    {
+        T value[4] = {v0, v1, v2, v3};
+        return Update(value, 4);
+    }
+
+    void Invalidate() { mValid = false; }
+
+private:
+    T mValue[N];
+    GLuint mProgram;
+    int mCount;
+    bool mValid;
+};
+
 class GShader
 {
 public:
@@ -24,14 +97,6 @@ public:
 
     virtual ~GShader();
 
-#ifdef ANDROID
-
-    bool initWithPreCompiledProgramByteArray(const char *shaderName,
-                                             const GLchar *vShaderByteArray,
-                                             const GLchar *fShaderByteArray);
-
-#endif
-
     void Bind();
 
     const std::string &GetName() { return mName; }
@@ -52,7 +117,12 @@ public:
     
     GLint GetTransformSlot() { return mTransfromSlot; }
 
-    virtual void SetRepeatMode(const std::string &pattern) {}
+    virtual void SetRepeatMode(GRepeatMode mode) {}
+
+    void SetRepeatMode(const std::string &pattern)
+    {
+        SetRepeatMode(GRepeatModeFromString(pattern.c_str()));
+    }
 
     virtual void SetRange(const GPoint &start, const GPoint &end) {}
 
@@ -64,10 +134,15 @@ public:
 
     virtual void SortColorStop() {}
 
+    virtual bool HasLookupTexture() const { return false; }
+
     virtual void SetTextureSize(float width, float height) {}
 
     void SetTransform(const GTransform &trans);
 
+    // for code that uploads u_modelView itself
+    void InvalidateTransform() { mTransformValue.Invalidate(); }
+
     virtual void SetDelta(float x, float y) {}
 
     virtual void SetWeight(float w[], int count) {}
@@ -88,6 +163,8 @@ protected:
     GLint mPositionSlot;
     GLint mColorSlot;
     GLint mTransfromSlot;
+
+    GUniformShadow<GLfloat, 6> mTransformValue;
     
     std::vector<GCanvasLog> mErrVec;
 };
@@ -102,30 +179,26 @@ public:
 
     void SetTextSampler(int value)
     {
-        glUniform1i(mTextureSamplerSlot, value);
+        if (mTextureSamplerValue.Update(value))
+        {
+            glUniform1i(mTextureSamplerSlot, value);
+        }
     }
 
     void SetHasTexture(bool value)
     {
-
-        if (mHasTextureFlag != value)
+        if (mHasTextureValue.Update(value))
         {
-            mHasTextureFlag = value;
             glUniform1i(mHasTextureSlot, value);
-
         }
     }
 
     void SetOverideTextureColor(int value)
     {
-        mOverrideTextureColorFlag = value;
-        glUniform1i(mOverrideTextureColorSlot, value);
-    }
-
-    void RestoreShaderState()
-    {
-        SetHasTexture(mHasTextureFlag);
-        SetOverideTextureColor(mOverrideTextureColorFlag);
+        if (mOverrideTextureColorValue.Update(value))
+        {
+            glUniform1i(mOverrideTextureColorSlot, value);
+        }
     }
 
 protected:
@@ -136,8 +209,9 @@ private:
     GLuint mHasTextureSlot;
     GLuint mOverrideTextureColorSlot;
 
-    bool mHasTextureFlag;
-    bool mOverrideTextureColorFlag;
+    GUniformShadow<GLint, 1> mTextureSamplerValue;
+    GUniformShadow<GLint, 1> mHasTextureValue;
+    GUniformShadow<GLint, 1> mOverrideTextureColorValue;
 };
 
 class TextureShader : public GShader
@@ -150,12 +224,18 @@ public:
 
     void SetTextSampler(int value)
     {
-        glUniform1i(mTextureSamplerSlot, value);
+        if (mTextureSamplerValue.Update(value))
+        {
+            glUniform1i(mTextureSamplerSlot, value);
+        }
     }
     
     void SetPremultipliedAlpha(bool value)
     {
-        glUniform1i(mPremultipliedAlphaSlot, value);
+        if (mPremultipliedAlphaValue.Update(value))
+        {
+            glUniform1i(mPremultipliedAlphaSlot, value);
+        }
     }
 
 protected:
@@ -164,11 +244,45 @@ protected:
 private:
     GLuint mTextureSamplerSlot;
     GLuint mPremultipliedAlphaSlot;
+
+    GUniformShadow<GLint, 1> mTextureSamplerValue;
+    GUniformShadow<GLint, 1> mPremultipliedAlphaValue;
+};
+
+// texture program of the instanced drawImage path, see GSpriteBatch
+class SpriteShader : public TextureShader
+{
+public:
+    SpriteShader(const char *name, const char *vertexShaderSrc,
+                 const char *fragmentShaderSrc);
+
+    GLint GetTransformXSlot() { return mTransformXSlot; }
+
+    GLint GetTransformYSlot() { return mTransformYSlot; }
+
+    GLint GetTexRectSlot() { return mTexRectSlot; }
+
+    // false when the program failed to build
+    bool IsComplete() const
+    {
+        return mPositionSlot >= 0 && mColorSlot >= 0 && mTransformXSlot >= 0 &&
+               mTransformYSlot >= 0 && mTexRectSlot >= 0;
+    }
+
+protected:
+    void calculateAttributesLocations();
+
+private:
+    GLint mTransformXSlot;
+    GLint mTransformYSlot;
+    GLint mTexRectSlot;
 };
 
 class ShadowShader : public GShader
 {
 public:
+    static const int MAX_WEIGHT_NUM = 13;
+
     ShadowShader(const char *name, const char *vertexShaderSrc,
                  const char *fragmentShaderSrc);
 
@@ -177,15 +291,19 @@ public:
 
     void SetDelta(float x, float y)
     {
-        glUniform1f(mXDeltaSlot, x);
-        glUniform1f(mYDeltaSlot, y);
-
+        if (mDeltaValue.Update(x, y))
+        {
+            glUniform1f(mXDeltaSlot, x);
+            glUniform1f(mYDeltaSlot, y);
+        }
     }
 
     void SetWeight(float w[], int count)
     {
-        glUniform1fv(mWeightSlot, count, w);
-
+        if (mWeightValue.Update(w, count))
+        {
+            glUniform1fv(mWeightSlot, count, w);
+        }
     }
 
 protected:
@@ -197,6 +315,8 @@ private:
     GLuint mWeightSlot;
     GLuint mSamplerSlot;
 
+    GUniformShadow<GLfloat, 2> mDeltaValue;
+    GUniformShadow<GLfloat, MAX_WEIGHT_NUM> mWeightValue;
 };
 
 class PatternShader : public GShader
@@ -207,25 +327,39 @@ public:
 
     void SetTextSampler(int value)
     {
-        glUniform1i(mTextureSamplerSlot, value);
+        if (mTextureSamplerValue.Update(value))
+        {
+            glUniform1i(mTextureSamplerSlot, value);
+        }
     }
 
-    void SetRepeatMode(const std::string &pattern)
+    using GShader::SetRepeatMode;
+
+    void SetRepeatMode(GRepeatMode mode)
     {
-        glUniform1i(mRepeatXSlot,
-                    (pattern == "repeat" || pattern == "repeat-x"));
-        glUniform1i(mRepeatYslot,
-                    (pattern == "repeat" || pattern == "repeat-y"));
+        GLint repeatX = (mode == REPEAT_MODE_REPEAT || mode == REPEAT_MODE_REPEAT_X);
+        GLint repeatY = (mode == REPEAT_MODE_REPEAT || mode == REPEAT_MODE_REPEAT_Y);
+        if (mRepeatValue.Update(repeatX, repeatY))
+        {
+            glUniform1i(mRepeatXSlot, repeatX);
+            glUniform1i(mRepeatYslot, repeatY);
+        }
     }
 
     void SetTextureSize(float width, float height)
     {
-        glUniform2f(mTextureSizeSlot, width, height);
+        if (mTextureSizeValue.Update(width, height))
+        {
+            glUniform2f(mTextureSizeSlot, width, height);
+        }
     }
     
     void SetPatternAlpha(float patternAlpha)
     {
-        glUniform1f(mPatternAlphaSlot, patternAlpha);
+        if (mPatternAlphaValue.Update(patternAlpha))
+        {
+            glUniform1f(mPatternAlphaSlot, patternAlpha);
+        }
     }
 
     GLint GetTextureSamplerSlot() { return mTextureSamplerSlot; }
@@ -238,87 +372,73 @@ protected:
     GLuint mRepeatYslot;
     GLuint mTextureSizeSlot;
     GLuint mPatternAlphaSlot;
+
+    GUniformShadow<GLint, 1> mTextureSamplerValue;
+    GUniformShadow<GLint, 2> mRepeatValue;
+    GUniformShadow<GLfloat, 2> mTextureSizeValue;
+    GUniformShadow<GLfloat, 1> mPatternAlphaValue;
 };
 
 
 class GradientShader : public GShader
 {
 public:
+    static const int MAX_STOP_NUM = 5;
+    // unit the *_LUT programs sample the baked stop list from
+    static const int LOOKUP_TEXTURE_UNIT = 1;
+
     GradientShader(const char *name, const char *vertexShaderSrc, const char *fragmentShaderSrc);
     
     void SetHasTexture(bool value)
     {
-        if (mHasTextureFlag != value)
+        if (mHasTextureValue.Update(value))
         {
-            mHasTextureFlag = value;
             glUniform1i(mHasTextureSlot, value);
-            
         }
     }
     
-    void RestoreShaderState() { SetHasTexture(mHasTextureFlag); }
-    
-    void SetColorStopCount(int count) { glUniform1i(mStopCountSlot, count); }
-    
-    void SetColorStop(float *color, float stop, int id)
+    void SetColorStopCount(int count)
     {
-        GLuint stopLoc;
-        GLuint colorLoc;
-        if (id == 0)
-        {
-            stopLoc = mStop0Slot;
-            colorLoc = mStop0ColorSlot;
-        }
-        else if (id == 1)
+        if (mStopCountValue.Update(count))
         {
-            stopLoc = mStop1Slot;
-            colorLoc = mStop1ColorSlot;
+            glUniform1i(mStopCountSlot, count);
         }
-        else if (id == 2)
-        {
-            stopLoc = mStop2Slot;
-            colorLoc = mStop2ColorSlot;
-        }
-        else if (id == 3)
+    }
+    
+    void SetColorStop(float *color, float stop, int id)
+    {
+        if (id < 0 || id >= MAX_STOP_NUM)
         {
-            stopLoc = mStop3Slot;
-            colorLoc = mStop3ColorSlot;
+            return;
         }
-        else if (id == 4)
+        if (mStopValue[id].Update(stop))
         {
-            stopLoc = mStop4Slot;
-            colorLoc = mStop4ColorSlot;
+            glUniform1f(mStopSlot[id], stop);
         }
-        else
+        if (mStopColorValue[id].Update(color))
         {
-            return;
+            glUniform4f(mStopColorSlot[id], color[0], color[1], color[2], color[3]);
         }
-        
-        glUniform1f(stopLoc, stop);
-        glUniform4f(colorLoc, color[0], color[1], color[2], color[3]);
     }
+
+    bool HasLookupTexture() const { return mGradientSamplerSlot >= 0; }
     
 protected:
     void calculateAttributesLocations();
     
     GLuint mTextureSamplerSlot;
+    GLint mGradientSamplerSlot;
     
     GLuint mStopCountSlot;
-    
-    GLuint mStop0ColorSlot;
-    GLuint mStop1ColorSlot;
-    GLuint mStop2ColorSlot;
-    GLuint mStop3ColorSlot;
-    GLuint mStop4ColorSlot;
-    
-    GLuint mStop0Slot;
-    GLuint mStop1Slot;
-    GLuint mStop2Slot;
-    GLuint mStop3Slot;
-    GLuint mStop4Slot;
+    GLuint mStopColorSlot[MAX_STOP_NUM];
+    GLuint mStopSlot[MAX_STOP_NUM];
     
     GLuint mHasTextureSlot;
-    bool mHasTextureFlag;
+
+    GUniformShadow<GLint, 1> mHasTextureValue;
+    GUniformShadow<GLint, 1> mStopCountValue;
+    GUniformShadow<GLfloat, 1> mStopValue[MAX_STOP_NUM];
+    GUniformShadow<GLfloat, 4> mStopColorValue[MAX_STOP_NUM];
 };
 
 class LinearGradientShader : public GradientShader
@@ -329,14 +449,19 @@ public:
 
     void SetRange(const GPoint &start, const GPoint &end)
     {
-        glUniform2f(mRangeStartSlot, start.x, start.y);
-        glUniform2f(mRangeEndSlot, end.x, end.y);
+        if (mRangeValue.Update(start.x, start.y, end.x, end.y))
+        {
+            glUniform2f(mRangeStartSlot, start.x, start.y);
+            glUniform2f(mRangeEndSlot, end.x, end.y);
+        }
     }
 
 protected:
     void calculateAttributesLocations();
     GLuint mRangeStartSlot;
     GLuint mRangeEndSlot;
+
+    GUniformShadow<GLfloat, 4> mRangeValue;
 };
 
 class RadialGradientShader : public GradientShader
@@ -347,14 +472,19 @@ public:
 
     void SetRange(const float *start, const float *end)
     {
-        glUniform3f(mStartSlot, start[0], start[1], start[2]);
-        glUniform3f(mEndSlot, end[0], end[1], end[2]);
+        GLfloat range[6] = {start[0], start[1], start[2], end[0], end[1], end[2]};
+        if (mRangeValue.Update(range))
+        {
+            glUniform3f(mStartSlot, start[0], start[1], start[2]);
+            glUniform3f(mEndSlot, end[0], end[1], end[2]);
+        }
     }
 protected:
     void calculateAttributesLocations();
     GLuint mStartSlot;
     GLuint mEndSlot;
 
+    GUniformShadow<GLfloat, 6> mRangeValue;
 };
 
 #endif /* GCANVAS_GSHADER_H */
@@ -8,23 +8,26 @@
  */
 #include "GShaderManager.h"
 #include "GShader.h"
+#include "GGLStateCache.h"
 #include "shaders/default.glsl"
 #include "shaders/grad.glsl"
 #include "shaders/pattern.glsl"
 #include "shaders/radiation.glsl"
 #include "shaders/texture.glsl"
 #include "shaders/shadow.glsl"
-
-#ifdef ANDROID
-#include "GPreCompiledShaders.h"
-bool g_use_pre_compile = false;
-#endif
+#include "GGL.h"
+#include "../support/Log.h"
 
 
 GShaderManager *GShaderManager::mShaderManager = nullptr;
 
+// guards the singleton and the share group registry
+static std::mutex sShareGroupMutex;
+static std::map< const void *, GShaderManager * > sShareGroupManagers;
+
 GShaderManager *GShaderManager::getSingleton()
 {
+    std::lock_guard< std::mutex > lock(sShareGroupMutex);
     if (nullptr == mShaderManager)
     {
         mShaderManager = new GShaderManager();
@@ -41,6 +44,43 @@ void GShaderManager::release()
     }
 }
 
+GShaderManager *GShaderManager::acquireForShareGroup(const void *shareGroup)
+{
+    if (shareGroup == nullptr)
+    {
+        return getSingleton();
+    }
+
+    std::lock_guard< std::mutex > lock(sShareGroupMutex);
+    GShaderManager *&manager = sShareGroupManagers[shareGroup];
+    if (manager == nullptr)
+    {
+        manager = new GShaderManager();
+        manager->mShareGroup = shareGroup;
+    }
+    ++manager->mRefCount;
+    return manager;
+}
+
+void GShaderManager::releaseForShareGroup(GShaderManager *manager)
+{
+    if (manager == nullptr || manager == mShaderManager)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard< std::mutex > lock(sShareGroupMutex);
+        if (--manager->mRefCount > 0)
+        {
+            return;
+        }
+        sShareGroupManagers.erase(manager->mShareGroup);
+    }
+    // deletes the programs, a context of the group must still be current
+    delete manager;
+}
+
 
 void GShaderManager::addProgram(const std::string &key, GShader *program)
 {
@@ -60,49 +100,225 @@ void GShaderManager::addProgram(const std::string &key, GShader *program)
 
 GShader *GShaderManager::programForKey(const std::string &key)
 {
+    if (mAsyncActive.load(std::memory_order_acquire))
+    {
+        collectAsyncPrograms(key);
+    }
+
     std::map< std::string, GShader * >::iterator iter =
         mProgramCaches.find(key);
     if (iter == mProgramCaches.end())
     {
-        return nullptr;
+        return compileProgram(key);
     }
 
     return iter->second;
 }
 
-GShaderManager::GShaderManager()
+void GShaderManager::registerProgram(const std::string &key, const char *vertexSrc,
+                                     const char *fragmentSrc, ShaderCreator creator)
 {
-#ifdef ANDROID
-    if (g_use_pre_compile)
+    ProgramSource source = {vertexSrc, fragmentSrc, creator};
+    mProgramSources[key] = source;
+}
+
+bool GShaderManager::isCompiled(const std::string &key)
+{
+    return mProgramCaches.find(key) != mProgramCaches.end();
+}
+
+GShader *GShaderManager::compileProgram(const std::string &key)
+{
+    std::map< std::string, ProgramSource >::iterator iter =
+        mProgramSources.find(key);
+    if (iter == mProgramSources.end())
     {
-        const char *extString = (const char *)glGetString(GL_EXTENSIONS);
-        bool isPreCompileSupported =
-            (strstr(extString, "GL_OES_get_program_binary") != 0);
+        return nullptr;
+    }
+
+    // the constructors bind the new program to set its uniforms; compiles
+    // happen lazily mid frame, while the batch of the bound one is pending
+    GGLStateCache *cache = GGLStateCache::Current();
+    GLuint boundProgram = cache->BoundProgram();
 
-        if (isPreCompileSupported)
+    const ProgramSource &source = iter->second;
+    GShader *program =
+        source.creator(key.c_str(), source.vertexSrc, source.fragmentSrc);
+    cache->UseProgram(boundProgram);
+    addProgram(key, program);
+    return program;
+}
+
+void GShaderManager::warmUp(const std::vector< std::string > &keys)
+{
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        programForKey(keys[i]);
+    }
+}
+
+void GShaderManager::collectAsyncPrograms(const std::string &key)
+{
+    std::unique_lock< std::mutex > lock(mAsyncMutex);
+    mAsyncCondition.wait(lock, [&] {
+        return mAsyncPending.find(key) == mAsyncPending.end();
+    });
+
+    std::map< std::string, GShader * >::iterator iter = mAsyncPrograms.begin();
+    for (; iter != mAsyncPrograms.end(); ++iter)
+    {
+        if (isCompiled(iter->first))
         {
-            GPreCompiledShaders::getInstance()->SetSupportPreCompiledShaders(
-                    true);
+            delete iter->second;
+        }
+        else
+        {
+            addProgram(iter->first, iter->second);
         }
     }
-#endif
+    mAsyncPrograms.clear();
 
-    loadDefaultShaders();
+    if (mAsyncPending.empty())
+    {
+        lock.unlock();
+        if (mAsyncWorker.joinable())
+        {
+            mAsyncWorker.join();
+        }
+        mAsyncActive.store(false, std::memory_order_release);
+    }
+}
 
-#ifdef ANDROID
-    if (g_use_pre_compile)
+#if defined(ANDROID) || defined(__linux__)
+
+bool GShaderManager::precompileAsync(const std::vector< std::string > &keys)
+{
+    if (mAsyncActive.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext sharedContext = eglGetCurrentContext();
+    if (display == EGL_NO_DISPLAY || sharedContext == EGL_NO_CONTEXT)
+    {
+        return false;
+    }
+
+    std::vector< std::pair< std::string, ProgramSource > > sources;
+    for (size_t i = 0; i < keys.size(); ++i)
     {
-        if (GPreCompiledShaders::getInstance()
-                ->GetSupportPreCompiledShaders())
+        std::map< std::string, ProgramSource >::iterator iter =
+            mProgramSources.find(keys[i]);
+        if (iter != mProgramSources.end() && !isCompiled(keys[i]))
         {
-            GPreCompiledShaders::getInstance()->SavePreCompiledShaders();
+            sources.push_back(*iter);
         }
     }
+    if (sources.empty())
+    {
+        return true;
+    }
+
+    EGLint configId = 0;
+    eglQueryContext(display, sharedContext, EGL_CONFIG_ID, &configId);
+    EGLint configAttribs[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) ||
+        configCount < 1)
+    {
+        return false;
+    }
+
+    // sharing needs the client version of the shared context
+    EGLint clientVersion = 2;
+    eglQueryContext(display, sharedContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion);
+    EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, sharedContext, contextAttribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        LOG_W("precompileAsync: eglCreateContext failed 0x%x", eglGetError());
+        return false;
+    }
+    // no surface is needed to compile, but not every driver allows that
+    EGLint surfaceAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+
+    {
+        std::lock_guard< std::mutex > lock(mAsyncMutex);
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            mAsyncPending.insert(sources[i].first);
+        }
+    }
+    mAsyncActive.store(true, std::memory_order_release);
+
+    mAsyncWorker = std::thread([this, display, context, surface, sources]() {
+        bool current = eglMakeCurrent(display, surface, surface, context) == EGL_TRUE;
+        if (!current)
+        {
+            LOG_W("precompileAsync: eglMakeCurrent failed 0x%x", eglGetError());
+        }
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            const std::string &key = sources[i].first;
+            const ProgramSource &source = sources[i].second;
+            GShader *program = nullptr;
+            if (current)
+            {
+                program = source.creator(key.c_str(), source.vertexSrc, source.fragmentSrc);
+                // the program must be complete before another context uses it
+                glFinish();
+            }
+
+            std::lock_guard< std::mutex > lock(mAsyncMutex);
+            if (program != nullptr)
+            {
+                mAsyncPrograms[key] = program;
+            }
+            mAsyncPending.erase(key);
+            mAsyncCondition.notify_all();
+        }
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (surface != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(display, surface);
+        }
+        eglDestroyContext(display, context);
+        eglReleaseThread();
+    });
+    return true;
+}
+
+#else
+
+bool GShaderManager::precompileAsync(const std::vector< std::string > &keys)
+{
+    return false;
+}
+
 #endif
+
+GShaderManager::GShaderManager()
+        : mShareGroup(nullptr), mRefCount(0), mAsyncActive(false)
+{
+    loadDefaultShaders();
 }
 
 GShaderManager::~GShaderManager()
 {
+    if (mAsyncWorker.joinable())
+    {
+        mAsyncWorker.join();
+    }
+    for (auto &async : mAsyncPrograms)
+    {
+        delete async.second;
+    }
+    mAsyncPrograms.clear();
+
     std::map< std::string, GShader * >::iterator iter =
         mProgramCaches.begin();
     for (; iter != mProgramCaches.end(); ++iter)
@@ -112,29 +328,33 @@ GShaderManager::~GShaderManager()
     }
 }
 
-void GShaderManager::loadDefaultShaders()
+template< class T >
+static GShader *CreateShader(const char *name, const char *vertexSrc,
+                             const char *fragmentSrc)
 {
-    GShader *program =
-        new DefaultShader(DEFAULT_SHADER, DEFAULT_SHADER_VS, DEFAULT_SHADER_PS);
-    addProgram(DEFAULT_SHADER, program);
-
-    program =
-        new TextureShader(TEXTURE_SHADER, TEXTURE_SHADER_VS, TEXTURE_SHADER_PS);
-    addProgram(TEXTURE_SHADER, program);
-
-    program =
-            new ShadowShader(SHADOW_SHADER, SHADOW_SHADER_VS, SHADOW_SHADER_PS);
-    addProgram(SHADOW_SHADER, program);
-
-    program =
-            new PatternShader(PATTERN_SHADER, PATTERN_SHADER_VS, PATTERN_SHADER_PS);
-    addProgram(PATTERN_SHADER, program);
-
-    program = new LinearGradientShader(LINEAR_SHADER, LINEAR_SHADER_VS,
-                                       LINEAR_SHADER_PS);
-    addProgram(LINEAR_SHADER, program);
+    return new T(name, vertexSrc, fragmentSrc);
+}
 
-    program = new RadialGradientShader(RADIAL_SHADER, RADIAL_SHADER_VS,
-                                       RADIAL_SHADER_PS);
-    addProgram(RADIAL_SHADER, program);
+void GShaderManager::loadDefaultShaders()
+{
+    registerProgram(DEFAULT_SHADER, DEFAULT_SHADER_VS, DEFAULT_SHADER_PS,
+                    CreateShader< DefaultShader >);
+    registerProgram(TEXTURE_SHADER, TEXTURE_SHADER_VS, TEXTURE_SHADER_PS,
+                    CreateShader< TextureShader >);
+    registerProgram(TEXTURE_ALPHA_SPLIT_SHADER, TEXTURE_SHADER_VS,
+                    TEXTURE_ALPHA_SPLIT_SHADER_PS, CreateShader< TextureShader >);
+    registerProgram(SPRITE_SHADER, SPRITE_SHADER_VS, TEXTURE_SHADER_PS,
+                    CreateShader< SpriteShader >);
+    registerProgram(SHADOW_SHADER, SHADOW_SHADER_VS, SHADOW_SHADER_PS,
+                    CreateShader< ShadowShader >);
+    registerProgram(PATTERN_SHADER, PATTERN_SHADER_VS, PATTERN_SHADER_PS,
+                    CreateShader< PatternShader >);
+    registerProgram(LINEAR_SHADER, LINEAR_SHADER_VS, LINEAR_SHADER_PS,
+                    CreateShader< LinearGradientShader >);
+    registerProgram(RADIAL_SHADER, RADIAL_SHADER_VS, RADIAL_SHADER_PS,
+                    CreateShader< RadialGradientShader >);
+    registerProgram(LINEAR_LUT_SHADER, LINEAR_SHADER_VS, LINEAR_LUT_SHADER_PS,
+                    CreateShader< LinearGradientShader >);
+    registerProgram(RADIAL_LUT_SHADER, RADIAL_SHADER_VS, RADIAL_LUT_SHADER_PS,
+                    CreateShader< RadialGradientShader >);
 }
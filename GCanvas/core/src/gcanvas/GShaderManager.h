@@ -9,14 +9,36 @@
 #ifndef GCANVAS_GSHADERMANAGER_H
 #define GCANVAS_GSHADERMANAGER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 class GShader;
 
+/**
+ * Program objects belong to a GL share group, so there is one manager per
+ * group: acquireForShareGroup() creates it for the first context of the
+ * group and releaseForShareGroup() deletes it, with its programs, when the
+ * last one lets go. The process wide getSingleton() manager stays for
+ * platforms without a share group handle.
+ *
+ * Programs are registered with their sources up front and compiled the
+ * first time programForKey() asks for them. warmUp() compiles a list right
+ * away, precompileAsync() compiles it on a worker thread with an EGL
+ * context shared with the current one, of the same client version;
+ * programForKey() waits for a program that is still being compiled there.
+ * GCanvasContext starts one when it sets up GL.
+ */
 class GShaderManager
 {
 public:
+    typedef GShader *(*ShaderCreator)(const char *name, const char *vertexSrc,
+                                      const char *fragmentSrc);
 
     // Android depend constructor, set it public
     GShaderManager();
@@ -25,14 +47,47 @@ public:
     static GShaderManager *getSingleton();
     static void release();
 
+    // nullptr maps to the singleton, which is not reference counted
+    static GShaderManager *acquireForShareGroup(const void *shareGroup);
+    static void releaseForShareGroup(GShaderManager *manager);
+
     void addProgram(const std::string &key, GShader *program);
     GShader *programForKey(const std::string &key);
 
+    void registerProgram(const std::string &key, const char *vertexSrc,
+                         const char *fragmentSrc, ShaderCreator creator);
+    bool isCompiled(const std::string &key);
+
+    void warmUp(const std::vector< std::string > &keys);
+    // false when there is no current EGL context to share or a batch is running
+    bool precompileAsync(const std::vector< std::string > &keys);
+
 private:
+    struct ProgramSource
+    {
+        const char *vertexSrc;
+        const char *fragmentSrc;
+        ShaderCreator creator;
+    };
+
     void loadDefaultShaders();
+    GShader *compileProgram(const std::string &key);
+    void collectAsyncPrograms(const std::string &key);
 
     std::map< std::string, GShader * > mProgramCaches;
+    std::map< std::string, ProgramSource > mProgramSources;
     static GShaderManager *mShaderManager;
+
+    const void *mShareGroup;
+    int mRefCount;   // guarded by the share group registry lock
+
+    // async precompile, guarded by mAsyncMutex
+    std::mutex mAsyncMutex;
+    std::condition_variable mAsyncCondition;
+    std::set< std::string > mAsyncPending;
+    std::map< std::string, GShader * > mAsyncPrograms;
+    std::thread mAsyncWorker;
+    std::atomic< bool > mAsyncActive;
 };
 
 #endif /* GCANVAS_GSHADERMANAGER_H */
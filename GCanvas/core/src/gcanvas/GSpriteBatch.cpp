@@ -0,0 +1,147 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GSpriteBatch.h"
+#include "GShader.h"
+#include "GFrameProfiler.h"
+#include "../support/Log.h"
+
+#include <string.h>
+
+GSpriteBatch::GSpriteBatch()
+        : mSupport(-1), mDrawArraysInstanced(nullptr), mVertexAttribDivisor(nullptr)
+{
+}
+
+bool GSpriteBatch::IsSupported()
+{
+    if (mSupport >= 0)
+    {
+        return mSupport == 1;
+    }
+    mSupport = 0;
+
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    const char *version = (const char *)glGetString(GL_VERSION);
+    if (extensions == nullptr || version == nullptr)
+    {
+        // no current context, try again next time
+        mSupport = -1;
+        return false;
+    }
+
+#if defined(ANDROID) || defined(__linux__)
+    if (strstr(extensions, "GL_ANGLE_instanced_arrays") != nullptr)
+    {
+        mDrawArraysInstanced = (GDrawArraysInstancedFunc)eglGetProcAddress("glDrawArraysInstancedANGLE");
+        mVertexAttribDivisor = (GVertexAttribDivisorFunc)eglGetProcAddress("glVertexAttribDivisorANGLE");
+    }
+    if ((mDrawArraysInstanced == nullptr || mVertexAttribDivisor == nullptr) &&
+        strstr(extensions, "GL_EXT_instanced_arrays") != nullptr)
+    {
+        mDrawArraysInstanced = (GDrawArraysInstancedFunc)eglGetProcAddress("glDrawArraysInstancedEXT");
+        mVertexAttribDivisor = (GVertexAttribDivisorFunc)eglGetProcAddress("glVertexAttribDivisorEXT");
+    }
+    if ((mDrawArraysInstanced == nullptr || mVertexAttribDivisor == nullptr) &&
+        strncmp(version, "OpenGL ES 3", 11) == 0)
+    {
+        mDrawArraysInstanced = (GDrawArraysInstancedFunc)eglGetProcAddress("glDrawArraysInstanced");
+        mVertexAttribDivisor = (GVertexAttribDivisorFunc)eglGetProcAddress("glVertexAttribDivisor");
+    }
+#elif defined(IOS)
+    if (strstr(extensions, "GL_EXT_instanced_arrays") != nullptr)
+    {
+        mDrawArraysInstanced = glDrawArraysInstancedEXT;
+        mVertexAttribDivisor = glVertexAttribDivisorEXT;
+    }
+#endif
+
+    if (mDrawArraysInstanced == nullptr || mVertexAttribDivisor == nullptr)
+    {
+        LOG_I("GSpriteBatch: instanced arrays not supported");
+        return false;
+    }
+    mSupport = 1;
+    return true;
+}
+
+void GSpriteBatch::Push(const GTransform &t, float tx, float ty, float tw, float th,
+                        const GColorRGBA &color)
+{
+    if (mSprites.capacity() == 0)
+    {
+        mSprites.reserve(MAX_SPRITES);
+    }
+
+    Sprite sprite;
+    sprite.transformX[0] = t.a;
+    sprite.transformX[1] = t.c;
+    sprite.transformX[2] = t.tx;
+    sprite.transformY[0] = t.b;
+    sprite.transformY[1] = t.d;
+    sprite.transformY[2] = t.ty;
+    sprite.texRect[0] = tx;
+    sprite.texRect[1] = ty;
+    sprite.texRect[2] = tw;
+    sprite.texRect[3] = th;
+    sprite.color = color;
+    mSprites.push_back(sprite);
+}
+
+int GSpriteBatch::WriteVertices(GVertex *vertices) const
+{
+    // corners in the order PushRectangle emits them
+    static const GLfloat corners[6][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 0}, {0, 1}, {1, 1}};
+
+    GVertex *vb = vertices;
+    for (size_t i = 0; i < mSprites.size(); ++i)
+    {
+        const Sprite &sprite = mSprites[i];
+        for (int j = 0; j < 6; ++j)
+        {
+            GLfloat u = corners[j][0];
+            GLfloat v = corners[j][1];
+            vb->pos.x = sprite.transformX[0] * u + sprite.transformX[1] * v + sprite.transformX[2];
+            vb->pos.y = sprite.transformY[0] * u + sprite.transformY[1] * v + sprite.transformY[2];
+            vb->uv.x = sprite.texRect[0] + u * sprite.texRect[2];
+            vb->uv.y = sprite.texRect[1] + v * sprite.texRect[3];
+            vb->color = sprite.color;
+            ++vb;
+        }
+    }
+    return (int)(vb - vertices);
+}
+
+void GSpriteBatch::Draw(SpriteShader *shader, GVertexArrayCache &arrays)
+{
+    if (mSprites.empty() || !IsSupported())
+    {
+        mSprites.clear();
+        return;
+    }
+
+    static const GLfloat quad[8] = {0, 0, 1, 0, 0, 1, 1, 1};
+
+    // the storage was reserved for MAX_SPRITES, a VAO keeps pointing at it
+    const GLfloat *base = mSprites[0].transformX;
+    const GVertexAttrib attribs[5] = {
+        {shader->GetPositionSlot(), 2, 0, quad, 0},
+        {shader->GetTransformXSlot(), 3, sizeof(Sprite), base, 1},
+        {shader->GetTransformYSlot(), 3, sizeof(Sprite), base + 3, 1},
+        {shader->GetTexRectSlot(), 4, sizeof(Sprite), base + 6, 1},
+        {shader->GetColorSlot(), 4, sizeof(Sprite), base + 10, 1}
+    };
+    arrays.SetAttribDivisorFunc(mVertexAttribDivisor);
+    arrays.Bind(this, attribs, 5);
+
+    mDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)mSprites.size());
+    GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+    GFRAME_COUNT(FRAME_COUNTER_VERTICES, mSprites.size() * 4);
+    mSprites.clear();
+}
@@ -0,0 +1,86 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GSPRITEBATCH_H
+#define GCANVAS_GSPRITEBATCH_H
+
+#include "GGL.h"
+#include "GPoint.h"
+#include "GTransform.h"
+#include "GVertexArrayCache.h"
+
+#include <vector>
+
+class SpriteShader;
+
+// same signature for the ANGLE, EXT and ES 3 core entry points
+typedef void (*GDrawArraysInstancedFunc)(GLenum mode, GLint first, GLsizei count,
+                                         GLsizei primcount);
+
+/**
+ * Images of one texture drawn with a single instanced draw call instead of
+ * six vertices each: every sprite maps the unit quad into place with its
+ * own affine transform and carries its texture rect and color.
+ *
+ * Needs GL_ANGLE_instanced_arrays, GL_EXT_instanced_arrays or ES 3, the
+ * context keeps pushing vertices when IsSupported() is false. Instances
+ * are read from client memory like the context's vertex buffer, so no
+ * buffer object may be bound to GL_ARRAY_BUFFER when drawing.
+ */
+class GSpriteBatch
+{
+public:
+    static const int MAX_SPRITES = 4096;
+    // fewer sprites are cheaper as vertices than a program switch
+    static const int MIN_INSTANCED_SPRITES = 16;
+
+    GSpriteBatch();
+
+    // needs a current context the first time
+    bool IsSupported();
+
+    // corner (u, v) of the unit quad goes to t applied to (u, v), its
+    // texture coordinate to (tx + u * tw, ty + v * th)
+    void Push(const GTransform &t, float tx, float ty, float tw, float th,
+              const GColorRGBA &color);
+
+    int Count() const { return (int)mSprites.size(); }
+
+    bool Empty() const { return mSprites.empty(); }
+
+    bool Full() const { return (int)mSprites.size() >= MAX_SPRITES; }
+
+    // six vertices per sprite in the order of PushRectangle, returns the
+    // number written; the caller makes room for Count() * 6
+    int WriteVertices(GVertex *vertices) const;
+
+    // draws all sprites with the bound program and empties the batch, the
+    // layout is left bound in arrays
+    void Draw(SpriteShader *shader, GVertexArrayCache &arrays);
+
+    GVertexAttribDivisorFunc AttribDivisorFunc() const { return mVertexAttribDivisor; }
+
+    void Clear() { mSprites.clear(); }
+
+private:
+    struct Sprite
+    {
+        GLfloat transformX[3];   // a, c, tx
+        GLfloat transformY[3];   // b, d, ty
+        GLfloat texRect[4];
+        GColorRGBA color;
+    };
+
+    std::vector<Sprite> mSprites;
+
+    int mSupport;   // -1 unknown, 0 no, 1 yes
+    GDrawArraysInstancedFunc mDrawArraysInstanced;
+    GVertexAttribDivisorFunc mVertexAttribDivisor;
+};
+
+#endif /* GCANVAS_GSPRITEBATCH_H */
@@ -8,8 +8,30 @@
  */
 
 #include "GTexture.h"
+#include "GFrameProfiler.h"
 #include "../support/Log.h"
 #include "../support/Util.h"
+#include "../support/GLUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_R11_EAC
+#define GL_COMPRESSED_R11_EAC                        0x9270
+#define GL_COMPRESSED_SIGNED_R11_EAC                 0x9271
+#define GL_COMPRESSED_RG11_EAC                       0x9272
+#define GL_COMPRESSED_SIGNED_RG11_EAC                0x9273
+#define GL_COMPRESSED_RGB8_ETC2                      0x9274
+#define GL_COMPRESSED_SRGB8_ETC2                     0x9275
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2  0x9276
+#define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9277
+#define GL_COMPRESSED_RGBA8_ETC2_EAC                 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC          0x9279
+#endif
 
 
 GLubyte *(*GTexture::loadPixelCallback)(const char *filePath, unsigned int *w,
@@ -46,13 +68,13 @@ GTexture::GTexture(const char *path)
 
 GTexture::~GTexture()
 {
-    glDeleteTextures(1, &mTextureID);
+    GGLStateCache::Current()->DeleteTextures(1, &mTextureID);
     mFormat = mTextureID = mWidth = mHeight = 0;
 }
 
-void GTexture::Bind() const { glBindTexture(GL_TEXTURE_2D, mTextureID); }
+void GTexture::Bind() const { GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mTextureID); }
 
-void GTexture::Unbind() const { glBindTexture(GL_TEXTURE_2D, 0); }
+void GTexture::Unbind() const { GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, 0); }
 
 void GTexture::SetLoadPixelCallback(GLubyte *(*callback)(const char *filePath,
                                                           unsigned int *w,
@@ -83,7 +105,7 @@ void GTexture::CreateTexture(GLubyte *pixels, std::vector<GCanvasLog> *errVec)
     // Release previous texture if we had one
     if (mTextureID)
     {
-        glDeleteTextures(1, &mTextureID);
+        GGLStateCache::Current()->DeleteTextures(1, &mTextureID);
         mTextureID = 0;
     }
 
@@ -101,7 +123,7 @@ void GTexture::CreateTexture(GLubyte *pixels, std::vector<GCanvasLog> *errVec)
     }
     
     int boundTexture = 0;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+    boundTexture = (GLint) GGLStateCache::Current()->BoundTexture();
 
     glGenTextures(1, &mTextureID);
     if (mTextureID <= 0 && errVec) {
@@ -109,7 +131,7 @@ void GTexture::CreateTexture(GLubyte *pixels, std::vector<GCanvasLog> *errVec)
         fillLogInfo(log, "gen_texture_fail", "<function:%s, glGetError:%x>", __FUNCTION__, glGetError());
         errVec->push_back(log);
     }
-    glBindTexture(GL_TEXTURE_2D, mTextureID);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mTextureID);
     glerror = glGetError();
     if (glerror && errVec && mWidth > 0 && mHeight > 0) {
         GCanvasLog log;
@@ -120,6 +142,11 @@ void GTexture::CreateTexture(GLubyte *pixels, std::vector<GCanvasLog> *errVec)
 
     glTexImage2D(GL_TEXTURE_2D, 0, mFormat, (GLsizei)mWidth,
                  (GLsizei)mHeight, 0, mFormat, GL_UNSIGNED_BYTE, pixels);
+    if (pixels != nullptr) {
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                     gcanvas::TexImageSize(mWidth, mHeight, mFormat, GL_UNSIGNED_BYTE,
+                                           gcanvas::UnpackAlignment()));
+    }
 
     glerror = glGetError();
     if (glerror && errVec) {
@@ -140,7 +167,7 @@ void GTexture::CreateTexture(GLubyte *pixels, std::vector<GCanvasLog> *errVec)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
 
-    glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
     glerror = glGetError();
     if (glerror && errVec) {
         GCanvasLog log;
@@ -158,16 +185,19 @@ void GTexture::UpdateTexture(GLubyte *pixels, int x, int y, int w, int h)
     }
 
     int boundTexture = 0;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+    boundTexture = (GLint) GGLStateCache::Current()->BoundTexture();
     if (boundTexture != (int)mTextureID)
     {
-        glBindTexture(GL_TEXTURE_2D, mTextureID);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, mTextureID);
     }
     glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, mFormat, GL_UNSIGNED_BYTE,
                     pixels);
+    GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                 gcanvas::TexImageSize(w, h, mFormat, GL_UNSIGNED_BYTE,
+                                       gcanvas::UnpackAlignment()));
     if (boundTexture != (int)mTextureID)
     {
-        glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
     }
     glFlush();
 }
@@ -204,10 +234,18 @@ void TextureGroup::Clear()
     for (unsigned int i = 0; i < mVecTexture.size(); ++i)
     {
         GLuint glID = (GLuint)mVecTexture[i]->GetGlID();
-        glDeleteTextures(1, &glID);
+        GGLStateCache::Current()->DeleteTextures(1, &glID);
         delete mVecTexture[i];
     }
     mVecTexture.clear();
+
+    for (unsigned int i = 0; i < mLevels.size(); ++i)
+    {
+        GLuint glID = (GLuint)mLevels[i]->GetGlID();
+        GGLStateCache::Current()->DeleteTextures(1, &glID);
+        delete mLevels[i];
+    }
+    mLevels.clear();
 }
 void TextureGroup::Append(int glID, int width, int height)
 {
@@ -224,7 +262,59 @@ const Texture *TextureGroup::Get(int id) const
     return nullptr;
 }
 
-TextureMgr::TextureMgr(){};
+int TextureGroup::TileColumns() const
+{
+    if (mTileWidth <= 0)
+    {
+        return 1;
+    }
+    return (mSrcWidth - 1) / mTileWidth + 1;
+}
+
+int TextureGroup::TileRows() const
+{
+    if (mTileHeight <= 0)
+    {
+        return 1;
+    }
+    return (mSrcHeight - 1) / mTileHeight + 1;
+}
+
+int TextureGroup::TileIndex(int col, int row) const
+{
+    if (col < 0 || row < 0 || col >= TileColumns() || row >= TileRows())
+    {
+        return -1;
+    }
+    int index = row * TileColumns() + col;
+    return index < (int)mVecTexture.size() ? index : -1;
+}
+
+unsigned char *(*TextureMgr::decodeImageCallback)(const unsigned char *buffer,
+                                                  unsigned int size,
+                                                  unsigned int *w,
+                                                  unsigned int *h) = nullptr;
+
+TextureMgr::TextureMgr()
+    : mMipmapEnabled(false), mMipmapThreshold(0.5f), mNpotMipmapSupport(-1){};
+
+unsigned char *TextureMgr::DecodeImage(const unsigned char *buffer, unsigned int size,
+                                       unsigned int *w, unsigned int *h)
+{
+    if (decodeImageCallback == nullptr)
+    {
+        LOG_E("[TextureMgr::DecodeImage] no image decoder registered");
+        return nullptr;
+    }
+    return decodeImageCallback(buffer, size, w, h);
+}
+
+void TextureMgr::SetDecodeImageCallback(unsigned char *(*callback)(
+    const unsigned char *buffer, unsigned int size, unsigned int *w,
+    unsigned int *h))
+{
+    decodeImageCallback = callback;
+}
 
 void TextureMgr::Append(int id, int glID, int width, int height)
 {
@@ -232,6 +322,10 @@ void TextureMgr::Append(int id, int glID, int width, int height)
     TextureGroup &textureGroup = mTextureGroupPool[id];
     textureGroup.Clear();
     textureGroup.Append(glID, width, height);
+    textureGroup.mSrcWidth = textureGroup.mTileWidth = width;
+    textureGroup.mSrcHeight = textureGroup.mTileHeight = height;
+    textureGroup.mAlphaSplit = false;
+    textureGroup.mOwned = false;
 }
 void TextureMgr::Remove(int id) { mTextureGroupPool.erase(id); }
 void TextureMgr::Clear() { mTextureGroupPool.clear(); }
@@ -250,78 +344,463 @@ const TextureGroup *TextureMgr::Get(int id) const
 bool TextureMgr::AppendPng(const unsigned char *buffer, unsigned int size, int textureGroupId,
                            unsigned int *widthPtr, unsigned int *heightPtr)
 {
-    return false;
-//    unsigned int srcWidth = 0;
-//    unsigned int srcHeight = 0;
-//    unsigned int destWidth = 0;
-//    unsigned int destHeight = 0;
-//
-//    bool success = false;
-//    unsigned char *srcPixels = nullptr;
-//    int error = PngLoader::Instance().DecodePng(
-//        buffer, size, &srcPixels, &srcWidth, &srcHeight);
-//    if (error)
-//    {
-//        LOG_E("[TextureMgr::AppendPng] error %d", error);
-//    }
-//    else
-//    {
-//        TextureGroup &textureGroup = mTextureGroupPool[textureGroupId];
-//        textureGroup.Clear();
-//
-//        GLint glMax;
-//        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glMax);
-//        unsigned int maxTextureSize = (unsigned int)glMax;
-//
-//        *widthPtr = srcWidth;
-//        *heightPtr = srcHeight;
-//        destWidth = std::min(srcWidth, maxTextureSize);
-//        destHeight = std::min(srcHeight, maxTextureSize);
-//
-//        textureGroup.mSrcWidth = srcWidth;
-//        textureGroup.mSrcHeight = srcHeight;
-//        textureGroup.mTileWidth = destWidth;
-//        textureGroup.mTileHeight = destHeight;
-//
-//        if (srcWidth <= maxTextureSize)
-//        {
-//            for (unsigned int y = 0; y < srcHeight; y += destHeight)
-//            {
-//                int h = std::min(srcHeight - y, destHeight);
-//
-//                GLuint glID = CreateTexture(srcPixels + (y * 4), srcWidth, h);
-//                Texture *texture = new Texture(glID, srcWidth, h);
-//                textureGroup.mVecTexture.push_back(texture);
-//            }
-//        }
-//        else
-//        {
-//            GLubyte *destPixels = new GLubyte[4 * destWidth * destHeight];
-//
-//            for (unsigned int y = 0; y < srcHeight; y += destHeight)
-//            {
-//                int h = std::min(srcHeight - y, destHeight);
-//                for (unsigned int x = 0; x < srcWidth; x += destWidth)
-//                {
-//                    int w = std::min(srcWidth - x, destWidth);
-//
-//                    gcanvas::GetSegmentPixel(srcPixels, srcWidth, x, y, w, h,
-//                                             destPixels);
-//                    GLuint glID = CreateTexture(destPixels, w, h);
-//                    Texture *texture = new Texture(glID, w, h);
-//                    textureGroup.mVecTexture.push_back(texture);
-//                }
-//            }
-//            delete[] destPixels;
-//        }
-//
-//        success = true;
-//    }
-//
-//    if (srcPixels)
-//    {
-//        free(srcPixels);
-//    }
-//
-//    return success;
+    GCompressedImage compressed;
+    if (ParseCompressedImage(buffer, size, compressed))
+    {
+        return AppendCompressed(textureGroupId, buffer, size, false, widthPtr,
+                                heightPtr);
+    }
+
+    unsigned int srcWidth = 0;
+    unsigned int srcHeight = 0;
+    unsigned char *srcPixels = DecodeImage(buffer, size, &srcWidth, &srcHeight);
+    if (srcPixels == nullptr || srcWidth == 0 || srcHeight == 0)
+    {
+        LOG_E("[TextureMgr::AppendPng] decode fail, size %d", size);
+        delete[] srcPixels;
+        return false;
+    }
+
+    if (widthPtr) *widthPtr = srcWidth;
+    if (heightPtr) *heightPtr = srcHeight;
+
+    bool success = AppendPixels(textureGroupId, srcPixels, srcWidth, srcHeight);
+    delete[] srcPixels;
+    return success;
+}
+
+bool TextureMgr::AppendPixels(int textureGroupId, const unsigned char *pixels,
+                              unsigned int srcWidth, unsigned int srcHeight)
+{
+    if (pixels == nullptr || srcWidth == 0 || srcHeight == 0)
+    {
+        return false;
+    }
+
+    TextureGroup &textureGroup = mTextureGroupPool[textureGroupId];
+    textureGroup.Clear();
+
+    GLint glMax;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glMax);
+    unsigned int maxTextureSize = (unsigned int)glMax;
+
+    unsigned int destWidth = std::min(srcWidth, maxTextureSize);
+    unsigned int destHeight = std::min(srcHeight, maxTextureSize);
+
+    textureGroup.mSrcWidth = srcWidth;
+    textureGroup.mSrcHeight = srcHeight;
+    textureGroup.mTileWidth = destWidth;
+    textureGroup.mTileHeight = destHeight;
+    textureGroup.mAlphaSplit = false;
+    textureGroup.mOwned = true;
+
+    int boundTexture = 0;
+    boundTexture = (GLint) GGLStateCache::Current()->BoundTexture();
+
+    bool success = true;
+    if (srcWidth <= maxTextureSize)
+    {
+        // full width rows are contiguous, upload in place
+        for (unsigned int y = 0; y < srcHeight; y += destHeight)
+        {
+            unsigned int h = std::min(srcHeight - y, destHeight);
+            GLuint glID = gcanvas::PixelsBindTexture(
+                pixels + y * srcWidth * 4, GL_RGBA, srcWidth, h);
+            if (glID == (GLuint)-1)
+            {
+                success = false;
+                break;
+            }
+            textureGroup.Append(glID, srcWidth, h);
+        }
+    }
+    else
+    {
+        GLubyte *destPixels = new GLubyte[4 * destWidth * destHeight];
+
+        for (unsigned int y = 0; y < srcHeight && success; y += destHeight)
+        {
+            unsigned int h = std::min(srcHeight - y, destHeight);
+            for (unsigned int x = 0; x < srcWidth; x += destWidth)
+            {
+                unsigned int w = std::min(srcWidth - x, destWidth);
+
+                gcanvas::GetSegmentPixel(pixels, srcWidth, x, y, w, h,
+                                         destPixels);
+                GLuint glID = gcanvas::PixelsBindTexture(destPixels, GL_RGBA, w, h);
+                if (glID == (GLuint)-1)
+                {
+                    success = false;
+                    break;
+                }
+                textureGroup.Append(glID, w, h);
+            }
+        }
+        delete[] destPixels;
+    }
+
+    if (success && mMipmapEnabled && textureGroup.mVecTexture.size() == 1)
+    {
+        BuildDownsampledLevels(textureGroup, pixels, srcWidth, srcHeight);
+    }
+
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+
+    if (!success)
+    {
+        LOG_E("[TextureMgr::AppendPixels] upload fail, %dx%d", srcWidth, srcHeight);
+        mTextureGroupPool.erase(textureGroupId);
+    }
+    return success;
+}
+
+// bytes per 4x4 block, 0 for formats we do not handle
+static unsigned int CompressedBlockBytes(GLenum format)
+{
+    switch (format)
+    {
+        case GL_ETC1_RGB8_OES:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_R11_EAC:
+        case GL_COMPRESSED_SIGNED_R11_EAC:
+            return 8;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        case GL_COMPRESSED_RG11_EAC:
+        case GL_COMPRESSED_SIGNED_RG11_EAC:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+static unsigned int ReadBE16(const unsigned char *p) { return (p[0] << 8) | p[1]; }
+
+static unsigned int ReadKTX32(const unsigned char *p, bool swap)
+{
+    if (swap)
+    {
+        return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    }
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static bool ParsePKM(const unsigned char *buffer, unsigned int size,
+                     GCompressedImage &image)
+{
+    // "PKM " + version "10"/"20" + type + padded size + visible size, big endian
+    const unsigned int headerSize = 16;
+    if (size < headerSize || memcmp(buffer, "PKM ", 4) != 0)
+    {
+        return false;
+    }
+
+    static const GLenum PKM_FORMATS[] = {
+        GL_ETC1_RGB8_OES,
+        GL_COMPRESSED_RGB8_ETC2,
+        0, // old RGBA layout, not produced by current tools
+        GL_COMPRESSED_RGBA8_ETC2_EAC,
+        GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+        GL_COMPRESSED_R11_EAC,
+        GL_COMPRESSED_RG11_EAC,
+        GL_COMPRESSED_SIGNED_R11_EAC,
+        GL_COMPRESSED_SIGNED_RG11_EAC};
+
+    unsigned int type = ReadBE16(buffer + 6);
+    if (type >= sizeof(PKM_FORMATS) / sizeof(PKM_FORMATS[0]) || PKM_FORMATS[type] == 0)
+    {
+        LOG_E("[ParsePKM] unsupported type %d", type);
+        return false;
+    }
+
+    image.internalFormat = PKM_FORMATS[type];
+    unsigned int paddedWidth = ReadBE16(buffer + 8);
+    unsigned int paddedHeight = ReadBE16(buffer + 10);
+    image.width = ReadBE16(buffer + 12);
+    image.height = ReadBE16(buffer + 14);
+
+    unsigned int dataSize = (paddedWidth / 4) * (paddedHeight / 4) *
+                            CompressedBlockBytes(image.internalFormat);
+    if (image.width == 0 || image.height == 0 || dataSize == 0 ||
+        dataSize > size - headerSize)
+    {
+        LOG_E("[ParsePKM] bad header, %dx%d, size %d", image.width, image.height, size);
+        return false;
+    }
+
+    image.levelCount = 1;
+    image.levelData[0] = buffer + headerSize;
+    image.levelSize[0] = dataSize;
+    return true;
+}
+
+static bool ParseKTX(const unsigned char *buffer, unsigned int size,
+                     GCompressedImage &image)
+{
+    static const unsigned char KTX_IDENTIFIER[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    const unsigned int headerSize = 64;
+    if (size < headerSize || memcmp(buffer, KTX_IDENTIFIER, 12) != 0)
+    {
+        return false;
+    }
+
+    bool swap = ReadKTX32(buffer + 12, false) != 0x04030201;
+    if (swap && ReadKTX32(buffer + 12, true) != 0x04030201)
+    {
+        return false;
+    }
+
+    unsigned int glType = ReadKTX32(buffer + 16, swap);
+    image.internalFormat = ReadKTX32(buffer + 28, swap);
+    image.width = ReadKTX32(buffer + 36, swap);
+    image.height = ReadKTX32(buffer + 40, swap);
+    unsigned int depth = ReadKTX32(buffer + 44, swap);
+    unsigned int arrayElements = ReadKTX32(buffer + 48, swap);
+    unsigned int faces = ReadKTX32(buffer + 52, swap);
+    unsigned int levels = ReadKTX32(buffer + 56, swap);
+    unsigned int keyValueBytes = ReadKTX32(buffer + 60, swap);
+
+    // only plain compressed 2D textures
+    if (glType != 0 || depth != 0 || arrayElements != 0 || faces != 1 ||
+        image.width == 0 || image.height == 0 ||
+        CompressedBlockBytes(image.internalFormat) == 0)
+    {
+        LOG_E("[ParseKTX] unsupported texture, format %x", image.internalFormat);
+        return false;
+    }
+
+    if (levels == 0) levels = 1;
+    image.levelCount = std::min(levels, (unsigned int)GCOMPRESSED_MAX_LEVELS);
+
+    unsigned int offset = headerSize;
+    if (keyValueBytes > size - offset)
+    {
+        return false;
+    }
+    offset += keyValueBytes;
+
+    for (unsigned int i = 0; i < image.levelCount; ++i)
+    {
+        if (size - offset < 4)
+        {
+            return false;
+        }
+        unsigned int imageSize = ReadKTX32(buffer + offset, swap);
+        offset += 4;
+        if (imageSize > size - offset)
+        {
+            LOG_E("[ParseKTX] level %d truncated", i);
+            return false;
+        }
+        image.levelData[i] = buffer + offset;
+        image.levelSize[i] = imageSize;
+        offset += std::min((imageSize + 3) & ~3u, size - offset);
+    }
+    return true;
+}
+
+bool ParseCompressedImage(const unsigned char *buffer, unsigned int size,
+                          GCompressedImage &image)
+{
+    if (buffer == nullptr)
+    {
+        return false;
+    }
+    return ParsePKM(buffer, size, image) || ParseKTX(buffer, size, image);
+}
+
+bool IsCompressedFormatSupported(GLenum internalFormat)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+    if (count <= 0)
+    {
+        return false;
+    }
+
+    std::vector< GLint > formats(count);
+    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &formats[0]);
+    return std::find(formats.begin(), formats.end(), (GLint)internalFormat) !=
+           formats.end();
+}
+
+bool TextureMgr::AppendCompressed(int textureGroupId, const unsigned char *buffer,
+                                  unsigned int size, bool alphaSplit,
+                                  unsigned int *widthPtr, unsigned int *heightPtr)
+{
+    GCompressedImage image;
+    if (!ParseCompressedImage(buffer, size, image))
+    {
+        LOG_E("[TextureMgr::AppendCompressed] not a KTX/PKM image, size %d", size);
+        return false;
+    }
+
+    if (!IsCompressedFormatSupported(image.internalFormat))
+    {
+        LOG_E("[TextureMgr::AppendCompressed] format %x not supported",
+              image.internalFormat);
+        return false;
+    }
+
+    GLint maxTextureSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if ((int)image.width > maxTextureSize || (int)image.height > maxTextureSize)
+    {
+        // compressed blocks cannot be cut into tiles without decoding
+        LOG_E("[TextureMgr::AppendCompressed] %dx%d exceeds max size %d",
+              image.width, image.height, maxTextureSize);
+        return false;
+    }
+
+    int boundTexture = 0;
+    boundTexture = (GLint) GGLStateCache::Current()->BoundTexture();
+
+    GLuint glID = 0;
+    glGenTextures(1, &glID);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
+
+    bool success = true;
+    for (unsigned int i = 0; i < image.levelCount; ++i)
+    {
+        GLsizei w = std::max(1u, image.width >> i);
+        GLsizei h = std::max(1u, image.height >> i);
+        glCompressedTexImage2D(GL_TEXTURE_2D, i, image.internalFormat, w, h, 0,
+                               image.levelSize[i], image.levelData[i]);
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, image.levelSize[i]);
+        GLenum glerror = glGetError();
+        if (glerror)
+        {
+            LOG_E("[TextureMgr::AppendCompressed] level %d, glGetError:%x", i, glerror);
+            success = false;
+            break;
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    image.levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+
+    if (!success)
+    {
+        GGLStateCache::Current()->DeleteTextures(1, &glID);
+        return false;
+    }
+
+    unsigned int visibleHeight = alphaSplit ? image.height / 2 : image.height;
+
+    TextureGroup &textureGroup = mTextureGroupPool[textureGroupId];
+    textureGroup.Clear();
+    textureGroup.Append(glID, image.width, visibleHeight);
+    textureGroup.mVecTexture[0]->SetHasMipmaps(image.levelCount > 1);
+    textureGroup.mSrcWidth = textureGroup.mTileWidth = image.width;
+    textureGroup.mSrcHeight = textureGroup.mTileHeight = visibleHeight;
+    textureGroup.mAlphaSplit = alphaSplit;
+    textureGroup.mOwned = true;
+
+    if (widthPtr) *widthPtr = image.width;
+    if (heightPtr) *heightPtr = visibleHeight;
+    return true;
+}
+
+static bool IsPowerOfTwo(unsigned int v) { return v > 0 && (v & (v - 1)) == 0; }
+
+bool TextureMgr::IsNpotMipmapSupported()
+{
+    if (mNpotMipmapSupport < 0)
+    {
+        const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+        if (extensions == nullptr)
+        {
+            return false; // no current context, try again next time
+        }
+        mNpotMipmapSupport = strstr(extensions, "GL_OES_texture_npot") != nullptr ? 1 : 0;
+    }
+    return mNpotMipmapSupport == 1;
+}
+
+// called with the group's texture freshly uploaded, pixels still available
+void TextureMgr::BuildDownsampledLevels(TextureGroup &textureGroup,
+                                        const unsigned char *pixels,
+                                        unsigned int width, unsigned int height)
+{
+    if ((IsPowerOfTwo(width) && IsPowerOfTwo(height)) || IsNpotMipmapSupported())
+    {
+        return; // hardware mipmaps are generated lazily in GetLevelForScale
+    }
+
+    // each level is box filtered from the previous one, stop at small sizes
+    const unsigned int maxLevels = 4;
+    const unsigned int minSize = 16;
+    std::vector< unsigned char > src(pixels, pixels + width * height * 4);
+    std::vector< unsigned char > dest;
+    while (textureGroup.mLevels.size() < maxLevels && width / 2 >= minSize &&
+           height / 2 >= minSize)
+    {
+        unsigned int w = width / 2;
+        unsigned int h = height / 2;
+        dest.resize(w * h * 4);
+        gcanvas::DownsamplePixels(&src[0], width, height, &dest[0]);
+
+        GLuint glID = gcanvas::PixelsBindTexture(&dest[0], GL_RGBA, w, h);
+        if (glID == (GLuint)-1)
+        {
+            break;
+        }
+        textureGroup.mLevels.push_back(new Texture(glID, w, h));
+
+        src.swap(dest);
+        width = w;
+        height = h;
+    }
+}
+
+const Texture *TextureMgr::GetLevelForScale(int id, float scale)
+{
+    std::map< int, TextureGroup >::iterator itr = mTextureGroupPool.find(id);
+    if (mTextureGroupPool.end() == itr || itr->second.mVecTexture.empty())
+    {
+        return nullptr;
+    }
+
+    TextureGroup &textureGroup = itr->second;
+    Texture *base = textureGroup.mVecTexture[0];
+    bool pot = IsPowerOfTwo(base->GetWidth()) && IsPowerOfTwo(base->GetHeight());
+    // power of two images only cost a glGenerateMipmap, they always get them
+    if (!(mMipmapEnabled || pot) || !(scale > 0) || scale >= mMipmapThreshold ||
+        textureGroup.IsSplit() || textureGroup.mAlphaSplit || !textureGroup.mOwned)
+    {
+        return base;
+    }
+
+    if (!textureGroup.mLevels.empty())
+    {
+        // level n halves the size n times, sample the one at or above scale
+        int level = (int)std::floor(std::log2(1.0f / scale));
+        level = std::min(level, (int)textureGroup.mLevels.size());
+        return level > 0 ? textureGroup.mLevels[level - 1] : base;
+    }
+
+    if (!base->HasMipmaps())
+    {
+        if (!pot && !IsNpotMipmapSupported())
+        {
+            return base;
+        }
+
+        int boundTexture = 0;
+        boundTexture = (GLint) GGLStateCache::Current()->BoundTexture();
+        base->Bind();
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+        base->SetHasMipmaps(true);
+    }
+    return base;
 }
@@ -11,6 +11,7 @@
 #define GCANVAS_GTEXTURE_H
 
 #include "GGL.h"
+#include "GGLStateCache.h"
 #include <map>
 #include <vector>
 
@@ -26,30 +27,61 @@ public:
         mGlId = glID;
         mWidth = w;
         mHeight = h;
+        mHasMipmaps = false;
     }
 
     int GetGlID() const { return mGlId; }
     int GetWidth() const { return mWidth; }
     int GetHeight() const { return mHeight; }
+    bool HasMipmaps() const { return mHasMipmaps; }
+    void SetHasMipmaps(bool value) { mHasMipmaps = value; }
 
-    void Bind() const { glBindTexture(GL_TEXTURE_2D, (GLuint)mGlId); }
+    void Bind() const { GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, (GLuint)mGlId); }
 
 private:
     int mGlId;
     int mWidth;
     int mHeight;
+    bool mHasMipmaps;
 };
 
+// -----------------------------------------------------------
+// --    Compressed texture container (KTX / PKM)
+// --    Level data points into the parsed buffer, no copy is made
+// -----------------------------------------------------------
+#define GCOMPRESSED_MAX_LEVELS 16
+
+struct GCompressedImage
+{
+    GLenum internalFormat;
+    unsigned int width;       // size of level 0 in pixels
+    unsigned int height;
+    unsigned int levelCount;
+    const unsigned char *levelData[GCOMPRESSED_MAX_LEVELS];
+    unsigned int levelSize[GCOMPRESSED_MAX_LEVELS];
+};
+
+// returns true for a KTX or PKM container holding an ETC1/ETC2 image
+bool ParseCompressedImage(const unsigned char *buffer, unsigned int size,
+                          GCompressedImage &image);
+bool IsCompressedFormatSupported(GLenum internalFormat);
+
 class TextureGroup
 {
 public:
-    TextureGroup(){};
+    TextureGroup()
+        : mSrcWidth(0), mSrcHeight(0), mTileWidth(0), mTileHeight(0),
+          mAlphaSplit(false), mOwned(false){};
     ~TextureGroup();
 
     bool IsSplit() const;
     void Clear();
     void Append(int glID, int width, int height);
     const Texture *Get(int id) const;
+    // tiles are stored row major, TileIndex returns -1 when out of range
+    int TileIndex(int col, int row) const;
+    int TileColumns() const;
+    int TileRows() const;
 
 public:
     std::vector< Texture * > mVecTexture;
@@ -57,6 +89,10 @@ public:
     int mSrcHeight;   // enable when split
     int mTileWidth;  // enable when split
     int mTileHeight; // enable when split
+    bool mAlphaSplit; // ETC1 color over alpha layout, sizes are of the visible half
+    bool mOwned;      // uploaded by TextureMgr, false for textures of the host
+    // CPU downsampled levels of a single NPOT texture, level i is 1/2^(i+1) size
+    std::vector< Texture * > mLevels;
 };
 
 class TextureMgr
@@ -65,13 +101,53 @@ public:
     TextureMgr();
     bool AppendPng(const unsigned char *buffer, unsigned int size, int textureGroupId,
                    unsigned int *widthPtr, unsigned int *heightPtr);
+    // upload RGBA pixels, split into tiles when larger than GL_MAX_TEXTURE_SIZE
+    bool AppendPixels(int textureGroupId, const unsigned char *pixels,
+                      unsigned int width, unsigned int height);
+    // upload a KTX/PKM container without decompressing, with alphaSplit the
+    // image holds color in its top half and alpha in its bottom half
+    bool AppendCompressed(int textureGroupId, const unsigned char *buffer,
+                          unsigned int size, bool alphaSplit,
+                          unsigned int *widthPtr, unsigned int *heightPtr);
     void Append(int id, int glID, int width, int height);
     void Remove(int id);
     void Clear();
     const TextureGroup *Get(int id) const;
 
+    // Minification quality. Images drawn below the threshold scale get
+    // mipmaps generated on first use, or on ES2 without GL_OES_texture_npot a
+    // CPU downsampled level built at upload time for non power of two images.
+    // Power of two images always get them, SetMipmapEnabled opts in the rest.
+    // Textures of the host (Append) are sampled as they are
+    void SetMipmapEnabled(bool enable) { mMipmapEnabled = enable; }
+    void SetMipmapThreshold(float scale) { mMipmapThreshold = scale; }
+    // texture to sample for a single texture group drawn at the given scale
+    const Texture *GetLevelForScale(int id, float scale);
+
+    // decode with the registered callback, result is released by delete []
+    static unsigned char *DecodeImage(const unsigned char *buffer, unsigned int size,
+                                      unsigned int *w, unsigned int *h);
+    // Caution: the memeory allocated by callback should be allocated by new []
+    static void SetDecodeImageCallback(unsigned char *(*callback)(
+        const unsigned char *buffer, unsigned int size, unsigned int *w,
+        unsigned int *h));
+
 private:
+    static unsigned char *(*decodeImageCallback)(const unsigned char *buffer,
+                                                 unsigned int size,
+                                                 unsigned int *w,
+                                                 unsigned int *h);
+
+    bool IsNpotMipmapSupported();
+
+    void BuildDownsampledLevels(TextureGroup &textureGroup,
+                                const unsigned char *pixels,
+                                unsigned int width, unsigned int height);
+
     std::map< int, TextureGroup > mTextureGroupPool;
+    bool mMipmapEnabled;
+    float mMipmapThreshold;
+    int mNpotMipmapSupport; // -1 unknown, 0 no, 1 yes
 };
 
 struct GCanvasLog;
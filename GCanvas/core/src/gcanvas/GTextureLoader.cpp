@@ -0,0 +1,240 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GTextureLoader.h"
+#include "../support/Log.h"
+
+#include <chrono>
+#include <stdio.h>
+
+GTextureLoader::GTextureLoader(int workerCount)
+    : mWorkerCount(workerCount > 0 ? workerCount : 1), mUploadBudgetMs(4.0f),
+      mNextSeq(0), mExit(false)
+{
+}
+
+GTextureLoader::~GTextureLoader()
+{
+    {
+        std::lock_guard< std::mutex > lock(mMutex);
+        mExit = true;
+    }
+    mCond.notify_all();
+    for (unsigned int i = 0; i < mWorkers.size(); ++i)
+    {
+        mWorkers[i].join();
+    }
+
+    for (unsigned int i = 0; i < mDecoded.size(); ++i)
+    {
+        delete[] mDecoded[i].pixels;
+    }
+}
+
+void GTextureLoader::SetReadyCallback(const ReadyCallback &callback)
+{
+    std::lock_guard< std::mutex > lock(mMutex);
+    mReadyCallback = callback;
+}
+
+void GTextureLoader::Load(int textureGroupId, const unsigned char *buffer,
+                          unsigned int size)
+{
+    if (buffer == nullptr || size == 0)
+    {
+        return;
+    }
+
+    Request request;
+    request.id = textureGroupId;
+    request.encoded.assign(buffer, buffer + size);
+    Enqueue(request);
+}
+
+void GTextureLoader::Load(int textureGroupId, const std::string &filePath)
+{
+    Request request;
+    request.id = textureGroupId;
+    request.filePath = filePath;
+    Enqueue(request);
+}
+
+void GTextureLoader::Enqueue(Request &request)
+{
+    {
+        std::lock_guard< std::mutex > lock(mMutex);
+        request.seq = ++mNextSeq;
+        mLatestSeq[request.id] = request.seq;
+        mRequests.push_back(std::move(request));
+        if (mWorkers.empty())
+        {
+            StartWorkers();
+        }
+    }
+    mCond.notify_one();
+}
+
+// called with mMutex held
+void GTextureLoader::StartWorkers()
+{
+    for (int i = 0; i < mWorkerCount; ++i)
+    {
+        mWorkers.push_back(std::thread(&GTextureLoader::WorkerLoop, this));
+    }
+}
+
+void GTextureLoader::Cancel(int textureGroupId)
+{
+    std::lock_guard< std::mutex > lock(mMutex);
+    mLatestSeq.erase(textureGroupId);
+}
+
+void GTextureLoader::CancelAll()
+{
+    std::lock_guard< std::mutex > lock(mMutex);
+    mLatestSeq.clear();
+    mRequests.clear();
+}
+
+// called with mMutex held
+bool GTextureLoader::IsCurrent(int id, unsigned int seq)
+{
+    std::map< int, unsigned int >::const_iterator itr = mLatestSeq.find(id);
+    return itr != mLatestSeq.end() && itr->second == seq;
+}
+
+static unsigned char *ReadFile(const std::string &path, unsigned int *size)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = nullptr;
+    if (len > 0)
+    {
+        data = new unsigned char[len];
+        if (fread(data, 1, (size_t)len, file) != (size_t)len)
+        {
+            delete[] data;
+            data = nullptr;
+        }
+    }
+    fclose(file);
+
+    *size = data ? (unsigned int)len : 0;
+    return data;
+}
+
+void GTextureLoader::WorkerLoop()
+{
+    while (true)
+    {
+        Request request;
+        {
+            std::unique_lock< std::mutex > lock(mMutex);
+            mCond.wait(lock, [this] { return mExit || !mRequests.empty(); });
+            if (mExit)
+            {
+                return;
+            }
+            request = std::move(mRequests.front());
+            mRequests.pop_front();
+            if (!IsCurrent(request.id, request.seq))
+            {
+                continue;
+            }
+        }
+
+        Decoded decoded;
+        decoded.id = request.id;
+        decoded.seq = request.seq;
+        decoded.width = decoded.height = 0;
+        if (request.filePath.empty())
+        {
+            decoded.pixels = TextureMgr::DecodeImage(
+                request.encoded.data(), (unsigned int)request.encoded.size(),
+                &decoded.width, &decoded.height);
+        }
+        else
+        {
+            unsigned int size = 0;
+            unsigned char *encoded = ReadFile(request.filePath, &size);
+            decoded.pixels = encoded ? TextureMgr::DecodeImage(encoded, size,
+                                                               &decoded.width,
+                                                               &decoded.height)
+                                     : nullptr;
+            delete[] encoded;
+        }
+
+        std::lock_guard< std::mutex > lock(mMutex);
+        mDecoded.push_back(decoded);
+    }
+}
+
+int GTextureLoader::Upload(TextureMgr &textureMgr)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    int count = 0;
+    while (true)
+    {
+        Decoded decoded;
+        ReadyCallback callback;
+        {
+            std::lock_guard< std::mutex > lock(mMutex);
+            if (mDecoded.empty())
+            {
+                break;
+            }
+            decoded = mDecoded.front();
+            mDecoded.pop_front();
+            if (!IsCurrent(decoded.id, decoded.seq))
+            {
+                delete[] decoded.pixels;
+                continue;
+            }
+            mLatestSeq.erase(decoded.id);
+            callback = mReadyCallback;
+        }
+
+        bool success = textureMgr.AppendPixels(decoded.id, decoded.pixels,
+                                               decoded.width, decoded.height);
+        delete[] decoded.pixels;
+        ++count;
+
+        if (!success)
+        {
+            LOG_E("[GTextureLoader::Upload] texture %d fail", decoded.id);
+        }
+        if (callback)
+        {
+            callback(decoded.id, success, decoded.width, decoded.height);
+        }
+
+        float elapsed = std::chrono::duration< float, std::milli >(Clock::now() - start).count();
+        if (elapsed >= mUploadBudgetMs)
+        {
+            break;
+        }
+    }
+    return count;
+}
+
+int GTextureLoader::PendingCount()
+{
+    std::lock_guard< std::mutex > lock(mMutex);
+    return (int)mLatestSeq.size();
+}
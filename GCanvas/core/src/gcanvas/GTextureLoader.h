@@ -0,0 +1,92 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GTEXTURELOADER_H
+#define GCANVAS_GTEXTURELOADER_H
+
+#include "GTexture.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------
+// --    Async image loader
+// --    Worker threads decode images to RGBA, the GL thread
+// --    uploads finished images under a per-frame time budget
+// -----------------------------------------------------------
+class GTextureLoader
+{
+public:
+    typedef std::function<void(int textureGroupId, bool success,
+                               unsigned int width, unsigned int height)>
+        ReadyCallback;
+
+    explicit GTextureLoader(int workerCount = 2);
+    ~GTextureLoader();
+
+    void SetReadyCallback(const ReadyCallback &callback);
+    // milliseconds of upload work allowed per Upload() call
+    void SetUploadBudget(float ms) { mUploadBudgetMs = ms; }
+
+    // may be called from any thread, the encoded buffer is copied
+    void Load(int textureGroupId, const unsigned char *buffer, unsigned int size);
+    void Load(int textureGroupId, const std::string &filePath);
+    // drop a pending load, a decode already in flight is discarded on arrival
+    void Cancel(int textureGroupId);
+    void CancelAll();
+
+    // GL thread, once per frame. Uploads at least one finished image and
+    // keeps going while the budget lasts, returns the number uploaded
+    int Upload(TextureMgr &textureMgr);
+    int PendingCount();
+
+private:
+    struct Request
+    {
+        int id;
+        unsigned int seq;
+        std::string filePath;
+        std::vector< unsigned char > encoded;
+    };
+
+    struct Decoded
+    {
+        int id;
+        unsigned int seq;
+        unsigned char *pixels; // allocated by new []
+        unsigned int width;
+        unsigned int height;
+    };
+
+    void Enqueue(Request &request);
+    void StartWorkers();
+    void WorkerLoop();
+    bool IsCurrent(int id, unsigned int seq);
+
+private:
+    int mWorkerCount;
+    float mUploadBudgetMs;
+    ReadyCallback mReadyCallback;
+
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    std::vector< std::thread > mWorkers;
+    std::deque< Request > mRequests;
+    std::deque< Decoded > mDecoded;
+    std::map< int, unsigned int > mLatestSeq;
+    unsigned int mNextSeq;
+    bool mExit;
+};
+
+#endif /* GCANVAS_GTEXTURELOADER_H */
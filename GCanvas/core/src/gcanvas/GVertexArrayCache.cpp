@@ -0,0 +1,228 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GVertexArrayCache.h"
+#include "../support/Log.h"
+
+#include <string.h>
+
+GVertexArrayCache::GVertexArrayCache()
+        : mBound(0), mBoundKnown(false), mSupport(-1), mMaxAttribs(8),
+          mGenVertexArrays(nullptr), mBindVertexArray(nullptr), mDeleteVertexArrays(nullptr),
+          mAttribDivisor(nullptr), mIssuedCount(0), mSkippedCount(0)
+{
+    memset(&mDefault, 0, sizeof(mDefault));
+}
+
+bool GVertexArrayCache::IsSupported()
+{
+    if (mSupport >= 0)
+    {
+        return mSupport == 1;
+    }
+    return CheckSupport();
+}
+
+bool GVertexArrayCache::CheckSupport()
+{
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    const char *version = (const char *)glGetString(GL_VERSION);
+    if (extensions == nullptr || version == nullptr)
+    {
+        // no current context, try again next time
+        return false;
+    }
+    mSupport = 0;
+
+    // ES 3 rejects client memory pointers in a non-zero VAO
+    bool es2 = strncmp(version, "OpenGL ES 2", 11) == 0;
+
+    GLint maxAttribs = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+    if (maxAttribs > 0)
+    {
+        mMaxAttribs = maxAttribs < MAX_ATTRIBS ? maxAttribs : MAX_ATTRIBS;
+    }
+
+#if defined(ANDROID) || defined(__linux__)
+    if (es2 && strstr(extensions, "GL_OES_vertex_array_object") != nullptr)
+    {
+        mGenVertexArrays = (GGenVertexArraysFunc)eglGetProcAddress("glGenVertexArraysOES");
+        mBindVertexArray = (GBindVertexArrayFunc)eglGetProcAddress("glBindVertexArrayOES");
+        mDeleteVertexArrays = (GDeleteVertexArraysFunc)eglGetProcAddress("glDeleteVertexArraysOES");
+    }
+#elif defined(IOS)
+    if (es2 && strstr(extensions, "GL_OES_vertex_array_object") != nullptr)
+    {
+        mGenVertexArrays = glGenVertexArraysOES;
+        mBindVertexArray = glBindVertexArrayOES;
+        mDeleteVertexArrays = glDeleteVertexArraysOES;
+    }
+#endif
+
+    if (mGenVertexArrays == nullptr || mBindVertexArray == nullptr ||
+        mDeleteVertexArrays == nullptr)
+    {
+        LOG_I("GVertexArrayCache: vertex array objects not supported");
+        return false;
+    }
+    mSupport = 1;
+    return true;
+}
+
+void GVertexArrayCache::Bind(const void *key, const GVertexAttrib *attribs, int count)
+{
+    VertexArray *array = &mDefault;
+    if (IsSupported())
+    {
+        std::map<const void *, VertexArray>::iterator iter = mArrays.find(key);
+        if (iter == mArrays.end())
+        {
+            VertexArray created;
+            memset(&created, 0, sizeof(created));
+            mGenVertexArrays(1, &created.name);
+            iter = mArrays.insert(std::make_pair(key, created)).first;
+        }
+        array = &iter->second;
+
+        if (!mBoundKnown || mBound != array->name)
+        {
+            mBindVertexArray(array->name);
+            mBound = array->name;
+            mBoundKnown = true;
+            ++mIssuedCount;
+        }
+        else
+        {
+            ++mSkippedCount;
+        }
+    }
+    Specify(*array, attribs, count);
+}
+
+void GVertexArrayCache::Specify(VertexArray &array, const GVertexAttrib *attribs, int count)
+{
+    unsigned int used = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const GVertexAttrib &attrib = attribs[i];
+        if (attrib.slot < 0)
+        {
+            continue;
+        }
+
+        GLuint slot = (GLuint)attrib.slot;
+        if (attrib.slot >= MAX_ATTRIBS)
+        {
+            // not tracked, always specified
+            glEnableVertexAttribArray(slot);
+            glVertexAttribPointer(slot, attrib.size, GL_FLOAT, GL_FALSE, attrib.stride,
+                                  attrib.pointer);
+            if (mAttribDivisor != nullptr)
+            {
+                mAttribDivisor(slot, attrib.divisor);
+            }
+            mIssuedCount += 3;
+            continue;
+        }
+
+        used |= 1u << slot;
+        AttribState &state = array.attribs[slot];
+        if (!array.known || !state.enabled)
+        {
+            glEnableVertexAttribArray(slot);
+            state.enabled = true;
+            ++mIssuedCount;
+        }
+        else
+        {
+            ++mSkippedCount;
+        }
+
+        if (!array.known || state.size != attrib.size || state.stride != attrib.stride ||
+            state.pointer != attrib.pointer)
+        {
+            glVertexAttribPointer(slot, attrib.size, GL_FLOAT, GL_FALSE, attrib.stride,
+                                  attrib.pointer);
+            state.size = attrib.size;
+            state.stride = attrib.stride;
+            state.pointer = attrib.pointer;
+            ++mIssuedCount;
+        }
+        else
+        {
+            ++mSkippedCount;
+        }
+
+        if (mAttribDivisor != nullptr && (!array.known || state.divisor != attrib.divisor))
+        {
+            mAttribDivisor(slot, attrib.divisor);
+            state.divisor = attrib.divisor;
+            ++mIssuedCount;
+        }
+    }
+
+    for (int slot = 0; slot < mMaxAttribs; ++slot)
+    {
+        AttribState &state = array.attribs[slot];
+        if ((used & (1u << slot)) == 0 && (!array.known || state.enabled))
+        {
+            glDisableVertexAttribArray((GLuint)slot);
+            state.enabled = false;
+            ++mIssuedCount;
+        }
+    }
+    array.known = true;
+}
+
+void GVertexArrayCache::Invalidate()
+{
+    // a VAO is only changed through its Bind(), its mirror stays valid
+    mBoundKnown = false;
+    mDefault.known = false;
+}
+
+void GVertexArrayCache::Unbind()
+{
+    if (mSupport == 1 && (!mBoundKnown || mBound != 0))
+    {
+        mBindVertexArray(0);
+        ++mIssuedCount;
+    }
+    mBound = 0;
+    mBoundKnown = mSupport == 1;
+    // the default arrays are shared with the other user
+    mDefault.known = false;
+}
+
+void GVertexArrayCache::Release()
+{
+    if (mSupport == 1)
+    {
+        if (mBoundKnown && mBound != 0)
+        {
+            mBindVertexArray(0);
+        }
+        std::map<const void *, VertexArray>::iterator iter = mArrays.begin();
+        for (; iter != mArrays.end(); ++iter)
+        {
+            mDeleteVertexArrays(1, &iter->second.name);
+        }
+    }
+    mArrays.clear();
+    mBound = 0;
+    mBoundKnown = false;
+    mDefault.known = false;
+}
+
+void GVertexArrayCache::ResetCounters()
+{
+    mIssuedCount = 0;
+    mSkippedCount = 0;
+}
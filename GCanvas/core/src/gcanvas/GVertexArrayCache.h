@@ -0,0 +1,112 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GVERTEXARRAYCACHE_H
+#define GCANVAS_GVERTEXARRAYCACHE_H
+
+#include "GGL.h"
+
+#include <map>
+
+// GL_OES_vertex_array_object entry points
+typedef void (*GGenVertexArraysFunc)(GLsizei n, GLuint *arrays);
+typedef void (*GBindVertexArrayFunc)(GLuint array);
+typedef void (*GDeleteVertexArraysFunc)(GLsizei n, const GLuint *arrays);
+typedef void (*GVertexAttribDivisorFunc)(GLuint index, GLuint divisor);
+
+// one float attribute array of a vertex layout
+struct GVertexAttrib
+{
+    GLint slot;            // skipped when < 0
+    GLint size;
+    GLsizei stride;
+    const void *pointer;   // client memory, GL_ARRAY_BUFFER stays 0
+    GLuint divisor;
+};
+
+/**
+ * Vertex layouts of the 2d pipelines, one per key, e.g. per program.
+ * With GL_OES_vertex_array_object in an ES 2 context every key gets a
+ * vertex array object, so switching layouts is one bind; the attribute
+ * calls are only issued when a layout differs from what its VAO last
+ * recorded. Without VAOs the same diff runs against the default vertex
+ * array. The layouts point at client memory, which ES 3 only allows in the
+ * default vertex array, so an ES 3 context always takes that path.
+ *
+ * Belongs to one GL context. Invalidate() after code outside the cache
+ * touched the attribute arrays or the VAO binding, Release() deletes the
+ * VAOs and needs the context current.
+ */
+class GVertexArrayCache
+{
+public:
+    static const int MAX_ATTRIBS = 16;
+
+    GVertexArrayCache();
+
+    // needs a current context the first time
+    bool IsSupported();
+
+    // for layouts with a divisor, nullptr when instancing is not used
+    void SetAttribDivisorFunc(GVertexAttribDivisorFunc func) { mAttribDivisor = func; }
+
+    // arrays of the slots in attribs are enabled, all others disabled
+    void Bind(const void *key, const GVertexAttrib *attribs, int count);
+
+    void Invalidate();
+
+    // binds VAO 0 before code outside the cache draws, e.g. WebGL
+    void Unbind();
+
+    void Release();
+
+    unsigned long IssuedCount() const { return mIssuedCount; }
+
+    unsigned long SkippedCount() const { return mSkippedCount; }
+
+    void ResetCounters();
+
+private:
+    struct AttribState
+    {
+        bool enabled;
+        GLint size;
+        GLsizei stride;
+        const void *pointer;
+        GLuint divisor;
+    };
+
+    struct VertexArray
+    {
+        GLuint name;
+        bool known;        // attribs mirror GL
+        AttribState attribs[MAX_ATTRIBS];
+    };
+
+    bool CheckSupport();
+
+    void Specify(VertexArray &array, const GVertexAttrib *attribs, int count);
+
+    std::map<const void *, VertexArray> mArrays;
+    VertexArray mDefault;   // used without VAOs
+
+    GLuint mBound;
+    bool mBoundKnown;
+
+    int mSupport;   // -1 unknown, 0 no, 1 yes
+    int mMaxAttribs;
+    GGenVertexArraysFunc mGenVertexArrays;
+    GBindVertexArrayFunc mBindVertexArray;
+    GDeleteVertexArraysFunc mDeleteVertexArrays;
+    GVertexAttribDivisorFunc mAttribDivisor;
+
+    unsigned long mIssuedCount;
+    unsigned long mSkippedCount;
+};
+
+#endif /* GCANVAS_GVERTEXARRAYCACHE_H */
@@ -0,0 +1,887 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GWebglBinaryStream.h"
+#include "GFrameProfiler.h"
+#include "../support/Log.h"
+
+#include <string.h>
+
+#define G_BUFFER_OFFSET(i) ((char *)NULL + (i))
+
+int32_t GWebglBinaryArgs::Int()
+{
+    int32_t value = 0;
+    if (mEnd - mCur < 4)
+    {
+        mValid = false;
+        return 0;
+    }
+    memcpy(&value, mCur, 4);
+    mCur += 4;
+    return value;
+}
+
+float GWebglBinaryArgs::Float()
+{
+    float value = 0;
+    if (mEnd - mCur < 4)
+    {
+        mValid = false;
+        return 0;
+    }
+    memcpy(&value, mCur, 4);
+    mCur += 4;
+    return value;
+}
+
+const void *GWebglBinaryArgs::Bytes(uint32_t &length)
+{
+    length = (uint32_t)Int();
+    uint32_t padded = (length + 3) & ~3u;
+    if (!mValid || padded < length || (size_t)(mEnd - mCur) < padded)
+    {
+        mValid = false;
+        length = 0;
+        return nullptr;
+    }
+    const void *bytes = length > 0 ? mCur : nullptr;
+    mCur += padded;
+    return bytes;
+}
+
+GWebglBinaryReader::GWebglBinaryReader()
+        : mDrawCount(0), mDevicePixelRatio(1)
+{
+}
+
+// 4 byte words a record of id holds before its payload, counting the
+// payload length; -1 for an id without a binary form
+static int ArgumentWords(uint32_t id)
+{
+    switch (id)
+    {
+        case WEBGL_CMD_FLUSH:
+            return 0;
+        case WEBGL_CMD_ACTIVE_TEXTURE:
+        case WEBGL_CMD_BLEND_EQUATION:
+        case WEBGL_CMD_CLEAR:
+        case WEBGL_CMD_CLEAR_DEPTH:
+        case WEBGL_CMD_CLEAR_STENCIL:
+        case WEBGL_CMD_COMPILE_SHADER:
+        case WEBGL_CMD_CULL_FACE:
+        case WEBGL_CMD_DELETE_BUFFER:
+        case WEBGL_CMD_DELETE_FRAMEBUFFER:
+        case WEBGL_CMD_DELETE_PROGRAM:
+        case WEBGL_CMD_DELETE_RENDERBUFFER:
+        case WEBGL_CMD_DELETE_SHADER:
+        case WEBGL_CMD_DELETE_TEXTURE:
+        case WEBGL_CMD_DEPTH_FUNC:
+        case WEBGL_CMD_DEPTH_MASK:
+        case WEBGL_CMD_DISABLE:
+        case WEBGL_CMD_DISABLE_VERTEX_ATTRIB_ARRAY:
+        case WEBGL_CMD_ENABLE:
+        case WEBGL_CMD_ENABLE_VERTEX_ATTRIB_ARRAY:
+        case WEBGL_CMD_FRONT_FACE:
+        case WEBGL_CMD_GENERATE_MIPMAP:
+        case WEBGL_CMD_LINE_WIDTH:
+        case WEBGL_CMD_LINK_PROGRAM:
+        case WEBGL_CMD_STENCIL_MASK:
+        case WEBGL_CMD_USE_PROGRAM:
+        case WEBGL_CMD_VALIDATE_PROGRAM:
+            return 1;
+        case WEBGL_CMD_ATTACH_SHADER:
+        case WEBGL_CMD_BIND_BUFFER:
+        case WEBGL_CMD_BIND_FRAMEBUFFER:
+        case WEBGL_CMD_BIND_RENDERBUFFER:
+        case WEBGL_CMD_BIND_TEXTURE:
+        case WEBGL_CMD_BLEND_EQUATION_SEPARATE:
+        case WEBGL_CMD_BLEND_FUNC:
+        case WEBGL_CMD_DEPTH_RANGE:
+        case WEBGL_CMD_DETACH_SHADER:
+        case WEBGL_CMD_PIXEL_STOREI:
+        case WEBGL_CMD_POLYGON_OFFSET:
+        case WEBGL_CMD_SAMPLE_COVERAGE:
+        case WEBGL_CMD_SHADER_SOURCE:
+        case WEBGL_CMD_STENCIL_MASK_SEPARATE:
+            return 2;
+        case WEBGL_CMD_BIND_ATTRIB_LOCATION:
+        case WEBGL_CMD_BUFFER_DATA:
+        case WEBGL_CMD_BUFFER_SUB_DATA:
+        case WEBGL_CMD_DRAW_ARRAYS:
+        case WEBGL_CMD_STENCIL_FUNC:
+        case WEBGL_CMD_STENCIL_OP:
+        case WEBGL_CMD_TEX_PARAMETERF:
+        case WEBGL_CMD_TEX_PARAMETERI:
+        case WEBGL_CMD_UNIFORM_MATRIX2FV:
+        case WEBGL_CMD_UNIFORM_MATRIX3FV:
+        case WEBGL_CMD_UNIFORM_MATRIX4FV:
+            return 3;
+        case WEBGL_CMD_BLEND_COLOR:
+        case WEBGL_CMD_BLEND_FUNC_SEPARATE:
+        case WEBGL_CMD_CLEAR_COLOR:
+        case WEBGL_CMD_COLOR_MASK:
+        case WEBGL_CMD_DRAW_ELEMENTS:
+        case WEBGL_CMD_FRAMEBUFFER_RENDERBUFFER:
+        case WEBGL_CMD_RENDERBUFFER_STORAGE:
+        case WEBGL_CMD_SCISSOR:
+        case WEBGL_CMD_STENCIL_FUNC_SEPARATE:
+        case WEBGL_CMD_STENCIL_OP_SEPARATE:
+        case WEBGL_CMD_VIEWPORT:
+            return 4;
+        case WEBGL_CMD_FRAMEBUFFER_TEXTURE_2D:
+            return 5;
+        case WEBGL_CMD_VERTEX_ATTRIB_POINTER:
+            return 6;
+        case WEBGL_CMD_COMPRESSED_TEX_IMAGE_2D:
+            return 7;
+        case WEBGL_CMD_COMPRESSED_TEX_SUB_IMAGE_2D:
+        case WEBGL_CMD_COPY_TEX_IMAGE_2D:
+        case WEBGL_CMD_COPY_TEX_SUB_IMAGE_2D:
+            return 8;
+        case WEBGL_CMD_TEX_IMAGE_2D:
+        case WEBGL_CMD_TEX_SUB_IMAGE_2D:
+            return 9;
+        default:
+            break;
+    }
+    if (id >= WEBGL_CMD_UNIFORM1F && id <= WEBGL_CMD_UNIFORM4IV)
+    {
+        // f, fv, i, iv per size: location and 1 to 4 values or a payload
+        uint32_t n = (id - WEBGL_CMD_UNIFORM1F) / 4 + 1;
+        uint32_t variant = (id - WEBGL_CMD_UNIFORM1F) % 4;
+        return (variant == 1 || variant == 3) ? 2 : (int)n + 1;
+    }
+    if (id >= WEBGL_CMD_VERTEX_ATTRIB1F && id <= WEBGL_CMD_VERTEX_ATTRIB4F)
+    {
+        return (int)(id - WEBGL_CMD_VERTEX_ATTRIB1F) + 2;
+    }
+    if (id >= WEBGL_CMD_VERTEX_ATTRIB1FV && id <= WEBGL_CMD_VERTEX_ATTRIB4FV)
+    {
+        return 2;
+    }
+    return -1;
+}
+
+static void UniformFv(int n, GLint location, const GLfloat *v, uint32_t length)
+{
+    GLsizei count = length / (n * sizeof(GLfloat));
+    switch (n)
+    {
+        case 1: glUniform1fv(location, count, v); break;
+        case 2: glUniform2fv(location, count, v); break;
+        case 3: glUniform3fv(location, count, v); break;
+        case 4: glUniform4fv(location, count, v); break;
+    }
+}
+
+static void UniformIv(int n, GLint location, const GLint *v, uint32_t length)
+{
+    GLsizei count = length / (n * sizeof(GLint));
+    switch (n)
+    {
+        case 1: glUniform1iv(location, count, v); break;
+        case 2: glUniform2iv(location, count, v); break;
+        case 3: glUniform3iv(location, count, v); break;
+        case 4: glUniform4iv(location, count, v); break;
+    }
+}
+
+static void UniformMatrixFv(int n, GLint location, GLboolean transpose, const GLfloat *v,
+                            uint32_t length)
+{
+    GLsizei count = length / (n * n * sizeof(GLfloat));
+    switch (n)
+    {
+        case 2: glUniformMatrix2fv(location, count, transpose, v); break;
+        case 3: glUniformMatrix3fv(location, count, transpose, v); break;
+        case 4: glUniformMatrix4fv(location, count, transpose, v); break;
+    }
+}
+
+static void VertexAttribFv(int n, GLuint index, const GLfloat *v, uint32_t length)
+{
+    if (length < n * sizeof(GLfloat))
+    {
+        return;
+    }
+    switch (n)
+    {
+        case 1: glVertexAttrib1fv(index, v); break;
+        case 2: glVertexAttrib2fv(index, v); break;
+        case 3: glVertexAttrib3fv(index, v); break;
+        case 4: glVertexAttrib4fv(index, v); break;
+    }
+}
+
+static void DeleteObject(uint32_t id, GLuint name)
+{
+    switch (id)
+    {
+        case WEBGL_CMD_DELETE_BUFFER: glDeleteBuffers(1, &name); break;
+        case WEBGL_CMD_DELETE_FRAMEBUFFER: glDeleteFramebuffers(1, &name); break;
+        case WEBGL_CMD_DELETE_PROGRAM: glDeleteProgram(name); break;
+        case WEBGL_CMD_DELETE_RENDERBUFFER: glDeleteRenderbuffers(1, &name); break;
+        case WEBGL_CMD_DELETE_SHADER: glDeleteShader(name); break;
+        case WEBGL_CMD_DELETE_TEXTURE: glDeleteTextures(1, &name); break;
+    }
+}
+
+// ids are checked against ArgumentWords before
+void GWebglBinaryReader::ExecuteCommand(uint32_t id, GWebglBinaryArgs &a)
+{
+    uint32_t length = 0;
+    const void *bytes;
+    switch (id)
+    {
+        case WEBGL_CMD_ACTIVE_TEXTURE:
+            glActiveTexture(a.Int());
+            break;
+        case WEBGL_CMD_ATTACH_SHADER:
+        {
+            GLuint program = a.Int();
+            glAttachShader(program, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BIND_ATTRIB_LOCATION:
+        {
+            GLuint program = a.Int();
+            GLuint index = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                mName.assign((const char *)bytes, length);
+                glBindAttribLocation(program, index, mName.c_str());
+            }
+            break;
+        }
+        case WEBGL_CMD_BIND_BUFFER:
+        {
+            GLenum target = a.Int();
+            glBindBuffer(target, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BIND_FRAMEBUFFER:
+        {
+            GLenum target = a.Int();
+            GLuint framebuffer = a.Int();
+            if (framebuffer == 0 && mBindDefaultFramebuffer)
+            {
+                mBindDefaultFramebuffer();
+            }
+            else
+            {
+                glBindFramebuffer(target, framebuffer);
+            }
+            break;
+        }
+        case WEBGL_CMD_BIND_RENDERBUFFER:
+        {
+            GLenum target = a.Int();
+            glBindRenderbuffer(target, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BIND_TEXTURE:
+        {
+            GLenum target = a.Int();
+            glBindTexture(target, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BLEND_COLOR:
+        {
+            GLfloat r = a.Float(), g = a.Float(), b = a.Float();
+            glBlendColor(r, g, b, a.Float());
+            break;
+        }
+        case WEBGL_CMD_BLEND_EQUATION:
+            glBlendEquation(a.Int());
+            break;
+        case WEBGL_CMD_BLEND_EQUATION_SEPARATE:
+        {
+            GLenum modeRGB = a.Int();
+            glBlendEquationSeparate(modeRGB, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BLEND_FUNC:
+        {
+            GLenum sfactor = a.Int();
+            glBlendFunc(sfactor, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BLEND_FUNC_SEPARATE:
+        {
+            GLenum srcRGB = a.Int(), dstRGB = a.Int(), srcAlpha = a.Int();
+            glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, a.Int());
+            break;
+        }
+        case WEBGL_CMD_BUFFER_DATA:
+        {
+            GLenum target = a.Int();
+            GLenum usage = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid())
+            {
+                glBufferData(target, length, bytes, usage);
+            }
+            break;
+        }
+        case WEBGL_CMD_BUFFER_SUB_DATA:
+        {
+            GLenum target = a.Int();
+            GLintptr offset = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                glBufferSubData(target, offset, length, bytes);
+            }
+            break;
+        }
+        case WEBGL_CMD_CLEAR:
+            glClear(a.Int());
+            break;
+        case WEBGL_CMD_CLEAR_COLOR:
+        {
+            GLfloat r = a.Float(), g = a.Float(), b = a.Float();
+            glClearColor(r, g, b, a.Float());
+            break;
+        }
+        case WEBGL_CMD_CLEAR_DEPTH:
+            glClearDepthf(a.Float());
+            break;
+        case WEBGL_CMD_CLEAR_STENCIL:
+            glClearStencil(a.Int());
+            break;
+        case WEBGL_CMD_COLOR_MASK:
+        {
+            GLboolean r = a.Int(), g = a.Int(), b = a.Int();
+            glColorMask(r, g, b, a.Int());
+            break;
+        }
+        case WEBGL_CMD_COMPILE_SHADER:
+            glCompileShader(a.Int());
+            break;
+        case WEBGL_CMD_COMPRESSED_TEX_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int();
+            GLenum internalformat = a.Int();
+            GLsizei width = a.Int(), height = a.Int();
+            GLint border = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid())
+            {
+                glCompressedTexImage2D(target, level, internalformat, width, height, border,
+                                       length, bytes);
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_COMPRESSED_TEX_SUB_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int(), xoffset = a.Int(), yoffset = a.Int();
+            GLsizei width = a.Int(), height = a.Int();
+            GLenum format = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format,
+                                          length, bytes);
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_COPY_TEX_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int();
+            GLenum internalformat = a.Int();
+            GLint x = a.Int(), y = a.Int();
+            GLsizei width = a.Int(), height = a.Int();
+            glCopyTexImage2D(target, level, internalformat, x, y, width, height, a.Int());
+            break;
+        }
+        case WEBGL_CMD_COPY_TEX_SUB_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int(), xoffset = a.Int(), yoffset = a.Int();
+            GLint x = a.Int(), y = a.Int();
+            GLsizei width = a.Int();
+            glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, a.Int());
+            break;
+        }
+        case WEBGL_CMD_CULL_FACE:
+            glCullFace(a.Int());
+            break;
+        case WEBGL_CMD_DELETE_BUFFER:
+        case WEBGL_CMD_DELETE_FRAMEBUFFER:
+        case WEBGL_CMD_DELETE_PROGRAM:
+        case WEBGL_CMD_DELETE_RENDERBUFFER:
+        case WEBGL_CMD_DELETE_SHADER:
+        case WEBGL_CMD_DELETE_TEXTURE:
+            DeleteObject(id, a.Int());
+            break;
+        case WEBGL_CMD_DEPTH_FUNC:
+            glDepthFunc(a.Int());
+            break;
+        case WEBGL_CMD_DEPTH_MASK:
+            glDepthMask(a.Int());
+            break;
+        case WEBGL_CMD_DEPTH_RANGE:
+        {
+            GLfloat zNear = a.Float();
+            glDepthRangef(zNear, a.Float());
+            break;
+        }
+        case WEBGL_CMD_DETACH_SHADER:
+        {
+            GLuint program = a.Int();
+            glDetachShader(program, a.Int());
+            break;
+        }
+        case WEBGL_CMD_DISABLE:
+            glDisable(a.Int());
+            break;
+        case WEBGL_CMD_DISABLE_VERTEX_ATTRIB_ARRAY:
+            glDisableVertexAttribArray(a.Int());
+            break;
+        case WEBGL_CMD_DRAW_ARRAYS:
+        {
+            GLenum mode = a.Int();
+            GLint first = a.Int();
+            GLsizei count = a.Int();
+            glDrawArrays(mode, first, count);
+            GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+            GFRAME_COUNT(FRAME_COUNTER_VERTICES, count);
+            break;
+        }
+        case WEBGL_CMD_DRAW_ELEMENTS:
+        {
+            GLenum mode = a.Int();
+            GLsizei count = a.Int();
+            GLenum type = a.Int();
+            glDrawElements(mode, count, type, G_BUFFER_OFFSET(a.Int()));
+            GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+            GFRAME_COUNT(FRAME_COUNTER_VERTICES, count);
+            break;
+        }
+        case WEBGL_CMD_ENABLE:
+            glEnable(a.Int());
+            break;
+        case WEBGL_CMD_ENABLE_VERTEX_ATTRIB_ARRAY:
+            glEnableVertexAttribArray(a.Int());
+            break;
+        case WEBGL_CMD_FLUSH:
+            glFlush();
+            break;
+        case WEBGL_CMD_FRAMEBUFFER_RENDERBUFFER:
+        {
+            GLenum target = a.Int(), attachment = a.Int(), renderbuffertarget = a.Int();
+            glFramebufferRenderbuffer(target, attachment, renderbuffertarget, a.Int());
+            break;
+        }
+        case WEBGL_CMD_FRAMEBUFFER_TEXTURE_2D:
+        {
+            GLenum target = a.Int(), attachment = a.Int(), textarget = a.Int();
+            GLuint texture = a.Int();
+            glFramebufferTexture2D(target, attachment, textarget, texture, a.Int());
+            break;
+        }
+        case WEBGL_CMD_FRONT_FACE:
+            glFrontFace(a.Int());
+            break;
+        case WEBGL_CMD_GENERATE_MIPMAP:
+            glGenerateMipmap(a.Int());
+            break;
+        case WEBGL_CMD_LINE_WIDTH:
+            glLineWidth(a.Float());
+            break;
+        case WEBGL_CMD_LINK_PROGRAM:
+            glLinkProgram(a.Int());
+            break;
+        case WEBGL_CMD_PIXEL_STOREI:
+        {
+            GLenum pname = a.Int();
+            glPixelStorei(pname, a.Int());
+            break;
+        }
+        case WEBGL_CMD_POLYGON_OFFSET:
+        {
+            GLfloat factor = a.Float();
+            glPolygonOffset(factor, a.Float());
+            break;
+        }
+        case WEBGL_CMD_RENDERBUFFER_STORAGE:
+        {
+            GLenum target = a.Int(), internalformat = a.Int();
+            GLsizei width = a.Int() * mDevicePixelRatio;
+            glRenderbufferStorage(target, internalformat, width, a.Int() * mDevicePixelRatio);
+            break;
+        }
+        case WEBGL_CMD_SAMPLE_COVERAGE:
+        {
+            GLfloat value = a.Float();
+            glSampleCoverage(value, a.Int());
+            break;
+        }
+        case WEBGL_CMD_SCISSOR:
+        {
+            GLint x = a.Int() * mDevicePixelRatio, y = a.Int() * mDevicePixelRatio;
+            GLsizei width = a.Int() * mDevicePixelRatio;
+            glScissor(x, y, width, a.Int() * mDevicePixelRatio);
+            break;
+        }
+        case WEBGL_CMD_SHADER_SOURCE:
+        {
+            GLuint shader = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                const GLchar *source = (const GLchar *)bytes;
+                GLint sourceLength = length;
+                glShaderSource(shader, 1, &source, &sourceLength);
+            }
+            break;
+        }
+        case WEBGL_CMD_STENCIL_FUNC:
+        {
+            GLenum func = a.Int();
+            GLint ref = a.Int();
+            glStencilFunc(func, ref, a.Int());
+            break;
+        }
+        case WEBGL_CMD_STENCIL_FUNC_SEPARATE:
+        {
+            GLenum face = a.Int(), func = a.Int();
+            GLint ref = a.Int();
+            glStencilFuncSeparate(face, func, ref, a.Int());
+            break;
+        }
+        case WEBGL_CMD_STENCIL_MASK:
+            glStencilMask(a.Int());
+            break;
+        case WEBGL_CMD_STENCIL_MASK_SEPARATE:
+        {
+            GLenum face = a.Int();
+            glStencilMaskSeparate(face, a.Int());
+            break;
+        }
+        case WEBGL_CMD_STENCIL_OP:
+        {
+            GLenum fail = a.Int(), zfail = a.Int();
+            glStencilOp(fail, zfail, a.Int());
+            break;
+        }
+        case WEBGL_CMD_STENCIL_OP_SEPARATE:
+        {
+            GLenum face = a.Int(), fail = a.Int(), zfail = a.Int();
+            glStencilOpSeparate(face, fail, zfail, a.Int());
+            break;
+        }
+        case WEBGL_CMD_TEX_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int(), internalformat = a.Int();
+            GLsizei width = a.Int(), height = a.Int();
+            GLint border = a.Int();
+            GLenum format = a.Int(), type = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid())
+            {
+                glTexImage2D(target, level, internalformat, width, height, border, format, type,
+                             bytes);
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, bytes != nullptr ? length : 0);
+            }
+            break;
+        }
+        case WEBGL_CMD_TEX_PARAMETERF:
+        {
+            GLenum target = a.Int(), pname = a.Int();
+            glTexParameterf(target, pname, a.Float());
+            break;
+        }
+        case WEBGL_CMD_TEX_PARAMETERI:
+        {
+            GLenum target = a.Int(), pname = a.Int();
+            glTexParameteri(target, pname, a.Int());
+            break;
+        }
+        case WEBGL_CMD_TEX_SUB_IMAGE_2D:
+        {
+            GLenum target = a.Int();
+            GLint level = a.Int(), xoffset = a.Int(), yoffset = a.Int();
+            GLsizei width = a.Int(), height = a.Int();
+            GLenum format = a.Int(), type = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type,
+                                bytes);
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_UNIFORM1F:
+        {
+            GLint location = a.Int();
+            glUniform1f(location, a.Float());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM2F:
+        {
+            GLint location = a.Int();
+            GLfloat x = a.Float();
+            glUniform2f(location, x, a.Float());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM3F:
+        {
+            GLint location = a.Int();
+            GLfloat x = a.Float(), y = a.Float();
+            glUniform3f(location, x, y, a.Float());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM4F:
+        {
+            GLint location = a.Int();
+            GLfloat x = a.Float(), y = a.Float(), z = a.Float();
+            glUniform4f(location, x, y, z, a.Float());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM1I:
+        {
+            GLint location = a.Int();
+            glUniform1i(location, a.Int());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM2I:
+        {
+            GLint location = a.Int();
+            GLint x = a.Int();
+            glUniform2i(location, x, a.Int());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM3I:
+        {
+            GLint location = a.Int();
+            GLint x = a.Int(), y = a.Int();
+            glUniform3i(location, x, y, a.Int());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM4I:
+        {
+            GLint location = a.Int();
+            GLint x = a.Int(), y = a.Int(), z = a.Int();
+            glUniform4i(location, x, y, z, a.Int());
+            break;
+        }
+        case WEBGL_CMD_UNIFORM1FV:
+        case WEBGL_CMD_UNIFORM2FV:
+        case WEBGL_CMD_UNIFORM3FV:
+        case WEBGL_CMD_UNIFORM4FV:
+        {
+            GLint location = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                UniformFv((id - WEBGL_CMD_UNIFORM1FV) / 4 + 1, location,
+                          (const GLfloat *)bytes, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_UNIFORM1IV:
+        case WEBGL_CMD_UNIFORM2IV:
+        case WEBGL_CMD_UNIFORM3IV:
+        case WEBGL_CMD_UNIFORM4IV:
+        {
+            GLint location = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                UniformIv((id - WEBGL_CMD_UNIFORM1IV) / 4 + 1, location,
+                          (const GLint *)bytes, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_UNIFORM_MATRIX2FV:
+        case WEBGL_CMD_UNIFORM_MATRIX3FV:
+        case WEBGL_CMD_UNIFORM_MATRIX4FV:
+        {
+            GLint location = a.Int();
+            GLboolean transpose = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                UniformMatrixFv(id - WEBGL_CMD_UNIFORM_MATRIX2FV + 2, location, transpose,
+                                (const GLfloat *)bytes, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_USE_PROGRAM:
+            glUseProgram(a.Int());
+            break;
+        case WEBGL_CMD_VALIDATE_PROGRAM:
+            glValidateProgram(a.Int());
+            break;
+        case WEBGL_CMD_VERTEX_ATTRIB1F:
+        {
+            GLuint index = a.Int();
+            glVertexAttrib1f(index, a.Float());
+            break;
+        }
+        case WEBGL_CMD_VERTEX_ATTRIB2F:
+        {
+            GLuint index = a.Int();
+            GLfloat x = a.Float();
+            glVertexAttrib2f(index, x, a.Float());
+            break;
+        }
+        case WEBGL_CMD_VERTEX_ATTRIB3F:
+        {
+            GLuint index = a.Int();
+            GLfloat x = a.Float(), y = a.Float();
+            glVertexAttrib3f(index, x, y, a.Float());
+            break;
+        }
+        case WEBGL_CMD_VERTEX_ATTRIB4F:
+        {
+            GLuint index = a.Int();
+            GLfloat x = a.Float(), y = a.Float(), z = a.Float();
+            glVertexAttrib4f(index, x, y, z, a.Float());
+            break;
+        }
+        case WEBGL_CMD_VERTEX_ATTRIB1FV:
+        case WEBGL_CMD_VERTEX_ATTRIB2FV:
+        case WEBGL_CMD_VERTEX_ATTRIB3FV:
+        case WEBGL_CMD_VERTEX_ATTRIB4FV:
+        {
+            GLuint index = a.Int();
+            bytes = a.Bytes(length);
+            if (a.IsValid() && bytes != nullptr)
+            {
+                VertexAttribFv(id - WEBGL_CMD_VERTEX_ATTRIB1FV + 1, index,
+                               (const GLfloat *)bytes, length);
+            }
+            break;
+        }
+        case WEBGL_CMD_VERTEX_ATTRIB_POINTER:
+        {
+            GLuint index = a.Int();
+            GLint size = a.Int();
+            GLenum type = a.Int();
+            GLboolean normalized = a.Int();
+            GLsizei stride = a.Int();
+            glVertexAttribPointer(index, size, type, normalized, stride,
+                                  G_BUFFER_OFFSET(a.Int()));
+            break;
+        }
+        case WEBGL_CMD_VIEWPORT:
+        {
+            GLint x = a.Float() * mDevicePixelRatio, y = a.Float() * mDevicePixelRatio;
+            GLsizei width = a.Float() * mDevicePixelRatio;
+            glViewport(x, y, width, a.Float() * mDevicePixelRatio);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+int GWebglBinaryReader::Execute(const void *data, size_t length)
+{
+    const unsigned char *cur = (const unsigned char *)data;
+    const unsigned char *end = cur + length;
+    if (((uintptr_t)cur & 3) != 0 || (length & 3) != 0)
+    {
+        LOG_E("GWebglBinaryReader::Execute: stream not 4 byte aligned");
+        return -1;
+    }
+
+    int executed = 0;
+    while (end - cur >= 8)
+    {
+        uint32_t header[2];
+        memcpy(header, cur, sizeof(header));
+        cur += sizeof(header);
+        if ((header[1] & 3) != 0 || (size_t)(end - cur) < header[1])
+        {
+            LOG_E("GWebglBinaryReader::Execute: bad record, id=%u size=%u",
+                  header[0], header[1]);
+            return -1;
+        }
+
+        int words = ArgumentWords(header[0]);
+        if (words < 0)
+        {
+            LOG_E("GWebglBinaryReader::Execute: command %u has no binary form", header[0]);
+            return -1;
+        }
+        if (header[1] < (uint32_t)words * 4)
+        {
+            // checked up front, GL must not see the zeros of a short read
+            LOG_E("GWebglBinaryReader::Execute: arguments of command %u cut short", header[0]);
+            return -1;
+        }
+
+        GWebglBinaryArgs args(cur, cur + header[1]);
+        ExecuteCommand(header[0], args);
+        if (!args.IsValid())
+        {
+            LOG_E("GWebglBinaryReader::Execute: arguments of command %u cut short", header[0]);
+            return -1;
+        }
+        ++executed;
+        if (header[0] == WEBGL_CMD_DRAW_ARRAYS || header[0] == WEBGL_CMD_DRAW_ELEMENTS)
+        {
+            ++mDrawCount;
+        }
+        cur += header[1];
+    }
+    if (cur != end)
+    {
+        LOG_E("GWebglBinaryReader::Execute: stream ends inside a record header");
+        return -1;
+    }
+    return executed;
+}
+
+void GWebglBinaryWriter::Begin(uint32_t id)
+{
+    mRecordStart = mData.size();
+    mData.push_back(id);
+    mData.push_back(0);
+}
+
+void GWebglBinaryWriter::Int(int32_t value)
+{
+    mData.push_back((uint32_t)value);
+}
+
+void GWebglBinaryWriter::Float(float value)
+{
+    uint32_t word;
+    memcpy(&word, &value, 4);
+    mData.push_back(word);
+}
+
+void GWebglBinaryWriter::Bytes(const void *data, uint32_t length)
+{
+    mData.push_back(length);
+    size_t offset = mData.size();
+    mData.resize(offset + (length + 3) / 4, 0);
+    if (length > 0)
+    {
+        memcpy(&mData[offset], data, length);
+    }
+}
+
+void GWebglBinaryWriter::End()
+{
+    mData[mRecordStart + 1] = (uint32_t)((mData.size() - mRecordStart - 2) * sizeof(uint32_t));
+}
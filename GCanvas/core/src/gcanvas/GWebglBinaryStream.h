@@ -0,0 +1,246 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GWEBGLBINARYSTREAM_H
+#define GCANVAS_GWEBGLBINARYSTREAM_H
+
+#include "GGL.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Binary form of the WebGL command stream.
+ *
+ * The stream is a sequence of 4 byte aligned records in host byte order:
+ *
+ *   uint32 id      command index, same numbering as the text protocol
+ *   uint32 size    bytes of arguments that follow, a multiple of 4
+ *   args           32 bit ints and floats, in the order listed below
+ *
+ * Typed array payloads are an uint32 byte length followed by the raw
+ * bytes, zero padded to 4. They are handed to GL where they lie, so the
+ * buffer has to start 4 byte aligned and stay alive until Execute returns.
+ *
+ * Every command of the text protocol without a result has a binary form,
+ * except the ANGLE instanced draws. Queries, object creation and readPixels
+ * stay on the text protocol, a record of any id not listed in
+ * GWebglCommandId fails the stream.
+ *
+ *   bindAttribLocation    program, index, payload (name, no terminator)
+ *   bufferData            target, usage, payload
+ *   bufferSubData         target, offset, payload
+ *   compressedTexImage2D  target, level, internalformat, width, height,
+ *                         border, payload
+ *   compressedTexSubImage2D  target, level, xoffset, yoffset, width,
+ *                         height, format, payload
+ *   sampleCoverage        value (float), invert
+ *   shaderSource          shader, payload (source, no terminator)
+ *   texImage2D            target, level, internalformat, width, height,
+ *                         border, format, type, payload (may be empty)
+ *   texSubImage2D         target, level, xoffset, yoffset, width, height,
+ *                         format, type, payload
+ *   uniform[1234][if]v    location, payload
+ *   uniformMatrix[234]fv  location, transpose, payload
+ *   vertexAttrib[1234]fv  index, payload
+ *   viewport              x, y, width, height as floats
+ *   everything else       the arguments of the GL call
+ *
+ * As in the text protocol, viewport, scissor and renderbufferStorage sizes
+ * are in CSS pixels and scaled by the device pixel ratio, and binding
+ * framebuffer 0 goes to the host's default framebuffer where one is set.
+ *
+ * Hosts run a stream with GCanvasWeex::RenderWebGLBinary; the JS bridges
+ * do not produce one yet, GBenchMark and capture replays do.
+ */
+enum GWebglCommandId
+{
+    WEBGL_CMD_ACTIVE_TEXTURE = 1,
+    WEBGL_CMD_ATTACH_SHADER = 2,
+    WEBGL_CMD_BIND_ATTRIB_LOCATION = 3,
+    WEBGL_CMD_BIND_BUFFER = 4,
+    WEBGL_CMD_BIND_FRAMEBUFFER = 5,
+    WEBGL_CMD_BIND_RENDERBUFFER = 6,
+    WEBGL_CMD_BIND_TEXTURE = 7,
+    WEBGL_CMD_BLEND_COLOR = 8,
+    WEBGL_CMD_BLEND_EQUATION = 9,
+    WEBGL_CMD_BLEND_EQUATION_SEPARATE = 10,
+    WEBGL_CMD_BLEND_FUNC = 11,
+    WEBGL_CMD_BLEND_FUNC_SEPARATE = 12,
+    WEBGL_CMD_BUFFER_DATA = 13,
+    WEBGL_CMD_BUFFER_SUB_DATA = 14,
+    WEBGL_CMD_CLEAR = 16,
+    WEBGL_CMD_CLEAR_COLOR = 17,
+    WEBGL_CMD_CLEAR_DEPTH = 18,
+    WEBGL_CMD_CLEAR_STENCIL = 19,
+    WEBGL_CMD_COLOR_MASK = 20,
+    WEBGL_CMD_COMPILE_SHADER = 21,
+    WEBGL_CMD_COMPRESSED_TEX_IMAGE_2D = 22,
+    WEBGL_CMD_COMPRESSED_TEX_SUB_IMAGE_2D = 23,
+    WEBGL_CMD_COPY_TEX_IMAGE_2D = 24,
+    WEBGL_CMD_COPY_TEX_SUB_IMAGE_2D = 25,
+    WEBGL_CMD_CULL_FACE = 32,
+    WEBGL_CMD_DELETE_BUFFER = 33,
+    WEBGL_CMD_DELETE_FRAMEBUFFER = 34,
+    WEBGL_CMD_DELETE_PROGRAM = 35,
+    WEBGL_CMD_DELETE_RENDERBUFFER = 36,
+    WEBGL_CMD_DELETE_SHADER = 37,
+    WEBGL_CMD_DELETE_TEXTURE = 38,
+    WEBGL_CMD_DEPTH_FUNC = 39,
+    WEBGL_CMD_DEPTH_MASK = 40,
+    WEBGL_CMD_DEPTH_RANGE = 41,
+    WEBGL_CMD_DETACH_SHADER = 42,
+    WEBGL_CMD_DISABLE = 43,
+    WEBGL_CMD_DISABLE_VERTEX_ATTRIB_ARRAY = 44,
+    WEBGL_CMD_DRAW_ARRAYS = 45,
+    WEBGL_CMD_DRAW_ELEMENTS = 47,
+    WEBGL_CMD_ENABLE = 49,
+    WEBGL_CMD_ENABLE_VERTEX_ATTRIB_ARRAY = 50,
+    WEBGL_CMD_FLUSH = 51,
+    WEBGL_CMD_FRAMEBUFFER_RENDERBUFFER = 52,
+    WEBGL_CMD_FRAMEBUFFER_TEXTURE_2D = 53,
+    WEBGL_CMD_FRONT_FACE = 54,
+    WEBGL_CMD_GENERATE_MIPMAP = 55,
+    WEBGL_CMD_LINE_WIDTH = 87,
+    WEBGL_CMD_LINK_PROGRAM = 88,
+    WEBGL_CMD_PIXEL_STOREI = 89,
+    WEBGL_CMD_POLYGON_OFFSET = 90,
+    WEBGL_CMD_RENDERBUFFER_STORAGE = 92,
+    WEBGL_CMD_SAMPLE_COVERAGE = 93,
+    WEBGL_CMD_SCISSOR = 94,
+    WEBGL_CMD_SHADER_SOURCE = 95,
+    WEBGL_CMD_STENCIL_FUNC = 96,
+    WEBGL_CMD_STENCIL_FUNC_SEPARATE = 97,
+    WEBGL_CMD_STENCIL_MASK = 98,
+    WEBGL_CMD_STENCIL_MASK_SEPARATE = 99,
+    WEBGL_CMD_STENCIL_OP = 100,
+    WEBGL_CMD_STENCIL_OP_SEPARATE = 101,
+    WEBGL_CMD_TEX_IMAGE_2D = 102,
+    WEBGL_CMD_TEX_PARAMETERF = 103,
+    WEBGL_CMD_TEX_PARAMETERI = 104,
+    WEBGL_CMD_TEX_SUB_IMAGE_2D = 105,
+    WEBGL_CMD_UNIFORM1F = 106,
+    WEBGL_CMD_UNIFORM1FV = 107,
+    WEBGL_CMD_UNIFORM1I = 108,
+    WEBGL_CMD_UNIFORM1IV = 109,
+    WEBGL_CMD_UNIFORM2F = 110,
+    WEBGL_CMD_UNIFORM2FV = 111,
+    WEBGL_CMD_UNIFORM2I = 112,
+    WEBGL_CMD_UNIFORM2IV = 113,
+    WEBGL_CMD_UNIFORM3F = 114,
+    WEBGL_CMD_UNIFORM3FV = 115,
+    WEBGL_CMD_UNIFORM3I = 116,
+    WEBGL_CMD_UNIFORM3IV = 117,
+    WEBGL_CMD_UNIFORM4F = 118,
+    WEBGL_CMD_UNIFORM4FV = 119,
+    WEBGL_CMD_UNIFORM4I = 120,
+    WEBGL_CMD_UNIFORM4IV = 121,
+    WEBGL_CMD_UNIFORM_MATRIX2FV = 122,
+    WEBGL_CMD_UNIFORM_MATRIX3FV = 123,
+    WEBGL_CMD_UNIFORM_MATRIX4FV = 124,
+    WEBGL_CMD_USE_PROGRAM = 125,
+    WEBGL_CMD_VALIDATE_PROGRAM = 126,
+    WEBGL_CMD_VERTEX_ATTRIB1F = 127,
+    WEBGL_CMD_VERTEX_ATTRIB2F = 128,
+    WEBGL_CMD_VERTEX_ATTRIB3F = 129,
+    WEBGL_CMD_VERTEX_ATTRIB4F = 130,
+    WEBGL_CMD_VERTEX_ATTRIB1FV = 131,
+    WEBGL_CMD_VERTEX_ATTRIB2FV = 132,
+    WEBGL_CMD_VERTEX_ATTRIB3FV = 133,
+    WEBGL_CMD_VERTEX_ATTRIB4FV = 134,
+    WEBGL_CMD_VERTEX_ATTRIB_POINTER = 135,
+    WEBGL_CMD_VIEWPORT = 136,
+
+    WEBGL_CMD_COUNT = 137
+};
+
+// cursor over the arguments of one record
+class GWebglBinaryArgs
+{
+public:
+    GWebglBinaryArgs(const unsigned char *begin, const unsigned char *end)
+            : mCur(begin), mEnd(end), mValid(true)
+    {
+    }
+
+    int32_t Int();
+
+    float Float();
+
+    // points into the stream, nullptr for an empty payload
+    const void *Bytes(uint32_t &length);
+
+    bool IsValid() const { return mValid; }
+
+private:
+    const unsigned char *mCur;
+    const unsigned char *mEnd;
+    bool mValid;
+};
+
+class GWebglBinaryReader
+{
+public:
+    GWebglBinaryReader();
+
+    // Runs the commands against the current GL context and returns how many
+    // were executed, or -1 when the stream is misaligned, a record is cut
+    // short or has an unknown id. Records before the bad one have already
+    // run, the bad one not.
+    int Execute(const void *data, size_t length);
+
+    void SetDevicePixelRatio(float ratio) { mDevicePixelRatio = ratio; }
+
+    // bindFramebuffer(target, 0) calls this instead when set, for hosts whose
+    // default framebuffer is not 0 (iOS GLKView)
+    void SetDefaultFramebufferBinder(const std::function<void()> &binder)
+    {
+        mBindDefaultFramebuffer = binder;
+    }
+
+    // drawArrays and drawElements run so far
+    unsigned long DrawCount() const { return mDrawCount; }
+
+private:
+    void ExecuteCommand(uint32_t id, GWebglBinaryArgs &a);
+
+    unsigned long mDrawCount;
+    float mDevicePixelRatio;
+    std::function<void()> mBindDefaultFramebuffer;
+    std::string mName;   // bindAttribLocation needs it terminated
+};
+
+// builds a stream, e.g. to record a frame
+class GWebglBinaryWriter
+{
+public:
+    void Begin(uint32_t id);
+
+    void Int(int32_t value);
+
+    void Float(float value);
+
+    void Bytes(const void *data, uint32_t length);
+
+    void End();
+
+    const unsigned char *Data() const { return mData.empty() ? nullptr : (const unsigned char *)&mData[0]; }
+
+    size_t Size() const { return mData.size() * sizeof(uint32_t); }
+
+    void Clear() { mData.clear(); }
+
+private:
+    std::vector<uint32_t> mData;   // words keep the stream 4 byte aligned
+    size_t mRecordStart = 0;
+};
+
+#endif /* GCANVAS_GWEBGLBINARYSTREAM_H */
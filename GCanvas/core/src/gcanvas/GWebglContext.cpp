@@ -12,17 +12,21 @@
 #include "GGL.h"
 #include "GCanvas.hpp"
 #include "GCanvasWeex.hpp"
+#include "GFrameProfiler.h"
 #include "../support/Encode.h"
+#include "../support/GLUtil.h"
 #include "../support/Util.h"
 
 #include <string>
+#include <string.h>
+#include <vector>
 #include <stdint.h>
 #include <sstream>
 #include <iostream>
 
 //refrence https://www.khronos.org/registry/OpenGL-Refpages/es2.0/
 
-#ifdef ANDROID
+#if defined(ANDROID) || defined(__linux__)
 #define GL_GLEXT_PROTOTYPES
 PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESv;
 PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESv;
@@ -31,7 +35,7 @@ PFNGLISVERTEXARRAYOESPROC glIsVertexArrayOESv;
 #endif
 
 #define WEBGL_EXT_API_OFFSET    300
-#define WEBGL_EXT_API_COUNT     7
+#define WEBGL_EXT_API_COUNT     8
 #define WEBGL_EXT_API_MAX_INDEX (WEBGL_EXT_API_OFFSET+WEBGL_EXT_API_COUNT)
 
 #define WEBGL_API_COUNT     137 //(1 + 136)
@@ -39,6 +43,9 @@ PFNGLISVERTEXARRAYOESPROC glIsVertexArrayOESv;
 
 #define G_BUFFER_OFFSET(i) ((char *)NULL + (i))
 
+// plain text uniformMatrix*fv arguments, four mat4
+#define GWEBGL_MAX_MATRIX_FLOATS 64
+
 
 namespace gcanvas {
 
@@ -49,37 +56,56 @@ namespace gcanvas {
         return oss.str();
     }
 
-    const int *ParseTokensInt(const char *&p, int iMaxCount) {
-        static int tokens[16];
-        if (iMaxCount > 16) {
-            LOG_I("[ParseTokensInt] iMaxCount[%d] is too larger...", iMaxCount);
-        }
+    // Tokens of the current command are parsed into storage owned by the
+    // caller, usually a local array of the handler, so handlers stay
+    // reentrant and contexts on different threads never share a buffer.
+    // Reads at most count tokens and stops at the end of the command, slots
+    // left over are zeroed. Returns the number of tokens read.
+    int ParseTokensInt(const char *&p, int *out, int count) {
         int iToken = 0;
 
-        while (*p && *p != ';' && iToken < iMaxCount) {
-            tokens[iToken++] = atoi(p);
+        while (*p && *p != ';' && iToken < count) {
+            out[iToken++] = atoi(p);
             while (*p && (*p != ',' && *p != ';')) {
                 ++p;
             }
             if (*p == ',') ++p;
         }
         if (*p == ';') ++p;
-        return tokens;
+        for (int i = iToken; i < count; ++i) {
+            out[i] = 0;
+        }
+        return iToken;
     }
 
-    const float *ParseTokensFloat(const char *&p, int iMaxCount) {
-        static float tokens[32];
+    int ParseTokensFloat(const char *&p, float *out, int count) {
         int iToken = 0;
 
-        while (*p && *p != ';' && iToken < iMaxCount) {
-            tokens[iToken++] = atof(p);
+        while (*p && *p != ';' && iToken < count) {
+            out[iToken++] = (float) atof(p);
             while (*p && (*p != ',' && *p != ';')) {
                 ++p;
             }
             if (*p == ',') ++p;
         }
         if (*p == ';') ++p;
-        return tokens;
+        for (int i = iToken; i < count; ++i) {
+            out[i] = 0;
+        }
+        return iToken;
+    }
+
+    // single argument commands
+    int ParseTokenInt(const char *&p) {
+        int value;
+        ParseTokensInt(p, &value, 1);
+        return value;
+    }
+
+    float ParseTokenFloat(const char *&p) {
+        float value;
+        ParseTokensFloat(p, &value, 1);
+        return value;
     }
 
     void ParseTokensSkip(const char *&p) {
@@ -254,6 +280,87 @@ namespace gcanvas {
         return array;
     }
 
+    // decimal tokens decoded straight out of the base64 stream into a typed array
+    struct TypedArraySink {
+        int bytes;
+        char *array;
+        unsigned int count;
+        unsigned int capacity;
+        char token[64];
+        int tokenLen;
+    };
+
+    static void FlushTypedArrayToken(TypedArraySink *sink) {
+        if (sink->tokenLen == 0) return;
+        sink->token[sink->tokenLen] = '\0';
+        sink->tokenLen = 0;
+        if (sink->count >= sink->capacity) return;
+
+        unsigned int i = sink->count++;
+        if (sink->bytes == 1) {
+            ((int8_t *) sink->array)[i] = (int8_t) atoi(sink->token);
+        } else if (sink->bytes == 2) {
+            ((int16_t *) sink->array)[i] = (int16_t) atoi(sink->token);
+        } else if (sink->bytes == 4) {
+            ((int32_t *) sink->array)[i] = (int32_t) atoi(sink->token);
+        } else {
+            ((float *) sink->array)[i] = (float) atof(sink->token);
+        }
+    }
+
+    static bool TypedArraySinkWrite(const char *data, int len, void *userData) {
+        TypedArraySink *sink = (TypedArraySink *) userData;
+        for (int i = 0; i < len; ++i) {
+            char c = data[i];
+            if (c == ',') {
+                FlushTypedArrayToken(sink);
+            } else if (sink->tokenLen < (int) sizeof(sink->token) - 1) {
+                sink->token[sink->tokenLen++] = c;
+            }
+        }
+        return true;
+    }
+
+    // Same result as ParseTokensBase64 + SplitStringToArray, but decodes the
+    // payload in chunks and parses it on the fly, so neither the decoded text
+    // nor the intermediate element vector is materialized.
+    void *ParseTokensBase64Array(const char *&pos, int bytes, unsigned int &size) {
+        const char *begin = pos;
+        ParseTokensSkip(pos);
+        int len = (int) (pos - begin - 1);
+        size = 0;
+
+        if (len <= 0) return NULL;
+
+        int elementSize = (bytes == 14) ? (bytes - 10) : bytes;
+        if (elementSize != 1 && elementSize != 2 && elementSize != 4) return NULL;
+
+        // every element takes at least one digit and one separator
+        TypedArraySink sink;
+        sink.bytes = bytes;
+        sink.count = 0;
+        sink.capacity = (unsigned int) (gcanvas::Base64DecodeLen(len) / 2 + 1);
+        sink.tokenLen = 0;
+        sink.array = (char *) malloc(elementSize * sink.capacity);
+        if (!sink.array) return NULL;
+
+        if (gcanvas::Base64DecodeStream(begin, len, TypedArraySinkWrite, &sink) < 0) {
+            LOG_W("[ParseTokensBase64Array] malformed base64 payload, len=%d", len);
+            free(sink.array);
+            return NULL;
+        }
+        FlushTypedArrayToken(&sink);
+
+        if (sink.count == 0) {
+            free(sink.array);
+            return NULL;
+        }
+
+        size = sink.count * elementSize;
+        void *array = realloc(sink.array, size);
+        return array ? array : sink.array;
+    }
+
 
     typedef enum {
         kReturnBoolean = 1,
@@ -584,15 +691,19 @@ namespace gcanvas {
 // https://developer.mozilla.org/en-US/docs/Web/API/WebGLRenderingContext
 //////////////////////////////////////////////////////////////////////////
     int activeTexture(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
 
         LOG_D("[webgl::exec] glActiveTexture(%s)", GetMacroValDebug(tokens[0]));
-        glActiveTexture(tokens[0]);
+        if (obj->mWebglState.ActiveTexture(tokens[0])) {
+            glActiveTexture(tokens[0]);
+        }
         return kContinue;
     }
 
     int attachShader(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint program = tokens[0];
         GLuint shader = tokens[1];
 
@@ -602,7 +713,8 @@ namespace gcanvas {
     }
 
     int bindAttribLocation(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint program = tokens[0];
         GLuint index = tokens[1];
 
@@ -615,18 +727,22 @@ namespace gcanvas {
     }
 
     int bindBuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
 
         GLuint target = tokens[0];
         GLuint buffer = tokens[1];
 
         LOG_D("[webgl::exec] glBindBuffer(%s, %d)", GetMacroValDebug(target), buffer);
-        glBindBuffer(target, buffer);
+        if (obj->mWebglState.BindBuffer(target, buffer)) {
+            glBindBuffer(target, buffer);
+        }
         return kContinue;
     }
 
     int bindFramebuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint target = tokens[0];
         GLuint framebuffer = tokens[1];
 
@@ -639,9 +755,13 @@ namespace gcanvas {
         if(func){
             func(obj->mContextId);
         }
+        // the view binds its own framebuffer, not 0
+        obj->mWebglState.ForgetFramebuffer();
     }else{
 #endif
-        glBindFramebuffer(target, framebuffer);
+        if (obj->mWebglState.BindFramebuffer(target, framebuffer)) {
+            glBindFramebuffer(target, framebuffer);
+        }
 #ifdef IOS
         }
 #endif
@@ -649,85 +769,105 @@ namespace gcanvas {
     }
 
     int bindRenderbuffer(GCanvasWeex *obj, const char *&p) { // bindRenderbuffer0,81;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint target = tokens[0];
         GLuint renderbuffer = tokens[1];
 
         LOG_D("[webgl::exec] bindRenderbuffer(%s, %d)", GetMacroValDebug(target), renderbuffer);
-        glBindRenderbuffer(target, renderbuffer);
+        if (obj->mWebglState.BindRenderbuffer(target, renderbuffer)) {
+            glBindRenderbuffer(target, renderbuffer);
+        }
         return kContinue;
     }
 
 //new
     int blendColor(GCanvasWeex *obj, const char *&p) { // blendColor0,81;
-        const float *tokens = ParseTokensFloat(p, 4);
+        float tokens[4];
+        ParseTokensFloat(p, tokens, 4);
         GLfloat red = tokens[0];
         GLfloat green = tokens[1];
         GLfloat blue = tokens[2];
         GLfloat alpha = tokens[3];
 
         LOG_D("[webgl::exec] blendColor(%f, %f, %f, %f)", red, green, blue, alpha);
-        glBlendColor(red, green, blue, alpha);
+        if (obj->mWebglState.BlendColor(red, green, blue, alpha)) {
+            glBlendColor(red, green, blue, alpha);
+        }
         return kContinue;
     }
 
     int bindTexture(GCanvasWeex *obj, const char *&p) { // bindTexture0,4;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint target = tokens[0];
         GLuint texture = tokens[1];
 
         LOG_D("[webgl::exec] glBindTexture(%s, %d)", GetMacroValDebug(target), texture);
-        glBindTexture(target, texture);
+        if (obj->mWebglState.BindTexture(target, texture)) {
+            glBindTexture(target, texture);
+        }
         return kContinue;
     }
 
     int blendEquation(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
 
         LOG_D("[webgl::exec] glBlendEquation(%s)", GetMacroValDebug(tokens[0]));
-        glBlendEquation(tokens[0]);
+        if (obj->mWebglState.BlendEquationSeparate(tokens[0], tokens[0])) {
+            glBlendEquation(tokens[0]);
+        }
         return kContinue;
     }
 
     int blendEquationSeparate(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
 
         LOG_D("[webgl::exec] glBlendEquationSeparate(%s, %s)", GetMacroValDebug(tokens[0]),
               GetMacroValDebug(tokens[1]));
-        glBlendEquationSeparate(tokens[0], tokens[1]);
+        if (obj->mWebglState.BlendEquationSeparate(tokens[0], tokens[1])) {
+            glBlendEquationSeparate(tokens[0], tokens[1]);
+        }
         return kContinue;
     }
 
     int blendFunc(GCanvasWeex *obj, const char *&p) { // blendFunc1,2;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
 
         LOG_D("[webgl::exec] glBlendFunc(%s, %s)", GetMacroValDebug(tokens[0]),
               GetMacroValDebug(tokens[1]));
-        glBlendFunc(tokens[0], tokens[1]);
+        if (obj->mWebglState.BlendFuncSeparate(tokens[0], tokens[1], tokens[0], tokens[1])) {
+            glBlendFunc(tokens[0], tokens[1]);
+        }
         return kContinue;
     }
 
     int blendFuncSeparate(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
 
         LOG_D("[webgl::exec] glBlendFuncSeparate(%s, %s, %s, %s)",
               GetMacroValDebug(tokens[0]), GetMacroValDebug(tokens[1]),
               GetMacroValDebug(tokens[2]), GetMacroValDebug(tokens[3]));
-        glBlendFuncSeparate(tokens[0], tokens[1], tokens[2], tokens[3]);
+        if (obj->mWebglState.BlendFuncSeparate(tokens[0], tokens[1], tokens[2], tokens[3])) {
+            glBlendFuncSeparate(tokens[0], tokens[1], tokens[2], tokens[3]);
+        }
         return kContinue;
     }
 
     int bufferData(GCanvasWeex *obj, const char *&p) { // bufferData0,4,AAEAAAAAAQEAAAAAAP8A/wAA,0;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum target = tokens[0];
         int bytes = tokens[1];
-        std::string &buf = obj->mTempStr;
-        ParseTokensBase64(p, buf);
 
         unsigned int size;
-        GLvoid *array = SplitStringToArray(buf.c_str(), bytes, size);
+        GLvoid *array = ParseTokensBase64Array(p, bytes, size);
 
-        int usage = ParseTokensInt(p, 1)[0];
+        int usage = ParseTokenInt(p);
         if (bytes == 1) {
             LOG_D("[webgl::exec] glBufferData: %d", ((GLbyte *) array)[0]);
             LOG_D("[webgl::exec] glBufferData: %d", ((GLbyte *) array)[1]);
@@ -747,15 +887,14 @@ namespace gcanvas {
 
     int bufferSubData(GCanvasWeex *obj,
                       const char *&p) { //bufferSubData0, offset, bytes, AAEAAAAAAQEAAAAAAP8A/wAA
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLenum target = tokens[0];
         int offset = tokens[1];
         int bytes = tokens[2];
-        std::string &buf = obj->mTempStr;
-        ParseTokensBase64(p, buf);
 
         unsigned int size;
-        GLvoid *array = SplitStringToArray(buf.c_str(), bytes, size);
+        GLvoid *array = ParseTokensBase64Array(p, bytes, size);
 
         if (array) {
             LOG_D("[webgl::exec] glBufferSubData(%s, %d, %d)",
@@ -769,7 +908,8 @@ namespace gcanvas {
 
 //new
     int checkFramebufferStatus(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLenum target = tokens[0];
 
         LOG_D("[webgl::exec] glCheckFramebufferStatus(%s)", GetMacroValDebug(target));
@@ -780,44 +920,53 @@ namespace gcanvas {
     }
 
     int clear(GCanvasWeex *obj, const char *&p) { // clear;
-        const int mask = ParseTokensInt(p, 1)[0];
+        const int mask = ParseTokenInt(p);
         glClear(mask);
         LOG_D("[webgl::exec] glClear(%d)", mask);
         return kContinue;
     }
 
     int clearColor(GCanvasWeex *obj, const char *&p) { // clearColor0,0,0,1;
-        const float *tokens = ParseTokensFloat(p, 4);
+        float tokens[4];
+        ParseTokensFloat(p, tokens, 4);
         LOG_D("[webgl::exec] glClearColor(%f, %f, %f, %f)", tokens[0], tokens[1],
               tokens[2], tokens[3]);
-        glClearColor(tokens[0], tokens[1], tokens[2], tokens[3]);
+        if (obj->mWebglState.ClearColor(tokens[0], tokens[1], tokens[2], tokens[3])) {
+            glClearColor(tokens[0], tokens[1], tokens[2], tokens[3]);
+        }
         return kContinue;
     }
 
     int clearDepth(GCanvasWeex *obj, const char *&p) { // clearDepth1.0;
-        const float *tokens = ParseTokensFloat(p, 1);
+        float tokens[1];
+        ParseTokensFloat(p, tokens, 1);
         LOG_D("[webgl::exec] glClearDepthf(%f)", tokens[0]);
         glClearDepthf(tokens[0]);
         return kContinue;
     }
 
     int clearStencil(GCanvasWeex *obj, const char *&p) { // clearStencil2;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glClearStencil(%d)", tokens[0]);
         glClearStencil(tokens[0]);
         return kContinue;
     }
 
     int colorMask(GCanvasWeex *obj, const char *&p) { // colorMask0,0,0,1;
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         LOG_D("[webgl::exec] glColorMask(%d, %d, %d, %d)", tokens[0], tokens[1],
               tokens[2], tokens[3]);
-        glColorMask(tokens[0], tokens[1], tokens[2], tokens[3]);
+        if (obj->mWebglState.ColorMask(tokens[0] != 0, tokens[1] != 0, tokens[2] != 0, tokens[3] != 0)) {
+            glColorMask(tokens[0], tokens[1], tokens[2], tokens[3]);
+        }
         return kContinue;
     }
 
     int compileShader(GCanvasWeex *obj, const char *&p) { // compileShader1
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         LOG_D("[webgl::exec] glCompileShader(%d)", shader);
@@ -827,7 +976,8 @@ namespace gcanvas {
 
 //new
     int compressedTexImage2D(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 7);
+        int tokens[7];
+        ParseTokensInt(p, tokens, 7);
         GLenum target = tokens[0];
         GLuint level = tokens[1];
         GLenum internalformat = tokens[2];
@@ -836,22 +986,24 @@ namespace gcanvas {
         GLsizei border = tokens[5];
         int bytes = tokens[6];
 
-        std::string &buf = obj->mTempStr;
-        ParseTokensBase64(p, buf);
-
         unsigned int size = 0;
-        GLvoid *array = SplitStringToArray(buf.c_str(), bytes, size);
+        GLvoid *array = ParseTokensBase64Array(p, bytes, size);
 
         LOG_D("[webgl::exec] glCompressedTexImage2D(%s, %d, %s, %d, %d, %d, %d)",
               GetMacroValDebug(target), level,
               GetMacroValDebug(internalformat), width, height, border, size);
         glCompressedTexImage2D(target, level, internalformat, width, height, border, size, array);
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, array ? size : 0);
+        if (array) {
+            free(array);
+        }
         return kContinue;
     }
 
 //new
     int compressedTexSubImage2D(GCanvasWeex *obj, const char *&p) {
-        const int *intTokens = ParseTokensInt(p, 8);
+        int intTokens[8];
+        ParseTokensInt(p, intTokens, 8);
         GLenum target = intTokens[0];
         GLuint level = intTokens[1];
         GLint xoffset = intTokens[2];
@@ -861,24 +1013,26 @@ namespace gcanvas {
         GLenum format = intTokens[6];
         int bytes = intTokens[7];
 
-        std::string &buf = obj->mTempStr;
-        ParseTokensBase64(p, buf);
-
         unsigned int size = 0;
-        GLvoid *array = SplitStringToArray(buf.c_str(), bytes, size);
+        GLvoid *array = ParseTokensBase64Array(p, bytes, size);
 
         LOG_D("[webgl::exec] glCompressedTexImage2D(%s, %d, %d, %d, %d, %d, %s, %d)",
               GetMacroValDebug(target), level,
               xoffset, yoffset, width, height, GetMacroValDebug(format), size);
         glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, size,
                                   array);
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES, array ? size : 0);
+        if (array) {
+            free(array);
+        }
         return kContinue;
     }
 
 
     int copyTexImage2D(GCanvasWeex *obj,
                        const char *&p) {//copyTexImage2D gl.copyTexImage2D(gl.TEXTURE_2D, 0, gl.RGBA, 0, 0, 512, 512, 0);
-        const int *tokens = ParseTokensInt(p, 8);
+        int tokens[8];
+        ParseTokensInt(p, tokens, 8);
         LOG_D("[webgl::exec] glCopyTexImage2D(%s, %d, %s, %d, %d, %d, %d)",
               GetMacroValDebug(tokens[0]), tokens[1], GetMacroValDebug(tokens[2]), tokens[3],
               tokens[4], tokens[5], tokens[6], tokens[7]);
@@ -889,7 +1043,8 @@ namespace gcanvas {
 
 //new
     int copyTexSubImage2D(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 8);
+        int tokens[8];
+        ParseTokensInt(p, tokens, 8);
         LOG_D("[webgl::exec] glCopyTexSubImage2D(%s, %d, %d, %d, %d, %d, %d)",
               GetMacroValDebug(tokens[0]), tokens[1], tokens[2], tokens[3], tokens[4], tokens[5],
               tokens[6], tokens[7]);
@@ -911,6 +1066,7 @@ namespace gcanvas {
     int createFramebuffer(GCanvasWeex *obj, const char *&p) { // createFramebuffer;
         GLuint framebuffer = 0;
         glGenFramebuffers(1, &framebuffer);
+        GFRAME_COUNT(FRAME_COUNTER_FBO_ALLOCATIONS, 1);
         ++p;
         LOG_D("[webgl::exec] glGenFramebuffers(1, %d)", framebuffer);
 
@@ -938,7 +1094,8 @@ namespace gcanvas {
     }
 
     int createShader(GCanvasWeex *obj, const char *&p) { // createShader1;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = glCreateShader(tokens[0]);
         ++p;
         LOG_D("[webgl::exec] glCreateShader(%s)=%d", GetMacroValDebug(tokens[0]), shader);
@@ -958,32 +1115,40 @@ namespace gcanvas {
     }
 
     int cullFace(GCanvasWeex *obj, const char *&p) { // cullFace1;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glCullFace(%s)", GetMacroValDebug(tokens[0]));
-        glCullFace(tokens[0]);
+        if (obj->mWebglState.CullFace(tokens[0])) {
+            glCullFace(tokens[0]);
+        }
         return kContinue;
     }
 
     int deleteBuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint buffer = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteBuffer(1, %d)", buffer);
         glDeleteBuffers(1, &buffer);
+        obj->mWebglState.DeleteBuffer(buffer);
         return kContinue;
     }
 
     int deleteFramebuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint framebuffer = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteFramebuffers(1, %d)", framebuffer);
         glDeleteFramebuffers(1, &framebuffer);
+        obj->mWebglState.DeleteFramebuffer(framebuffer);
         return kContinue;
     }
 
     int deleteProgram(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteProgram(%d)", program);
@@ -992,16 +1157,19 @@ namespace gcanvas {
     }
 
     int deleteRenderbuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint renderbuffer = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteRenderbuffers(1, %d)", renderbuffer);
         glDeleteRenderbuffers(1, &renderbuffer);
+        obj->mWebglState.DeleteRenderbuffer(renderbuffer);
         return kContinue;
     }
 
     int deleteShader(GCanvasWeex *obj, const char *&p) { // deleteShader;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteShader(%d)", shader);
@@ -1010,30 +1178,38 @@ namespace gcanvas {
     }
 
     int deleteTexture(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint texture = tokens[0];
 
         LOG_D("[webgl::exec] glDeleteTextures(1, %d)", texture);
         glDeleteTextures(1, &texture);
+        obj->mWebglState.DeleteTexture(texture);
         return kContinue;
     }
 
     int depthFunc(GCanvasWeex *obj, const char *&p) { // depthFunc1;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glDepthFunc(%s)", GetMacroValDebug(tokens[0]));
-        glDepthFunc(tokens[0]);
+        if (obj->mWebglState.DepthFunc(tokens[0])) {
+            glDepthFunc(tokens[0]);
+        }
         return kContinue;
     }
 
     int depthMask(GCanvasWeex *obj, const char *&p) {
-        const int flag = ParseTokensInt(p, 1)[0];
+        const int flag = ParseTokenInt(p);
         LOG_D("[webgl::exec] glDepthMask(%d)", flag);
-        glDepthMask((bool) flag);
+        if (obj->mWebglState.DepthMask(flag ? GL_TRUE : GL_FALSE)) {
+            glDepthMask((bool) flag);
+        }
         return kContinue;
     }
 
     int depthRange(GCanvasWeex *obj, const char *&p) {
-        const float *tokens = ParseTokensFloat(p, 2);
+        float tokens[2];
+        ParseTokensFloat(p, tokens, 2);
         LOG_D("[webgl::exec] glDepthRange(%f, %f)", tokens[0], tokens[1]);
         glDepthRangef(tokens[0], tokens[1]);
         return kContinue;
@@ -1041,21 +1217,26 @@ namespace gcanvas {
 
 //new
     int detachShader(GCanvasWeex *obj, const char *&p) {
-        const float *tokens = ParseTokensFloat(p, 2);
+        float tokens[2];
+        ParseTokensFloat(p, tokens, 2);
         LOG_D("[webgl::exec] glDetachShader(%d, %d)", tokens[0], tokens[1]);
         glDetachShader(tokens[0], tokens[1]);
         return kContinue;
     }
 
     int disable(GCanvasWeex *obj, const char *&p) { // disable0;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glDisable(%s)", GetMacroValDebug(tokens[0]));
-        glDisable(tokens[0]);
+        if (obj->mWebglState.SetCapability(tokens[0], false)) {
+            glDisable(tokens[0]);
+        }
         return kContinue;
     }
 
     int disableVertexAttribArray(GCanvasWeex *obj, const char *&p) { // disableVertexAttribArray0;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glDisableVertexAttribArray(%d)",
               tokens[0]);
         glDisableVertexAttribArray(tokens[0]);
@@ -1063,32 +1244,43 @@ namespace gcanvas {
     }
 
     int drawArrays(GCanvasWeex *obj, const char *&p) { // drawArrays4,0,3;
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         LOG_D("[webgl::exec] glDrawArrays(%s, %d, %d)", GetMacroValDebug(tokens[0]),
               tokens[1], tokens[2]);
         glDrawArrays(tokens[0], tokens[1], tokens[2]);
+        obj->mCanvasContext->mDrawCallCount++;
+        GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+        GFRAME_COUNT(FRAME_COUNTER_VERTICES, tokens[2]);
         LOG_D("after glDrawArrays");
         return kContinue;
     }
 
     int drawElements(GCanvasWeex *obj, const char *&p) { // drawElements4,36,0,0;
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         LOG_D("[webgl::exec] glDrawElements(%s, %d, %s, %d)",
               GetMacroValDebug(tokens[0]), tokens[1], GetMacroValDebug(tokens[2]),
               tokens[3]);
         glDrawElements(tokens[0], tokens[1], tokens[2], G_BUFFER_OFFSET(tokens[3]));
+        obj->mCanvasContext->mDrawCallCount++;
+        GFRAME_COUNT(FRAME_COUNTER_DRAW_CALLS, 1);
+        GFRAME_COUNT(FRAME_COUNTER_VERTICES, tokens[1]);
         return kContinue;
     }
 
     int enable(GCanvasWeex *obj, const char *&p) { // enable0;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glEnable(%s)", GetMacroValDebug(tokens[0]));
-        glEnable(tokens[0]);
+        if (obj->mWebglState.SetCapability(tokens[0], true)) {
+            glEnable(tokens[0]);
+        }
         return kContinue;
     }
 
     int enableVertexAttribArray(GCanvasWeex *obj, const char *&p) { // enableVertexAttribArray10;
-        GLuint index = ParseTokensInt(p, 1)[0];
+        GLuint index = ParseTokenInt(p);
         LOG_D("[webgl::exec] glEnableVertexAttribArray(%d)", index);
         glEnableVertexAttribArray(index);
         return kContinue;
@@ -1102,7 +1294,8 @@ namespace gcanvas {
     }
 
     int framebufferRenderbuffer(GCanvasWeex *obj, const char *&p) { // framebufferRenderbuffer0,1,0,81;
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         LOG_D("[webgl::exec] glFramebufferRenderbuffer(GL_FRAMEBUFFER, %s, xGL_RENDERBUFFER, %d)",
               GetMacroValDebug(tokens[1]), tokens[3]);
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, tokens[1], GL_RENDERBUFFER, tokens[3]);
@@ -1110,7 +1303,8 @@ namespace gcanvas {
     }
 
     int framebufferTexture2D(GCanvasWeex *obj, const char *&p) { // framebufferTexture2D0,0,0,40,0;
-        const int *tokens = ParseTokensInt(p, 5);
+        int tokens[5];
+        ParseTokensInt(p, tokens, 5);
         LOG_D("[webgl::exec] glFramebufferTexture2D(GL_FRAMEBUFFER, %s, %s, %d, 0)",
               GetMacroValDebug(tokens[1]), GetMacroValDebug(tokens[2]), tokens[3], tokens[4]);
         glFramebufferTexture2D(GL_FRAMEBUFFER, tokens[1], tokens[2], tokens[3], tokens[4]);
@@ -1118,21 +1312,25 @@ namespace gcanvas {
     }
 
     int frontFace(GCanvasWeex *obj, const char *&p) { // enable0;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         LOG_D("[webgl::exec] glFrontFace(%s)", GetMacroValDebug(tokens[0]));
-        glFrontFace(tokens[0]);
+        if (obj->mWebglState.FrontFace(tokens[0])) {
+            glFrontFace(tokens[0]);
+        }
         return kContinue;
     }
 
     int generateMipmap(GCanvasWeex *obj, const char *&p) { // generateMipmap0;
-        GLenum target = ParseTokensInt(p, 1)[0];
+        GLenum target = ParseTokenInt(p);
         LOG_D("[webgl::exec] glGenerateMipmap(%s)", GetMacroValDebug(target));
         glGenerateMipmap(target);
         return kContinue;
     }
 
     int getActiveAttrib(GCanvasWeex *obj, const char *&p) {//getActiveAttrib
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
 
         GLuint program = tokens[0];
         GLuint index = tokens[1];
@@ -1162,7 +1360,8 @@ namespace gcanvas {
     }
 
     int getActiveUniform(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint program = tokens[0];
         GLuint index = tokens[1];
 
@@ -1192,7 +1391,8 @@ namespace gcanvas {
     }
 
     int getAttachedShaders(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
         GLsizei size = 0;
         GLuint shader[256];
@@ -1212,7 +1412,8 @@ namespace gcanvas {
     }
 
     int getAttribLocation(GCanvasWeex *obj, const char *&p) { // getAttribLocation31,position;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
         std::string &name = obj->mTempStr;
         ParseTokensString(p, name);
@@ -1227,7 +1428,8 @@ namespace gcanvas {
 
 //new
     int getBufferParameter(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum target = tokens[0];
         GLenum pname = tokens[1];
 
@@ -1275,7 +1477,8 @@ namespace gcanvas {
 
 //new
     int getFramebufferAttachmentParameter(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLenum target = tokens[0];
         GLenum attachment = tokens[1];
         GLenum pname = tokens[2];
@@ -1297,11 +1500,31 @@ namespace gcanvas {
         return kContinue;
     }
 
+    // state the WebGL mirror knows is answered without a glGet
+    void GetIntegerv(GCanvasWeex *obj, GLenum pname, GLint *values) {
+        if (!obj->mWebglState.GetIntegerv(pname, values)) {
+            glGetIntegerv(pname, values);
+        }
+    }
+
+    void GetFloatv(GCanvasWeex *obj, GLenum pname, GLfloat *values) {
+        if (!obj->mWebglState.GetFloatv(pname, values)) {
+            glGetFloatv(pname, values);
+        }
+    }
+
+    void GetBooleanv(GCanvasWeex *obj, GLenum pname, GLboolean *values) {
+        if (!obj->mWebglState.GetBooleanv(pname, values)) {
+            glGetBooleanv(pname, values);
+        }
+    }
+
 //new
     int getParameter(GCanvasWeex *obj, const char *&p) {
         //ref:https://www.khronos.org/registry/OpenGL-Refpages/es2.0/xhtml/glGet.xml
         
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLenum pname = tokens[0];
 
         switch (pname) {
@@ -1316,7 +1539,7 @@ namespace gcanvas {
             case GL_SCISSOR_TEST:
             case GL_STENCIL_TEST: {
                 GLboolean bParams;
-                glGetBooleanv(pname, &bParams);
+                GetBooleanv(obj, pname, &bParams);
 
                 LOG_D("[webgl::exec] glGetParameter(%s)=%d, glGetBooleanv",
                       GetMacroValDebug(pname), bParams);
@@ -1358,7 +1581,7 @@ namespace gcanvas {
             case GL_STENCIL_VALUE_MASK:
             case GL_STENCIL_WRITEMASK: {
                 GLint iParams;
-                glGetIntegerv(pname, &iParams);
+                GetIntegerv(obj, pname, &iParams);
 
                 LOG_D("[webgl::exec] getParameter(%s)=%d, glGetIntegerv",
                       GetMacroValDebug(pname), iParams);
@@ -1408,7 +1631,7 @@ namespace gcanvas {
             case GL_TEXTURE_BINDING_2D:
             case GL_TEXTURE_BINDING_CUBE_MAP: {
                 GLint iParams;
-                glGetIntegerv(pname, &iParams);
+                GetIntegerv(obj, pname, &iParams);
 
                 LOG_D("[webgl::exec] getParameter(%s)=%d, glGetIntegerv",
                       GetMacroValDebug(pname), iParams);
@@ -1428,7 +1651,7 @@ namespace gcanvas {
             case GL_POLYGON_OFFSET_UNITS:
             case GL_SAMPLE_COVERAGE_VALUE: {
                 GLfloat fParams;
-                glGetFloatv(pname, &fParams);
+                GetFloatv(obj, pname, &fParams);
 
                 LOG_D("[webgl::exec] getParameter(%s)=%f, glGetFloatv",
                       GetMacroValDebug(pname), fParams);
@@ -1445,7 +1668,7 @@ namespace gcanvas {
             case GL_MAX_VIEWPORT_DIMS: //	Int32Array (with 2 elements)
             {
                 GLint values[2];
-                glGetIntegerv(pname, values);
+                GetIntegerv(obj, pname, values);
 
                 GLuint retType = kReturnIntArray; //intArray
                 std::string result = gcanvas::toString(retType);
@@ -1467,7 +1690,7 @@ namespace gcanvas {
             case GL_VIEWPORT:    //Int32Array (with 4 elements)
             {
                 GLint values[4];
-                glGetIntegerv(pname, values);
+                GetIntegerv(obj, pname, values);
 
                 GLuint retType = kReturnIntArray; //intArray
                 std::string result = gcanvas::toString(retType);
@@ -1489,7 +1712,7 @@ namespace gcanvas {
             case GL_COLOR_WRITEMASK: //sequence<GLboolean> (with 4 values)
             {
                 GLint values[4];
-                glGetIntegerv(pname, values);
+                GetIntegerv(obj, pname, values);
 
                 GLuint retType = kReturnBooleanArray; //booleanArray
                 std::string result = gcanvas::toString(retType);
@@ -1514,7 +1737,7 @@ namespace gcanvas {
             case GL_ALIASED_POINT_SIZE_RANGE: //Float32Array (with 2 elements)
             case GL_DEPTH_RANGE: {
                 GLfloat values[2];
-                glGetFloatv(pname, values);
+                GetFloatv(obj, pname, values);
 
                 GLuint retType = kReturnFloatArray; //FloatArray
                 std::string result = gcanvas::toString(retType);
@@ -1535,7 +1758,7 @@ namespace gcanvas {
             case GL_COLOR_CLEAR_VALUE:        //Float32Array (with 4 values)
             {
                 GLfloat values[4];
-                glGetFloatv(pname, values);
+                GetFloatv(obj, pname, values);
 
                 GLuint retType = kReturnFloatArray; //FloatArray
                 std::string result = gcanvas::toString(retType);
@@ -1596,7 +1819,7 @@ namespace gcanvas {
             default: {
                 LOG_D("[webgl::exec] getParameter(%s) is undefined!!", GetMacroValDebug(pname));
                 GLint iParams;
-                glGetIntegerv(pname, &iParams);
+                GetIntegerv(obj, pname, &iParams);
 
                 GLuint retType = kReturnInt; //int
                 std::string result(gcanvas::toString(retType));
@@ -1612,7 +1835,8 @@ namespace gcanvas {
 
 //new
     int getProgramInfoLog(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
         GLchar infolog[2048];
@@ -1627,7 +1851,8 @@ namespace gcanvas {
 
 //new
     int getProgramParameter(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint program = tokens[0];
         GLenum pname = tokens[1];
 
@@ -1674,7 +1899,8 @@ namespace gcanvas {
 
 //new
     int getRenderbufferParameter(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum target = tokens[0];
         GLenum pname = tokens[1];
 
@@ -1699,7 +1925,8 @@ namespace gcanvas {
 
 //new
     int getShaderInfoLog(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         GLchar infolog[2048];
@@ -1717,7 +1944,8 @@ namespace gcanvas {
 
 
     int getShaderParameter(GCanvasWeex *obj, const char *&p) { // getShaderParameter1;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint shader = tokens[0];
         GLenum pname = tokens[1];
 
@@ -1758,7 +1986,8 @@ namespace gcanvas {
 
 //new
     int getShaderPrecisionFormat(GCanvasWeex *obj, const char *&p) { // getShaderPrecisionFormat;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum shadertype = tokens[0];
         GLenum precisiontype = tokens[1];
 
@@ -1788,7 +2017,8 @@ namespace gcanvas {
 
 //new
     int getShaderSource(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         GLchar source[4096];
@@ -1818,7 +2048,8 @@ namespace gcanvas {
         //https://www.khronos.org/registry/OpenGL-Refpages/es2.0/xhtml/glGetTexParameter.xml
         
         //WebGL 1.0 only support glGetTexParameteriv
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum target = tokens[0];
         GLenum pname = tokens[1];
 
@@ -1840,7 +2071,8 @@ namespace gcanvas {
 
 //new
     int getUniform(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLint program = tokens[0];
         GLint location = tokens[1];
 
@@ -1956,7 +2188,8 @@ namespace gcanvas {
 
 
     int getUniformLocation(GCanvasWeex *obj, const char *&p) { // getUniformLocation1,s_texture;
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
         std::string &name = obj->mTempStr;
         ParseTokensString(p, name);
@@ -1974,7 +2207,8 @@ namespace gcanvas {
 //new
     int getVertexAttrib(GCanvasWeex *obj,
                         const char *&p) { //https://developer.mozilla.org/en-US/docs/Web/API/WebGLRenderingContext/getVertexAttrib
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint index = tokens[0];
         GLenum pname = tokens[1];
 
@@ -2033,7 +2267,8 @@ namespace gcanvas {
 
 //new
     int getVertexAttribOffset(GCanvasWeex *obj, const char *&p) { // getVertexAttribOffset;
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLuint index = tokens[0];
 //    GLenum pname = tokens[1];
 
@@ -2047,7 +2282,8 @@ namespace gcanvas {
 
 //new
     int isBuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint buffer = tokens[0];
 
         GLuint ret = glIsBuffer(buffer);
@@ -2059,10 +2295,15 @@ namespace gcanvas {
 
 //new
     int isEnabled(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLenum cap = tokens[0];
 
-        GLuint ret = glIsEnabled(cap);
+        GLboolean enabled = GL_FALSE;
+        if (!obj->mWebglState.GetBooleanv(cap, &enabled)) {
+            enabled = glIsEnabled(cap);
+        }
+        GLuint ret = enabled;
         LOG_D("[webgl::exec] glIsEnabled(%d)=%d", GetMacroValDebug(cap), ret);
 
         obj->setSyncResult(gcanvas::toString(ret));
@@ -2071,7 +2312,8 @@ namespace gcanvas {
 
 //new
     int isFramebuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint framebuffer = tokens[0];
 
         GLuint ret = glIsFramebuffer(framebuffer);
@@ -2083,7 +2325,8 @@ namespace gcanvas {
 
 //new
     int isProgram(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
         GLuint ret = glIsProgram(program);
@@ -2095,7 +2338,8 @@ namespace gcanvas {
 
 //new
     int isRenderbuffer(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint renderbuffer = tokens[0];
 
         GLuint ret = glIsRenderbuffer(renderbuffer);
@@ -2107,7 +2351,8 @@ namespace gcanvas {
 
 //new
     int isShader(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         GLuint ret = glIsShader(shader);
@@ -2119,7 +2364,8 @@ namespace gcanvas {
 
 //new
     int isTexture(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint texture = tokens[0];
 
         GLuint ret = glIsTexture(texture);
@@ -2130,14 +2376,88 @@ namespace gcanvas {
     }
 
     int lineWidth(GCanvasWeex *obj, const char *&p) { // lineWidth1;
-        const GLfloat *tokens = ParseTokensFloat(p, 1);
+        GLfloat tokens[1];
+        ParseTokensFloat(p, tokens, 1);
         LOG_D("[webgl::exec] glLineWidth(%f)", tokens[0]);
-        glLineWidth(tokens[0]);
+        if (obj->mWebglState.LineWidth(tokens[0])) {
+            glLineWidth(tokens[0]);
+        }
         return kContinue;
     }
 
+    // One "location,type,size,name;" entry per active attribute or uniform,
+    // after a "count;" header. Uniform arrays get an entry per element,
+    // "name[i]" with size 1, since their locations need not be consecutive.
+    void AppendActiveVariables(GLuint program, bool uniforms, std::string &out) {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(program, uniforms ? GL_ACTIVE_UNIFORMS : GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(program, uniforms ? GL_ACTIVE_UNIFORM_MAX_LENGTH :
+                                GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        out.append(gcanvas::toString(count));
+        out.append(";");
+        if (count <= 0) {
+            return;
+        }
+
+        std::vector<GLchar> name(maxLength > 0 ? maxLength : 256);
+        std::string element;
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei len = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            name[0] = '\0';
+            if (uniforms) {
+                glGetActiveUniform(program, i, (GLsizei) name.size(), &len, &size, &type, &name[0]);
+            } else {
+                glGetActiveAttrib(program, i, (GLsizei) name.size(), &len, &size, &type, &name[0]);
+            }
+            GLint location = uniforms ? glGetUniformLocation(program, &name[0]) :
+                             glGetAttribLocation(program, &name[0]);
+
+            out.append(gcanvas::toString(location));
+            out.append(",");
+            out.append(gcanvas::toString(type));
+            out.append(",");
+            out.append(gcanvas::toString(size));
+            out.append(",");
+            out.append(&name[0], len);
+            out.append(";");
+
+            if (!uniforms || size <= 1 || len < 3 || strcmp(&name[len - 3], "[0]") != 0) {
+                continue;
+            }
+            for (GLint e = 1; e < size; ++e) {
+                element.assign(&name[0], len - 2);
+                element.append(gcanvas::toString(e));
+                element.append("]");
+                out.append(gcanvas::toString(glGetUniformLocation(program, element.c_str())));
+                out.append(",");
+                out.append(gcanvas::toString(type));
+                out.append(",1,");
+                out.append(element);
+                out.append(";");
+            }
+        }
+    }
+
+    // "linkStatus;attributes...uniforms..." for the JS side to resolve
+    // getAttribLocation/getUniformLocation locally, "0;" when the link failed
+    void GetProgramLocationTable(GLuint program, std::string &out) {
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        out = gcanvas::toString(linked);
+        out.append(";");
+        if (linked == GL_FALSE) {
+            return;
+        }
+        AppendActiveVariables(program, false, out);
+        AppendActiveVariables(program, true, out);
+    }
+
     int linkProgram(GCanvasWeex *obj, const char *&p) { // linkProgram1
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
         glLinkProgram(program);
@@ -2146,7 +2466,8 @@ namespace gcanvas {
     }
 
     int pixelStorei(GCanvasWeex *obj, const char *&p) { // pixelStorei2,1
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum pname = tokens[0];
         GLint param = tokens[1];
 
@@ -2156,7 +2477,8 @@ namespace gcanvas {
     }
 
     int polygonOffset(GCanvasWeex *obj, const char *&p) { // polygonOffset1.0,1.0);
-        const float *tokens = ParseTokensFloat(p, 2);
+        float tokens[2];
+        ParseTokensFloat(p, tokens, 2);
         GLfloat factor = tokens[0];
         GLfloat units = tokens[1];
 
@@ -2166,7 +2488,8 @@ namespace gcanvas {
     }
 
     int readPixels(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 6);
+        int tokens[6];
+        ParseTokensInt(p, tokens, 6);
         float ratio = obj->GetDevicePixelRatio();
         GLint x = tokens[0] * ratio;
         GLint y = tokens[1] * ratio;
@@ -2197,7 +2520,8 @@ namespace gcanvas {
     }
 
     int renderbufferStorage(GCanvasWeex *obj, const char *&p) { // renderbufferStorage0,3,512,512;
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         GLenum target = tokens[0];
         GLenum internalformat = tokens[1];
         float ratio = obj->GetDevicePixelRatio();
@@ -2212,10 +2536,12 @@ namespace gcanvas {
 
 //new
     int sampleCoverage(GCanvasWeex *obj, const char *&p) {
-        const float *fTokens = ParseTokensFloat(p, 1);
+        float fTokens[1];
+        ParseTokensFloat(p, fTokens, 1);
         GLfloat value = fTokens[0];
 
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint invert = tokens[0];
 
         LOG_D("[webgl::exec] glSampleCoverage(%f, %d)", value, invert);
@@ -2225,7 +2551,8 @@ namespace gcanvas {
 
 //new
     int scissor(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         float ratio = obj->GetDevicePixelRatio();
         GLint x = tokens[0] * ratio;
         GLint y = tokens[1] * ratio;
@@ -2233,13 +2560,16 @@ namespace gcanvas {
         GLsizei height = tokens[3] * ratio;
 
         LOG_D("[webgl::exec] glScissor(%d, %d, %d, %d)", x, y, width, height);
-        glScissor(x, y, width, height);
+        if (obj->mWebglState.Scissor(x, y, width, height)) {
+            glScissor(x, y, width, height);
+        }
         return kContinue;
     }
 
 
     int shaderSource(GCanvasWeex *obj, const char *&p) { // shaderSource1,CiAgICAgICAgYXR0
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint shader = tokens[0];
 
         std::string &source = obj->mTempStr;
@@ -2269,7 +2599,8 @@ namespace gcanvas {
 
     int stencilFunc(GCanvasWeex *obj, const char *&p) {//glStencilFunc(GL_LESS, 0x1, 0x1);
 
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLenum func = tokens[0];
         GLint ref = tokens[1];
         GLuint mask = tokens[2];
@@ -2282,7 +2613,8 @@ namespace gcanvas {
 
 //new
     int stencilFuncSeparate(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         GLenum face = tokens[0];
         GLenum func = tokens[1];
         GLint ref = tokens[2];
@@ -2296,7 +2628,8 @@ namespace gcanvas {
 
 //new
     int stencilMask(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint mask = tokens[0];
 
         glStencilMask(mask);
@@ -2306,7 +2639,8 @@ namespace gcanvas {
 
 //new
     int stencilMaskSeparate(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum face = tokens[0];
         GLuint mask = tokens[1];
 
@@ -2316,7 +2650,8 @@ namespace gcanvas {
     }
 
     int stencilOp(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLenum fail = tokens[0];
         GLenum zfail = tokens[1];
         GLenum zpass = tokens[2];
@@ -2328,7 +2663,8 @@ namespace gcanvas {
     }
 
     int stencilOpSeparate(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         GLenum face = tokens[0];
         GLenum fail = tokens[1];
         GLenum zfail = tokens[2];
@@ -2346,9 +2682,10 @@ namespace gcanvas {
     extern int (*g_webglExtFuncMap[WEBGL_EXT_API_COUNT])(GCanvasWeex *, const char *&);
 
     int texImage2D(GCanvasWeex *obj, const char *&p) { //  texImage2D0,0,3,3,0,a.bmp;
-        const int args = ParseTokensInt(p, 1)[0];
+        const int args = ParseTokenInt(p);
         if (6 == args) {
-            const int *tokens = ParseTokensInt(p, 5);
+            int tokens[5];
+            ParseTokensInt(p, tokens, 5);
             GLenum target = tokens[0];
             GLint level = tokens[1];
             GLenum internalformat = tokens[2];
@@ -2404,36 +2741,44 @@ namespace gcanvas {
 #endif
 
         } else {
-            const int *tokens = ParseTokensInt(p, 9);
+            int tokens[9];
+            ParseTokensInt(p, tokens, 9);
             const GLvoid *array = nullptr;
             LOG_D("texImage2D after parseTokensInt: %s", p);
             if (tokens[8] == 0) {
                 ParseTokensSkip(p);
             } else {
-                std::string &buf = obj->mTempStr;
-                ParseTokensBase64(p, buf);
-                LOG_D("texImage2D after base64 : %s", buf.c_str());
                 int bytes = tokens[8];
                 unsigned int size;
-                array = SplitStringToArray(buf.c_str(), bytes, size);
+                array = ParseTokensBase64Array(p, bytes, size);
             }
             glTexImage2D(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4],
                          tokens[5], tokens[6], tokens[7], array);
+            if (array) {
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                             TexImageSize(tokens[3], tokens[4], tokens[6], tokens[7],
+                                          UnpackAlignment()));
+            }
 
             LOG_D("[webgl::exec] glTexImage2D(%s, %d, %s, %d, %d, %d, %s, %s, array)",
                   GetMacroValDebug(tokens[0]), tokens[1], GetMacroValDebug(tokens[2]), tokens[3],
                   tokens[4], tokens[5], GetMacroValDebug(tokens[6]), GetMacroValDebug(tokens[7]),
                   array);
+            if (array) {
+                free((void *) array);
+            }
         };
         return kContinue;
     }
 
     int texParameterf(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLenum target = tokens[0];
         GLenum pname = tokens[1];
 
-        const float *floatTokens = ParseTokensFloat(p, 1);
+        float floatTokens[1];
+        ParseTokensFloat(p, floatTokens, 1);
         GLfloat param = floatTokens[0];
 
         LOG_D("[webgl::exec] glTexParameterf(%s, %s, %f) ",
@@ -2444,7 +2789,8 @@ namespace gcanvas {
 
     int texParameteri(GCanvasWeex *obj, const char *&p) { // texParameteri0,undefined,undefined;
 
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLenum target = tokens[0];
         GLenum pname = tokens[1];
         GLint param = tokens[2];
@@ -2457,9 +2803,10 @@ namespace gcanvas {
 
 
     int texSubImage2D(GCanvasWeex *obj, const char *&p) {
-        const int args = ParseTokensInt(p, 1)[0];
+        const int args = ParseTokenInt(p);
         if (7 == args) {
-            const int *tokens = ParseTokensInt(p, 6);
+            int tokens[6];
+            ParseTokensInt(p, tokens, 6);
 
             GLenum target = tokens[0];
             GLint level = tokens[1];
@@ -2492,12 +2839,18 @@ namespace gcanvas {
 #endif
 
         } else if (9 == args) {
-            const int *tokens = ParseTokensInt(p, 9);
+            int tokens[9];
+            ParseTokensInt(p, tokens, 9);
             int bytes = tokens[8];
             unsigned int size;
             const GLvoid *array = SplitStringToArray(p, bytes, size);
             glTexSubImage2D(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4],
                             tokens[5], tokens[6], tokens[7], array);
+            if (array) {
+                GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                             TexImageSize(tokens[4], tokens[5], tokens[6], tokens[7],
+                                          UnpackAlignment()));
+            }
 
             LOG_D("[webgl::exec] glTexSubImage2D(%s, %d, %d, %d, %d, %d, %s, %s, array)",
                   GetMacroValDebug(tokens[0]), tokens[1], tokens[2], tokens[3],
@@ -2512,7 +2865,8 @@ namespace gcanvas {
 
 
     int uniformXfv(GCanvasWeex *obj, const char *&p, int type) { // uniform3fv_53,/////wj/////
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLint location = tokens[0];
 
         std::string &value = obj->mTempStr;
@@ -2541,7 +2895,8 @@ namespace gcanvas {
     }
 
     int uniformXiv(GCanvasWeex *obj, const char *&p, int type) { // uniform3fv_53,/////wj/////
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLint location = tokens[0];
 
         std::string &value = obj->mTempStr;
@@ -2575,10 +2930,12 @@ namespace gcanvas {
     }
 
     int uniform1f(GCanvasWeex *obj, const char *&p) { // uniform1f_4,0
-        const int *intTokens = ParseTokensInt(p, 1);
+        int intTokens[1];
+        ParseTokensInt(p, intTokens, 1);
         GLint location = intTokens[0];
 
-        const float *tokens = ParseTokensFloat(p, 1);
+        float tokens[1];
+        ParseTokensFloat(p, tokens, 1);
         LOG_D("[webgl::exec] glUniform1f(%d, %f)", location, tokens[0]);
         glUniform1f(location, tokens[0]);
         return kContinue;
@@ -2589,7 +2946,8 @@ namespace gcanvas {
     }
 
     int uniform1i(GCanvasWeex *obj, const char *&p) { // uniform1i_4,0
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLint location = tokens[0];
         GLint x = tokens[1];
 
@@ -2603,10 +2961,12 @@ namespace gcanvas {
     }
 
     int uniform2f(GCanvasWeex *obj, const char *&p) { // uniform2f_51,344,154;
-        const int *intTokens = ParseTokensInt(p, 1);
+        int intTokens[1];
+        ParseTokensInt(p, intTokens, 1);
         GLint location = intTokens[0];
 
-        const float *tokens = ParseTokensFloat(p, 2);
+        float tokens[2];
+        ParseTokensFloat(p, tokens, 2);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
 
@@ -2620,7 +2980,8 @@ namespace gcanvas {
     }
 
     int uniform2i(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLint location = tokens[0];
         GLint x = tokens[1];
         GLint y = tokens[2];
@@ -2633,10 +2994,12 @@ namespace gcanvas {
     int uniform2iv(GCanvasWeex *obj, const char *&p) { return uniformXiv(obj, p, 2); }
 
     int uniform3f(GCanvasWeex *obj, const char *&p) { // uniform3f_51,0,0,1
-        const int *intTokens = ParseTokensInt(p, 1);
+        int intTokens[1];
+        ParseTokensInt(p, intTokens, 1);
         GLint location = intTokens[0];
 
-        const float *tokens = ParseTokensFloat(p, 3);
+        float tokens[3];
+        ParseTokensFloat(p, tokens, 3);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
         GLfloat z = tokens[2];
@@ -2651,7 +3014,8 @@ namespace gcanvas {
     }
 
     int uniform3i(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         GLint location = tokens[0];
         GLint x = tokens[1];
         GLint y = tokens[2];
@@ -2665,10 +3029,12 @@ namespace gcanvas {
     int uniform3iv(GCanvasWeex *obj, const char *&p) { return uniformXiv(obj, p, 3); }
 
     int uniform4f(GCanvasWeex *obj, const char *&p) { // uniform4f_83,0,0,1,1
-        const int *intTokens = ParseTokensInt(p, 1);
+        int intTokens[1];
+        ParseTokensInt(p, intTokens, 1);
         GLint location = intTokens[0];
 
-        const float *tokens = ParseTokensFloat(p, 4);
+        float tokens[4];
+        ParseTokensFloat(p, tokens, 4);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
         GLfloat z = tokens[2];
@@ -2685,7 +3051,8 @@ namespace gcanvas {
     }
 
     int uniform4i(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 5);
+        int tokens[5];
+        ParseTokensInt(p, tokens, 5);
         GLint location = tokens[0];
         GLint x = tokens[1];
         GLint y = tokens[2];
@@ -2702,14 +3069,17 @@ namespace gcanvas {
 
     int uniformMatrixXfv(GCanvasWeex *obj, const char *&p,
                          int type) { // uniformMatrix3fv52,0,so9wP0Qdrz4AAAAAAAAAAEQdr76yj3A/AAAAAAAAA
-        const int *tokens = ParseTokensInt(p, 3);
+        int tokens[3];
+        ParseTokensInt(p, tokens, 3);
         GLint location = tokens[0];
         GLuint transpose = tokens[1];
 
         unsigned int size = 0;
         const GLfloat *fvalue = NULL;
+        GLfloat matrices[GWEBGL_MAX_MATRIX_FLOATS];
         if (g_encode_type == 1) {
-            fvalue = ParseTokensFloat(p, 16);
+            size = (unsigned int) ParseTokensFloat(p, matrices, GWEBGL_MAX_MATRIX_FLOATS);
+            fvalue = matrices;
         } else {
             std::string &value = obj->mTempStr;
             ParseTokensBase64(p, value);
@@ -2758,17 +3128,21 @@ namespace gcanvas {
     }
 
     int useProgram(GCanvasWeex *obj, const char *&p) { // useProgram1
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
-        glUseProgram(program);
+        if (obj->mWebglState.UseProgram(program)) {
+            glUseProgram(program);
+        }
         LOG_D("[webgl::exec] glUseProgram(%d)", program);
         return kContinue;
     }
 
 //new
     int validateProgram(GCanvasWeex *obj, const char *&p) { // validateProgram
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint program = tokens[0];
 
         glValidateProgram(program);
@@ -2778,8 +3152,8 @@ namespace gcanvas {
 
 //new
     int vertexAttrib1f(GCanvasWeex *obj, const char *&p) {
-        int index = ParseTokensInt(p, 1)[0];
-        GLfloat x = ParseTokensFloat(p, 1)[0];
+        int index = ParseTokenInt(p);
+        GLfloat x = ParseTokenFloat(p);
 
         LOG_D("[webgl::exec] glVertexAttrib1f(%d, %f)", index, x);
         glVertexAttrib1f(index, x);
@@ -2791,8 +3165,9 @@ namespace gcanvas {
 
 //new
     int vertexAttrib2f(GCanvasWeex *obj, const char *&p) {
-        int index = ParseTokensInt(p, 1)[0];
-        const float *tokens = ParseTokensFloat(p, 2);
+        int index = ParseTokenInt(p);
+        float tokens[2];
+        ParseTokensFloat(p, tokens, 2);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
 
@@ -2803,8 +3178,9 @@ namespace gcanvas {
 
 //new
     int vertexAttrib3f(GCanvasWeex *obj, const char *&p) {
-        int index = ParseTokensInt(p, 1)[0];
-        const float *tokens = ParseTokensFloat(p, 3);
+        int index = ParseTokenInt(p);
+        float tokens[3];
+        ParseTokensFloat(p, tokens, 3);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
         GLfloat z = tokens[2];
@@ -2816,8 +3192,9 @@ namespace gcanvas {
 
 //new
     int vertexAttrib4f(GCanvasWeex *obj, const char *&p) {
-        int index = ParseTokensInt(p, 1)[0];
-        const float *tokens = ParseTokensFloat(p, 4);
+        int index = ParseTokenInt(p);
+        float tokens[4];
+        ParseTokensFloat(p, tokens, 4);
         GLfloat x = tokens[0];
         GLfloat y = tokens[1];
         GLfloat z = tokens[2];
@@ -2829,7 +3206,8 @@ namespace gcanvas {
     }
 
     int vertexAttribXfv(GCanvasWeex *obj, const char *&p, int type) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         GLint index = tokens[0];
 
         std::string &value = obj->mTempStr;
@@ -2882,7 +3260,8 @@ namespace gcanvas {
     }
 
     int vertexAttribPointer(GCanvasWeex *obj, const char *&p) { // vertexAttribPointer10,3,22,0,0,0;
-        const int *tokens = ParseTokensInt(p, 6);
+        int tokens[6];
+        ParseTokensInt(p, tokens, 6);
         GLint index = tokens[0];
         GLint size = tokens[1];
         GLenum type = tokens[2];
@@ -2897,17 +3276,21 @@ namespace gcanvas {
     }
 
     int viewport(GCanvasWeex *obj, const char *&p) { // viewport0,0,600,450;
-        const float *tokens = ParseTokensFloat(p, 4);
+        float tokens[4];
+        ParseTokensFloat(p, tokens, 4);
         float ratio = obj->GetDevicePixelRatio();
         LOG_D("[webgl::exec] glViewport(%f, %f, %f, %f)",
               tokens[0] * ratio,
               tokens[1] * ratio,
               tokens[2] * ratio,
               tokens[3] * ratio);
-        glViewport(tokens[0] * ratio,
-                   tokens[1] * ratio,
-                   tokens[2] * ratio,
-                   tokens[3] * ratio);
+        GLint x = tokens[0] * ratio;
+        GLint y = tokens[1] * ratio;
+        GLsizei width = tokens[2] * ratio;
+        GLsizei height = tokens[3] * ratio;
+        if (obj->mWebglState.Viewport(x, y, width, height)) {
+            glViewport(x, y, width, height);
+        }
         return kContinue;
     }
 
@@ -3058,7 +3441,8 @@ namespace gcanvas {
 //////////////////////////////////////////////////////////////////////////
 #ifdef IOS
     int drawArraysInstancedANGLE(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 4);
+        int tokens[4];
+        ParseTokensInt(p, tokens, 4);
         glDrawArraysInstancedEXT(tokens[0], tokens[1], tokens[2], tokens[3]);
         LOG_D("[webgl::exec] glDrawArraysInstancedEXT(%d, %d, %d, %d)",
           tokens[0], tokens[1], tokens[2], tokens[3]);
@@ -3066,7 +3450,8 @@ namespace gcanvas {
     }
 
     int drawElementsInstancedANGLE(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 5);
+        int tokens[5];
+        ParseTokensInt(p, tokens, 5);
         glDrawElementsInstancedEXT(tokens[0], tokens[1], tokens[2], G_BUFFER_OFFSET(tokens[3]), tokens[4]);
         LOG_D("[webgl::exec] glDrawElementsInstancedEXT(%d, %d, %d, %d, %d)",
           tokens[0], tokens[1], tokens[2], tokens[3], tokens[4]);
@@ -3074,7 +3459,8 @@ namespace gcanvas {
     }
 
     int vertexAttribDivisorANGLE(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 2);
+        int tokens[2];
+        ParseTokensInt(p, tokens, 2);
         glVertexAttribDivisorEXT(tokens[0], tokens[1]);
         LOG_D("[webgl::exec] glVertexAttribDivisorEXT(%d, %d)", tokens[0], tokens[1]);
         return kContinue;
@@ -3090,7 +3476,8 @@ namespace gcanvas {
     }
 
     int deleteVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
         glDeleteVertexArraysOES(1, &array);
         LOG_D("[webgl::exec] glDeleteVertexArraysOES(1, %d)", array);
@@ -3098,7 +3485,8 @@ namespace gcanvas {
     }
 
     int isVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
         GLuint value = glIsVertexArrayOES(array);
         LOG_D("[webgl::exec] glIsVertexArrayOES(%d)", array);
@@ -3107,9 +3495,11 @@ namespace gcanvas {
     }
 
     int bindVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
         glBindVertexArrayOES(array);
+        obj->mWebglState.BindVertexArray();
         LOG_D("[webgl::exec] glBindVertexArrayOES(%d)", array);
         return kContinue;
     }
@@ -3137,7 +3527,8 @@ namespace gcanvas {
     }
     
     int deleteVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
 
         if (glDeleteVertexArraysOESv) {
@@ -3147,7 +3538,8 @@ namespace gcanvas {
     }
     
     int isVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
         if (glIsVertexArrayOESv) {
             GLuint value = glIsVertexArrayOESv(array);
@@ -3157,16 +3549,31 @@ namespace gcanvas {
     }
     
     int bindVertexArrayOES(GCanvasWeex *obj, const char *&p) {
-        const int *tokens = ParseTokensInt(p, 1);
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
         GLuint array = tokens[0];
         if (glBindVertexArrayOESv) {
             glBindVertexArrayOESv(array);
-        }        
+            obj->mWebglState.BindVertexArray();
+        }
         return kContinue;
     }
     
 #endif
 
+    // gcanvas extension, the location table of a linked program
+    int getProgramLocationsGCANVAS(GCanvasWeex *obj, const char *&p) {
+        int tokens[1];
+        ParseTokensInt(p, tokens, 1);
+        GLuint program = tokens[0];
+
+        std::string table;
+        GetProgramLocationTable(program, table);
+        LOG_D("[webgl::exec] getProgramLocations(%d)=%s", program, table.c_str());
+        obj->setSyncResult(table);
+        return kContinue;
+    }
+
 
     int (*g_webglExtFuncMap[WEBGL_EXT_API_COUNT])(GCanvasWeex *, const char *&) = {
             //extension method for ANGLE_instanced_arrays
@@ -3178,7 +3585,10 @@ namespace gcanvas {
             createVertexArrayOES,
             deleteVertexArrayOES,
             isVertexArrayOES,
-            bindVertexArrayOES
+            bindVertexArrayOES,
+
+            //gcanvas extension
+            getProgramLocationsGCANVAS
     };
 
 }
@@ -3187,6 +3597,7 @@ namespace gcanvas {
 using namespace gcanvas;
 
 int GCanvasWeex::executeWebGLCommands(const char *&cmd, int length) {
+    PrepareWebGL();
     const char *end = cmd + length;
     while (cmd < end) {
         int index = atoi(cmd);
@@ -3218,7 +3629,7 @@ void GCanvasWeex::GetAllParameter(std::string &ret) {
 
 }
 
-#ifdef ANDROID
+#if defined(ANDROID) || defined(__linux__)
 
 void GCanvasWeex::initWebglExt() {
     glGenVertexArraysOESv = (PFNGLGENVERTEXARRAYSOESPROC) eglGetProcAddress("glGenVertexArraysOES");
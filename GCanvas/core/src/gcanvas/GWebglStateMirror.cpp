@@ -0,0 +1,480 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#include "GWebglStateMirror.h"
+
+GWebglStateMirror::GWebglStateMirror()
+        : mKnown(0), mCapabilityKnown(0), mTexture2DKnown(0), mTextureCubeKnown(0),
+          mIssuedCount(0), mFilteredCount(0)
+{
+}
+
+void GWebglStateMirror::Invalidate()
+{
+    mKnown = 0;
+    mCapabilityKnown = 0;
+    mTexture2DKnown = 0;
+    mTextureCubeKnown = 0;
+}
+
+void GWebglStateMirror::ForgetTextures()
+{
+    mKnown &= ~KNOWN_ACTIVE_TEXTURE;
+    mTexture2DKnown = 0;
+    mTextureCubeKnown = 0;
+}
+
+void GWebglStateMirror::ForgetFramebuffer()
+{
+    mKnown &= ~KNOWN_FRAMEBUFFER;
+}
+
+void GWebglStateMirror::ResetCounters()
+{
+    mIssuedCount = 0;
+    mFilteredCount = 0;
+}
+
+bool GWebglStateMirror::Changed(bool changed, unsigned int bit)
+{
+    if (changed || !(mKnown & bit))
+    {
+        mKnown |= bit;
+        ++mIssuedCount;
+        return true;
+    }
+    ++mFilteredCount;
+    return false;
+}
+
+int GWebglStateMirror::CapabilityIndex(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_BLEND:
+            return CAP_BLEND;
+        case GL_CULL_FACE:
+            return CAP_CULL_FACE;
+        case GL_DEPTH_TEST:
+            return CAP_DEPTH_TEST;
+        case GL_DITHER:
+            return CAP_DITHER;
+        case GL_POLYGON_OFFSET_FILL:
+            return CAP_POLYGON_OFFSET_FILL;
+        case GL_SAMPLE_ALPHA_TO_COVERAGE:
+            return CAP_SAMPLE_ALPHA_TO_COVERAGE;
+        case GL_SAMPLE_COVERAGE:
+            return CAP_SAMPLE_COVERAGE;
+        case GL_SCISSOR_TEST:
+            return CAP_SCISSOR_TEST;
+        case GL_STENCIL_TEST:
+            return CAP_STENCIL_TEST;
+        default:
+            return -1;
+    }
+}
+
+int GWebglStateMirror::ActiveUnit() const
+{
+    if (!(mKnown & KNOWN_ACTIVE_TEXTURE))
+    {
+        return -1;
+    }
+    int unit = (int)(mActiveTexture - GL_TEXTURE0);
+    return (unit >= 0 && unit < MAX_TEXTURE_UNITS) ? unit : -1;
+}
+
+bool GWebglStateMirror::ActiveTexture(GLenum unit)
+{
+    bool changed = mActiveTexture != unit;
+    mActiveTexture = unit;
+    return Changed(changed, KNOWN_ACTIVE_TEXTURE);
+}
+
+bool GWebglStateMirror::BindBuffer(GLenum target, GLuint buffer)
+{
+    bool changed;
+    if (target == GL_ARRAY_BUFFER)
+    {
+        changed = mArrayBuffer != buffer;
+        mArrayBuffer = buffer;
+        return Changed(changed, KNOWN_ARRAY_BUFFER);
+    }
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        changed = mElementArrayBuffer != buffer;
+        mElementArrayBuffer = buffer;
+        return Changed(changed, KNOWN_ELEMENT_ARRAY_BUFFER);
+    }
+    ++mIssuedCount;
+    return true;
+}
+
+bool GWebglStateMirror::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    if (target != GL_FRAMEBUFFER)
+    {
+        ++mIssuedCount;
+        return true;
+    }
+    bool changed = mFramebuffer != framebuffer;
+    mFramebuffer = framebuffer;
+    return Changed(changed, KNOWN_FRAMEBUFFER);
+}
+
+bool GWebglStateMirror::BindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    if (target != GL_RENDERBUFFER)
+    {
+        ++mIssuedCount;
+        return true;
+    }
+    bool changed = mRenderbuffer != renderbuffer;
+    mRenderbuffer = renderbuffer;
+    return Changed(changed, KNOWN_RENDERBUFFER);
+}
+
+bool GWebglStateMirror::BindTexture(GLenum target, GLuint texture)
+{
+    int unit = ActiveUnit();
+    GLuint *textures = nullptr;
+    unsigned int *known = nullptr;
+    if (target == GL_TEXTURE_2D)
+    {
+        textures = mTexture2D;
+        known = &mTexture2DKnown;
+    }
+    else if (target == GL_TEXTURE_CUBE_MAP)
+    {
+        textures = mTextureCube;
+        known = &mTextureCubeKnown;
+    }
+    if (unit < 0 || textures == nullptr)
+    {
+        ++mIssuedCount;
+        return true;
+    }
+
+    unsigned int bit = 1u << unit;
+    if ((*known & bit) && textures[unit] == texture)
+    {
+        ++mFilteredCount;
+        return false;
+    }
+    textures[unit] = texture;
+    *known |= bit;
+    ++mIssuedCount;
+    return true;
+}
+
+bool GWebglStateMirror::UseProgram(GLuint program)
+{
+    bool changed = mProgram != program;
+    mProgram = program;
+    return Changed(changed, KNOWN_PROGRAM);
+}
+
+bool GWebglStateMirror::SetCapability(GLenum cap, bool enabled)
+{
+    int index = CapabilityIndex(cap);
+    if (index < 0)
+    {
+        ++mIssuedCount;
+        return true;
+    }
+
+    unsigned int bit = 1u << index;
+    if ((mCapabilityKnown & bit) && mCapabilities[index] == enabled)
+    {
+        ++mFilteredCount;
+        return false;
+    }
+    mCapabilities[index] = enabled;
+    mCapabilityKnown |= bit;
+    ++mIssuedCount;
+    return true;
+}
+
+bool GWebglStateMirror::BlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    bool changed = mBlendColor[0] != r || mBlendColor[1] != g || mBlendColor[2] != b ||
+                   mBlendColor[3] != a;
+    mBlendColor[0] = r;
+    mBlendColor[1] = g;
+    mBlendColor[2] = b;
+    mBlendColor[3] = a;
+    return Changed(changed, KNOWN_BLEND_COLOR);
+}
+
+bool GWebglStateMirror::BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+{
+    bool changed = mBlendEquation[0] != modeRGB || mBlendEquation[1] != modeAlpha;
+    mBlendEquation[0] = modeRGB;
+    mBlendEquation[1] = modeAlpha;
+    return Changed(changed, KNOWN_BLEND_EQUATION);
+}
+
+bool GWebglStateMirror::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha,
+                                          GLenum dstAlpha)
+{
+    bool changed = mBlendFunc[0] != srcRGB || mBlendFunc[1] != dstRGB ||
+                   mBlendFunc[2] != srcAlpha || mBlendFunc[3] != dstAlpha;
+    mBlendFunc[0] = srcRGB;
+    mBlendFunc[1] = dstRGB;
+    mBlendFunc[2] = srcAlpha;
+    mBlendFunc[3] = dstAlpha;
+    return Changed(changed, KNOWN_BLEND_FUNC);
+}
+
+bool GWebglStateMirror::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    bool changed = mClearColor[0] != r || mClearColor[1] != g || mClearColor[2] != b ||
+                   mClearColor[3] != a;
+    mClearColor[0] = r;
+    mClearColor[1] = g;
+    mClearColor[2] = b;
+    mClearColor[3] = a;
+    return Changed(changed, KNOWN_CLEAR_COLOR);
+}
+
+bool GWebglStateMirror::ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+{
+    bool changed = mColorMask[0] != r || mColorMask[1] != g || mColorMask[2] != b ||
+                   mColorMask[3] != a;
+    mColorMask[0] = r;
+    mColorMask[1] = g;
+    mColorMask[2] = b;
+    mColorMask[3] = a;
+    return Changed(changed, KNOWN_COLOR_MASK);
+}
+
+bool GWebglStateMirror::CullFace(GLenum mode)
+{
+    bool changed = mCullFace != mode;
+    mCullFace = mode;
+    return Changed(changed, KNOWN_CULL_FACE);
+}
+
+bool GWebglStateMirror::FrontFace(GLenum mode)
+{
+    bool changed = mFrontFace != mode;
+    mFrontFace = mode;
+    return Changed(changed, KNOWN_FRONT_FACE);
+}
+
+bool GWebglStateMirror::DepthFunc(GLenum func)
+{
+    bool changed = mDepthFunc != func;
+    mDepthFunc = func;
+    return Changed(changed, KNOWN_DEPTH_FUNC);
+}
+
+bool GWebglStateMirror::DepthMask(GLboolean flag)
+{
+    bool changed = mDepthMask != flag;
+    mDepthMask = flag;
+    return Changed(changed, KNOWN_DEPTH_MASK);
+}
+
+bool GWebglStateMirror::LineWidth(GLfloat width)
+{
+    bool changed = mLineWidth != width;
+    mLineWidth = width;
+    return Changed(changed, KNOWN_LINE_WIDTH);
+}
+
+bool GWebglStateMirror::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    bool changed = mScissor[0] != x || mScissor[1] != y || mScissor[2] != width ||
+                   mScissor[3] != height;
+    mScissor[0] = x;
+    mScissor[1] = y;
+    mScissor[2] = width;
+    mScissor[3] = height;
+    return Changed(changed, KNOWN_SCISSOR);
+}
+
+bool GWebglStateMirror::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    bool changed = mViewport[0] != x || mViewport[1] != y || mViewport[2] != width ||
+                   mViewport[3] != height;
+    mViewport[0] = x;
+    mViewport[1] = y;
+    mViewport[2] = width;
+    mViewport[3] = height;
+    return Changed(changed, KNOWN_VIEWPORT);
+}
+
+void GWebglStateMirror::DeleteBuffer(GLuint buffer)
+{
+    if (mArrayBuffer == buffer)
+    {
+        mArrayBuffer = 0;
+    }
+    if (mElementArrayBuffer == buffer)
+    {
+        mElementArrayBuffer = 0;
+    }
+}
+
+void GWebglStateMirror::DeleteFramebuffer(GLuint framebuffer)
+{
+    if (mFramebuffer == framebuffer)
+    {
+        mFramebuffer = 0;
+    }
+}
+
+void GWebglStateMirror::DeleteRenderbuffer(GLuint renderbuffer)
+{
+    if (mRenderbuffer == renderbuffer)
+    {
+        mRenderbuffer = 0;
+    }
+}
+
+void GWebglStateMirror::DeleteTexture(GLuint texture)
+{
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        if (mTexture2D[i] == texture)
+        {
+            mTexture2D[i] = 0;
+        }
+        if (mTextureCube[i] == texture)
+        {
+            mTextureCube[i] = 0;
+        }
+    }
+}
+
+void GWebglStateMirror::BindVertexArray()
+{
+    mKnown &= ~KNOWN_ELEMENT_ARRAY_BUFFER;
+}
+
+bool GWebglStateMirror::GetIntegerv(GLenum pname, GLint *values) const
+{
+    int unit;
+    switch (pname)
+    {
+        case GL_ACTIVE_TEXTURE:
+            if (!(mKnown & KNOWN_ACTIVE_TEXTURE)) return false;
+            values[0] = mActiveTexture;
+            return true;
+        case GL_ARRAY_BUFFER_BINDING:
+            if (!(mKnown & KNOWN_ARRAY_BUFFER)) return false;
+            values[0] = mArrayBuffer;
+            return true;
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+            if (!(mKnown & KNOWN_ELEMENT_ARRAY_BUFFER)) return false;
+            values[0] = mElementArrayBuffer;
+            return true;
+        case GL_FRAMEBUFFER_BINDING:
+            if (!(mKnown & KNOWN_FRAMEBUFFER)) return false;
+            values[0] = mFramebuffer;
+            return true;
+        case GL_RENDERBUFFER_BINDING:
+            if (!(mKnown & KNOWN_RENDERBUFFER)) return false;
+            values[0] = mRenderbuffer;
+            return true;
+        case GL_TEXTURE_BINDING_2D:
+            unit = ActiveUnit();
+            if (unit < 0 || !(mTexture2DKnown & (1u << unit))) return false;
+            values[0] = mTexture2D[unit];
+            return true;
+        case GL_TEXTURE_BINDING_CUBE_MAP:
+            unit = ActiveUnit();
+            if (unit < 0 || !(mTextureCubeKnown & (1u << unit))) return false;
+            values[0] = mTextureCube[unit];
+            return true;
+        case GL_CURRENT_PROGRAM:
+            if (!(mKnown & KNOWN_PROGRAM)) return false;
+            values[0] = mProgram;
+            return true;
+        case GL_BLEND_EQUATION_RGB:
+        case GL_BLEND_EQUATION_ALPHA:
+            if (!(mKnown & KNOWN_BLEND_EQUATION)) return false;
+            values[0] = mBlendEquation[pname == GL_BLEND_EQUATION_RGB ? 0 : 1];
+            return true;
+        case GL_BLEND_SRC_RGB:
+        case GL_BLEND_DST_RGB:
+        case GL_BLEND_SRC_ALPHA:
+        case GL_BLEND_DST_ALPHA:
+            if (!(mKnown & KNOWN_BLEND_FUNC)) return false;
+            values[0] = mBlendFunc[pname == GL_BLEND_SRC_RGB ? 0 : pname == GL_BLEND_DST_RGB ? 1 :
+                                   pname == GL_BLEND_SRC_ALPHA ? 2 : 3];
+            return true;
+        case GL_CULL_FACE_MODE:
+            if (!(mKnown & KNOWN_CULL_FACE)) return false;
+            values[0] = mCullFace;
+            return true;
+        case GL_FRONT_FACE:
+            if (!(mKnown & KNOWN_FRONT_FACE)) return false;
+            values[0] = mFrontFace;
+            return true;
+        case GL_DEPTH_FUNC:
+            if (!(mKnown & KNOWN_DEPTH_FUNC)) return false;
+            values[0] = mDepthFunc;
+            return true;
+        case GL_COLOR_WRITEMASK:
+            if (!(mKnown & KNOWN_COLOR_MASK)) return false;
+            for (int i = 0; i < 4; ++i) values[i] = mColorMask[i] ? 1 : 0;
+            return true;
+        case GL_SCISSOR_BOX:
+            if (!(mKnown & KNOWN_SCISSOR)) return false;
+            for (int i = 0; i < 4; ++i) values[i] = mScissor[i];
+            return true;
+        case GL_VIEWPORT:
+            if (!(mKnown & KNOWN_VIEWPORT)) return false;
+            for (int i = 0; i < 4; ++i) values[i] = mViewport[i];
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool GWebglStateMirror::GetFloatv(GLenum pname, GLfloat *values) const
+{
+    switch (pname)
+    {
+        case GL_BLEND_COLOR:
+            if (!(mKnown & KNOWN_BLEND_COLOR)) return false;
+            for (int i = 0; i < 4; ++i) values[i] = mBlendColor[i];
+            return true;
+        case GL_COLOR_CLEAR_VALUE:
+            if (!(mKnown & KNOWN_CLEAR_COLOR)) return false;
+            for (int i = 0; i < 4; ++i) values[i] = mClearColor[i];
+            return true;
+        case GL_LINE_WIDTH:
+            if (!(mKnown & KNOWN_LINE_WIDTH)) return false;
+            values[0] = mLineWidth;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool GWebglStateMirror::GetBooleanv(GLenum pname, GLboolean *values) const
+{
+    if (pname == GL_DEPTH_WRITEMASK)
+    {
+        if (!(mKnown & KNOWN_DEPTH_MASK)) return false;
+        values[0] = mDepthMask;
+        return true;
+    }
+
+    int index = CapabilityIndex(pname);
+    if (index < 0 || !(mCapabilityKnown & (1u << index)))
+    {
+        return false;
+    }
+    values[0] = mCapabilities[index] ? GL_TRUE : GL_FALSE;
+    return true;
+}
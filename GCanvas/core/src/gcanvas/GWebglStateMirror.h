@@ -0,0 +1,177 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_GWEBGLSTATEMIRROR_H
+#define GCANVAS_GWEBGLSTATEMIRROR_H
+
+#include "GGL.h"
+
+/**
+ * Mirror of the GL state a WebGL context sets through the command stream,
+ * one per canvas since every canvas has its own GL context. Setters return
+ * false for a call that would not change anything, the handler then skips
+ * the GL call; getters answer getParameter/isEnabled without a glGet.
+ *
+ * A value is only trusted after the mirror has seen it set. Code that
+ * changes the same state outside the WebGL handlers has to call
+ * Invalidate() or one of the Forget*() methods.
+ */
+class GWebglStateMirror
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 32;
+
+    GWebglStateMirror();
+
+    void Invalidate();
+
+    void ForgetTextures();
+
+    void ForgetFramebuffer();
+
+    // setters, true when the call has to reach GL
+    bool ActiveTexture(GLenum unit);
+
+    bool BindBuffer(GLenum target, GLuint buffer);
+
+    bool BindFramebuffer(GLenum target, GLuint framebuffer);
+
+    bool BindRenderbuffer(GLenum target, GLuint renderbuffer);
+
+    bool BindTexture(GLenum target, GLuint texture);
+
+    bool UseProgram(GLuint program);
+
+    bool SetCapability(GLenum cap, bool enabled);
+
+    bool BlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    bool BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+
+    bool BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+
+    bool ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    bool ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+
+    bool CullFace(GLenum mode);
+
+    bool FrontFace(GLenum mode);
+
+    bool DepthFunc(GLenum func);
+
+    bool DepthMask(GLboolean flag);
+
+    bool LineWidth(GLfloat width);
+
+    bool Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    bool Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // deleting a bound object unbinds it
+    void DeleteBuffer(GLuint buffer);
+
+    void DeleteFramebuffer(GLuint framebuffer);
+
+    void DeleteRenderbuffer(GLuint renderbuffer);
+
+    void DeleteTexture(GLuint texture);
+
+    // the element array binding belongs to the vertex array object
+    void BindVertexArray();
+
+    // queries, false when the value is not known and GL has to be asked
+    bool GetIntegerv(GLenum pname, GLint *values) const;
+
+    bool GetFloatv(GLenum pname, GLfloat *values) const;
+
+    bool GetBooleanv(GLenum pname, GLboolean *values) const;
+
+    unsigned long IssuedCount() const { return mIssuedCount; }
+
+    unsigned long FilteredCount() const { return mFilteredCount; }
+
+    void ResetCounters();
+
+private:
+    enum
+    {
+        KNOWN_ACTIVE_TEXTURE = 1 << 0,
+        KNOWN_ARRAY_BUFFER = 1 << 1,
+        KNOWN_ELEMENT_ARRAY_BUFFER = 1 << 2,
+        KNOWN_FRAMEBUFFER = 1 << 3,
+        KNOWN_RENDERBUFFER = 1 << 4,
+        KNOWN_PROGRAM = 1 << 5,
+        KNOWN_BLEND_COLOR = 1 << 6,
+        KNOWN_BLEND_EQUATION = 1 << 7,
+        KNOWN_BLEND_FUNC = 1 << 8,
+        KNOWN_CLEAR_COLOR = 1 << 9,
+        KNOWN_COLOR_MASK = 1 << 10,
+        KNOWN_CULL_FACE = 1 << 11,
+        KNOWN_FRONT_FACE = 1 << 12,
+        KNOWN_DEPTH_FUNC = 1 << 13,
+        KNOWN_DEPTH_MASK = 1 << 14,
+        KNOWN_LINE_WIDTH = 1 << 15,
+        KNOWN_SCISSOR = 1 << 16,
+        KNOWN_VIEWPORT = 1 << 17
+    };
+
+    enum
+    {
+        CAP_BLEND,
+        CAP_CULL_FACE,
+        CAP_DEPTH_TEST,
+        CAP_DITHER,
+        CAP_POLYGON_OFFSET_FILL,
+        CAP_SAMPLE_ALPHA_TO_COVERAGE,
+        CAP_SAMPLE_COVERAGE,
+        CAP_SCISSOR_TEST,
+        CAP_STENCIL_TEST,
+        CAP_COUNT
+    };
+
+    static int CapabilityIndex(GLenum cap);
+
+    // index into the texture tables, -1 when the active unit is not tracked
+    int ActiveUnit() const;
+
+    // records the outcome of a setter and returns whether to call GL
+    bool Changed(bool changed, unsigned int bit);
+
+    unsigned int mKnown;
+    unsigned int mCapabilityKnown;
+    unsigned int mTexture2DKnown;    // bit per unit
+    unsigned int mTextureCubeKnown;
+
+    GLenum mActiveTexture;
+    GLuint mArrayBuffer;
+    GLuint mElementArrayBuffer;
+    GLuint mFramebuffer;
+    GLuint mRenderbuffer;
+    GLuint mTexture2D[MAX_TEXTURE_UNITS];
+    GLuint mTextureCube[MAX_TEXTURE_UNITS];
+    GLuint mProgram;
+    bool mCapabilities[CAP_COUNT];
+    GLfloat mBlendColor[4];
+    GLenum mBlendEquation[2];
+    GLenum mBlendFunc[4];
+    GLfloat mClearColor[4];
+    GLboolean mColorMask[4];
+    GLenum mCullFace;
+    GLenum mFrontFace;
+    GLenum mDepthFunc;
+    GLboolean mDepthMask;
+    GLfloat mLineWidth;
+    GLint mScissor[4];
+    GLint mViewport[4];
+
+    unsigned long mIssuedCount;
+    unsigned long mFilteredCount;
+};
+
+#endif /* GCANVAS_GWEBGLSTATEMIRROR_H */
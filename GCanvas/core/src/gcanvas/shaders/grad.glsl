@@ -99,3 +99,30 @@ void main()                                                                 \n\
 
 
 
+#define LINEAR_LUT_SHADER "LINEAR_LUT"
+
+#define LINEAR_LUT_SHADER_PS                                    "\
+precision highp float;                                         \n\
+varying vec2      v_inPos;                                     \n\
+varying vec2      v_texCoord;                                  \n\
+varying vec4      v_desColor;                                  \n\
+uniform sampler2D u_texture;                                   \n\
+uniform sampler2D u_gradient;                                  \n\
+uniform bool      b_hasTexture;                                \n\
+uniform vec2      u_startPos;                                  \n\
+uniform vec2      u_endPos;                                    \n\
+void main()                                                                 \n\
+{                                                                           \n\
+   vec2 vecA = u_startPos - v_inPos;                                        \n\
+   vec2 vecB = u_endPos - u_startPos;                                       \n\
+   float t = clamp(-dot(vecA, vecB) / dot(vecB, vecB), 0.0, 1.0);          \n\
+   vec4 finalColor = texture2D(u_gradient,                                  \n\
+                               vec2(t * 255.0 / 256.0 + 0.5 / 256.0, 0.5));\n\
+   if (b_hasTexture) {                                                      \n\
+        vec4 marsk = texture2D(u_texture, v_texCoord);                      \n\
+        gl_FragColor = vec4(finalColor.rgb*marsk.a, marsk.a);               \n\
+   }                                                                        \n\
+   else {                                                                   \n\
+   		gl_FragColor = finalColor; 						                    \n\
+   }                                                                        \n\
+}"
@@ -108,3 +108,41 @@ void main()                                                                   \n
 
 
 
+#define RADIAL_LUT_SHADER "RADIAL_LUT"
+
+#define RADIAL_LUT_SHADER_PS                                    "\
+precision highp float;                                         \n\
+varying vec2      v_inPos;                                     \n\
+varying vec4      v_desColor;                                  \n\
+varying vec2      v_texCoord;                                  \n\
+uniform sampler2D u_texture;                                   \n\
+uniform sampler2D u_gradient;                                  \n\
+uniform bool      b_hasTexture;                                \n\
+uniform vec3      u_startPos;                                  \n\
+uniform vec3      u_endPos;                                    \n\
+void main()                                                                   \n\
+{                                                                             \n\
+   vec2 x_c0  = v_inPos - u_startPos.xy;                                      \n\
+   vec2 c1_c0 = u_endPos.xy - u_startPos.xy;                                  \n\
+   float t0 = dot(c1_c0, c1_c0) - u_endPos.z * u_endPos.z;                    \n\
+   float t1 = dot(x_c0, c1_c0) + u_startPos.z * u_endPos.z;                   \n\
+   float t2 = dot(x_c0, x_c0) - u_startPos.z * u_startPos.z;                  \n\
+   float t3 = t1 * t1 - t0 * t2;                                              \n\
+   float t4 = sqrt(t3) / t0;                                                  \n\
+   float t5 = t1 / t0;                                                        \n\
+   float t  = max(t4 + t5, t5 - t4);                                          \n\
+   if (u_startPos.z + t * u_endPos.z < 0.0) {                                 \n\
+        gl_FragColor = vec4(1.0, 1.0, 1.0, 1.0);                              \n\
+   }                                                                          \n\
+   else {                                                                     \n\
+        float u = clamp(t, 0.0, 1.0) * 255.0 / 256.0 + 0.5 / 256.0;           \n\
+        vec4 finalColor = texture2D(u_gradient, vec2(u, 0.5));                \n\
+        if (b_hasTexture) {                                                   \n\
+            vec4 marsk = texture2D(u_texture, v_texCoord);                    \n\
+            gl_FragColor = vec4(finalColor.rgb, marsk.a);                     \n\
+        }                                                                     \n\
+        else {                                                                \n\
+            gl_FragColor = finalColor;                                        \n\
+        }                                                                     \n\
+   }                                                                          \n\
+}"
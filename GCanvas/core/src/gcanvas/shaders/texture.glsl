@@ -32,3 +32,53 @@ void main()                         \n\
     texColor = texColor * v_desColor.a;             \n\
     gl_FragColor = texColor;                        \n\
 }"
+
+// ETC1 has no alpha channel, the alpha split layout stacks the color image
+// on top of a grayscale alpha image in one texture of twice the height
+#define TEXTURE_ALPHA_SPLIT_SHADER "TEXTURE_ALPHA_SPLIT"
+
+#define TEXTURE_ALPHA_SPLIT_SHADER_PS "\
+precision mediump float;            \n\
+varying vec4 v_desColor;            \n\
+varying vec2 v_texCoord;            \n\
+uniform sampler2D u_texture;        \n\
+uniform bool b_premultipliedAlpha;  \n\
+void main()                         \n\
+{                                   \n\
+    vec4 texColor;                  \n\
+    if(v_texCoord.x < 0.0 || v_texCoord.x > 1.0 ||  \n\
+    v_texCoord.y < 0.0 || v_texCoord.y > 1.0) {     \n\
+        texColor = vec4(0.0,0.0,0.0,0.0);           \n\
+    }else{                                          \n\
+        vec2 colorCoord = vec2(v_texCoord.x, v_texCoord.y * 0.5);       \n\
+        vec2 alphaCoord = vec2(v_texCoord.x, v_texCoord.y * 0.5 + 0.5); \n\
+        float alpha = texture2D(u_texture, alphaCoord).r;               \n\
+        texColor = vec4(texture2D(u_texture, colorCoord).rgb * alpha, alpha); \n\
+    }                                               \n\
+    texColor = texColor * v_desColor.a;             \n\
+    gl_FragColor = texColor;                        \n\
+}"
+
+
+// drawImage with instanced arrays: a_position is a corner of the unit quad,
+// the rest is per sprite, the affine transform that puts the quad in place
+// as two rows, the texture rect and the color
+#define SPRITE_SHADER "SPRITE"
+
+#define SPRITE_SHADER_VS "\
+attribute vec2 a_position;                  \n\
+attribute vec3 a_transformX;                \n\
+attribute vec3 a_transformY;                \n\
+attribute vec4 a_texRect;                   \n\
+attribute vec4 a_srcColor;                  \n\
+uniform mat4 u_modelView;                   \n\
+varying vec4 v_desColor;                    \n\
+varying vec2 v_texCoord;                    \n\
+void main()                                 \n\
+{                                           \n\
+    vec3 corner = vec3(a_position, 1.0);    \n\
+    vec2 pos = vec2(dot(a_transformX, corner), dot(a_transformY, corner)); \n\
+    gl_Position = u_modelView * vec4(pos, 0.0, 1.0); \n\
+    v_desColor = a_srcColor;                \n\
+    v_texCoord = a_texRect.xy + a_position * a_texRect.zw; \n\
+}"
@@ -8,21 +8,20 @@
  */
 
 #include "GCanvas2DContextAndroid.h"
+#include "gcanvas/GFrameProfiler.h"
+#include "gcanvas/GGLStateCache.h"
 
 #include "GFontCache.h"
 #include "GPoint.h"
 #include "GFontManagerAndroid.h"
 #include "gcanvas/GFrameBufferObject.h"
-#include "gcanvas/GShaderManager.h"
+#include "support/GLUtil.h"
 #include "support/Log.h"
 
 
 
 GCanvas2DContextAndroid::GCanvas2DContextAndroid(uint32_t w, uint32_t h, GCanvasConfig &config) :
         GCanvasContext(w, h, config) {
-    // init shader manager
-    mShaderManager = nullptr;
-
     // init font cache
     mFontCache = new GFontCache(*mFontManager);
     GFontManagerAndroid *ptr = static_cast<GFontManagerAndroid *>(mFontManager);
@@ -40,25 +39,6 @@ GCanvas2DContextAndroid::~GCanvas2DContextAndroid() {
         delete mFontCache;
         mFontCache = nullptr;
     }
-
-    if (mShaderManager != nullptr) {
-        delete mShaderManager;
-        mShaderManager = nullptr;
-    }
-}
-
-
-bool GCanvas2DContextAndroid::InitializeGLShader() {
-    if (mShaderManager == nullptr) {
-        mShaderManager = new GShaderManager();
-    }
-
-    return GCanvasContext::InitializeGLShader();
-}
-
-
-GShader *GCanvas2DContextAndroid::FindShader(const char *name) {
-    return mShaderManager->programForKey(name);
 }
 
 
@@ -110,7 +90,7 @@ void GCanvas2DContextAndroid::GetRawImageData(int width, int height, uint8_t *pi
 void GCanvas2DContextAndroid::BeginDraw(bool is_first_draw) {
     if (mConfig.useFbo) {
         // 深度test 一直开启
-        glEnable(GL_DEPTH_TEST);
+        GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
         BindFBO();
     } else {
         if (is_first_draw) {
@@ -182,7 +162,7 @@ void GCanvas2DContextAndroid::ResizeCopyUseFbo(int width, int height) {
 
     if (mContextType == 0) {
         // 更新viewport变换
-        glViewport(0, 0, mWidth, mHeight);
+        GGLStateCache::Current()->Viewport(0, 0, mWidth, mHeight);
     }
 }
 
@@ -201,7 +181,7 @@ void GCanvas2DContextAndroid::CopyFBO(GFrameBufferObject &srcFbo, GFrameBufferOb
     ResetGLBeforeCopyFrame(destFbo.mWidth, destFbo.mHeight);
 
     GColorRGBA color = GColorWhite;
-    glBindTexture(GL_TEXTURE_2D, srcFbo.mFboTexture.GetTextureID());
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, srcFbo.mFboTexture.GetTextureID());
     PushRectangle(-1, -1, 2, 2, 0, 0, 1, 1, color);
     glDrawArrays(GL_TRIANGLES, 0, mVertexBufferIndex);
     mVertexBufferIndex = 0;
@@ -238,7 +218,7 @@ GCanvas2DContextAndroid::ResizeCopyUseImage(int width, int height, const unsigne
         SetCanvasDimension(0, 0);
     }
     // 更新viewport变换
-    glViewport(0, 0, width, height);
+    GGLStateCache::Current()->Viewport(0, 0, width, height);
 }
 
 
@@ -254,7 +234,7 @@ void GCanvas2DContextAndroid::CopyImageToCanvas(int width, int height,
     glDrawArrays(GL_TRIANGLES, 0, mVertexBufferIndex);
     mVertexBufferIndex = 0;
 
-    glDeleteTextures(1, &glID);
+    GGLStateCache::Current()->DeleteTextures(1, &glID);
 
     RestoreGLAfterCopyFrame();
 }
@@ -274,7 +254,7 @@ GCanvas2DContextAndroid::BindImage(const unsigned char *rgbaData, GLint format,
 //        LOG_EXCEPTION("", "gen_texture_fail", "<function:%s, glGetError:%x>", __FUNCTION__,
 //                      glerror);
     }
-    glBindTexture(GL_TEXTURE_2D, glID);
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
     glerror = glGetError();
     if (glerror) {
 //        LOG_EXCEPTION("", "bind_texture_fail", "<function:%s, glGetError:%x>", __FUNCTION__,
@@ -287,6 +267,9 @@ GCanvas2DContextAndroid::BindImage(const unsigned char *rgbaData, GLint format,
 
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
                  GL_UNSIGNED_BYTE, rgbaData);
+    GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                 gcanvas::TexImageSize(width, height, format, GL_UNSIGNED_BYTE,
+                                       gcanvas::UnpackAlignment()));
     glerror = glGetError();
     if (glerror) {
 //        LOG_EXCEPTION("", "glTexImage2D_failglTexImage2D_fail", "<function:%s, glGetError:%x>",
@@ -311,14 +294,15 @@ DrawFBO(std::string fboName, GCompositeOperation compositeOp, float sx, float sy
 
 
     Save();
-    glViewport(mX, mY, mWidth, mHeight);
+    GGLStateCache::Current()->Viewport(mX, mY, mWidth, mHeight);
 
     GFrameBufferObject &fbo = mFboMap[fboName];
 
     UseDefaultRenderPipeline();
 
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_DEPTH_TEST);
+    GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Disable(GL_DEPTH_TEST);
+    SetClipScissorEnabled(false);
 
     DoSetGlobalCompositeOperation(compositeOp, compositeOp);
 
@@ -333,11 +317,12 @@ DrawFBO(std::string fboName, GCompositeOperation compositeOp, float sx, float sy
     mVertexBufferIndex = 0;
 
     if (HasClipRegion()) {
-        glEnable(GL_STENCIL_TEST);
-        glEnable(GL_DEPTH_TEST);
+        GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
+        GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
     }
+    SetClipScissorEnabled(true);
 
-    glViewport(0, 0, mWidth, mHeight);
+    GGLStateCache::Current()->Viewport(0, 0, mWidth, mHeight);
 
     Restore();
 }
@@ -349,11 +334,12 @@ void GCanvas2DContextAndroid::ResetGLBeforeCopyFrame(int width, int height) {
     SetClearColor(GColorTransparent);
     ClearScreen();
     SetClearColor(c);
-    glViewport(0, 0, width, height);
+    GGLStateCache::Current()->Viewport(0, 0, width, height);
 
     UseDefaultRenderPipeline();
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_DEPTH_TEST);
+    GGLStateCache::Current()->Disable(GL_STENCIL_TEST);
+    GGLStateCache::Current()->Disable(GL_DEPTH_TEST);
+    SetClipScissorEnabled(false);
 
     GCompositeOperation compositeOp = COMPOSITE_OP_SOURCE_OVER;
     DoSetGlobalCompositeOperation(compositeOp, compositeOp);
@@ -366,9 +352,10 @@ void GCanvas2DContextAndroid::ResetGLBeforeCopyFrame(int width, int height) {
 
 void GCanvas2DContextAndroid::RestoreGLAfterCopyFrame() {
     if (HasClipRegion()) {
-        glEnable(GL_STENCIL_TEST);
+        GGLStateCache::Current()->Enable(GL_STENCIL_TEST);
     }
-    glEnable(GL_DEPTH_TEST);
+    GGLStateCache::Current()->Enable(GL_DEPTH_TEST);
+    SetClipScissorEnabled(true);
 
     Restore();
 }
@@ -379,8 +366,4 @@ void GCanvas2DContextAndroid::DrawFrame(bool clear) {
     if (clear) {
         ClearGeometryDataBuffers();
     }
-}
-
-GShaderManager *GCanvas2DContextAndroid::GetShaderManager() {
-    return this->mShaderManager;
 }
\ No newline at end of file
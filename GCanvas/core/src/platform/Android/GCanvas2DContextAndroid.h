@@ -14,7 +14,6 @@
 #include "GCanvas2dContext.h"
 #include "GFont.h"
 #include "GSystemFontInformation.h"
-#include "GShaderManager.h"
 
 #include <cstdint>
 
@@ -36,7 +35,6 @@ public:
     void InitFBO() override;
 
 
-    API_EXPORT GShader *FindShader(const char *) override;
 
 
     API_EXPORT void ClearColor();
@@ -78,7 +76,6 @@ public:
     void SetEnableFboMsaa(bool v) { mEnableFboMsaa = v; }
 
 
-    GShaderManager* GetShaderManager();
 protected:
 
 
@@ -88,7 +85,6 @@ protected:
     void RestoreGLAfterCopyFrame();
 
 
-    bool InitializeGLShader() override;
 
 
     // void GLBlend(GCompositeOperation op, GCompositeOperation alphaOp);
@@ -102,7 +98,6 @@ protected:
 private:
 
     bool mEnableFboMsaa = false;
-    GShaderManager *mShaderManager = nullptr;
 
     GFontCache *mFontCache = nullptr;
 
@@ -9,6 +9,7 @@
 
 
 #include "GCanvas2dContext.h"
+#include "gcanvas/GGLStateCache.h"
 #include "CharacterSet.h"
 #include "gcanvas/GCanvas2dContext.h"
 #include "support/Log.h"
@@ -58,7 +59,7 @@ void GCanvasContext::DoSetGlobalCompositeOperation(GCompositeOperation op, GComp
 
     GBlendOperationFuncs alphaFuncs = GCompositeOperationFuncs(alphaOp);
 
-    glBlendFuncSeparate(funcs.source, funcs.destination,
+    GGLStateCache::Current()->BlendFuncSeparate(funcs.source, funcs.destination,
                         alphaFuncs.source, alphaFuncs.destination);
 
     mCurrentState->mGlobalCompositeOp = op;
@@ -8,6 +8,7 @@
  */
 
 #include "GFrameBufferObject.h"
+#include "gcanvas/GGLStateCache.h"
 #include "GCanvas2dContext.h"
 
 #include "support/Log.h"
@@ -78,12 +79,13 @@ bool GFrameBufferObject::InitFBO(int width, int height, GColorRGBA color, bool e
     LOG_W("initFBO> useMsaa=%d, support_render_texture_msaa=%d", useMsaa, support_render_texture_msaa);
 
     glGenFramebuffers(1, &mFboFrame);
+    GFRAME_COUNT(FRAME_COUNTER_FBO_ALLOCATIONS, 1);
     if (mFboFrame <= 0)
     {
         AppendErrorLogInfo(errVec, "gen_framebuffer_fail", "<function:%s, glGetError:%x>", __FUNCTION__, glGetError());
     }
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &mSaveFboFrame);
-    glBindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
+    mSaveFboFrame = (GLint) GGLStateCache::Current()->BoundFramebuffer();
+    GGLStateCache::Current()->BindFramebuffer(GL_FRAMEBUFFER, mFboFrame);
 
     mFboTexture.SetWidth(width);
     mFboTexture.SetHeight(height);
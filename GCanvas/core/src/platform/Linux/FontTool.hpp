@@ -10,6 +10,7 @@
 #include <iostream>
 #include <locale>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include FT_FREETYPE_H
@@ -59,6 +60,10 @@ inline std::string getLoweredFileExt(const std::string &fp) {
  * 1) loading typeface from font
  * 2) building typeface cache
  * 3) exporting/importing typeface cache
+ *
+ * There is one loader per process. Callers that may run on several threads
+ * hold getMutex() while they touch the faces, since faces are opened lazily
+ * and FreeType objects are not thread safe.
  */
 class TypefaceLoader {
 public:
@@ -108,6 +113,7 @@ private:
   bool mInited;
   FT_Library mFreetype;
   std::vector<Typeface> mFaces;
+  std::recursive_mutex mMutex;
 
   TypefaceLoader() : mInited(false), mFreetype(nullptr) {}
 
@@ -116,6 +122,7 @@ private:
   TypefaceLoader &operator=(const TypefaceLoader &) = delete;
 
   TypefaceLoader *init() {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     if (mInited) {
       return this;
     }
@@ -166,6 +173,8 @@ public:
 
   std::vector<Typeface> &getFaces() { return mFaces; }
 
+  std::recursive_mutex &getMutex() { return mMutex; }
+
   static TypefaceLoader *getInstance() {
     static std::unique_ptr<TypefaceLoader> instance(new TypefaceLoader());
     ASSERT(instance);
@@ -442,6 +451,7 @@ public:
 
   const std::vector<Typeface *> &selectTypefaces(const std::string &key = "") {
     ASSERT(mTypefaceLoader);
+    std::lock_guard<std::recursive_mutex> lock(mTypefaceLoader->getMutex());
 
     // return typefaces if already in cache
     auto it = mTypefacesCache.find(key);
@@ -488,6 +498,7 @@ public:
   }
 
   Typeface *selectTypeface(wchar_t charcode, const std::string &key = "") {
+    std::lock_guard<std::recursive_mutex> lock(mTypefaceLoader->getMutex());
     const std::vector<Typeface *> &faces = selectTypefaces(key);
 
     for (auto it = faces.rbegin(); it != faces.rend(); it++) {
@@ -501,6 +512,7 @@ public:
   }
 
   Typeface *selectFallbackTypeface(const std::string &key = "") {
+    std::lock_guard<std::recursive_mutex> lock(mTypefaceLoader->getMutex());
     const std::vector<Typeface *> &faces = selectTypefaces(key);
     if (faces.empty()) {
       if (key.empty()) {
@@ -349,6 +349,7 @@ void GFont::LoadGlyph(wchar_t charcode, int ftBitmapWidth, int ftBitmapHeight,
 
 void GFont::loadGlyphs(const wchar_t *charcodes,bool isStroke)
 {
+    GFRAME_PHASE(FRAME_PHASE_GLYPH_RASTER);
 
     FT_Glyph ft_glyph;
     FT_GlyphSlot slot;
@@ -62,7 +62,12 @@ GFontManagerImplement::GFontManagerImplement(GCanvasContext *context) : GFontMan
     using NSFontTool::TypefaceLoader;
     TypefaceLoader *tl = TypefaceLoader::getInstance();
     ASSERT(tl);
-    ASSERT(tl->importFontCache(".fontcache"));  
+    // import once, a second import would move the faces other canvases hold
+    std::lock_guard<std::recursive_mutex> lock(tl->getMutex());
+    if (tl->getFaces().empty())
+    {
+        ASSERT(tl->importFontCache(".fontcache"));
+    }
 
 }
 
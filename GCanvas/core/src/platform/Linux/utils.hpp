@@ -157,10 +157,12 @@ static inline FILE *_log_file_() {
 #endif
 
 /// Public assert macros
+#ifndef ASSERT
 #define ASSERT(x)                                                              \
   do {                                                                         \
     _ASSERT_(x, "");                                                           \
   } while (0)
+#endif
 #define ASSERT_MSG(x, msg, ...)                                                \
   do {                                                                         \
     _ASSERT_(x, FAIL_COLOR(msg), ##__VA_ARGS__);                               \
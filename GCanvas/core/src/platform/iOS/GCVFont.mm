@@ -384,6 +384,7 @@ static NSMutableDictionary *staticFontInstaceDict;
 
 - (void)createGlyph:(CGGlyph)glyph withFont:(CTFontRef)font withFontStyle:(NSString *)fontStyle glyphInfo:(GGlyph *)glyphInfo
 {
+    GFRAME_PHASE(FRAME_PHASE_GLYPH_RASTER);
     CGRect bbRect;
     CTFontGetBoundingRectsForGlyphs(font, kCTFontOrientationDefault, &glyph, &bbRect, 1);
     CGSize advance;
@@ -7,6 +7,7 @@
  * the LICENSE file in the root directory of this source tree.
  */
 #include "../../gcanvas/GFontManager.h"
+#include "../../gcanvas/GGLStateCache.h"
 #include "../../gcanvas/GCanvas2dContext.h"
 #include "../../support/Log.h"
 #include "../../GCanvas.hpp"
@@ -118,7 +119,7 @@ void iOS_GCanvas_Draw_Text(const unsigned short *text, unsigned int text_length,
     GCanvasState *current_state_ = context->GetCurrentState();
     GCVFont *curFont = (__bridge GCVFont*)fontContext;
     
-    [curFont resetWithFontStyle:current_state_->mFont isStroke:isStroke];
+    [curFont resetWithFontStyle:current_state_->mFont.Get() isStroke:isStroke];
     NSString *string = [[NSString alloc] initWithBytes:text length:text_length encoding:NSUTF8StringEncoding];
     GFontLayout *fontLayout = [curFont getLayoutForString:string withFontStyle:[NSString stringWithUTF8String:current_state_->mFont->GetName().c_str()]];
     CGPoint destPoint = [curFont adjustTextPenPoint:CGPointMake(x, y)
@@ -128,7 +129,7 @@ void iOS_GCanvas_Draw_Text(const unsigned short *text, unsigned int text_length,
     
     current_state_->mShader->SetOverideTextureColor(1);
     
-    glActiveTexture(GL_TEXTURE0);
+    GGLStateCache::Current()->ActiveTexture(GL_TEXTURE0);
     
     [curFont drawString:string withFontStyle:[NSString stringWithUTF8String:current_state_->mFont->GetName().c_str()] withLayout:fontLayout withPosition:destPoint];
     
@@ -143,7 +144,7 @@ float iOS_GCanvas_Measure_Text(const char *text, unsigned int text_length, GCanv
     GCanvasState *current_state_ = context->GetCurrentState();
     GCVFont *curFont = (__bridge GCVFont*)fontContext;
     
-    [curFont resetWithFontStyle:current_state_->mFont isStroke:false];
+    [curFont resetWithFontStyle:current_state_->mFont.Get() isStroke:false];
     NSString *string = [[NSString alloc] initWithBytes:text length:text_length encoding:NSUTF8StringEncoding];
     GFontLayout *fontLayout = [curFont getLayoutForString:string withFontStyle:[NSString stringWithUTF8String:current_state_->mFont->GetName().c_str()]];
     
@@ -161,7 +162,7 @@ float* iOS_GCanvas_Measure_TextExt(const char *text, unsigned int text_length, G
     GCanvasState *current_state_ = context->GetCurrentState();
     GCVFont *curFont = (__bridge GCVFont*)fontContext;
     
-    [curFont resetWithFontStyle:current_state_->mFont isStroke:false];
+    [curFont resetWithFontStyle:current_state_->mFont.Get() isStroke:false];
     NSString *string = [[NSString alloc] initWithBytes:text length:text_length encoding:NSUTF8StringEncoding];
     GFontLayout *fontLayout = [curFont getLayoutForString:string withFontStyle:[NSString stringWithUTF8String:current_state_->mFont->GetName().c_str()]];
     
@@ -13,6 +13,7 @@
 
 #ifdef DEBUG
 void DLog(const char *format, ...);
+#ifndef ASSERT
 #ifdef __ANDROID__
 #define ASSERT(x)                                                              \
     {                                                                          \
@@ -29,6 +30,7 @@ void DLog(const char *format, ...);
         assert(x);                                                             \
     }
 #endif
+#endif
 #else
 #ifndef ASSERT
 #define ASSERT(x)                                                              \
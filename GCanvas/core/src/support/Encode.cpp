@@ -13,104 +13,235 @@ namespace gcanvas
 static const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
                                      "abcdefghijklmnopqrstuvwxyz"
                                      "0123456789+/";
-static const unsigned char BASE64_INDEXES[] = {
-    62,  255, 255, 255, 63,  52,  53, 54, 55, 56, 57, 58, 59, 60, 61, 255,
-    255, 255, 255, 255, 255, 255, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,
-    10,  11,  12,  13,  14,  15,  16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
-    255, 255, 255, 255, 255, 255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
-    36,  37,  38,  39,  40,  41,  42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
+
+// full byte table, invalid chars (including the pad) map to 255 so a whole
+// quad can be validated with a single test of the high bit
+static const unsigned char BASE64_INDEXES[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,
+     52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+    255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+     15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,
+    255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+     41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
 
 static const char BASE64_PAD = '=';
-static const char BASE64_FIRST = '+';
 
-#define CSHL(v, n) ((unsigned char)((v) << (n)))
-#define CSHR(v, n) ((unsigned char)((v) >> (n)))
-#define CSHLR(v, l, r) CSHR(CSHL(v, l), r)
-#define CSHRL(v, r, l) CSHL(CSHR(v, r), l)
-#define DECODE(v) (BASE64_INDEXES[(v)-BASE64_FIRST])
+// input chars decoded per Base64DecodeStream chunk, must be a multiple of 4
+static const int BASE64_STREAM_CHUNK = 4096;
 
-int Base64EncodeLen(int inputLen) { return (inputLen + 2) / 3 * 4; }
+// encode whole 3 byte groups, len must be a multiple of 3
+static int EncodeBlock(unsigned char *output, const unsigned char *input,
+                       int len)
+{
+    int ret = 0;
+    for (int i = 0; i < len; i += 3)
+    {
+        unsigned int v = (input[i] << 16) | (input[i + 1] << 8) | input[i + 2];
+        output[ret] = BASE64_CHARS[v >> 18];
+        output[ret + 1] = BASE64_CHARS[(v >> 12) & 0x3F];
+        output[ret + 2] = BASE64_CHARS[(v >> 6) & 0x3F];
+        output[ret + 3] = BASE64_CHARS[v & 0x3F];
+        ret += 4;
+    }
+    return ret;
+}
 
-int Base64EncodeBuf(char *szDest, const char *szSrc, int &iBufSize)
+// encode the last 1 or 2 bytes with padding
+static int EncodeTail(unsigned char *output, const unsigned char *input,
+                      int len)
 {
-    unsigned char *output = (unsigned char *)szDest;
-    const unsigned char *input = (const unsigned char *)szSrc;
+    if (len <= 0)
+    {
+        return 0;
+    }
+
+    unsigned int v = input[0] << 16;
+    if (len > 1)
+    {
+        v |= input[1] << 8;
+    }
+    output[0] = BASE64_CHARS[v >> 18];
+    output[1] = BASE64_CHARS[(v >> 12) & 0x3F];
+    output[2] = len > 1 ? BASE64_CHARS[(v >> 6) & 0x3F] : BASE64_PAD;
+    output[3] = BASE64_PAD;
+    return 4;
+}
+
+// decode whole quads, only the last quad of the final block may be padded.
+// returns decoded bytes or -1 on malformed input
+static int DecodeBlock(unsigned char *output, const unsigned char *input,
+                       int len, bool final)
+{
+    int full = len;
+    if (final && len >= 4 && input[len - 1] == BASE64_PAD)
+    {
+        full = len - 4;
+    }
 
     int ret = 0;
-    for (int i = 0; i < iBufSize; i += 3)
+    for (int i = 0; i < full; i += 4)
     {
-        output[ret++] = BASE64_CHARS[CSHR(input[i], 2)];
+        unsigned int a = BASE64_INDEXES[input[i]];
+        unsigned int b = BASE64_INDEXES[input[i + 1]];
+        unsigned int c = BASE64_INDEXES[input[i + 2]];
+        unsigned int d = BASE64_INDEXES[input[i + 3]];
+        if ((a | b | c | d) & 0x80)
+        {
+            return -1;
+        }
 
-        if (i + 1 >= iBufSize)
+        unsigned int v = (a << 18) | (b << 12) | (c << 6) | d;
+        output[ret] = (unsigned char)(v >> 16);
+        output[ret + 1] = (unsigned char)(v >> 8);
+        output[ret + 2] = (unsigned char)v;
+        ret += 3;
+    }
+
+    if (full < len)
+    {
+        const unsigned char *tail = input + full;
+        unsigned int a = BASE64_INDEXES[tail[0]];
+        unsigned int b = BASE64_INDEXES[tail[1]];
+        if ((a | b) & 0x80)
         {
-            output[ret] = BASE64_CHARS[CSHLR(input[i], 6, 2)];
-            output[++ret] = BASE64_PAD;
-            output[++ret] = BASE64_PAD;
-            ++ret;
-            break;
+            return -1;
         }
+        output[ret++] = (unsigned char)((a << 2) | (b >> 4));
 
-        output[ret] =
-            BASE64_CHARS[CSHLR(input[i], 6, 2) | CSHR(input[i + 1], 4)];
-        if (i + 2 >= iBufSize)
+        if (tail[2] != BASE64_PAD)
         {
-            output[++ret] = BASE64_CHARS[CSHLR(input[i + 1], 4, 2)];
-            output[++ret] = BASE64_PAD;
-            ++ret;
-            break;
+            unsigned int c = BASE64_INDEXES[tail[2]];
+            if (c & 0x80)
+            {
+                return -1;
+            }
+            output[ret++] = (unsigned char)((b << 4) | (c >> 2));
         }
-        output[++ret] =
-            BASE64_CHARS[CSHLR(input[i + 1], 4, 2) | CSHR(input[i + 2], 6)];
-        output[++ret] = BASE64_CHARS[CSHLR(input[i + 2], 2, 2)];
-        ++ret;
     }
-    iBufSize = ret;
-    return iBufSize;
+    return ret;
 }
 
-int Base64DecodeBuf(char *szDest, const char *szSrc, int &iBufSize)
+int Base64EncodeLen(int inputLen) { return (inputLen + 2) / 3 * 4; }
+
+int Base64DecodeLen(int inputLen) { return inputLen / 4 * 3; }
+
+int Base64EncodeBuf(char *szDest, const char *szSrc, int &iBufSize)
 {
     unsigned char *output = (unsigned char *)szDest;
     const unsigned char *input = (const unsigned char *)szSrc;
 
+    int whole = iBufSize - iBufSize % 3;
+    int ret = EncodeBlock(output, input, whole);
+    ret += EncodeTail(output + ret, input + whole, iBufSize - whole);
+
+    iBufSize = ret;
+    return iBufSize;
+}
+
+int Base64DecodeBuf(char *szDest, const char *szSrc, int &iBufSize)
+{
     if (iBufSize % 4 > 0)
     {
         return -1;
     }
 
-    int ret = 0;
-    for (int i = 0; i < iBufSize; i += 4)
+    int ret = DecodeBlock((unsigned char *)szDest,
+                          (const unsigned char *)szSrc, iBufSize, true);
+    iBufSize = ret < 0 ? 0 : ret;
+    return ret;
+}
+
+int Base64DecodeStream(const char *szSrc, int iSrcLen, Base64Sink sink,
+                       void *userData)
+{
+    if (iSrcLen % 4 > 0 || sink == nullptr)
+    {
+        return -1;
+    }
+
+    unsigned char chunk[BASE64_STREAM_CHUNK / 4 * 3];
+    const unsigned char *input = (const unsigned char *)szSrc;
+
+    int total = 0;
+    for (int i = 0; i < iSrcLen; i += BASE64_STREAM_CHUNK)
     {
-        unsigned char buf[4] = {0};
-        for (int j = 0; j < 4; ++j)
+        int len = iSrcLen - i;
+        bool final = len <= BASE64_STREAM_CHUNK;
+        if (!final)
         {
-            if (input[i + j] == BASE64_PAD)
-            {
-                break;
-            }
-            buf[j] = DECODE(input[i + j]);
+            len = BASE64_STREAM_CHUNK;
         }
 
-        buf[0] <<= 2;
-        output[ret++] = buf[0] | CSHR(buf[1], 4);
-
-        if (BASE64_PAD == input[i + 2])
+        int ret = DecodeBlock(chunk, input + i, len, final);
+        if (ret < 0)
+        {
+            return -1;
+        }
+        total += ret;
+        if (!sink((const char *)chunk, ret, userData))
         {
             break;
         }
+    }
+    return total;
+}
+
+void Base64EncodeBegin(Base64Encoder &encoder) { encoder.carryLen = 0; }
 
-        buf[1] <<= 4;
-        output[ret++] = buf[1] | CSHR(buf[2], 2);
+int Base64EncodeUpdate(Base64Encoder &encoder, char *szDest, const char *szSrc,
+                       int iSrcLen)
+{
+    unsigned char *output = (unsigned char *)szDest;
+    const unsigned char *input = (const unsigned char *)szSrc;
 
-        if (BASE64_PAD == input[i + 3])
+    int ret = 0;
+    if (encoder.carryLen > 0)
+    {
+        unsigned char group[3] = {encoder.carry[0], encoder.carry[1], 0};
+        int need = 3 - encoder.carryLen;
+        if (iSrcLen < need)
         {
-            break;
+            for (int i = 0; i < iSrcLen; ++i)
+            {
+                encoder.carry[encoder.carryLen++] = input[i];
+            }
+            return 0;
         }
+        for (int i = 0; i < need; ++i)
+        {
+            group[encoder.carryLen + i] = input[i];
+        }
+        ret = EncodeBlock(output, group, 3);
+        input += need;
+        iSrcLen -= need;
+        encoder.carryLen = 0;
+    }
 
-        buf[2] <<= 6;
-        output[ret++] = buf[2] | buf[3];
+    int whole = iSrcLen - iSrcLen % 3;
+    ret += EncodeBlock(output + ret, input, whole);
+    for (int i = whole; i < iSrcLen; ++i)
+    {
+        encoder.carry[encoder.carryLen++] = input[i];
     }
-    iBufSize = ret;
-    return iBufSize;
+    return ret;
+}
+
+int Base64EncodeFinish(Base64Encoder &encoder, char *szDest)
+{
+    int ret = EncodeTail((unsigned char *)szDest, encoder.carry,
+                         encoder.carryLen);
+    encoder.carryLen = 0;
+    return ret;
 }
 }
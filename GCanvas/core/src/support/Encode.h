@@ -13,8 +13,32 @@ namespace gcanvas
 {
 ////////////////////////////base64 encoding////////////////////////////
 int Base64EncodeLen(int inputLen);
+int Base64DecodeLen(int inputLen);
 int Base64EncodeBuf(char *szDest, const char *szSrc, int &iBufSize);
 int Base64DecodeBuf(char *szDest, const char *szSrc, int &iBufSize);
+
+////////////////////////////base64 streaming////////////////////////////
+// Receives decoded bytes chunk by chunk, return false to stop decoding.
+typedef bool (*Base64Sink)(const char *data, int len, void *userData);
+
+// Decode szSrc in fixed size chunks without a full size intermediate
+// buffer, returns total decoded bytes or -1 on malformed input.
+int Base64DecodeStream(const char *szSrc, int iSrcLen, Base64Sink sink,
+                       void *userData);
+
+// Incremental encoder, input may be fed in pieces of any length.
+struct Base64Encoder
+{
+    unsigned char carry[2];
+    int carryLen;
+};
+
+void Base64EncodeBegin(Base64Encoder &encoder);
+// szDest must hold Base64EncodeLen(iSrcLen + 2) chars, returns chars written
+int Base64EncodeUpdate(Base64Encoder &encoder, char *szDest, const char *szSrc,
+                       int iSrcLen);
+// flush the carried bytes with padding, szDest must hold 4 chars
+int Base64EncodeFinish(Base64Encoder &encoder, char *szDest);
 }
 
 #endif /* GCANVAS_ENCODE_H */
@@ -8,6 +8,8 @@
 */
 
 #include "GLUtil.h"
+#include "../gcanvas/GFrameProfiler.h"
+#include "../gcanvas/GGLStateCache.h"
 
 namespace gcanvas {
 
@@ -106,7 +108,7 @@ namespace gcanvas {
                         glerror);
             errVec->push_back(log);
         }
-        glBindTexture(GL_TEXTURE_2D, glID);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
         glerror = glGetError();
         if (glerror && errVec) {
             GCanvasLog log;
@@ -121,6 +123,8 @@ namespace gcanvas {
 
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
                      GL_UNSIGNED_BYTE, rgbaData);
+        GFRAME_COUNT(FRAME_COUNTER_TEXTURE_UPLOAD_BYTES,
+                     TexImageSize(width, height, format, GL_UNSIGNED_BYTE, UnpackAlignment()));
         glerror = glGetError();
         if (glerror && errVec) {
             GCanvasLog log;
@@ -132,4 +136,45 @@ namespace gcanvas {
         return glID;
     }
 
+    size_t TexImageSize(int width, int height, GLenum format, GLenum type, int alignment) {
+        if (width <= 0 || height <= 0) {
+            return 0;
+        }
+
+        size_t pixelBytes = 0;
+        if (type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 ||
+            type == GL_UNSIGNED_SHORT_5_5_5_1) {
+            pixelBytes = 2;
+        } else if (type == GL_UNSIGNED_BYTE) {
+            switch (format) {
+                case GL_ALPHA:
+                case GL_LUMINANCE:
+                    pixelBytes = 1;
+                    break;
+                case GL_LUMINANCE_ALPHA:
+                    pixelBytes = 2;
+                    break;
+                case GL_RGB:
+                    pixelBytes = 3;
+                    break;
+                case GL_RGBA:
+                    pixelBytes = 4;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // rows start aligned, the last one is not padded
+        size_t align = alignment > 1 ? (size_t) alignment : 1;
+        size_t rowBytes = ((size_t) width * pixelBytes + align - 1) / align * align;
+        return rowBytes * (size_t) (height - 1) + (size_t) width * pixelBytes;
+    }
+
+    int UnpackAlignment() {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        return alignment;
+    }
+
 }
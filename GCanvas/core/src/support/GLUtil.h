@@ -18,6 +18,12 @@ namespace gcanvas{
     GLuint PixelsBindTexture(const unsigned char *rgbaData, GLint format, unsigned int width,
                              unsigned int height, std::vector<GCanvasLog> *errVec = nullptr);
     void PixelsSampler(int inWidth, int inHeight, int *inPixels, int outWidth, int outHeight, int *outPixels);
+    // bytes glTexImage2D reads for width x height pixels of format and type
+    // when rows start at multiples of alignment, 0 if the combination is
+    // unknown; 1 for tightly packed data
+    size_t TexImageSize(int width, int height, GLenum format, GLenum type, int alignment);
+    // GL_UNPACK_ALIGNMENT of the current context
+    int UnpackAlignment();
 }
 
 #endif /* GCANVAS_GLUTIL_H */
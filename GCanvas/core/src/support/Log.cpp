@@ -22,17 +22,16 @@
     GCanvasSystemLog gcanvasSystemLog;
 
     // default log level : Error
-    LogLevel g_log_level = LOG_LEVEL_ERROR;
+    std::atomic<int> g_log_level(LOG_LEVEL_ERROR);
 
-    LogLevel GetLogLevel() { return g_log_level; };
+    LogLevel GetLogLevel() { return (LogLevel) g_log_level.load(std::memory_order_relaxed); };
 
     void SetLogLevel(LogLevel logLevel) {
-        if (g_log_level == logLevel) return;
+        int oldLevel = g_log_level.exchange(logLevel, std::memory_order_relaxed);
+        if (oldLevel == logLevel) return;
 #ifdef DEBUG
-        LogLevel oldLevel = g_log_level;
         LOG_I("[SetLogLevel] %d=>%d", oldLevel, logLevel);
 #endif
-        g_log_level = logLevel;
     };
 
 
@@ -82,7 +81,7 @@
 #endif
 
     void LogExt(LogLevel logLevel, const char *tag, const char *format, ...) {
-        if (g_log_level > logLevel) return;
+        if (g_log_level.load(std::memory_order_relaxed) > logLevel) return;
         va_list va;
       
         char buffer[LOG_MSG_BUF_SIZE];
@@ -119,7 +118,7 @@
             hooks->GCanvasException(contextId.c_str(), tag, buffer);
         } else
         {
-            __android_log_write(TransLogLevel(g_log_level), tag, buffer);
+            __android_log_write(TransLogLevel(GetLogLevel()), tag, buffer);
         }
 #else
         if (hooks && hooks->GCanvasException) {
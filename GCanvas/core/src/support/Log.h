@@ -12,6 +12,7 @@
 #if defined(__ANDROID__)
 #include <android/log.h>
 #endif
+#include <atomic>
 #include <iostream>
 #include <vector>
 
@@ -65,6 +66,9 @@ typedef enum {
     void SetLogLevel(LogLevel logLevel);
     LogLevel GetLogLevel();
 
+    // read on every log call of every thread, set from the host's thread
+    extern std::atomic<int> g_log_level;
+
 
     API_EXPORT void LogException(GCanvasHooks *hooks, std::string contextId, const char *tag, const char *format, ...);
 
@@ -75,7 +79,20 @@ typedef enum {
     //#define DISABLE_LOG
     //#endif
 
+    // Lowest level compiled in, e.g. -DGCANVAS_LOG_MIN_LEVEL=LOG_LEVEL_WARN.
+    // Calls below it are removed together with their arguments.
+    #ifndef GCANVAS_LOG_MIN_LEVEL
+    #define GCANVAS_LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+    #endif
+
+    // true when a message of this level would be written, use it to guard
+    // work that only builds log output
+    #define LOG_ENABLED(level) ((level) >= GCANVAS_LOG_MIN_LEVEL && \
+                                (level) >= g_log_level.load(std::memory_order_relaxed))
+
     #ifdef DISABLE_LOG
+    #undef LOG_ENABLED
+    #define LOG_ENABLED(level) false
     #define LOG_D(...) ;
     #define LOG_I(...) ;
     #define LOG_W(...) ;
@@ -86,11 +103,13 @@ typedef enum {
     #define LOG_EXCEPTION_VECTOR(hooks, contextId, std::vector<GCanvasLog> *vec);
     #else
     #define LOG_TAG_NAME "gcanvasCore"
-    #define LOG_D(...) LogExt(LOG_LEVEL_DEBUG, LOG_TAG_NAME, __VA_ARGS__)
-    #define LOG_I(...) LogExt(LOG_LEVEL_INFO, LOG_TAG_NAME, __VA_ARGS__)
-    #define LOG_W(...) LogExt(LOG_LEVEL_WARN, LOG_TAG_NAME, __VA_ARGS__)
-    #define LOG_E(...) LogExt(LOG_LEVEL_ERROR, LOG_TAG_NAME, __VA_ARGS__)
-    #define LOG_F(...) LogExt(LOG_LEVEL_FATAL, LOG_TAG_NAME, __VA_ARGS__)
+    // the level is checked before the arguments are evaluated
+    #define LOG_AT(level, ...) do { if (LOG_ENABLED(level)) LogExt(level, LOG_TAG_NAME, __VA_ARGS__); } while (0)
+    #define LOG_D(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+    #define LOG_I(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+    #define LOG_W(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+    #define LOG_E(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+    #define LOG_F(...) LOG_AT(LOG_LEVEL_FATAL, __VA_ARGS__)
     #define LOG_EXT LogExt
     #define LOG_EXCEPTION(hooks, contextId, tag, ...) LogException(hooks, contextId, tag, __VA_ARGS__)
     #define LOG_EXCEPTION_VECTOR(hooks, contextId, vec) LogExceptionVector(hooks, contextId, vec)
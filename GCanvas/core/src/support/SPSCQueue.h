@@ -0,0 +1,113 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_SPSCQUEUE_H
+#define GCANVAS_SPSCQUEUE_H
+
+#include <atomic>
+
+namespace gcanvas
+{
+
+/**
+ * Unbounded lock free queue for exactly one producer thread and one
+ * consumer thread, a linked list with a stub node. Push never blocks and
+ * never fails, Pop returns false when the queue is empty.
+ *
+ * Nodes the consumer is done with stay in the list and the producer takes
+ * them back, so a queue that has reached its peak length allocates no more.
+ *
+ * Empty() is exact on the consumer thread and a hint anywhere else.
+ */
+template < class T > class SPSCQueue
+{
+public:
+    SPSCQueue() : mHead(new Node())
+    {
+        mTail = mFirst = mHeadCopy = mHead.load(std::memory_order_relaxed);
+    }
+
+    ~SPSCQueue()
+    {
+        while (mFirst != nullptr)
+        {
+            Node *next = mFirst->next.load(std::memory_order_relaxed);
+            delete mFirst;
+            mFirst = next;
+        }
+    }
+
+    // producer
+    void Push(const T &value)
+    {
+        Node *node = AllocNode();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->value = value;
+        mTail->next.store(node, std::memory_order_release);
+        mTail = node;
+    }
+
+    // consumer
+    bool Pop(T &value)
+    {
+        Node *head = mHead.load(std::memory_order_relaxed);
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+        value = next->value;
+        next->value = T();   // next becomes the stub
+        mHead.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return mHead.load(std::memory_order_acquire)->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node
+    {
+        Node() : next(nullptr), value()
+        {
+        }
+
+        std::atomic< Node * > next;
+        T value;
+    };
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    // producer, the nodes from mFirst up to the stub are free
+    Node *AllocNode()
+    {
+        if (mFirst == mHeadCopy)
+        {
+            mHeadCopy = mHead.load(std::memory_order_acquire);
+        }
+        if (mFirst != mHeadCopy)
+        {
+            Node *node = mFirst;
+            mFirst = mFirst->next.load(std::memory_order_relaxed);
+            return node;
+        }
+        return new Node();
+    }
+
+    std::atomic< Node * > mHead;   // consumer side, the stub before the first value
+    Node *mTail;       // producer side
+    Node *mFirst;      // producer side, oldest node of the list
+    Node *mHeadCopy;   // producer side, mHead as last seen
+};
+
+}
+
+#endif /* GCANVAS_SPSCQUEUE_H */
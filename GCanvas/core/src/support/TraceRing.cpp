@@ -0,0 +1,152 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#include "TraceRing.h"
+
+#include <chrono>
+
+namespace gcanvas
+{
+
+// A slot is written under a sequence number, odd while the write is in
+// progress and 2 * ticket + 2 once it is done, so a reader can tell a
+// finished record of the ticket it expects from a torn or newer one.
+struct TraceSlot
+{
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> timeNs;
+    std::atomic<uint32_t> event;
+    std::atomic<uint32_t> thread;
+    std::atomic<int32_t> arg0;
+    std::atomic<int32_t> arg1;
+};
+
+static TraceSlot sSlots[TraceRing::CAPACITY];
+static std::atomic<uint64_t> sNextTicket(0);
+static std::atomic<uint32_t> sThreadCount(0);
+
+std::atomic<bool> TraceRing::sEnabled(false);
+
+static uint32_t CurrentThreadNumber()
+{
+    static thread_local uint32_t number = ++sThreadCount;
+    return number;
+}
+
+void TraceRing::SetEnabled(bool enabled)
+{
+    sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRing::Record(uint32_t event, int32_t arg0, int32_t arg1)
+{
+    uint64_t now = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    uint64_t ticket = sNextTicket.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot &slot = sSlots[ticket & (CAPACITY - 1)];
+    slot.sequence.store(ticket * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timeNs.store(now, std::memory_order_relaxed);
+    slot.event.store(event, std::memory_order_relaxed);
+    slot.thread.store(CurrentThreadNumber(), std::memory_order_relaxed);
+    slot.arg0.store(arg0, std::memory_order_relaxed);
+    slot.arg1.store(arg1, std::memory_order_relaxed);
+    slot.sequence.store(ticket * 2 + 2, std::memory_order_release);
+}
+
+size_t TraceRing::Snapshot(std::vector<TraceRecord> &records)
+{
+    records.clear();
+    uint64_t end = sNextTicket.load(std::memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    records.reserve((size_t)(end - begin));
+
+    for (uint64_t ticket = begin; ticket < end; ++ticket)
+    {
+        TraceSlot &slot = sSlots[ticket & (CAPACITY - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != ticket * 2 + 2)
+        {
+            continue;   // still being written, or already overwritten
+        }
+
+        TraceRecord record;
+        record.timeNs = slot.timeNs.load(std::memory_order_relaxed);
+        record.event = slot.event.load(std::memory_order_relaxed);
+        record.thread = slot.thread.load(std::memory_order_relaxed);
+        record.arg0 = slot.arg0.load(std::memory_order_relaxed);
+        record.arg1 = slot.arg1.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            continue;   // overwritten while copying
+        }
+        records.push_back(record);
+    }
+    return records.size();
+}
+
+void TraceRing::Dump(FILE *file)
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    std::vector<TraceRecord> records;
+    Snapshot(records);
+    fprintf(file, "gcanvas trace, %u records\n", (unsigned int)records.size());
+    if (records.empty())
+    {
+        return;
+    }
+
+    uint64_t start = records[0].timeNs;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const TraceRecord &record = records[i];
+        const char *name = EventName(record.event);
+        double ms = (double)(int64_t)(record.timeNs - start) / 1000000.0;
+        if (name != nullptr)
+        {
+            fprintf(file, "%12.3f ms  t%-3u %-14s %d %d\n", ms, record.thread, name,
+                    record.arg0, record.arg1);
+        }
+        else
+        {
+            fprintf(file, "%12.3f ms  t%-3u event%-9u %d %d\n", ms, record.thread,
+                    record.event, record.arg0, record.arg1);
+        }
+    }
+    fflush(file);
+}
+
+const char *TraceRing::EventName(uint32_t event)
+{
+    switch (event)
+    {
+        case TRACE_CMD_QUEUED:
+            return "cmdQueued";
+        case TRACE_CMD_EXEC:
+            return "cmdExec";
+        case TRACE_CMD_DRAIN:
+            return "cmdDrain";
+        case TRACE_RENDER_2D:
+            return "render2d";
+        case TRACE_RENDER_WEBGL:
+            return "renderWebGL";
+        case TRACE_SYNC_RESULT:
+            return "syncResult";
+        default:
+            return nullptr;
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+/**
+ * Created by G-Canvas Open Source Team.
+ * Copyright (c) 2017, Alibaba, Inc. All rights reserved.
+ *
+ * This source code is licensed under the Apache Licence 2.0.
+ * For the full copyright and license information, please view
+ * the LICENSE file in the root directory of this source tree.
+ */
+#ifndef GCANVAS_TRACERING_H
+#define GCANVAS_TRACERING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace gcanvas
+{
+
+enum TraceEvent
+{
+    TRACE_CMD_QUEUED = 1,   // type, args length
+    TRACE_CMD_EXEC,         // type, args length
+    TRACE_CMD_DRAIN,        // commands run, commands coalesced into them
+    TRACE_RENDER_2D,        // command length
+    TRACE_RENDER_WEBGL,     // command length
+    TRACE_SYNC_RESULT,      // result length
+
+    TRACE_USER = 1000       // first id free for callers
+};
+
+struct TraceRecord
+{
+    uint64_t timeNs;     // steady clock
+    uint32_t event;
+    uint32_t thread;     // small per process thread number
+    int32_t arg0;
+    int32_t arg1;
+};
+
+/**
+ * Process wide ring of the last CAPACITY hot path events, cheap enough to
+ * leave in the command loop: recording is a few relaxed atomic stores and
+ * takes no lock, older records are overwritten. Off until SetEnabled(true),
+ * compiled out with GCANVAS_DISABLE_TRACE.
+ *
+ * Snapshot() and Dump() may run on any thread while others record, records
+ * that are being overwritten at that moment are left out.
+ */
+class TraceRing
+{
+public:
+    static const uint32_t CAPACITY = 4096;   // power of two
+
+    static void SetEnabled(bool enabled);
+
+    static bool IsEnabled()
+    {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    static void Record(uint32_t event, int32_t arg0, int32_t arg1);
+
+    // oldest first, returns the number of records
+    static size_t Snapshot(std::vector<TraceRecord> &records);
+
+    // one line per record, times relative to the oldest one
+    static void Dump(FILE *file);
+
+    static const char *EventName(uint32_t event);
+
+private:
+    static std::atomic<bool> sEnabled;
+};
+
+}
+
+#ifdef GCANVAS_DISABLE_TRACE
+#define GTRACE(event, arg0, arg1) do { } while (0)
+#else
+#define GTRACE(event, arg0, arg1)                                                   \
+    do {                                                                            \
+        if (gcanvas::TraceRing::IsEnabled())                                        \
+            gcanvas::TraceRing::Record((event), (int32_t)(arg0), (int32_t)(arg1));  \
+    } while (0)
+#endif
+
+#endif /* GCANVAS_TRACERING_H */
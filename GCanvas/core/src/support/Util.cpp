@@ -56,6 +56,41 @@ void FlipPixel(unsigned char *pixels, int w, int h)
     }
 }
 
+void GetSegmentPixel(const unsigned char *srcPixels, unsigned int srcWidth,
+                     unsigned int x, unsigned int y, unsigned int w,
+                     unsigned int h, unsigned char *destPixels)
+{
+    const unsigned char *src = srcPixels + (y * srcWidth + x) * 4;
+    for (unsigned int row = 0; row < h; ++row)
+    {
+        memcpy(destPixels, src, w * 4);
+        src += srcWidth * 4;
+        destPixels += w * 4;
+    }
+}
+
+void DownsamplePixels(const unsigned char *srcPixels, unsigned int w,
+                      unsigned int h, unsigned char *destPixels)
+{
+    unsigned int destWidth = w / 2;
+    unsigned int destHeight = h / 2;
+    unsigned int stride = w * 4;
+    for (unsigned int y = 0; y < destHeight; ++y)
+    {
+        const unsigned char *row0 = srcPixels + (y * 2) * stride;
+        const unsigned char *row1 = row0 + stride;
+        for (unsigned int x = 0; x < destWidth; ++x)
+        {
+            for (unsigned int c = 0; c < 4; ++c)
+            {
+                unsigned int sum = row0[x * 8 + c] + row0[x * 8 + 4 + c] +
+                                   row1[x * 8 + c] + row1[x * 8 + 4 + c];
+                *destPixels++ = (unsigned char)((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
 #ifdef ANDROID
 void timeraddMS(struct timeval *a, uint ms)
 {
@@ -20,6 +20,15 @@ namespace gcanvas
 {
 // flip the pixels by y axis
 void FlipPixel(unsigned char *pixels, int w, int h);
+
+// copy the w*h RGBA block at (x, y) out of a srcWidth wide image
+void GetSegmentPixel(const unsigned char *srcPixels, unsigned int srcWidth,
+                     unsigned int x, unsigned int y, unsigned int w,
+                     unsigned int h, unsigned char *destPixels);
+
+// 2x2 box filter RGBA pixels into a (w / 2) * (h / 2) image
+void DownsamplePixels(const unsigned char *srcPixels, unsigned int w,
+                      unsigned int h, unsigned char *destPixels);
     
 #ifdef ANDROID
 
@@ -0,0 +1,21 @@
+ctx.fillStyle = "#000000";
+ctx.fillRect(0, 0, c.width, c.height);
+
+ctx.save();
+ctx.beginPath();
+ctx.rect(0, 0, 100*ratio, 100*ratio);
+ctx.clip();
+
+ctx.save();
+ctx.beginPath();
+ctx.arc(50*ratio, 50*ratio, 40*ratio, 0, Math.PI * 2, false);
+ctx.clip();
+
+ctx.resetClip();
+ctx.fillStyle = "#00ff00";
+ctx.fillRect(150*ratio, 150*ratio, 100*ratio, 100*ratio);
+
+ctx.restore();
+ctx.fillStyle = "#0000ff";
+ctx.fillRect(0, 0, c.width, c.height);
+ctx.restore();
\ No newline at end of file
@@ -1,7 +1,35 @@
 #include "GBenchMark.h"
+#include "GCanvasWeex.hpp"
+#include "GCommandRecorder.h"
+#include "GGLStateCache.h"
+#include "GWebglBinaryStream.h"
+#include "support/Encode.h"
+#include "support/GLUtil.h"
+#include <chrono>
+#include <cmath>
 #include <fstream>
+#include <thread>
+
+// TextureMgr has no decoder of its own, png textures go through lodepng
+static unsigned char *decodePngImage(const unsigned char *buffer, unsigned int size,
+                                     unsigned int *w, unsigned int *h)
+{
+    std::vector<unsigned char> decoded;
+    unsigned width = 0, height = 0;
+    if (lodepng::decode(decoded, width, height, buffer, size) != 0 || decoded.empty())
+    {
+        return nullptr;
+    }
+    unsigned char *pixels = new unsigned char[decoded.size()];
+    memcpy(pixels, &decoded[0], decoded.size());
+    *w = width;
+    *h = height;
+    return pixels;
+}
+
 GBenchMark::GBenchMark(int width, int height) : mWidth(width), mHeight(height)
 {
+    TextureMgr::SetDecodeImageCallback(decodePngImage);
     std::shared_ptr<gcanvas::GCanvas> p(new gcanvas::GCanvas("benchMark", {true, true}, nullptr));
     this->mCanvas = p;
 }
@@ -146,6 +174,7 @@ void GBenchMark::run(std::string caseName, std::function<void(std::shared_ptr<gc
      p->OnSurfaceChanged(0,0,mWidth,mHeight);
      p->Clear();
     glClearColor(255,255,255,255);
+    p->BeginFrame();
     drawFunc(p, p->mCanvasContext, mWidth, mHeight);
     p->drawFrame();
     this->render2file(caseName);
@@ -170,3 +199,678 @@ void GBenchMark::dumpResult()
     }
      myfile.close();
 }
+
+// pbuffer context for one worker thread, made current on creation
+static bool createPbufferContext(int width, int height, EGLDisplay &display,
+                                 EGLSurface &surface, EGLContext &context)
+{
+    display = eglGetDisplay((EGLNativeDisplayType)0);
+    if (!eglInitialize(display, 0, 0))
+    {
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                              EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+                              EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+                              EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 16, EGL_STENCIL_SIZE, 8,
+                              EGL_NONE};
+    EGLConfig config;
+    int configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount != 1)
+    {
+        return false;
+    }
+
+    EGLint surfaceAttribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT)
+    {
+        return false;
+    }
+    return eglMakeCurrent(display, surface, surface, context) == EGL_TRUE;
+}
+
+float GBenchMark::runParallel(const std::vector<std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas, GCanvasContext *ctx, int width, int height)>> &drawFuncs,
+                              int threadCount, int framesPerThread)
+{
+    int width = mWidth;
+    int height = mHeight;
+    std::vector<std::thread> workers;
+    std::vector<int> rendered(threadCount, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.push_back(std::thread([&drawFuncs, &rendered, t, width, height, framesPerThread]() {
+            EGLDisplay display;
+            EGLSurface surface = EGL_NO_SURFACE;
+            EGLContext context = EGL_NO_CONTEXT;
+            if (!createPbufferContext(width, height, display, surface, context))
+            {
+                printf("Error: thread %d could not create a pbuffer context\n", t);
+                return;
+            }
+
+            {
+                std::shared_ptr<gcanvas::GCanvas> p(new gcanvas::GCanvas("parallel" + std::to_string(t), {true, true}, nullptr));
+                p->CreateContext();
+                // the contexts share nothing, each needs its own programs
+                p->GetGCanvasContext()->SetShareGroup(context);
+                p->OnSurfaceChanged(0, 0, width, height);
+                for (int i = 0; i < framesPerThread; i++)
+                {
+                    for (size_t k = 0; k < drawFuncs.size(); k++)
+                    {
+                        p->Clear();
+                        p->BeginFrame();
+                        drawFuncs[k](p, p->mCanvasContext, width, height);
+                        p->drawFrame();
+                        rendered[t]++;
+                    }
+                }
+                glFinish();
+            }
+
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+            eglDestroySurface(display, surface);
+            eglReleaseThread();
+        }));
+    }
+
+    int total = 0;
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers[t].join();
+        total += rendered[t];
+    }
+    std::chrono::duration<float> seconds = std::chrono::steady_clock::now() - start;
+    return seconds.count() > 0 ? total / seconds.count() : 0;
+}
+
+static const char *REPLAY_VERTEX_SHADER =
+    "attribute vec3 position;\n"
+    "attribute vec3 normal;\n"
+    "attribute vec2 uv;\n"
+    "uniform mat4 modelViewMatrix;\n"
+    "uniform mat4 projectionMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "varying vec3 vNormal;\n"
+    "varying vec2 vUv;\n"
+    "void main() {\n"
+    "  vNormal = normalize(normalMatrix * normal);\n"
+    "  vUv = uv;\n"
+    "  gl_PointSize = 2.0;\n"
+    "  gl_Position = projectionMatrix * modelViewMatrix * vec4(position, 1.0);\n"
+    "}\n";
+
+static const char *REPLAY_FRAGMENT_SHADER =
+    "precision mediump float;\n"
+    "uniform vec3 diffuse;\n"
+    "uniform float opacity;\n"
+    "uniform sampler2D map;\n"
+    "varying vec3 vNormal;\n"
+    "varying vec2 vUv;\n"
+    "void main() {\n"
+    "  float light = max(dot(vNormal, vec3(0.0, 0.0, 1.0)), 0.2);\n"
+    "  gl_FragColor = vec4(diffuse * light, opacity) * texture2D(map, vUv);\n"
+    "}\n";
+
+// objects of the recorded scene, created once before recording
+struct ReplayScene
+{
+    GLuint program;
+    GLint position, normal, uv;
+    GLint modelView, projection, normalMatrix, diffuse, opacity, map;
+    GLuint positionBuffer, normalBuffer, uvBuffer, indexBuffer, particleBuffer;
+    GLuint texture;
+    int indexCount;
+    int particleCount;
+};
+
+static GLuint compileReplayShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    return shader;
+}
+
+static void createReplayScene(ReplayScene &scene)
+{
+    scene.program = glCreateProgram();
+    glAttachShader(scene.program, compileReplayShader(GL_VERTEX_SHADER, REPLAY_VERTEX_SHADER));
+    glAttachShader(scene.program, compileReplayShader(GL_FRAGMENT_SHADER, REPLAY_FRAGMENT_SHADER));
+    glLinkProgram(scene.program);
+    scene.position = glGetAttribLocation(scene.program, "position");
+    scene.normal = glGetAttribLocation(scene.program, "normal");
+    scene.uv = glGetAttribLocation(scene.program, "uv");
+    scene.modelView = glGetUniformLocation(scene.program, "modelViewMatrix");
+    scene.projection = glGetUniformLocation(scene.program, "projectionMatrix");
+    scene.normalMatrix = glGetUniformLocation(scene.program, "normalMatrix");
+    scene.diffuse = glGetUniformLocation(scene.program, "diffuse");
+    scene.opacity = glGetUniformLocation(scene.program, "opacity");
+    scene.map = glGetUniformLocation(scene.program, "map");
+
+    // a 32x32 segment sphere, positions double as normals
+    const int segments = 32;
+    std::vector<float> positions, uvs;
+    std::vector<unsigned short> indices;
+    for (int y = 0; y <= segments; y++)
+    {
+        for (int x = 0; x <= segments; x++)
+        {
+            float u = (float)x / segments, v = (float)y / segments;
+            positions.push_back(-cosf(u * 6.2831853f) * sinf(v * 3.1415926f));
+            positions.push_back(cosf(v * 3.1415926f));
+            positions.push_back(sinf(u * 6.2831853f) * sinf(v * 3.1415926f));
+            uvs.push_back(u);
+            uvs.push_back(1 - v);
+        }
+    }
+    for (int y = 0; y < segments; y++)
+    {
+        for (int x = 0; x < segments; x++)
+        {
+            unsigned short a = y * (segments + 1) + x, b = a + segments + 1;
+            unsigned short tri[6] = {a, b, (unsigned short)(a + 1), b, (unsigned short)(b + 1), (unsigned short)(a + 1)};
+            indices.insert(indices.end(), tri, tri + 6);
+        }
+    }
+    scene.indexCount = (int)indices.size();
+
+    GLuint buffers[5];
+    glGenBuffers(5, buffers);
+    scene.positionBuffer = buffers[0];
+    scene.normalBuffer = buffers[1];
+    scene.uvBuffer = buffers[2];
+    scene.indexBuffer = buffers[3];
+    scene.particleBuffer = buffers[4];
+    glBindBuffer(GL_ARRAY_BUFFER, scene.positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, scene.normalBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, scene.uvBuffer);
+    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(float), &uvs[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+
+    scene.particleCount = 5000;
+    glBindBuffer(GL_ARRAY_BUFFER, scene.particleBuffer);
+    glBufferData(GL_ARRAY_BUFFER, scene.particleCount * 3 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+
+    std::vector<unsigned char> pixels(64 * 64 * 4, 255);
+    glGenTextures(1, &scene.texture);
+    glBindTexture(GL_TEXTURE_2D, scene.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+}
+
+static void bindReplayAttribute(GWebglBinaryWriter &w, GLuint buffer, GLint location, int size)
+{
+    w.Begin(WEBGL_CMD_BIND_BUFFER); w.Int(GL_ARRAY_BUFFER); w.Int(buffer); w.End();
+    w.Begin(WEBGL_CMD_VERTEX_ATTRIB_POINTER);
+    w.Int(location); w.Int(size); w.Int(GL_FLOAT); w.Int(0); w.Int(0); w.Int(0);
+    w.End();
+    w.Begin(WEBGL_CMD_ENABLE_VERTEX_ATTRIB_ARRAY); w.Int(location); w.End();
+}
+
+// What a three.js renderer emits for 300 textured meshes and one animated
+// point cloud. Typed array payloads are also returned in payloads.
+static void recordReplayFrame(const ReplayScene &scene, int width, int height,
+                              GWebglBinaryWriter &w, std::vector<std::vector<float>> &payloads)
+{
+    const int objectCount = 300;
+
+    w.Begin(WEBGL_CMD_VIEWPORT); w.Float(0); w.Float(0); w.Float(width); w.Float(height); w.End();
+    w.Begin(WEBGL_CMD_CLEAR_COLOR); w.Float(0); w.Float(0); w.Float(0); w.Float(1); w.End();
+    w.Begin(WEBGL_CMD_CLEAR); w.Int(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); w.End();
+    w.Begin(WEBGL_CMD_ENABLE); w.Int(GL_DEPTH_TEST); w.End();
+    w.Begin(WEBGL_CMD_DEPTH_FUNC); w.Int(GL_LEQUAL); w.End();
+    w.Begin(WEBGL_CMD_ENABLE); w.Int(GL_CULL_FACE); w.End();
+    w.Begin(WEBGL_CMD_FRONT_FACE); w.Int(GL_CCW); w.End();
+    w.Begin(WEBGL_CMD_USE_PROGRAM); w.Int(scene.program); w.End();
+
+    std::vector<float> projection = {1.3f, 0, 0, 0, 0, 1.3f, 0, 0, 0, 0, -1.002f, -1, 0, 0, -0.2f, 0};
+    payloads.push_back(projection);
+    w.Begin(WEBGL_CMD_UNIFORM_MATRIX4FV); w.Int(scene.projection); w.Int(0);
+    w.Bytes(&projection[0], projection.size() * sizeof(float)); w.End();
+
+    for (int i = 0; i < objectCount; i++)
+    {
+        float x = (i % 20) - 9.5f, y = (i / 20) - 7.0f;
+        std::vector<float> modelView = {0.3f, 0, 0, 0, 0, 0.3f, 0, 0, 0, 0, 0.3f, 0, x, y, -20, 1};
+        std::vector<float> normalMatrix = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        std::vector<float> diffuse = {(i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f};
+        payloads.push_back(modelView);
+        payloads.push_back(normalMatrix);
+        payloads.push_back(diffuse);
+
+        w.Begin(WEBGL_CMD_UNIFORM_MATRIX4FV); w.Int(scene.modelView); w.Int(0);
+        w.Bytes(&modelView[0], modelView.size() * sizeof(float)); w.End();
+        w.Begin(WEBGL_CMD_UNIFORM_MATRIX3FV); w.Int(scene.normalMatrix); w.Int(0);
+        w.Bytes(&normalMatrix[0], normalMatrix.size() * sizeof(float)); w.End();
+        w.Begin(WEBGL_CMD_UNIFORM3FV); w.Int(scene.diffuse);
+        w.Bytes(&diffuse[0], diffuse.size() * sizeof(float)); w.End();
+        w.Begin(WEBGL_CMD_UNIFORM1F); w.Int(scene.opacity); w.Float(1); w.End();
+
+        bindReplayAttribute(w, scene.positionBuffer, scene.position, 3);
+        bindReplayAttribute(w, scene.normalBuffer, scene.normal, 3);
+        bindReplayAttribute(w, scene.uvBuffer, scene.uv, 2);
+
+        w.Begin(WEBGL_CMD_ACTIVE_TEXTURE); w.Int(GL_TEXTURE0); w.End();
+        w.Begin(WEBGL_CMD_BIND_TEXTURE); w.Int(GL_TEXTURE_2D); w.Int(scene.texture); w.End();
+        w.Begin(WEBGL_CMD_UNIFORM1I); w.Int(scene.map); w.Int(0); w.End();
+        w.Begin(WEBGL_CMD_BIND_BUFFER); w.Int(GL_ELEMENT_ARRAY_BUFFER); w.Int(scene.indexBuffer); w.End();
+        w.Begin(WEBGL_CMD_DRAW_ELEMENTS);
+        w.Int(GL_TRIANGLES); w.Int(scene.indexCount); w.Int(GL_UNSIGNED_SHORT); w.Int(0);
+        w.End();
+    }
+
+    // point cloud animated on the JS side, uploaded every frame
+    std::vector<float> particles(scene.particleCount * 3);
+    for (int i = 0; i < scene.particleCount; i++)
+    {
+        particles[i * 3] = sinf(i * 0.37f) * 8;
+        particles[i * 3 + 1] = cosf(i * 0.11f) * 6;
+        particles[i * 3 + 2] = -15 - (i % 10);
+    }
+    payloads.push_back(particles);
+    w.Begin(WEBGL_CMD_BIND_BUFFER); w.Int(GL_ARRAY_BUFFER); w.Int(scene.particleBuffer); w.End();
+    w.Begin(WEBGL_CMD_BUFFER_SUB_DATA); w.Int(GL_ARRAY_BUFFER); w.Int(0);
+    w.Bytes(&particles[0], particles.size() * sizeof(float)); w.End();
+    w.Begin(WEBGL_CMD_VERTEX_ATTRIB_POINTER);
+    w.Int(scene.position); w.Int(3); w.Int(GL_FLOAT); w.Int(0); w.Int(0); w.Int(0);
+    w.End();
+    w.Begin(WEBGL_CMD_DISABLE_VERTEX_ATTRIB_ARRAY); w.Int(scene.normal); w.End();
+    w.Begin(WEBGL_CMD_DISABLE_VERTEX_ATTRIB_ARRAY); w.Int(scene.uv); w.End();
+    w.Begin(WEBGL_CMD_DRAW_ARRAYS); w.Int(GL_POINTS); w.Int(0); w.Int(scene.particleCount); w.End();
+}
+
+void GBenchMark::runWebGLReplay(int frames)
+{
+    ReplayScene scene;
+    createReplayScene(scene);
+
+    GWebglBinaryWriter frame;
+    std::vector<std::vector<float>> payloads;
+    recordReplayFrame(scene, mWidth, mHeight, frame, payloads);
+
+    // the text protocol carries payloads as base64 of "1.5,2,..."
+    std::vector<std::string> textPayloads;
+    size_t payloadBytes = 0;
+    for (size_t i = 0; i < payloads.size(); i++)
+    {
+        std::string list;
+        char number[32];
+        for (size_t k = 0; k < payloads[i].size(); k++)
+        {
+            snprintf(number, sizeof(number), k ? ",%g" : "%g", payloads[i][k]);
+            list += number;
+        }
+        int len = (int)list.size();
+        std::string encoded(gcanvas::Base64EncodeLen(len) + 1, '\0');
+        gcanvas::Base64EncodeBuf(&encoded[0], list.c_str(), len);
+        encoded.resize(len);
+        textPayloads.push_back(encoded);
+        payloadBytes += payloads[i].size() * sizeof(float);
+    }
+
+    GWebglBinaryReader reader;
+    int failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        if (reader.Execute(frame.Data(), frame.Size()) < 0)
+        {
+            ++failed;
+        }
+    }
+    glFinish();
+    std::chrono::duration<double, std::milli> binary = std::chrono::steady_clock::now() - start;
+
+    // decode, split and copy every payload like ParseTokensBase64 +
+    // SplitStringToFloat32Array, without the GL calls
+    std::string decoded;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        for (size_t k = 0; k < textPayloads.size(); k++)
+        {
+            int len = (int)textPayloads[k].size();
+            decoded.resize(gcanvas::Base64DecodeLen(len) + 1);
+            gcanvas::Base64DecodeBuf(&decoded[0], textPayloads[k].c_str(), len);
+            decoded[len] = '\0';
+            std::vector<float> elems;
+            for (char *s = strtok(&decoded[0], ","); s; s = strtok(NULL, ","))
+            {
+                elems.push_back(atof(s));
+            }
+            float *array = (float *)malloc(elems.size() * sizeof(float));
+            memcpy(array, &elems[0], elems.size() * sizeof(float));
+            free(array);
+        }
+    }
+    std::chrono::duration<double, std::milli> text = std::chrono::steady_clock::now() - start;
+
+    printf("webgl replay: %zu bytes/frame, %zu payloads (%zu bytes), %d frames failed\n",
+           frame.Size(), payloads.size(), payloadBytes, failed);
+    printf("  binary stream, incl. GL:      %8.3f ms/frame\n", binary.count() / frames);
+    printf("  text payload decode, no GL:   %8.3f ms/frame\n", text.count() / frames);
+}
+
+// one frame record of a capture; time summed over the loops, the counts of
+// the last loop, when programs and textures are already in place
+struct CaptureFrame
+{
+    const char *kind;
+    size_t bytes;
+    double cpuMs;
+    long drawCalls;
+    unsigned long glIssued;
+    unsigned long glSkipped;
+};
+
+static unsigned long issuedGLCalls(gcanvas::GCanvasWeex &canvas)
+{
+    return GGLStateCache::Current()->IssuedCount() +
+           canvas.mCanvasContext->GetVertexArrayCache().IssuedCount() +
+           canvas.mWebglState.IssuedCount();
+}
+
+static unsigned long skippedGLCalls(gcanvas::GCanvasWeex &canvas)
+{
+    return GGLStateCache::Current()->SkippedCount() +
+           canvas.mCanvasContext->GetVertexArrayCache().SkippedCount() +
+           canvas.mWebglState.FilteredCount();
+}
+
+// what GCanvasWeex::bindTexture / texSubImage2D do with an Android bitmap
+static void replayBitmap(gcanvas::GCanvasWeex &canvas, const GCaptureRecord &record)
+{
+    const std::vector<int32_t> &h = record.header;
+    const void *pixels = record.data.empty() ? nullptr : &record.data[0];
+    // recorded tightly packed, see GCanvasWeex::RecordBitmap
+    GLint alignment = gcanvas::UnpackAlignment();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (h[CAPTURE_BITMAP_SUB_IMAGE])
+    {
+        glTexSubImage2D(h[CAPTURE_BITMAP_TARGET], h[CAPTURE_BITMAP_LEVEL],
+                        h[CAPTURE_BITMAP_XOFFSET], h[CAPTURE_BITMAP_YOFFSET],
+                        h[CAPTURE_BITMAP_WIDTH], h[CAPTURE_BITMAP_HEIGHT],
+                        h[CAPTURE_BITMAP_FORMAT], h[CAPTURE_BITMAP_TYPE], pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+        return;
+    }
+
+    GLuint glID = 0;
+    bool is2d = canvas.GetContextType() == 0;
+    if (is2d)
+    {
+        glGenTextures(1, &glID);
+        GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glTexImage2D(h[CAPTURE_BITMAP_TARGET], h[CAPTURE_BITMAP_LEVEL],
+                 h[CAPTURE_BITMAP_INTERNAL_FORMAT], h[CAPTURE_BITMAP_WIDTH],
+                 h[CAPTURE_BITMAP_HEIGHT], 0, h[CAPTURE_BITMAP_FORMAT],
+                 h[CAPTURE_BITMAP_TYPE], pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    if (is2d)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        canvas.AddTexture(h[CAPTURE_BITMAP_ID], glID, h[CAPTURE_BITMAP_WIDTH],
+                          h[CAPTURE_BITMAP_HEIGHT]);
+    }
+}
+
+// false when the record has fewer header fields or data bytes than its
+// replay reads
+static bool captureRecordFits(const GCaptureRecord &r)
+{
+    size_t headers = 0, bytes = 0;
+    switch (r.type)
+    {
+    case CAPTURE_SURFACE:
+        headers = 4;
+        break;
+    case CAPTURE_CONTEXT_TYPE:
+    case CAPTURE_REMOVE_TEXTURE:
+        headers = 1;
+        break;
+    case CAPTURE_DEVICE_PIXEL_RATIO:
+        bytes = sizeof(float);
+        break;
+    case CAPTURE_CLEAR_COLOR:
+        bytes = 4 * sizeof(float);
+        break;
+    case CAPTURE_PNG_TEXTURE:
+    case CAPTURE_COMPRESSED_TEXTURE:
+        headers = 2;
+        break;
+    case CAPTURE_EXTERNAL_TEXTURE:
+        headers = 3;
+        break;
+    case CAPTURE_BITMAP:
+    {
+        headers = CAPTURE_BITMAP_HEADER_COUNT;
+        if (r.header.size() < headers)
+        {
+            return false;
+        }
+        const std::vector<int32_t> &h = r.header;
+        if (h[CAPTURE_BITMAP_WIDTH] < 0 || h[CAPTURE_BITMAP_HEIGHT] < 0)
+        {
+            return false;
+        }
+        bytes = gcanvas::TexImageSize(h[CAPTURE_BITMAP_WIDTH], h[CAPTURE_BITMAP_HEIGHT],
+                                      h[CAPTURE_BITMAP_FORMAT], h[CAPTURE_BITMAP_TYPE], 1);
+        break;
+    }
+    default:
+        break;
+    }
+    return r.header.size() >= headers && r.data.size() >= bytes;
+}
+
+bool GBenchMark::runCapture(const std::string &path, int loops)
+{
+    GCaptureReader reader;
+    if (!reader.Open(path))
+    {
+        printf("replay: %s is not a capture\n", path.c_str());
+        return false;
+    }
+    std::vector<GCaptureRecord> records;
+    GCaptureRecord record;
+    while (reader.Next(record))
+    {
+        records.push_back(record);
+    }
+    reader.Close();
+
+    size_t frameRecords = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (!captureRecordFits(records[i]))
+        {
+            printf("replay: record %zu (type %d) of %s is cut short\n", i, records[i].type,
+                   path.c_str());
+            return false;
+        }
+        int type = records[i].type;
+        if (type == CAPTURE_RENDER || type == CAPTURE_WEBGL || type == CAPTURE_WEBGL_BINARY)
+        {
+            frameRecords++;
+        }
+    }
+
+    std::vector<CaptureFrame> frames;
+    std::vector<GFrameStats> stats;
+    for (int loop = 0; loop < loops; loop++)
+    {
+        gcanvas::GCanvasWeex canvas("replay", {true, true});
+        // GCANVAS_RECORD_DIR must not capture the replay itself
+        canvas.StopRecording();
+        canvas.CreateContext();
+        canvas.initWebglExt();
+        // every Render of the replay is one profiler frame
+        canvas.mCanvasContext->GetFrameProfiler().SetCapacity(frameRecords);
+        canvas.SetFrameStatsEnabled(true);
+        std::vector<GLuint> externalTextures;
+
+        size_t frame = 0;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            const GCaptureRecord &r = records[i];
+            const std::vector<int32_t> &h = r.header;
+            const unsigned char *data = r.data.empty() ? nullptr : (const unsigned char *)&r.data[0];
+            int length = (int)r.data.size();
+            unsigned int width = 0, height = 0;
+
+            switch (r.type)
+            {
+            case CAPTURE_SURFACE:
+                canvas.OnSurfaceChanged(h[0], h[1], h[2], h[3]);
+                continue;
+            case CAPTURE_CONTEXT_TYPE:
+                canvas.SetContextType(h[0]);
+                continue;
+            case CAPTURE_DEVICE_PIXEL_RATIO:
+                canvas.SetDevicePixelRatio(*(const float *)data);
+                continue;
+            case CAPTURE_CLEAR_COLOR:
+            {
+                const float *c = (const float *)data;
+                canvas.SetClearColor(GColorRGBA{{c[0], c[1], c[2], c[3]}});
+                continue;
+            }
+            case CAPTURE_PNG_TEXTURE:
+                if (h[1])
+                {
+                    canvas.AddPngTextureAsync(data, length, h[0]);
+                }
+                else
+                {
+                    canvas.AddPngTexture(data, length, h[0], &width, &height);
+                }
+                continue;
+            case CAPTURE_COMPRESSED_TEXTURE:
+                canvas.AddCompressedTexture(data, length, h[0], h[1] != 0, &width, &height);
+                continue;
+            case CAPTURE_EXTERNAL_TEXTURE:
+            {
+                // a blank texture of the same size stands in for the host's
+                GLuint glID = 0;
+                glGenTextures(1, &glID);
+                GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, glID);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, h[1], h[2], 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, nullptr);
+                externalTextures.push_back(glID);
+                canvas.AddTexture(h[0], glID, h[1], h[2]);
+                continue;
+            }
+            case CAPTURE_REMOVE_TEXTURE:
+                canvas.RemoveTexture(h[0]);
+                continue;
+            case CAPTURE_BITMAP:
+                replayBitmap(canvas, r);
+                continue;
+            case CAPTURE_RENDER:
+            case CAPTURE_WEBGL:
+            case CAPTURE_WEBGL_BINARY:
+                break;
+            default:
+                continue;
+            }
+
+            // a frame: the commands of one Render, WebGL proc or binary call
+            GCanvasContext *ctx = canvas.mCanvasContext;
+            long draws = ctx->DrawCallCount() + (long)canvas.mWebglBinaryReader.DrawCount();
+            unsigned long issued = issuedGLCalls(canvas);
+            unsigned long skipped = skippedGLCalls(canvas);
+
+            auto start = std::chrono::steady_clock::now();
+            if (r.type == CAPTURE_WEBGL_BINARY)
+            {
+                canvas.RenderWebGLBinary(data, length);
+            }
+            else
+            {
+                // WebGL proc commands run through Render of the WebGL context
+                canvas.Render((const char *)data, length);
+            }
+            std::chrono::duration<double, std::milli> cpu = std::chrono::steady_clock::now() - start;
+            // the GPU catches up outside the measured time
+            glFinish();
+
+            if (frame == frames.size())
+            {
+                CaptureFrame f = {};
+                f.kind = r.type == CAPTURE_WEBGL_BINARY ? "binary" :
+                         (canvas.GetContextType() == 0 ? "2d" : "webgl");
+                f.bytes = r.data.size();
+                frames.push_back(f);
+            }
+            CaptureFrame &f = frames[frame++];
+            f.cpuMs += cpu.count();
+            f.drawCalls = ctx->DrawCallCount() + (long)canvas.mWebglBinaryReader.DrawCount() - draws;
+            f.glIssued = issuedGLCalls(canvas) - issued;
+            f.glSkipped = skippedGLCalls(canvas) - skipped;
+        }
+
+        // phases and GPU time of the last loop
+        glFinish();
+        canvas.GetFrameStats(stats);
+
+        if (!externalTextures.empty())
+        {
+            glDeleteTextures((GLsizei)externalTextures.size(), &externalTextures[0]);
+        }
+        GGLStateCache::Current()->Invalidate();
+    }
+
+    printf("replay %s: %zu records, %zu frames, %d loops\n", path.c_str(), records.size(),
+           frames.size(), loops);
+    printf("%6s %-7s %9s %10s %7s %10s %10s %8s %8s %9s %9s %8s\n", "frame", "kind", "bytes",
+           "cpu ms", "draws", "gl issued", "gl skipped", "parse ms", "tess ms", "upload KB",
+           "vertices", "gpu ms");
+    double total = 0, slowest = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const CaptureFrame &f = frames[i];
+        double ms = f.cpuMs / loops;
+        total += ms;
+        slowest = std::max(slowest, ms);
+        printf("%6zu %-7s %9zu %10.3f %7ld %10lu %10lu", i, f.kind, f.bytes, ms,
+               f.drawCalls, f.glIssued, f.glSkipped);
+        if (i < stats.size())
+        {
+            const GFrameStats &s = stats[i];
+            printf(" %8.3f %8.3f %9.1f %9llu", s.parseMs, s.tessellationMs,
+                   s.textureUploadBytes / 1024.0, (unsigned long long)s.vertexCount);
+            if (s.gpuMs >= 0)
+            {
+                printf(" %8.3f", s.gpuMs);
+            }
+            else
+            {
+                printf(" %8s", "-");
+            }
+        }
+        printf("\n");
+    }
+    if (!frames.empty())
+    {
+        printf("cpu: %.3f ms/frame average, %.3f ms slowest\n", total / frames.size(), slowest);
+    }
+    return true;
+}
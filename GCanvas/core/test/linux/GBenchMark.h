@@ -23,6 +23,20 @@ public:
     void run(std::string caseName, std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas,  GCanvasContext *mCanvasContext,int width,int height)> drawFunc);
 
     void dumpResult();
+
+    // Render every case framesPerThread times on each of threadCount
+    // threads, each thread owning an EGL pbuffer context and its canvas.
+    // Returns frames per second over all threads.
+    float runParallel(const std::vector<std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas,  GCanvasContext *mCanvasContext,int width,int height)>> &drawFuncs,
+                      int threadCount, int framesPerThread);
+    // Replay a recorded three.js style frame through the binary WebGL stream
+    // and compare with decoding the same payloads the way the text protocol
+    // does. Needs intilGLOffScreenEnviroment() first.
+    void runWebGLReplay(int frames);
+    // Replay a capture of GCanvasWeex (GCANVAS_RECORD_DIR, StartRecording)
+    // loops times and print CPU time, draw calls and GL calls per frame.
+    // Needs intilGLOffScreenEnviroment() first.
+    bool runCapture(const std::string &path, int loops);
 private:
     std::shared_ptr<gcanvas::GCanvas> mCanvas;
     void initGcanvas();
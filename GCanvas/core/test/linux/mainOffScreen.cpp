@@ -4,26 +4,76 @@
 #include <algorithm>
 
 #include <iostream>
+#include <thread>
 #include <GCanvas.hpp>
 #include <lodepng.h>
 
 #define CONTEXT_ES20
 
 #include "GBenchMark.h"
+#include "support/TraceRing.h"
 const static GLuint renderBufferHeight = 400;
 const static GLuint renderBufferWidth = 400;
 
    
+static void dumpTrace()
+{
+    gcanvas::TraceRing::Dump(stdout);
+}
+
 extern void prepareCases( std::unordered_map< std::string,std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas,  GCanvasContext *mCanvasContext,int width,int height)>>  &testCases);
 
 int main(int argc, char *argv[])
 {
+    // ./gcanvasTest --trace <mode>: record the hot path events of any mode
+    // below, the last ones are printed on exit
+    if (argc > 1 && std::string(argv[1]) == "--trace")
+    {
+        gcanvas::TraceRing::SetEnabled(true);
+        atexit(dumpTrace);
+        --argc;
+        ++argv;
+    }
+
     std::unordered_map< std::string,std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas,  GCanvasContext *mCanvasContext,int width,int height)>> testCases;
 
     prepareCases(testCases);
 
    GBenchMark becnMarker(renderBufferWidth,renderBufferHeight);
+
+   // ./gcanvasTest --parallel [frames]: scale all cases over 1..N threads
+   if (argc > 1 && std::string(argv[1]) == "--parallel")
+   {
+       int frames = argc > 2 ? atoi(argv[2]) : 20;
+       std::vector<std::function<void(std::shared_ptr<gcanvas::GCanvas> canvas,  GCanvasContext *mCanvasContext,int width,int height)>> drawFuncs;
+       for(auto it=testCases.begin();it!=testCases.end();it++){
+           drawFuncs.push_back(it->second);
+       }
+       int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+       float base = 0;
+       for (int threads = 1; threads <= maxThreads; threads *= 2)
+       {
+           float fps = becnMarker.runParallel(drawFuncs, threads, frames);
+           if (threads == 1) base = fps;
+           printf("threads %2d: %8.1f frames/s, speedup %.2f\n", threads, fps, base > 0 ? fps / base : 0);
+       }
+       return 0;
+   }
+
    becnMarker.intilGLOffScreenEnviroment();
+
+   // ./gcanvasTest --webgl-replay [frames]: binary WebGL stream replay
+   if (argc > 1 && std::string(argv[1]) == "--webgl-replay")
+   {
+       becnMarker.runWebGLReplay(argc > 2 ? atoi(argv[2]) : 100);
+       return 0;
+   }
+
+   // ./gcanvasTest --replay <capture> [loops]: replay a recorded canvas
+   if (argc > 2 && std::string(argv[1]) == "--replay")
+   {
+       return becnMarker.runCapture(argv[2], argc > 3 ? atoi(argv[3]) : 1) ? 0 : 1;
+   }
    for(auto it=testCases.begin();it!=testCases.end();it++){
             becnMarker.run(it->first,it->second);
    }
@@ -90,6 +90,7 @@ int main(void) {
  
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
+        c.BeginFrame();
         c.mCanvasContext->SetFillStyle("#ff0000");
         c.mCanvasContext->FillRect(0,0,WIDTH,HEIGHT);
         c.drawFrame();
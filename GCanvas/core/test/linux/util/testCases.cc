@@ -107,6 +107,30 @@ void prepareCases(std::unordered_map<std::string, std::function<void(std::shared
         ctx->SetFillStyle("#00ff00");
         ctx->FillRect(180 * ratio, 180 * ratio, 200 * ratio, 200 * ratio);
     };
+    testCases["td_2d_resetClip"] = [](std::shared_ptr<gcanvas::GCanvas> canvas, GCanvasContext *ctx, int width, int height) {
+        int ratio = 1;
+        ctx->SetFillStyle("#000000");
+        ctx->FillRect(0, 0, width, height);
+
+        ctx->Save();
+        ctx->BeginPath();
+        ctx->Rect(0, 0, 100 * ratio, 100 * ratio);
+        ctx->Clip();
+
+        ctx->Save();
+        ctx->BeginPath();
+        ctx->Arc(50 * ratio, 50 * ratio, 40 * ratio, 0, M_PI * 2, false);
+        ctx->Clip();
+
+        ctx->ResetClip();
+        ctx->SetFillStyle("#00ff00");
+        ctx->FillRect(150 * ratio, 150 * ratio, 100 * ratio, 100 * ratio);
+
+        ctx->Restore();
+        ctx->SetFillStyle("#0000ff");
+        ctx->FillRect(0, 0, width, height);
+        ctx->Restore();
+    };
 
     testCases["tc_2d_clearRect"] = [](std::shared_ptr<gcanvas::GCanvas> canvas, GCanvasContext *ctx, int width, int height) {
         int ratio = 1;
@@ -2,7 +2,7 @@
 const puppeteer = require('puppeteer');
 let caseNames = {
     "arc" :["tc_2d_arc.js","tc_2d_arcTo.js","tc_2d_MDN_arc.js","tc_2d_MDN_arcTo_1.js","tc_2d_MDN_arcTo_2.js",],
-    "clip" :["td_2d_clip.js",],
+    "clip" :["td_2d_clip.js","td_2d_resetClip.js",],
     "composite" :["compite_desover.js","composite_sourceover.js",],
     "eclipse" :["tc_2d_ellipse.js",],
     "fill" :["tc_2d_clearRect.js","tc_2d_fill.js","tc_2d_fillRect.js","tc_2d_text_fillText.js",],
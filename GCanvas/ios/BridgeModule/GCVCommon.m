@@ -8,6 +8,7 @@
  */
 
 #import "GCVCommon.h"
+#import "GCanvasPlugin.h"
 #import <OpenGLES/ES2/glext.h>  //define of GL_BGRA
 
 @implementation GCVImageCache
@@ -112,10 +113,9 @@
     CGContextRelease(context);
     CGColorSpaceRelease(colorSpace);
 
-    glEnable(GL_TEXTURE_2D);
     GLuint glID;
     glGenTextures(1, &glID);
-    glBindTexture(GL_TEXTURE_2D, glID);
+    [GCanvasPlugin bindTexture2D:glID];
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -313,7 +313,7 @@ static NSMutableDictionary  *_staticModuleExistDict;
         
         void (^bindImageTextureBlock)(GCVImageCache*) = ^(GCVImageCache* cache){
             dispatch_main_async_safe(^{
-                [EAGLContext setCurrentContext:component.glkview.context];
+                [GCanvasPlugin setCurrentContext:component.glkview.context];
                 textureId = [GCVCommon bindTexture:cache.image];
                 if( textureId > 0 ){
                     GCVLOG_METHOD(@"==>bindImageTexture success: jsTextureId:%d => texutreId:%d, componentId:%@", jsTextureId, textureId, componentId);
@@ -486,7 +486,7 @@ static NSMutableDictionary  *_staticModuleExistDict;
     GCVLOG_METHOD(@"glkView:drawInRect:, componentId:%@, context:%p", component.componentId, component.glkview.context);
     
     //multi GCanvas instance, need change current context while execute render commands
-    [EAGLContext setCurrentContext:component.glkview.context];
+    [GCanvasPlugin setCurrentContext:component.glkview.context];
     
     if ( component.needChangeEAGLContenxt ){
         [self refreshPlugin:plugin withComponent:component];
@@ -540,7 +540,7 @@ static NSMutableDictionary  *_staticModuleExistDict;
     if( !component || !plugin ) return @{};
     
     if ( component.needChangeEAGLContenxt ){
-        [EAGLContext setCurrentContext:component.glkview.context];
+        [GCanvasPlugin setCurrentContext:component.glkview.context];
         
         [self refreshPlugin:plugin withComponent:component];
         component.needChangeEAGLContenxt = NO;
@@ -41,6 +41,21 @@ typedef GCanvasPlugin* (^FetchPluginBlock)(NSString * componentId);
 + (void)setLogLevel:(NSUInteger)logLevel;
 
 + (void)setFetchPlugin:(FetchPluginBlock)block;
+
+/**
+ *  @abstract   make context current for GCanvas rendering, use it instead of
+ *              [EAGLContext setCurrentContext:] so the GL state mirror of the
+ *              thread is dropped when it switches to another canvas' context
+ *  @param      context   EAGLContext of the GLKView
+ */
++ (void)setCurrentContext:(EAGLContext*)context;
+
+/**
+ *  @abstract   bind a texture to GL_TEXTURE_2D through the GL state mirror of
+ *              the thread, for GL calls made outside GCanvas
+ *  @param      textureId   texture name, 0 unbinds
+ */
++ (void)bindTexture2D:(GLuint)textureId;
 /**
  *  @abstract   init GCanvas with componentId
  *  @param      componentId   unique instance bind GCanvas
@@ -143,6 +158,20 @@ typedef GCanvasPlugin* (^FetchPluginBlock)(NSString * componentId);
  */
 - (CGFloat)fps;
 
+/**
+ *  @abstract   turn per frame statistics on or off, off by default
+ */
+- (void)setFrameStatsEnabled:(BOOL)enabled;
+
+/**
+ *  @abstract   get the newest frame statistics
+ *
+ *  @param maxFrames        frames to return, 0 for all that are kept
+ *
+ *  @return     {"frames":[...]} with one object per frame, oldest first
+ */
+- (NSString*)frameStatsJson:(NSUInteger)maxFrames;
+
 /**
  *  @abstract   get GCanvas textureId
  *
@@ -161,7 +190,7 @@ typedef GCanvasPlugin* (^FetchPluginBlock)(NSString * componentId);
 - (NSString*)getSyncResult;
 
 /**
- *  @abstract   set GLKView
+ *  @abstract   set GLKView, its context's sharegroup keys the shader programs
  */
 - (void)setGLKView:(GLKView*)glkview;
 
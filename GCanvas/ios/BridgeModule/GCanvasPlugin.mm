@@ -15,6 +15,7 @@
 #include "GCanvasWeex.hpp"
 #include "GCanvas2dContext.h"
 #include "GCanvasManager.h"
+#include "GGLStateCache.h"
 #include "Log.h"
 
 
@@ -40,6 +41,20 @@
     SetLogLevel((LogLevel)logLevel);
 }
 
++ (void)setCurrentContext:(EAGLContext*)context{
+    // the mirror is per thread, it must not carry the state of one context into another
+    static thread_local void *gMirroredContext = NULL;
+    [EAGLContext setCurrentContext:context];
+    if( gMirroredContext != (__bridge void *)context ){
+        GGLStateCache::Current()->Invalidate();
+        gMirroredContext = (__bridge void *)context;
+    }
+}
+
++ (void)bindTexture2D:(GLuint)textureId{
+    GGLStateCache::Current()->BindTexture(GL_TEXTURE_2D, textureId);
+}
+
 + (FetchPluginBlock)GetFetchPluginBlock{
     static FetchPluginBlock gFetchPluginBlock;
     return gFetchPluginBlock;
@@ -214,6 +229,17 @@
     return self.gcanvas->mFps;
 }
 
+- (void)setFrameStatsEnabled:(BOOL)enabled{
+    if( !self.gcanvas ) return;
+    self.gcanvas->SetFrameStatsEnabled(enabled);
+}
+
+- (NSString*)frameStatsJson:(NSUInteger)maxFrames{
+    if( !self.gcanvas ) return @"{\"frames\":[]}";
+    std::string json = self.gcanvas->GetFrameStatsJson(maxFrames);
+    return [NSString stringWithUTF8String:json.c_str()];
+}
+
 - (GLuint)textureId{
     if( !self.gcanvas ) return 0;
     return self.gcanvas->GetFboTexture()->GetTextureID();
@@ -232,6 +258,10 @@
 
 - (void)setGLKView:(GLKView*)glkview{
     self.glkview = glkview;
+    // contexts of one EAGLSharegroup reuse each other's programs
+    if( self.context && glkview.context ){
+        self.context->SetShareGroup((__bridge const void *)glkview.context.sharegroup);
+    }
 }
 
 - (GLKView*)getGLKView{
@@ -60,6 +60,10 @@ const GBridge = {
   flushNative: function(componentId) { },
   callNative: function(componentId, cmdArgs, cache) { },
 
+  callNativeBatch: function(componentId, cmdArgsArray) {
+    return cmdArgsArray.map(cmdArgs => GBridge.callNative(componentId, cmdArgs));
+  },
+
   texImage2D(componentId, ...args) {
     if (isReactNativeIOS()) {
       if (args.length === 6) {
@@ -41,6 +41,10 @@ function joinArray(arr, sep) {
 
 const commandsCache = {};
 
+// see GCANVAS_BATCH_FLAG in GCanvasLinkNative.h
+const BATCH_FLAG = 0x10000000;
+const BATCH_SEPARATOR = '\x1e';
+
 const GBridge = {
 
   callEnable: (ref, configArray) => {
@@ -90,7 +94,9 @@ const GBridge = {
       console.log('>>> commands: ' + commands);
     }
 
-    callGCanvasLinkNative(componentId, 0x20000001, commands);
+    // without the sync bit (0x20000000) nothing waits for the GL thread, and
+    // frames queued before it runs are drawn as one
+    callGCanvasLinkNative(componentId, 0x00000001, commands);
   },
 
   callExtendCallNative: isWeexIOS ? function(componentId, cmdArgs) {
@@ -154,6 +160,35 @@ const GBridge = {
     }
   },
 
+  // Runs several sync commands in one round trip, results in order. Android
+  // takes them as one batch call, iOS has no batch entry and calls each.
+  callNativeBatch: isWeexIOS ? function(componentId, cmdArgsArray) {
+    return cmdArgsArray.map(cmdArgs => GBridge.callNative(componentId, cmdArgs));
+  } : function(componentId, cmdArgsArray) {
+    if (cmdArgsArray.length === 0) {
+      return [];
+    }
+    if (isDebugging) {
+      cmdArgsArray.forEach(cmdArgs => logCommand(componentId, cmdArgs));
+    }
+
+    // commands cached so far run ahead of the first one, as in flushNative
+    const pending = commandsCache[componentId];
+    commandsCache[componentId] = [];
+    const batch = cmdArgsArray.slice();
+    if (pending.length > 0) {
+      batch[0] = joinArray(pending, ';') + ';' + batch[0];
+    }
+
+    const result = callGCanvasLinkNative(componentId, 0x60000000 | BATCH_FLAG, joinArray(batch, BATCH_SEPARATOR));
+
+    if (isDebugging) {
+      console.log('>>> batch result: ' + result);
+    }
+
+    return result ? result.split(BATCH_SEPARATOR) : cmdArgsArray.map(() => '');
+  },
+
   texImage2D(componentId, ...args) {
     if (isWeexIOS) {
       if (args.length === 6) {
@@ -139,4 +139,7 @@ GLmethod.vertexAttrib4fv = i++; // new
 GLmethod.vertexAttribPointer = i++;
 GLmethod.viewport = i++;
 
+// gcanvas extension, the attribute and uniform locations of a program
+GLmethod.getProgramLocationsGCANVAS = 307;
+
 export default GLmethod;
\ No newline at end of file
@@ -11,6 +11,8 @@ export default class WebGLProgram {
 
   constructor(id) {
     this.id = id;
+    // locations by name since the last linkProgram, see getAttribLocation
+    this._locations = null;
   }
 
   static uuid = uuid;
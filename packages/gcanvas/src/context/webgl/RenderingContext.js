@@ -46,6 +46,51 @@ const processArray = (array, checkArrayType = false) => {
   return ArrayTypes[type] + ',' + btoa(joinArray(array, ','));
 };
 
+// "linkStatus;" then an attribute and a uniform block, each "count;" and
+// "location,type,size,name;" per variable, as getProgramLocationsGCANVAS
+// answers
+const parseLocationTable = (table) => {
+  const locations = {
+    attributes: {},
+    uniforms: {}
+  };
+  const fields = String(table).split(';');
+  if (fields[0] !== '1') {
+    return locations;
+  }
+  let index = 1;
+  [locations.attributes, locations.uniforms].forEach(block => {
+    const count = parseInt(fields[index++]) || 0;
+    for (let i = 0; i < count; i++) {
+      const [location, type, size, name] = fields[index++].split(',');
+      block[name] = Number(location);
+      // an array is also found by its bare name
+      if (name.endsWith('[0]')) {
+        block[name.slice(0, -3)] = Number(location);
+      }
+    }
+  });
+  return locations;
+};
+
+// limits do not change while the context lives, renderers query them one
+// after another on setup, so the first query fetches them all in one batch
+const LIMIT_PARAMETERS = [
+  GLenum.MAX_TEXTURE_SIZE,
+  GLenum.MAX_CUBE_MAP_TEXTURE_SIZE,
+  GLenum.MAX_RENDERBUFFER_SIZE,
+  GLenum.MAX_TEXTURE_IMAGE_UNITS,
+  GLenum.MAX_VERTEX_TEXTURE_IMAGE_UNITS,
+  GLenum.MAX_COMBINED_TEXTURE_IMAGE_UNITS,
+  GLenum.MAX_VERTEX_ATTRIBS,
+  GLenum.MAX_VERTEX_UNIFORM_VECTORS,
+  GLenum.MAX_VARYING_VECTORS,
+  GLenum.MAX_FRAGMENT_UNIFORM_VECTORS,
+  GLenum.MAX_VIEWPORT_DIMS,
+  GLenum.ALIASED_POINT_SIZE_RANGE,
+  GLenum.ALIASED_LINE_WIDTH_RANGE
+];
+
 export default class WebGLRenderingContext {
   // static GBridge = null;
 
@@ -57,6 +102,7 @@ export default class WebGLRenderingContext {
     this._version = 'WebGL 1.0';
     this._attrs = attrs;
     this._map = new Map();
+    this._limits = null;
 
     Object.keys(GLenum)
           .forEach(name => Object.defineProperty(this, name, {
@@ -543,11 +589,25 @@ export default class WebGLRenderingContext {
     return ids.map(id => this._map.get(Shader.uuid(id)));
   }
 
+  // one sync call per program and link rather than one per name
+  _getProgramLocations = function(program) {
+    if (!program._locations) {
+      const table = WebGLRenderingContext.GBridge.callNative(
+        this._canvas.id,
+        GLmethod.getProgramLocationsGCANVAS + ',' + program.id
+      );
+      // a timed out call is asked again next time
+      if (!table) {
+        return parseLocationTable('');
+      }
+      program._locations = parseLocationTable(table);
+    }
+    return program._locations;
+  }
+
   getAttribLocation = function(progarm, name) {
-    return WebGLRenderingContext.GBridge.callNative(
-      this._canvas.id,
-      GLmethod.getAttribLocation + ',' + progarm.id + ',' + name
-    );
+    const location = this._getProgramLocations(progarm).attributes[name];
+    return location === undefined ? -1 : location;
   }
 
   getBufferParameter = function(target, pname) {
@@ -583,11 +643,26 @@ export default class WebGLRenderingContext {
     }
   }
 
+  _getLimit = function(pname) {
+    if (!this._limits) {
+      const results = WebGLRenderingContext.GBridge.callNativeBatch(
+        this._canvas.id,
+        LIMIT_PARAMETERS.map(name => GLmethod.getParameter + ',' + name)
+      );
+      this._limits = {};
+      LIMIT_PARAMETERS.forEach((name, i) => {
+        this._limits[name] = results[i];
+      });
+    }
+    return this._limits[pname];
+  }
+
   getParameter = function(pname) {
-    const result = WebGLRenderingContext.GBridge.callNative(
-      this._canvas.id,
-      GLmethod.getParameter + ',' + pname
-    );
+    const result = LIMIT_PARAMETERS.indexOf(pname) >= 0 ? this._getLimit(pname) :
+      WebGLRenderingContext.GBridge.callNative(
+        this._canvas.id,
+        GLmethod.getParameter + ',' + pname
+      );
     switch (pname) {
       case GLenum.VERSION:
         return this._version;
@@ -704,14 +779,11 @@ export default class WebGLRenderingContext {
   }
 
   getUniformLocation = function(program, name) {
-    const id = WebGLRenderingContext.GBridge.callNative(
-      this._canvas.id,
-      GLmethod.getUniformLocation + ',' + program.id + ',' + name
-    );
-    if (id === -1) {
+    const id = this._getProgramLocations(program).uniforms[name];
+    if (id === undefined || id === -1) {
       return null;
     } else {
-      return new UniformLocation(Number(id));
+      return new UniformLocation(id);
     }
   }
 
@@ -806,6 +878,7 @@ export default class WebGLRenderingContext {
   }
 
   linkProgram = function(program) {
+    program._locations = null;
     WebGLRenderingContext.GBridge.callNative(
       this._canvas.id,
       GLmethod.linkProgram + ',' + program.id,